@@ -5,9 +5,12 @@ CLOUD_SERVER_SOURCES = \
 	$(SRC)/Cloud/Client.cpp \
 	$(SRC)/Cloud/Thermal.cpp \
 	$(SRC)/Cloud/Data.cpp \
+	$(SRC)/Cloud/Shards.cpp \
+	$(SRC)/Cloud/Event.cpp \
+	$(SRC)/Cloud/EventLog.cpp \
 	$(SRC)/Cloud/Sender.cpp \
 	$(SRC)/Cloud/Main.cpp
-CLOUD_SERVER_DEPENDS = ASYNC LIBNET IO OS GEO MATH UTIL
+CLOUD_SERVER_DEPENDS = ASYNC LIBNET IO OS THREAD GEO MATH UTIL
 $(eval $(call link-program,xcsoar-cloud-server,CLOUD_SERVER))
 
 CLOUD_TO_KML_SOURCES = \
@@ -20,6 +23,12 @@ CLOUD_TO_KML_SOURCES = \
 CLOUD_TO_KML_DEPENDS = ASYNC LIBNET IO OS GEO MATH UTIL
 $(eval $(call link-program,xcsoar-cloud-to-kml,CLOUD_TO_KML))
 
+CLOUD_DUMP_EVENTS_SOURCES = \
+	$(SRC)/Cloud/Event.cpp \
+	$(SRC)/Cloud/DumpEvents.cpp
+CLOUD_DUMP_EVENTS_DEPENDS = LIBNET IO OS GEO MATH UTIL
+$(eval $(call link-program,xcsoar-cloud-dump-events,CLOUD_DUMP_EVENTS))
+
 ifeq ($(TARGET),UNIX)
-OPTIONAL_OUTPUTS += $(CLOUD_SERVER_BIN) $(CLOUD_TO_KML_BIN)
+OPTIONAL_OUTPUTS += $(CLOUD_SERVER_BIN) $(CLOUD_TO_KML_BIN) $(CLOUD_DUMP_EVENTS_BIN)
 endif
@@ -8,6 +8,7 @@ PROFILE_SOURCES = \
 	$(SRC)/Profile/NumericValue.cpp \
 	$(SRC)/Profile/PathValue.cpp \
 	$(SRC)/Profile/GeoValue.cpp \
+	$(SRC)/Profile/Snapshot.cpp \
 	$(SRC)/Profile/ProfileMap.cpp
 
 PROFILE_DEPENDS = FMT
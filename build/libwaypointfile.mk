@@ -1,4 +1,5 @@
 WAYPOINTFILE_SOURCES = \
+	$(SRC)/Waypoint/ParallelParser.cpp \
 	$(SRC)/Waypoint/WaypointReaderBase.cpp \
 	$(SRC)/Waypoint/WaypointReaderOzi.cpp \
 	$(SRC)/Waypoint/WaypointReaderFS.cpp \
@@ -9,6 +10,6 @@ WAYPOINTFILE_SOURCES = \
 	$(SRC)/Waypoint/WaypointFileType.cpp \
 	$(SRC)/Waypoint/WaypointReader.cpp
 
-WAYPOINTFILE_DEPENDS = WAYPOINT CUPFILE UNITS IO
+WAYPOINTFILE_DEPENDS = WAYPOINT CUPFILE UNITS IO THREAD
 
 $(eval $(call link-library,libwaypointfile,WAYPOINTFILE))
@@ -190,6 +190,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Engine/Trace/Point.cpp \
 	$(SRC)/Engine/Trace/Trace.cpp \
 	$(SRC)/Engine/Trace/Vector.cpp \
+	$(SRC)/Engine/Trace/Snapshot.cpp \
 	$(SRC)/Engine/Util/Gradient.cpp \
 	$(SRC)/Engine/ThermalBand/ThermalBand.cpp \
 	$(SRC)/Engine/ThermalBand/ThermalSlice.cpp \
@@ -490,6 +491,8 @@ XCSOAR_SOURCES := \
 	\
 	$(SRC)/Job/Thread.cpp \
 	$(SRC)/Job/Async.cpp \
+	$(SRC)/Job/Graph.cpp \
+	$(SRC)/Job/Pool.cpp \
 	\
 	$(SRC)/RateLimiter.cpp \
 	\
@@ -85,6 +85,7 @@ endif
 ifeq ($(FREETYPE),y)
 SCREEN_SOURCES += \
 	$(CANVAS_SRC_DIR)/freetype/Font.cpp \
+	$(CANVAS_SRC_DIR)/freetype/GlyphAtlas.cpp \
 	$(CANVAS_SRC_DIR)/freetype/Init.cpp
 endif
 
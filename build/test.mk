@@ -55,6 +55,7 @@ $(1)_SOURCES = \
 	$(SRC)/Engine/Trace/Point.cpp \
 	$(SRC)/Engine/Trace/Trace.cpp \
 	$(SRC)/Engine/Trace/Vector.cpp \
+	$(SRC)/Engine/Trace/Snapshot.cpp \
 	$(SRC)/Engine/Navigation/Aircraft.cpp \
 	$(SRC)/Engine/Util/Gradient.cpp \
 	$(SRC)/NMEA/GPSState.cpp \
@@ -81,15 +82,24 @@ TEST_NAMES = \
 	TestTransponderCode \
 	TestMath \
 	TestMathTables \
+	TestPolynomialTrig \
 	TestAngle TestARange \
 	TestGrahamScan \
 	TestUnits TestEarth TestSunEphemeris \
 	TestValidity TestUTM \
 	TestAllocatedGrid \
-	TestRadixTree TestGeoBounds TestGeoClip \
+	TestRadixTree TestPrefixIndex TestPackedKDTree TestGeoBounds TestGeoClip \
+	TestRasterBuffer \
+	TestGlyphAtlas \
+	TestRasterCanvas \
+	TestLabelBlock \
 	TestLogger TestGRecord TestClimbAvCalc \
 	TestWaypointReader TestThermalBase \
+	TestJobGraph \
+	TestJobPool \
+	TestTraceSnapshot \
 	TestFlarmNet \
+	TestCloudShards \
 	TestColorRamp TestGeoPoint TestDiffFilter \
 	TestFileUtil TestPolars TestCSVLine TestGlidePolar \
 	test_replay_task TestProjection TestFlatPoint TestFlatLine TestFlatGeoPoint \
@@ -361,6 +371,12 @@ TEST_MATH_TABLES_SOURCES = \
 TEST_MATH_TABLES_DEPENDS = MATH
 $(eval $(call link-program,TestMathTables,TEST_MATH_TABLES))
 
+TEST_POLYNOMIAL_TRIG_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestPolynomialTrig.cpp
+TEST_POLYNOMIAL_TRIG_DEPENDS = GEO MATH
+$(eval $(call link-program,TestPolynomialTrig,TEST_POLYNOMIAL_TRIG))
+
 TEST_ANGLE_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestAngle.cpp
@@ -410,6 +426,20 @@ TEST_FLARM_NET_SOURCES = \
 TEST_FLARM_NET_DEPENDS = IO OS MATH UTIL
 $(eval $(call link-program,TestFlarmNet,TEST_FLARM_NET))
 
+TEST_CLOUD_SHARDS_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Cloud/Serialiser.cpp \
+	$(SRC)/Cloud/Client.cpp \
+	$(SRC)/Cloud/Thermal.cpp \
+	$(SRC)/Cloud/Data.cpp \
+	$(SRC)/Cloud/Shards.cpp \
+	$(SRC)/Cloud/Event.cpp \
+	$(SRC)/Cloud/EventLog.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestCloudShards.cpp
+TEST_CLOUD_SHARDS_DEPENDS = LIBNET IO OS THREAD GEO MATH UTIL
+$(eval $(call link-program,TestCloudShards,TEST_CLOUD_SHARDS))
+
 TEST_GEO_CLIP_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestGeoClip.cpp
@@ -427,7 +457,7 @@ TEST_PROJECTION_SOURCES = \
 	$(SRC)/Projection/Projection.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestProjection.cpp
-TEST_PROJECTION_DEPENDS = MATH
+TEST_PROJECTION_DEPENDS = GEO MATH
 TEST_PROJECTION_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,TestProjection,TEST_PROJECTION))
 
@@ -621,6 +651,45 @@ TEST_RADIX_TREE_SOURCES = \
 TEST_RADIX_TREE_DEPENDS = UTIL
 $(eval $(call link-program,TestRadixTree,TEST_RADIX_TREE))
 
+TEST_PREFIX_INDEX_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestPrefixIndex.cpp
+TEST_PREFIX_INDEX_DEPENDS = UTIL
+$(eval $(call link-program,TestPrefixIndex,TEST_PREFIX_INDEX))
+
+TEST_PACKED_KD_TREE_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestPackedKDTree.cpp
+TEST_PACKED_KD_TREE_DEPENDS = UTIL
+$(eval $(call link-program,TestPackedKDTree,TEST_PACKED_KD_TREE))
+
+TEST_RASTER_BUFFER_SOURCES = \
+	$(SRC)/Terrain/RasterBuffer.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestRasterBuffer.cpp
+TEST_RASTER_BUFFER_DEPENDS = UTIL
+$(eval $(call link-program,TestRasterBuffer,TEST_RASTER_BUFFER))
+
+TEST_GLYPH_ATLAS_SOURCES = \
+	$(CANVAS_SRC_DIR)/freetype/GlyphAtlas.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestGlyphAtlas.cpp
+TEST_GLYPH_ATLAS_DEPENDS = THREAD
+$(eval $(call link-program,TestGlyphAtlas,TEST_GLYPH_ATLAS))
+
+TEST_RASTER_CANVAS_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestRasterCanvas.cpp
+$(eval $(call link-program,TestRasterCanvas,TEST_RASTER_CANVAS))
+
+TEST_LABEL_BLOCK_SOURCES = \
+	$(SRC)/Renderer/LabelBlock.cpp \
+	$(SRC)/Renderer/WaypointLabelList.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestLabelBlock.cpp
+TEST_LABEL_BLOCK_DEPENDS = UTIL
+$(eval $(call link-program,TestLabelBlock,TEST_LABEL_BLOCK))
+
 TEST_LOGGER_SOURCES = \
 	$(SRC)/IGC/IGCFix.cpp \
 	$(SRC)/IGC/IGCWriter.cpp \
@@ -686,6 +755,22 @@ TEST_WAY_POINT_FILE_SOURCES = \
 TEST_WAY_POINT_FILE_DEPENDS = WAYPOINTFILE OPERATION GEO MATH IO ZZIP OS THREAD UTIL
 $(eval $(call link-program,TestWaypointReader,TEST_WAY_POINT_FILE))
 
+TEST_JOB_GRAPH_SOURCES = \
+	$(SRC)/Job/Graph.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
+	$(TEST_SRC_DIR)/TestJobGraph.cpp
+TEST_JOB_GRAPH_DEPENDS = OPERATION OS THREAD UTIL FMT
+$(eval $(call link-program,TestJobGraph,TEST_JOB_GRAPH))
+
+TEST_JOB_POOL_SOURCES = \
+	$(SRC)/Job/Pool.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
+	$(TEST_SRC_DIR)/TestJobPool.cpp
+TEST_JOB_POOL_DEPENDS = THREAD UTIL FMT
+$(eval $(call link-program,TestJobPool,TEST_JOB_POOL))
+
 TEST_TRACE_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(SRC)/Engine/Trace/Point.cpp \
@@ -697,6 +782,16 @@ TEST_TRACE_SOURCES = \
 TEST_TRACE_DEPENDS = IO OS GEO MATH UTIL
 $(eval $(call link-program,TestTrace,TEST_TRACE))
 
+TEST_TRACE_SNAPSHOT_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(SRC)/Engine/Trace/Point.cpp \
+	$(SRC)/Engine/Trace/Trace.cpp \
+	$(SRC)/Engine/Trace/Vector.cpp \
+	$(SRC)/Engine/Trace/Snapshot.cpp \
+	$(TEST_SRC_DIR)/TestTraceSnapshot.cpp
+TEST_TRACE_SNAPSHOT_DEPENDS = GEO MATH UTIL
+$(eval $(call link-program,TestTraceSnapshot,TEST_TRACE_SNAPSHOT))
+
 FLIGHT_TABLE_SOURCES = \
 	$(SRC)/IGC/IGCParser.cpp \
 	$(TEST_SRC_DIR)/FlightTable.cpp
@@ -719,7 +814,14 @@ DEBUG_PROGRAM_NAMES = \
 	TestTrace \
 	FlightTable \
 	BenchmarkProjection \
+	BenchmarkDistanceBearing \
+	BenchmarkRasterPolygon \
+	BenchmarkLabelBlock \
 	BenchmarkFAITriangleSector \
+	BenchmarkMacCready \
+	BenchmarkWaypointReader \
+	BenchmarkWaypointTree \
+	BenchmarkTrace \
 	DumpTextInflate \
 	DumpHexColor \
 	RunXMLParser \
@@ -808,6 +910,10 @@ DEBUG_PROGRAM_NAMES += DownloadFile \
 	RunNOAADownloader RunSkyLinesTracking RunLiveTrack24
 endif
 
+ifeq ($(TARGET),UNIX)
+DEBUG_PROGRAM_NAMES += FloodSkyLinesServer
+endif
+
 ifeq ($(TARGET_IS_LINUX),y)
 DEBUG_PROGRAM_NAMES += RunWPASupplicant
 endif
@@ -875,10 +981,33 @@ DEBUG_REPLAY_DEPENDS = DRIVER ASYNC LIBNET IO OS THREAD TIME
 BENCHMARK_PROJECTION_SOURCES = \
 	$(SRC)/Projection/Projection.cpp \
 	$(TEST_SRC_DIR)/BenchmarkProjection.cpp
-BENCHMARK_PROJECTION_DEPENDS = MATH
+BENCHMARK_PROJECTION_DEPENDS = GEO MATH
 BENCHMARK_PROJECTION_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,BenchmarkProjection,BENCHMARK_PROJECTION))
 
+BENCHMARK_DISTANCE_BEARING_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkDistanceBearing.cpp
+BENCHMARK_DISTANCE_BEARING_DEPENDS = GEO MATH
+$(eval $(call link-program,BenchmarkDistanceBearing,BENCHMARK_DISTANCE_BEARING))
+
+BENCHMARK_RASTER_POLYGON_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkRasterPolygon.cpp
+$(eval $(call link-program,BenchmarkRasterPolygon,BENCHMARK_RASTER_POLYGON))
+
+BENCHMARK_LABEL_BLOCK_SOURCES = \
+	$(SRC)/Renderer/LabelBlock.cpp \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/Compatibility/fmode.c \
+	$(SRC)/RadioFrequency.cpp \
+	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkLabelBlock.cpp
+BENCHMARK_LABEL_BLOCK_LDADD = $(FAKE_LIBS)
+BENCHMARK_LABEL_BLOCK_DEPENDS = WAYPOINTFILE OPERATION IO OS THREAD ZZIP GEO MATH UTIL
+BENCHMARK_LABEL_BLOCK_CPPFLAGS = $(SCREEN_CPPFLAGS)
+$(eval $(call link-program,BenchmarkLabelBlock,BENCHMARK_LABEL_BLOCK))
+
 BENCHMARK_FAI_TRIANGLE_SECTOR_SOURCES = \
 	$(ENGINE_SRC_DIR)/Task/Shapes/FAITriangleSettings.cpp \
 	$(ENGINE_SRC_DIR)/Task/Shapes/FAITriangleArea.cpp \
@@ -886,6 +1015,45 @@ BENCHMARK_FAI_TRIANGLE_SECTOR_SOURCES = \
 BENCHMARK_FAI_TRIANGLE_SECTOR_DEPENDS = GEO MATH
 $(eval $(call link-program,BenchmarkFAITriangleSector,BENCHMARK_FAI_TRIANGLE_SECTOR))
 
+BENCHMARK_MACCREADY_SOURCES = \
+	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/Compatibility/fmode.c \
+	$(SRC)/RadioFrequency.cpp \
+	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkMacCready.cpp
+BENCHMARK_MACCREADY_LDADD = $(FAKE_LIBS)
+BENCHMARK_MACCREADY_DEPENDS = WAYPOINTFILE GLIDE OPERATION IO OS THREAD ZZIP GEO MATH UTIL
+$(eval $(call link-program,BenchmarkMacCready,BENCHMARK_MACCREADY))
+
+BENCHMARK_WAYPOINT_READER_SOURCES = \
+	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/Compatibility/fmode.c \
+	$(SRC)/RadioFrequency.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkWaypointReader.cpp
+BENCHMARK_WAYPOINT_READER_LDADD = $(FAKE_LIBS)
+BENCHMARK_WAYPOINT_READER_DEPENDS = WAYPOINTFILE OPERATION IO OS THREAD ZZIP GEO MATH UTIL
+$(eval $(call link-program,BenchmarkWaypointReader,BENCHMARK_WAYPOINT_READER))
+
+BENCHMARK_WAYPOINT_TREE_SOURCES = \
+	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/Compatibility/fmode.c \
+	$(SRC)/RadioFrequency.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkWaypointTree.cpp
+BENCHMARK_WAYPOINT_TREE_LDADD = $(FAKE_LIBS)
+BENCHMARK_WAYPOINT_TREE_DEPENDS = WAYPOINTFILE OPERATION IO OS THREAD ZZIP GEO MATH UTIL
+$(eval $(call link-program,BenchmarkWaypointTree,BENCHMARK_WAYPOINT_TREE))
+
+BENCHMARK_TRACE_SOURCES = \
+	$(SRC)/Engine/Trace/Point.cpp \
+	$(SRC)/Engine/Trace/Trace.cpp \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(TEST_SRC_DIR)/BenchmarkTrace.cpp
+BENCHMARK_TRACE_DEPENDS = IO OS GEO MATH UTIL
+$(eval $(call link-program,BenchmarkTrace,BENCHMARK_TRACE))
+
 DUMP_TEXT_FILE_SOURCES = \
 	$(TEST_SRC_DIR)/DumpTextFile.cpp
 DUMP_TEXT_FILE_DEPENDS = IO OS ZZIP UTIL
@@ -993,6 +1161,15 @@ RUN_SL_TRACKING_SOURCES = \
 RUN_SL_TRACKING_DEPENDS = $(DEBUG_REPLAY_DEPENDS)
 $(eval $(call link-program,RunSkyLinesTracking,RUN_SL_TRACKING))
 
+FLOOD_SL_SERVER_SOURCES = \
+	$(SRC)/net/SocketError.cxx \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Engine/Navigation/Aircraft.cpp \
+	$(SRC)/Replay/AircraftSim.cpp \
+	$(TEST_SRC_DIR)/FloodSkyLinesServer.cpp
+FLOOD_SL_SERVER_DEPENDS = LIBNET OS IO GEO MATH UTIL
+$(eval $(call link-program,FloodSkyLinesServer,FLOOD_SL_SERVER))
+
 RUN_LIVETRACK24_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/net/SocketError.cxx \
@@ -1641,6 +1818,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Engine/Trace/Point.cpp \
 	$(SRC)/Engine/Trace/Trace.cpp \
 	$(SRC)/Engine/Trace/Vector.cpp \
+	$(SRC)/Engine/Trace/Snapshot.cpp \
 	$(SRC)/Engine/Navigation/Aircraft.cpp \
 	$(ENGINE_SRC_DIR)/ThermalBand/ThermalBand.cpp \
 	$(ENGINE_SRC_DIR)/ThermalBand/ThermalSlice.cpp \
@@ -1740,6 +1918,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Atmosphere/Pressure.cpp \
 	$(SRC)/Atmosphere/AirDensity.cpp \
 	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
+	$(SRC)/Job/Pool.cpp \
 	$(TEST_SRC_DIR)/Fonts.cpp \
 	$(TEST_SRC_DIR)/FakeAsset.cpp \
 	$(TEST_SRC_DIR)/FakeDialogs.cpp \
@@ -2054,6 +2233,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Engine/Trace/Point.cpp \
 	$(SRC)/Engine/Trace/Trace.cpp \
 	$(SRC)/Engine/Trace/Vector.cpp \
+	$(SRC)/Engine/Trace/Snapshot.cpp \
 	$(ENGINE_SRC_DIR)/ThermalBand/ThermalBand.cpp \
 	$(SRC)/UIUtil/GestureManager.cpp \
 	$(SRC)/Task/DefaultTask.cpp \
@@ -14,6 +14,8 @@
 #include <boost/geometry/algorithms/intersection.hpp>
 #include <boost/geometry/strategies/strategies.hpp>
 
+#include <cassert>
+
 CloudClientContainer::CloudClientContainer()
   :key_set(typename KeySet::bucket_traits(key_buckets, N_KEY_BUCKETS)) {}
 
@@ -103,6 +105,17 @@ CloudClientContainer::Remove(CloudClient &client)
   rtree.remove(client.shared_from_this());
 }
 
+CloudClientPtr
+CloudClientContainer::PopBack()
+{
+  assert(!list.empty());
+
+  auto &item = list.back();
+  auto ptr = item.shared_from_this();
+  Remove(item);
+  return ptr;
+}
+
 void
 CloudClientContainer::Expire(std::chrono::steady_clock::time_point before)
 {
@@ -190,19 +203,35 @@ CloudClient::Load(Deserialiser &s)
 }
 
 void
-CloudClientContainer::Save(Serialiser &s) const
+CloudClientContainer::SaveHeader(Serialiser &s, unsigned next_id)
 {
   s.Write32(next_id);
+}
 
+void
+CloudClientContainer::SaveRecords(Serialiser &s) const
+{
   for (const auto &client : list) {
     s.Write8(1);
     client.Save(s);
   }
+}
 
+void
+CloudClientContainer::SaveTrailer(Serialiser &s)
+{
   s.Write8(0);
   s.Write8(0);
 }
 
+void
+CloudClientContainer::Save(Serialiser &s) const
+{
+  SaveHeader(s, next_id);
+  SaveRecords(s);
+  SaveTrailer(s);
+}
+
 void
 CloudClientContainer::Load(Deserialiser &s)
 {
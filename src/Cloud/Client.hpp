@@ -196,6 +196,14 @@ public:
     return list.empty();
   }
 
+  /**
+   * The public id which will be assigned to the next new
+   * #CloudClient.
+   */
+  unsigned GetNextId() const noexcept {
+    return next_id;
+  }
+
   /**
    * For iteration over the list of all clients in unspecified order.
    * The iterators get invalidated by all modifying calls.
@@ -236,6 +244,13 @@ public:
    */
   void Remove(CloudClient &client);
 
+  /**
+   * Remove the oldest #CloudClient and return it, e.g. to insert it
+   * into another container.  Must not be called if the container is
+   * empty.
+   */
+  CloudClientPtr PopBack();
+
   void Expire(std::chrono::steady_clock::time_point before);
 
   typedef Tree::const_query_iterator query_iterator;
@@ -244,6 +259,15 @@ public:
   [[gnu::pure]]
   query_iterator_range QueryWithinRange(GeoPoint location, double range) const;
 
+  /**
+   * Save() consists of SaveHeader(), SaveRecords() and SaveTrailer();
+   * calling SaveRecords() of several containers in between writes
+   * them as one (see CloudData::Save()).
+   */
+  static void SaveHeader(Serialiser &s, unsigned next_id);
+  void SaveRecords(Serialiser &s) const;
+  static void SaveTrailer(Serialiser &s);
+
   void Save(Serialiser &s) const;
   void Load(Deserialiser &s);
 };
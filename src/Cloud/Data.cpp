@@ -32,12 +32,30 @@ CloudData::DumpClients()
 
 void
 CloudData::Save(Serialiser &s) const
+{
+  const CloudData *const parts[] = {this};
+  Save(s, parts, clients.GetNextId());
+}
+
+void
+CloudData::Save(Serialiser &s, std::span<const CloudData *const> parts,
+                unsigned next_id)
 {
   s.Write32(CLOUD_MAGIC);
   s.Write32(CLOUD_VERSION);
-  clients.Save(s);
+
+  CloudClientContainer::SaveHeader(s, next_id);
+  for (const auto *part : parts)
+    part->clients.SaveRecords(s);
+  CloudClientContainer::SaveTrailer(s);
+
   s.Write8(1);
-  thermals.Save(s);
+
+  CloudThermalContainer::SaveHeader(s);
+  for (const auto *part : parts)
+    part->thermals.SaveRecords(s);
+  CloudThermalContainer::SaveTrailer(s);
+
   s.Write8(0);
 }
 
@@ -6,6 +6,8 @@
 #include "Client.hpp"
 #include "Thermal.hpp"
 
+#include <span>
+
 class Serialiser;
 class Deserialiser;
 
@@ -16,5 +18,15 @@ struct CloudData {
   void DumpClients();
 
   void Save(Serialiser &s) const;
+
+  /**
+   * Write several #CloudData instances (e.g. the shards of
+   * #CloudShards) in the format of Save(), as if they were one.
+   * Load() reads them back into one #CloudData.
+   *
+   * @param next_id the public id of the next new client
+   */
+  static void Save(Serialiser &s, std::span<const CloudData *const> parts,
+                   unsigned next_id);
   void Load(Deserialiser &s);
 };
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "net/AllocatedSocketAddress.hxx"
+#include "net/StaticSocketAddress.hxx"
 #include "net/ToString.hxx"
 
 #include <iostream>
@@ -21,6 +22,12 @@ operator<<(std::ostream &stream, const AllocatedSocketAddress &address)
   return stream << SocketAddress(address);
 }
 
+inline std::ostream &
+operator<<(std::ostream &stream, const StaticSocketAddress &address)
+{
+  return stream << SocketAddress(address);
+}
+
 template<char positive, char negative>
 struct GeoAngle : Angle {
   constexpr GeoAngle(Angle _angle):Angle(_angle) {}
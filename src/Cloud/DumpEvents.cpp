@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Convert the binary event log of xcsoar-cloud-server to text or
+ * KML.
+ */
+
+#include "Event.hpp"
+#include "Tracking/SkyLines/Import.hpp"
+#include "io/FileReader.hxx"
+#include "system/Path.hpp"
+#include "util/ByteOrder.hxx"
+#include "util/PrintException.hxx"
+#include "util/StringAPI.hxx"
+
+#include <iostream>
+#include <iomanip>
+
+#include <time.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+static void
+WriteTime(std::ostream &os, uint64_t time_ms)
+{
+  const time_t t = time_ms / 1000;
+  struct tm tm;
+  gmtime_r(&t, &tm);
+
+  char buffer[32];
+  strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &tm);
+  os << buffer << '.' << std::setw(3) << std::setfill('0')
+     << time_ms % 1000 << std::setfill(' ') << 'Z';
+}
+
+static void
+ToText(const CloudEvent &event)
+{
+  WriteTime(cout, FromBE64(event.time));
+  cout << '\t' << event << '\n';
+}
+
+static void
+WriteCoordinates(const SkyLinesTracking::GeoPoint p, int16_t altitude)
+{
+  const auto location = SkyLinesTracking::ImportGeoPoint(p);
+  cout << location.longitude.Degrees() << ','
+       << location.latitude.Degrees() << ','
+       << (int16_t)FromBE16(altitude);
+}
+
+static void
+ToKML(const CloudEvent &event)
+{
+  const auto &geo = event.geo;
+
+  switch (event.type) {
+  case CloudEvent::Type::FIX:
+    cout << "<Placemark>\n"
+         << "  <name>" << FromBE32(event.client_id) << "</name>\n"
+         << "  <TimeStamp><when>";
+    WriteTime(cout, FromBE64(event.time));
+    cout << "</when></TimeStamp>\n"
+         << "  <Point><coordinates>";
+    WriteCoordinates(geo.location, geo.altitude);
+    cout << "</coordinates></Point>\n"
+         << "</Placemark>\n";
+    break;
+
+  case CloudEvent::Type::THERMAL:
+  case CloudEvent::Type::WAVE:
+    cout << "<Placemark>\n"
+         << "  <name>"
+         << (event.type == CloudEvent::Type::WAVE ? "wave " : "thermal ")
+         << (int16_t)FromBE16(geo.lift) / 256. << " m/s</name>\n"
+         << "  <TimeStamp><when>";
+    WriteTime(cout, FromBE64(event.time));
+    cout << "</when></TimeStamp>\n"
+         << "  <LineString><altitudeMode>absolute</altitudeMode><coordinates>";
+    WriteCoordinates(geo.location, geo.altitude);
+    cout << ' ';
+    WriteCoordinates(geo.location2,
+                     event.type == CloudEvent::Type::WAVE
+                     ? geo.altitude : geo.altitude2);
+    cout << "</coordinates></LineString>\n"
+         << "</Placemark>\n";
+    break;
+
+  case CloudEvent::Type::SEND_ERROR:
+    break;
+  }
+}
+
+int
+main(int argc, char **argv)
+try {
+  if (argc < 2 || argc > 3 ||
+      (argc == 3 && !StringIsEqual(argv[2], "text") &&
+       !StringIsEqual(argv[2], "kml"))) {
+    cerr << "Usage: " << argv[0] << " EVENTLOG [text|kml]" << endl;
+    return EXIT_FAILURE;
+  }
+
+  const Path path(argv[1]);
+  const bool kml = argc == 3 && StringIsEqual(argv[2], "kml");
+
+  FileReader file(path);
+  BufferedReader reader(file);
+
+  if (kml)
+    cout << std::fixed << std::setprecision(6)
+         << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+            "<Document>\n";
+
+  unsigned long n_invalid = 0;
+
+  ForEachEvent(reader, [&](const CloudEvent &event){
+    if (!IsValid(event))
+      ++n_invalid;
+    else if (kml)
+      ToKML(event);
+    else
+      ToText(event);
+  });
+
+  if (kml)
+    cout << "</Document>\n"
+            "</kml>\n";
+
+  cout.flush();
+
+  if (n_invalid > 0)
+    cerr << n_invalid << " invalid records" << endl;
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Event.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Dump.hpp"
+#include "Tracking/SkyLines/Export.hpp"
+#include "Tracking/SkyLines/Import.hpp"
+#include "net/IPv4Address.hxx"
+#include "net/IPv6Address.hxx"
+#include "net/StaticSocketAddress.hxx"
+#include "util/ByteOrder.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+static CloudEvent
+MakeEvent(CloudEvent::Type type, SocketAddress address,
+          uint64_t key, unsigned id) noexcept
+{
+  CloudEvent event{};
+  event.type = type;
+  event.client_id = ToBE32(id);
+  event.client_key = ToBE64(key);
+
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  event.time =
+    ToBE64(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+
+  switch (address.IsNull() ? AF_UNSPEC : address.GetFamily()) {
+  case AF_INET:
+    {
+      const auto &ipv4 = IPv4Address::Cast(address);
+      event.address_family = 4;
+      event.port = ToBE16(ipv4.GetPort());
+      memcpy(event.address, &ipv4.GetAddress(), 4);
+    }
+    break;
+
+  case AF_INET6:
+    {
+      const auto &ipv6 = IPv6Address::Cast(address);
+      event.address_family = 6;
+      event.port = ToBE16(ipv6.GetPort());
+      memcpy(event.address, &ipv6.GetAddress(), 16);
+    }
+    break;
+  }
+
+  return event;
+}
+
+static constexpr int16_t
+ExportAltitude(int altitude) noexcept
+{
+  return ToBE16(std::clamp(altitude, -32768, 32767));
+}
+
+static int16_t
+ExportLift(double lift) noexcept
+{
+  return ToBE16(std::clamp(std::lround(lift * 256), -32768L, 32767L));
+}
+
+CloudEvent
+MakeFixEvent(SocketAddress address, uint64_t key, unsigned id,
+             const ::GeoPoint &location, int altitude) noexcept
+{
+  auto event = MakeEvent(CloudEvent::Type::FIX, address, key, id);
+  event.geo.location = SkyLinesTracking::ExportGeoPoint(location);
+  event.geo.altitude = ExportAltitude(altitude);
+  return event;
+}
+
+CloudEvent
+MakeWaveEvent(SocketAddress address, uint64_t key, unsigned id,
+              const ::GeoPoint &a, const ::GeoPoint &b,
+              int bottom_altitude, int top_altitude,
+              double lift) noexcept
+{
+  auto event = MakeEvent(CloudEvent::Type::WAVE, address, key, id);
+  event.geo.location = SkyLinesTracking::ExportGeoPoint(a);
+  event.geo.location2 = SkyLinesTracking::ExportGeoPoint(b);
+  event.geo.altitude = ExportAltitude(bottom_altitude);
+  event.geo.altitude2 = ExportAltitude(top_altitude);
+  event.geo.lift = ExportLift(lift);
+  return event;
+}
+
+CloudEvent
+MakeThermalEvent(SocketAddress address, uint64_t key, unsigned id,
+                 const ::GeoPoint &bottom_location, int bottom_altitude,
+                 const ::GeoPoint &top_location, int top_altitude,
+                 double lift) noexcept
+{
+  auto event = MakeEvent(CloudEvent::Type::THERMAL, address, key, id);
+  event.geo.location = SkyLinesTracking::ExportGeoPoint(bottom_location);
+  event.geo.location2 = SkyLinesTracking::ExportGeoPoint(top_location);
+  event.geo.altitude = ExportAltitude(bottom_altitude);
+  event.geo.altitude2 = ExportAltitude(top_altitude);
+  event.geo.lift = ExportLift(lift);
+  return event;
+}
+
+CloudEvent
+MakeSendErrorEvent(SocketAddress address, std::string_view message) noexcept
+{
+  auto event = MakeEvent(CloudEvent::Type::SEND_ERROR, address, 0, 0);
+  message = message.substr(0, sizeof(event.message));
+  std::copy(message.begin(), message.end(), event.message);
+  return event;
+}
+
+bool
+IsValid(const CloudEvent &event) noexcept
+{
+  switch (event.type) {
+  case CloudEvent::Type::FIX:
+  case CloudEvent::Type::WAVE:
+  case CloudEvent::Type::THERMAL:
+  case CloudEvent::Type::SEND_ERROR:
+    return true;
+  }
+
+  return false;
+}
+
+StaticSocketAddress
+GetAddress(const CloudEvent &event) noexcept
+{
+  const unsigned port = FromBE16(event.port);
+
+  StaticSocketAddress result;
+
+  switch (event.address_family) {
+  case 4:
+    {
+      struct in_addr address;
+      memcpy(&address, event.address, sizeof(address));
+      result = IPv4Address(address, port);
+    }
+    break;
+
+  case 6:
+    {
+      struct in6_addr address;
+      memcpy(&address, event.address, sizeof(address));
+      result = IPv6Address(address, port);
+    }
+    break;
+  }
+
+  return result;
+}
+
+static std::ostream &
+WriteAddress(std::ostream &os, const CloudEvent &event)
+{
+  const auto address = GetAddress(event);
+  if (!address.IsDefined())
+    return os << '-';
+
+  return os << address;
+}
+
+static constexpr int
+ImportAltitude(int16_t altitude) noexcept
+{
+  return (int16_t)FromBE16(altitude);
+}
+
+static constexpr double
+ImportLift(int16_t lift) noexcept
+{
+  return (int16_t)FromBE16(lift) / 256.;
+}
+
+std::ostream &
+operator<<(std::ostream &os, const CloudEvent &event)
+{
+  switch (event.type) {
+  case CloudEvent::Type::FIX:
+    os << "FIX\t";
+    break;
+
+  case CloudEvent::Type::WAVE:
+    os << "WAVE\t";
+    break;
+
+  case CloudEvent::Type::THERMAL:
+    os << "THERMAL\t";
+    break;
+
+  case CloudEvent::Type::SEND_ERROR:
+    os << "SEND_ERROR\t";
+    WriteAddress(os, event) << '\t';
+    return os << std::string_view(event.message,
+                                  strnlen(event.message,
+                                          sizeof(event.message)));
+  }
+
+  WriteAddress(os, event) << '\t'
+    << std::hex << FromBE64(event.client_key) << std::dec << '\t'
+    << FromBE32(event.client_id) << '\t';
+
+  using SkyLinesTracking::ImportGeoPoint;
+  const auto &geo = event.geo;
+
+  switch (event.type) {
+  case CloudEvent::Type::FIX:
+    os << ImportGeoPoint(geo.location) << '\t'
+       << ImportAltitude(geo.altitude) << 'm';
+    break;
+
+  case CloudEvent::Type::WAVE:
+    os << ImportGeoPoint(geo.location) << '\t'
+       << ImportGeoPoint(geo.location2) << '\t'
+       << ImportAltitude(geo.altitude) << '-'
+       << ImportAltitude(geo.altitude2) << "m\t"
+       << ImportLift(geo.lift) << "m/s";
+    break;
+
+  case CloudEvent::Type::THERMAL:
+    os << ImportGeoPoint(geo.location2) << '\t'
+       << ImportAltitude(geo.altitude) << '-'
+       << ImportAltitude(geo.altitude2) << "m\t"
+       << ImportLift(geo.lift) << "m/s";
+    break;
+
+  case CloudEvent::Type::SEND_ERROR:
+    break;
+  }
+
+  return os;
+}
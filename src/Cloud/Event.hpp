@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "io/BufferedReader.hxx"
+
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <string_view>
+
+struct GeoPoint;
+class SocketAddress;
+class StaticSocketAddress;
+
+/**
+ * One record of the binary event log written by
+ * xcsoar-cloud-server.  All records have the same size, so the log
+ * file is just an array of them.  Integers are big-endian, like in
+ * the SkyLines tracking protocol.
+ */
+struct CloudEvent {
+  enum class Type : uint8_t {
+    FIX = 1,
+    WAVE = 2,
+    THERMAL = 3,
+    SEND_ERROR = 4,
+  };
+
+  Type type;
+
+  /**
+   * 4 for IPv4, 6 for IPv6, 0 if there is no address.
+   */
+  uint8_t address_family;
+
+  uint16_t port;
+
+  /**
+   * The public id of the client (#CloudClient::id); 0 if unknown.
+   */
+  uint32_t client_id;
+
+  /**
+   * The secret key of the client; 0 if unknown.
+   */
+  uint64_t client_key;
+
+  /**
+   * Milliseconds since the epoch (server clock).
+   */
+  uint64_t time;
+
+  /**
+   * The client's IP address; IPv4 addresses occupy the first 4
+   * bytes.
+   */
+  uint8_t address[16];
+
+  union {
+    /**
+     * Used by all types except #SEND_ERROR.  #FIX uses only the
+     * first location and altitude; #WAVE stores the two ends of the
+     * wave line; #THERMAL stores the bottom and the top.
+     */
+    struct {
+      SkyLinesTracking::GeoPoint location, location2;
+      int16_t altitude, altitude2;
+
+      /**
+       * Lift [1/256 m/s].
+       */
+      int16_t lift;
+
+      uint16_t reserved;
+    } geo;
+
+    /**
+     * The (truncated) error message of #SEND_ERROR; null-terminated
+     * unless it fills the whole array.
+     */
+    char message[24];
+  };
+};
+
+static_assert(sizeof(CloudEvent) == 64, "Wrong struct size");
+
+CloudEvent
+MakeFixEvent(SocketAddress address, uint64_t key, unsigned id,
+             const ::GeoPoint &location, int altitude) noexcept;
+
+CloudEvent
+MakeWaveEvent(SocketAddress address, uint64_t key, unsigned id,
+              const ::GeoPoint &a, const ::GeoPoint &b,
+              int bottom_altitude, int top_altitude,
+              double lift) noexcept;
+
+CloudEvent
+MakeThermalEvent(SocketAddress address, uint64_t key, unsigned id,
+                 const ::GeoPoint &bottom_location, int bottom_altitude,
+                 const ::GeoPoint &top_location, int top_altitude,
+                 double lift) noexcept;
+
+CloudEvent
+MakeSendErrorEvent(SocketAddress address, std::string_view message) noexcept;
+
+/**
+ * Is this a record which can be parsed, i.e. does it have a known
+ * type?
+ */
+[[gnu::pure]]
+bool
+IsValid(const CloudEvent &event) noexcept;
+
+/**
+ * Return the client address stored in the event; it is undefined if
+ * there is none.
+ */
+[[gnu::pure]]
+StaticSocketAddress
+GetAddress(const CloudEvent &event) noexcept;
+
+/**
+ * Write the event as one line of text (without the time stamp and
+ * without the trailing newline) in the format of the former
+ * xcsoar-cloud-server log.
+ */
+std::ostream &
+operator<<(std::ostream &os, const CloudEvent &event);
+
+/**
+ * Invoke the given function for each record of a binary event log.
+ * A truncated record at the end (e.g. after a crash) is ignored.
+ *
+ * Throws on I/O error.
+ */
+template<typename F>
+void
+ForEachEvent(BufferedReader &reader, F &&f)
+{
+  while (true) {
+    const auto src = reader.Read();
+    if (src.size() < sizeof(CloudEvent)) {
+      if (!reader.Fill(true))
+        break;
+
+      continue;
+    }
+
+    CloudEvent event;
+    memcpy(&event, src.data(), sizeof(event));
+    reader.Consume(sizeof(event));
+
+    f(event);
+  }
+}
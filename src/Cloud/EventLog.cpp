@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "EventLog.hpp"
+#include "system/Error.hxx"
+#include "util/Exception.hxx"
+#include "util/SpanCast.hxx"
+
+#include <iostream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static UniqueFileDescriptor
+OpenAppend(Path path)
+{
+  UniqueFileDescriptor fd;
+  if (!fd.Open(path.c_str(), O_WRONLY|O_CREAT|O_APPEND))
+    throw MakeErrno("Failed to open event log");
+
+  return fd;
+}
+
+CloudEventLog::CloudEventLog(Path path, bool _journal)
+  :Thread(_journal ? "journal" : "event_log"),
+   journal(_journal),
+   ring(std::make_unique<CloudEvent[]>(CAPACITY))
+{
+  if (path != nullptr)
+    fd = OpenAppend(path);
+}
+
+CloudEventLog::~CloudEventLog() noexcept = default;
+
+void
+CloudEventLog::Stop() noexcept
+{
+  {
+    const std::scoped_lock lock{mutex};
+    quit = true;
+    cond.notify_one();
+  }
+
+  Join();
+}
+
+void
+CloudEventLog::Add(const CloudEvent &event) noexcept
+{
+  std::unique_lock lock{mutex};
+
+  if (journal)
+    drained_cond.wait(lock, [this]{ return head - tail < CAPACITY; });
+  else if (head - tail >= CAPACITY) {
+    ++n_discarded;
+    return;
+  }
+
+  const bool was_empty = head == tail;
+  ring[head++ % CAPACITY] = event;
+
+  if (was_empty)
+    cond.notify_one();
+}
+
+void
+CloudEventLog::Rotate(Path path)
+{
+  auto new_fd = OpenAppend(path);
+
+  std::unique_lock lock{mutex};
+  drained_cond.wait(lock, [this]{ return head == tail && !busy; });
+
+  if (journal && fd.IsDefined())
+    fdatasync(fd.Get());
+
+  dirty = false;
+  fd = std::move(new_fd);
+}
+
+void
+CloudEventLog::Write(std::span<const CloudEvent> events) noexcept
+{
+  if (!fd.IsDefined())
+    return;
+
+  try {
+    fd.FullWrite(std::as_bytes(events));
+
+    if (journal) {
+      dirty = true;
+      if (std::chrono::steady_clock::now() >= last_sync + SYNC_INTERVAL)
+        Sync();
+    }
+  } catch (...) {
+    std::cerr << "Failed to write event log: "
+              << GetFullMessage(std::current_exception())
+              << std::endl;
+
+    /* give up; the mirror continues to work */
+    fd.Close();
+  }
+}
+
+void
+CloudEventLog::Sync() noexcept
+{
+  if (fd.IsDefined())
+    fdatasync(fd.Get());
+
+  last_sync = std::chrono::steady_clock::now();
+  dirty = false;
+}
+
+void
+CloudEventLog::Mirror(std::span<const CloudEvent> events) noexcept
+{
+  const auto now = std::chrono::steady_clock::now();
+
+  std::ostringstream os;
+
+  if (now >= mirror_second + std::chrono::seconds(1)) {
+    if (mirror_suppressed > 0)
+      os << "(" << mirror_suppressed << " events not shown)\n";
+
+    mirror_second = now;
+    mirror_count = 0;
+    mirror_suppressed = 0;
+  }
+
+  for (const auto &event : events) {
+    if (mirror_count >= MIRROR_RATE) {
+      ++mirror_suppressed;
+      continue;
+    }
+
+    ++mirror_count;
+    os << event << '\n';
+  }
+
+  std::cout << os.str() << std::flush;
+}
+
+void
+CloudEventLog::Run() noexcept
+{
+  std::vector<CloudEvent> batch;
+  batch.reserve(CAPACITY);
+
+  std::unique_lock lock{mutex};
+
+  const auto ready = [this]{ return quit || head != tail; };
+
+  while (true) {
+    if (dirty) {
+      /* sync the journal even if no more events arrive */
+      if (!cond.wait_until(lock, last_sync + SYNC_INTERVAL, ready)) {
+        busy = true;
+        lock.unlock();
+
+        Sync();
+
+        lock.lock();
+        busy = false;
+        drained_cond.notify_all();
+        continue;
+      }
+    } else
+      cond.wait(lock, ready);
+
+    if (head == tail)
+      /* quit, and everything has been written */
+      break;
+
+    /* copy the pending events and release the lock while doing
+       I/O */
+    batch.clear();
+    for (; tail != head; ++tail)
+      batch.push_back(ring[tail % CAPACITY]);
+
+    const auto discarded = std::exchange(n_discarded, 0);
+
+    busy = true;
+    drained_cond.notify_all();
+    lock.unlock();
+
+    Write(batch);
+
+    if (!journal)
+      Mirror(batch);
+
+    if (discarded > 0)
+      std::cerr << "Event log overflow, " << discarded
+                << " events discarded" << std::endl;
+
+    lock.lock();
+    busy = false;
+    drained_cond.notify_all();
+  }
+
+  if (journal && fd.IsDefined())
+    fdatasync(fd.Get());
+}
@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Event.hpp"
+#include "thread/Thread.hpp"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "io/UniqueFileDescriptor.hxx"
+#include "system/Path.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+/**
+ * An asynchronous event log: Add() copies the #CloudEvent into a ring
+ * buffer (and never blocks on I/O), and a background thread appends
+ * the buffered records to a binary log file.  It also prints a
+ * human-readable mirror on stdout, which is rate-limited so a busy
+ * server does not drown in its own log output.
+ *
+ * If the ring buffer is full, new events are discarded and counted.
+ *
+ * In "journal" mode (see #CloudShards), nothing is discarded (Add()
+ * waits instead), there is no mirror, the file is synced to disk at
+ * most once per second (and at the latest one second after the last
+ * write), and it can be switched with Rotate().
+ */
+class CloudEventLog final : Thread {
+  /**
+   * The maximum number of events in the ring buffer; must be a power
+   * of two.
+   */
+  static constexpr std::size_t CAPACITY = 16384;
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0);
+
+  /**
+   * The maximum number of events printed on stdout per second.
+   */
+  static constexpr unsigned MIRROR_RATE = 20;
+
+  static constexpr std::chrono::steady_clock::duration SYNC_INTERVAL =
+    std::chrono::seconds(1);
+
+  const bool journal;
+
+  const std::unique_ptr<CloudEvent[]> ring;
+
+  /**
+   * The binary log file; undefined if there is none.
+   */
+  UniqueFileDescriptor fd;
+
+  Mutex mutex;
+
+  /**
+   * Wakes up the thread when there are new events.
+   */
+  Cond cond;
+
+  /**
+   * Signalled by the thread after it has taken events from the ring
+   * buffer and after it has written them.
+   */
+  Cond drained_cond;
+
+  /**
+   * Free-running counters; the difference is the number of events in
+   * the ring buffer.  Protected by #mutex.
+   */
+  std::size_t head = 0, tail = 0;
+
+  /**
+   * The number of events which were discarded because the ring buffer
+   * was full.  Protected by #mutex.
+   */
+  unsigned long n_discarded = 0;
+
+  /**
+   * Protected by #mutex.
+   */
+  bool quit = false;
+
+  /**
+   * Is the thread currently writing events?  Protected by #mutex.
+   */
+  bool busy = false;
+
+  /**
+   * Have events been written since the last fdatasync()?  Only used
+   * in "journal" mode: by the thread (while holding #mutex or while
+   * #busy) and by Rotate().
+   */
+  bool dirty = false;
+
+  /**
+   * When was the file last synced to disk?  Only used by the thread
+   * (in "journal" mode).
+   */
+  std::chrono::steady_clock::time_point last_sync;
+
+  /**
+   * The rate limiter state of the mirror; only used by the thread.
+   */
+  std::chrono::steady_clock::time_point mirror_second;
+  unsigned mirror_count = 0;
+  unsigned long mirror_suppressed = 0;
+
+public:
+  /**
+   * Throws on error.
+   *
+   * @param path the binary log file (events are appended); nullptr
+   * to disable it (until Rotate() is called)
+   * @param journal enable "journal" mode
+   */
+  explicit CloudEventLog(Path path, bool journal=false);
+  ~CloudEventLog() noexcept;
+
+  /**
+   * Throws on error.
+   */
+  void Start() {
+    Thread::Start();
+  }
+
+  /**
+   * Write all pending events and stop the thread.
+   */
+  void Stop() noexcept;
+
+  /**
+   * Submit an event.  This method is thread-safe and does not block
+   * (except on the lock, which is only held for copying, and in
+   * "journal" mode while the ring buffer is full).
+   */
+  void Add(const CloudEvent &event) noexcept;
+
+  /**
+   * Wait until all events submitted so far have been written, and
+   * then continue in a new file.  All events submitted after this
+   * call go to the new file.
+   *
+   * Throws on error (and then keeps the old file).
+   */
+  void Rotate(Path path);
+
+private:
+  void Write(std::span<const CloudEvent> events) noexcept;
+  void Sync() noexcept;
+  void Mirror(std::span<const CloudEvent> events) noexcept;
+
+  /* virtual methods from Thread */
+  void Run() noexcept override;
+};
@@ -1,7 +1,8 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 // Copyright The XCSoar Project
 
-#include "Data.hpp"
+#include "Shards.hpp"
+#include "EventLog.hpp"
 #include "Dump.hpp"
 #include "Sender.hpp"
 #include "Serialiser.hpp"
@@ -10,20 +11,30 @@
 #include "util/ByteOrder.hxx"
 #include "event/Loop.hxx"
 #include "event/CoarseTimerEvent.hxx"
+#include "event/FineTimerEvent.hxx"
 #include "event/SignalMonitor.hxx"
+#include "thread/Thread.hpp"
 #include "net/IPv4Address.hxx"
 #include "io/FileOutputStream.hxx"
 #include "io/FileReader.hxx"
+#include "io/BufferedReader.hxx"
+#include "system/FileUtil.hpp"
+#include "util/NumberParser.hpp"
 #include "util/PrintException.hxx"
 #include "util/Exception.hxx"
 #include "util/Compiler.h"
 #include "util/ScopeExit.hxx"
 
-#include <array>
+#include <forward_list>
 #include <iostream>
 #include <iomanip>
 
+#include <cerrno>
+#include <cstring>
+
 #include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 // TODO: review these settings
 static constexpr double TRAFFIC_RANGE = 50000;
@@ -34,58 +45,50 @@ static constexpr std::chrono::steady_clock::duration MAX_THERMAL_AGE = std::chro
 
 static constexpr std::chrono::steady_clock::duration REQUEST_EXPIRY = std::chrono::minutes(5);
 
+/**
+ * Traffic updates for other clients are collected for this duration
+ * and then sent with one datagram per client.
+ */
+static constexpr Event::Duration TRAFFIC_COALESCE_WINDOW = std::chrono::milliseconds(100);
+
 using std::cout;
 using std::cerr;
 using std::endl;
 
+/**
+ * A SkyLines tracking server on one socket.  With more than one
+ * worker, each of them runs one instance in its own thread, and the
+ * kernel distributes incoming datagrams among their sockets
+ * (SO_REUSEPORT).
+ */
 class CloudServer final
-  : public SkyLinesTracking::Server, CloudData
+  : public SkyLinesTracking::Server
 {
-  const AllocatedPath db_path;
+  CloudShards &shards;
 
-  CoarseTimerEvent save_timer, expire_timer;
+  CloudEventLog &event_log;
 
-public:
-  CloudServer(AllocatedPath &&_db_path, EventLoop &event_loop,
-              SocketAddress bind_address)
-    :SkyLinesTracking::Server(event_loop, bind_address),
-     db_path(std::move(_db_path)),
-     save_timer(event_loop, BIND_THIS_METHOD(OnSaveTimer)),
-     expire_timer(event_loop, BIND_THIS_METHOD(OnExpireTimer))
-  {
-#ifndef _WIN32
-    SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
-    SignalMonitorRegister(SIGTERM, BIND_THIS_METHOD(OnQuitSignal));
-    SignalMonitorRegister(SIGQUIT, BIND_THIS_METHOD(OnQuitSignal));
+  /**
+   * The #EventLoop which runs the main thread; fatal errors stop
+   * it, which stops all workers.
+   */
+  EventLoop &main_loop;
 
-    SignalMonitorRegister(SIGHUP, BIND_THIS_METHOD(OnReloadSignal));
-    SignalMonitorRegister(SIGUSR1, BIND_THIS_METHOD(OnDumpSignal));
-#endif
+  TrafficResponseQueue traffic_queue;
+  FineTimerEvent traffic_timer;
 
-    ScheduleSave();
-  }
-
-  void Load();
-  void Save();
+public:
+  CloudServer(EventLoop &event_loop, SocketAddress bind_address,
+              bool reuse_port,
+              CloudShards &_shards, CloudEventLog &_event_log,
+              EventLoop &_main_loop)
+    :SkyLinesTracking::Server(event_loop, bind_address, reuse_port),
+     shards(_shards), event_log(_event_log), main_loop(_main_loop),
+     traffic_timer(event_loop, BIND_THIS_METHOD(OnTrafficTimer)) {}
 
 private:
-  void OnSaveTimer() noexcept {
-    Save();
-    ScheduleSave();
-  }
-
-  void ScheduleSave() {
-    save_timer.Schedule(std::chrono::minutes(1));
-  }
-
-  void OnExpireTimer() noexcept {
-    clients.Expire(GetEventLoop().SteadyNow() - std::chrono::minutes(10));
-    if (!clients.empty())
-      ScheduleExpire();
-  }
-
-  void ScheduleExpire() {
-    expire_timer.Schedule(std::chrono::minutes(5));
+  void OnTrafficTimer() noexcept {
+    traffic_queue.Flush(*this);
   }
 
 protected:
@@ -116,29 +119,13 @@ protected:
 
   void OnSendError(SocketAddress address,
                    std::exception_ptr e) noexcept override {
-    cerr << "Failed to send to " << address
-         << ": " << GetFullMessage(e)
-         << endl;
+    event_log.Add(MakeSendErrorEvent(address, GetFullMessage(e)));
   }
 
   void OnError(std::exception_ptr e) override {
     cerr << GetFullMessage(e) << endl;
-    GetEventLoop().Break();
-  }
-
-#ifndef _WIN32
-  void OnQuitSignal() noexcept {
-    GetEventLoop().Break();
-  }
-
-  void OnReloadSignal() noexcept {
-    Save();
+    main_loop.InjectBreak();
   }
-
-  void OnDumpSignal() noexcept {
-    DumpClients();
-  }
-#endif
 };
 
 void
@@ -148,46 +135,41 @@ CloudServer::OnFix(const Client &c,
 {
   (void)time_of_day; // TODO: use this parameter
 
-  CloudClient *client;
+  std::optional<CloudClientInfo> client;
   if (location.IsValid()) {
-    bool was_empty = clients.empty();
+    client = shards.UpdateClient(c.address, c.key, location, altitude);
 
-    client = &clients.Make(c.address, c.key, location, altitude);
-
-    cout << "FIX\t"
-         << client->address << '\t'
-         << std::hex << client->key << std::dec << '\t'
-         << client->id << '\t'
-         << client->location << '\t'
-         << client->altitude << 'm'
-         << endl;
-
-    if (was_empty)
-      ScheduleExpire();
+    event_log.Add(MakeFixEvent(client->address, client->key, client->id,
+                               client->location, client->altitude));
   } else {
-    client = clients.Find(c.key);
-    if (client != nullptr)
-      clients.Refresh(*client, c.address);
+    client = shards.RefreshClient(c.address, c.key);
+    if (!client)
+      return;
   }
 
   /* send this new traffic location to all interested clients
-     immediately */
+     (after a short delay which allows coalescing it with other
+     updates for the same client) */
   const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(location, TRAFFIC_RANGE)) {
-    if (i->key == c.key)
+  shards.VisitClientsWithinRange(client->location, TRAFFIC_RANGE,
+                                 [&](const CloudClient &i){
+    if (i.key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
-      continue;
+      return true;
 
-    if (now > i->wants_traffic)
+    if (now > i.wants_traffic)
       /* not interested (anymore) */
-      continue;
+      return true;
 
-    TrafficResponseSender s(*this, i->address, i->key);
-    s.Add(client->id, 0, //TODO: time?
-          client->location, client->altitude);
-    s.Flush();
-  }
+    traffic_queue.Add(i.address, i.key,
+                      client->id, 0, //TODO: time?
+                      client->location, client->altitude);
+    return true;
+  });
+
+  if (!traffic_queue.empty() && !traffic_timer.IsPending())
+    traffic_timer.Schedule(TRAFFIC_COALESCE_WINDOW);
 }
 
 void
@@ -197,36 +179,36 @@ CloudServer::OnTrafficRequest(const Client &c, bool near)
     /* "near" is the only selection flag we know */
     return;
 
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  const auto now = std::chrono::steady_clock::now();
+
+  ::GeoPoint location;
+  if (!shards.VisitClient(c.key, [&](CloudClient &client){
+        client.wants_traffic = now + REQUEST_EXPIRY;
+        location = client.location;
+      }))
     /* we don't send our data to clients who didn't sent anything to
        us yet */
     return;
 
-  const auto now = std::chrono::steady_clock::now();
-
-  client->wants_traffic = now + REQUEST_EXPIRY;
-
   const auto min_stamp = now - MAX_TRAFFIC_AGE;
 
   TrafficResponseSender s(*this, c.address, c.key);
 
   unsigned n = 0;
-  for (const auto &traffic : clients.QueryWithinRange(client->location,
-                                                      TRAFFIC_RANGE)) {
-    if (traffic.get() == client)
-      continue;
+  shards.VisitClientsWithinRange(location, TRAFFIC_RANGE,
+                                 [&](const CloudClient &traffic){
+    if (traffic.key == c.key)
+      return true;
 
-    if (traffic->stamp < min_stamp)
+    if (traffic.stamp < min_stamp)
       /* don't send stale traffic, it's probably not there anymore */
-      continue;
+      return true;
 
-    s.Add(traffic->id, 0, //TODO: time?
-          traffic->location, traffic->altitude);
+    s.Add(traffic.id, 0, //TODO: time?
+          traffic.location, traffic.altitude);
 
-    if (++n > 64)
-      break;
-  }
+    return ++n <= 64;
+  });
 
   s.Flush();
 }
@@ -239,21 +221,14 @@ CloudServer::OnWaveSubmit(const Client &c,
                           int top_altitude,
                           double lift)
 {
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  const auto client = shards.FindClient(c.key);
+  if (!client)
     /* we don't trust the client if he didn't sent anything to us
        yet */
     return;
 
-  cout << "WAVE\t"
-       << client->address << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << a << '\t'
-       << b << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
+  event_log.Add(MakeWaveEvent(client->address, client->key, client->id,
+                              a, b, bottom_altitude, top_altitude, lift));
 }
 
 void
@@ -265,135 +240,514 @@ CloudServer::OnThermalSubmit(const Client &c,
                              int top_altitude,
                              double lift)
 {
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  const auto client = shards.FindClient(c.key);
+  if (!client)
     /* we don't trust the client if he didn't sent anything to us
        yet */
     return;
 
-  cout << "THERMAL\t"
-       << client->address << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << top_location << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
-
-  const auto &thermal =
-    thermals.Make(c.key,
-                  AGeoPoint(bottom_location, bottom_altitude),
-                  AGeoPoint(top_location, top_altitude),
-                  lift);
+  event_log.Add(MakeThermalEvent(client->address, client->key, client->id,
+                                 bottom_location, bottom_altitude,
+                                 top_location, top_altitude, lift));
+
+  const auto thermal =
+    shards.AddThermal(*client,
+                      AGeoPoint(bottom_location, bottom_altitude),
+                      AGeoPoint(top_location, top_altitude),
+                      lift);
 
   /* send this new thermal to all interested clients immediately */
   const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(bottom_location,
-                                                THERMAL_RANGE)) {
-    if (i->key == c.key)
+  shards.VisitClientsWithinRange(bottom_location, THERMAL_RANGE,
+                                 [&](const CloudClient &i){
+    if (i.key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
-      continue;
+      return true;
 
-    if (now > i->wants_thermals)
+    if (now > i.wants_thermals)
       /* not interested (anymore) */
-      continue;
+      return true;
 
-    ThermalResponseSender s(*this, i->address, i->key);
-    s.Add(thermal.Pack());
+    ThermalResponseSender s(*this, i.address, i.key);
+    s.Add(thermal);
     s.Flush();
-  }
+    return true;
+  });
 }
 
 void
 CloudServer::OnThermalRequest(const Client &c)
 {
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  const auto now = std::chrono::steady_clock::now();
+
+  ::GeoPoint location;
+  if (!shards.VisitClient(c.key, [&](CloudClient &client){
+        client.wants_thermals = now + REQUEST_EXPIRY;
+        location = client.location;
+      }))
     /* we don't send our data to clients who didn't sent anything to
        us yet */
     return;
 
-  const auto now = std::chrono::steady_clock::now();
-
-  client->wants_thermals = now + REQUEST_EXPIRY;
-
   const auto min_time = now - MAX_THERMAL_AGE;
 
   ThermalResponseSender s(*this, c.address, c.key);
 
   unsigned n = 0;
-  for (const auto &thermal : thermals.QueryWithinRange(client->location,
-                                                       THERMAL_RANGE)) {
-    if (thermal->client_key == c.key)
+  shards.VisitThermalsWithinRange(location, THERMAL_RANGE,
+                                  [&](const CloudThermal &thermal){
+    if (thermal.client_key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
-      continue;
+      return true;
 
-    if (thermal->time < min_time)
+    if (thermal.time < min_time)
       /* don't send old thermals, they're useless */
-      continue;
+      return true;
 
-    s.Add(thermal->Pack());
+    s.Add(thermal.Pack());
 
-    if (++n > 256)
-      break;
-  }
+    return ++n <= 256;
+  });
 
   s.Flush();
 }
 
+/**
+ * A thread which runs an additional #CloudServer with its own
+ * #EventLoop.
+ */
+class CloudWorkerThread final : Thread {
+  EventLoop event_loop{ThreadId::Null()};
+  CloudServer server;
+
+public:
+  CloudWorkerThread(SocketAddress bind_address,
+                    CloudShards &shards, CloudEventLog &event_log,
+                    EventLoop &main_loop)
+    :Thread("worker"),
+     server(event_loop, bind_address, true, shards, event_log,
+            main_loop) {}
+
+  /**
+   * Throws on error.
+   */
+  void Start() {
+    event_loop.SetAlive(true);
+    Thread::Start();
+  }
+
+  void Stop() noexcept {
+    event_loop.InjectBreak();
+    Join();
+    event_loop.SetAlive(false);
+  }
+
+protected:
+  /* virtual methods from Thread */
+  void Run() noexcept override {
+    event_loop.Run();
+  }
+};
+
+/**
+ * Marks the end of a snapshot written by CloudInstance; it is
+ * followed by the journal generation.  Older snapshots don't have
+ * it, and CloudData::Load() ignores it.
+ */
+static constexpr uint32_t JOURNAL_MAGIC = 0x4a524e4c;
+
+/**
+ * The main thread of xcsoar-cloud-server: it owns the data, runs the
+ * first #CloudServer and the periodic maintenance, and handles
+ * signals.
+ *
+ * All changes are appended to a journal (DBPATH.journal.N).  Once a
+ * minute, a snapshot of the whole database is written by a forked
+ * child process, which gets a copy-on-write view of the data, so the
+ * event loop is only paused for the fork() call.  The snapshot
+ * contains the "generation" N of the first journal it does not
+ * include, and older journals are deleted after it has been
+ * committed.  On startup, the snapshot is loaded and all newer
+ * journals are replayed.
+ */
+class CloudInstance final {
+  const AllocatedPath db_path;
+
+  CloudShards shards;
+
+  CloudEventLog event_log;
+
+  /**
+   * Records all changes to #shards.
+   */
+  CloudEventLog journal;
+
+  CloudServer server;
+
+  std::forward_list<CloudWorkerThread> workers;
+
+  CoarseTimerEvent save_timer, expire_timer;
+
+  /**
+   * The generation of the journal file currently being written.
+   */
+  unsigned journal_generation;
+
+  /**
+   * All journals older than this are included in the committed
+   * snapshot.
+   */
+  unsigned snapshot_generation;
+
+  /**
+   * The process which currently writes a snapshot (or -1), and the
+   * generation it will contain.
+   */
+  pid_t snapshot_pid = -1;
+  unsigned pending_generation;
+
+public:
+  CloudInstance(AllocatedPath &&_db_path, EventLoop &event_loop,
+                SocketAddress bind_address, unsigned n_workers,
+                Path event_log_path)
+    :db_path(std::move(_db_path)),
+     /* more shards than workers, so clients in neighbouring
+        regions rarely contend for the same lock */
+     shards(n_workers > 1 ? n_workers * 4 : 1),
+     event_log(event_log_path),
+     journal(nullptr, true),
+     server(event_loop, bind_address, n_workers > 1, shards, event_log,
+            event_loop),
+     save_timer(event_loop, BIND_THIS_METHOD(OnSaveTimer)),
+     expire_timer(event_loop, BIND_THIS_METHOD(OnExpireTimer))
+  {
+    for (unsigned i = 1; i < n_workers; ++i)
+      workers.emplace_front(bind_address, shards, event_log, event_loop);
+
+#ifndef _WIN32
+    SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
+    SignalMonitorRegister(SIGTERM, BIND_THIS_METHOD(OnQuitSignal));
+    SignalMonitorRegister(SIGQUIT, BIND_THIS_METHOD(OnQuitSignal));
+
+    SignalMonitorRegister(SIGHUP, BIND_THIS_METHOD(OnReloadSignal));
+    SignalMonitorRegister(SIGUSR1, BIND_THIS_METHOD(OnDumpSignal));
+    SignalMonitorRegister(SIGCHLD, BIND_THIS_METHOD(OnChildSignal));
+#endif
+
+    ScheduleSave();
+    ScheduleExpire();
+  }
+
+  /**
+   * Start the event log, the journal and the worker threads.  Must
+   * be called after Load().
+   */
+  void StartThreads() {
+    event_log.Start();
+    journal.Start();
+
+    for (auto &worker : workers)
+      worker.Start();
+  }
+
+  void StopThreads() noexcept {
+    for (auto &worker : workers)
+      worker.Stop();
+
+    journal.Stop();
+    event_log.Stop();
+  }
+
+  /**
+   * Load the snapshot, replay the journals and start a new journal.
+   */
+  void Load();
+
+  /**
+   * Write a snapshot synchronously; to be called after
+   * StopThreads().
+   */
+  void Save();
+
+private:
+  EventLoop &GetEventLoop() const noexcept {
+    return server.GetEventLoop();
+  }
+
+  [[gnu::pure]]
+  AllocatedPath GetJournalPath(unsigned generation) const noexcept;
+
+  /**
+   * Delete the journals which are included in a snapshot of the
+   * given generation.
+   */
+  void DeleteJournals(unsigned generation) noexcept;
+
+  /**
+   * Write the snapshot file.  Returns false on error.
+   */
+  bool WriteSnapshot(unsigned generation, bool locked) noexcept;
+
+  /**
+   * Rotate the journal and fork a process which writes a snapshot.
+   */
+  void StartSnapshot() noexcept;
+
+  void OnSnapshotFinished(int status) noexcept;
+
+  void OnSaveTimer() noexcept {
+    StartSnapshot();
+    ScheduleSave();
+  }
+
+  void ScheduleSave() {
+    save_timer.Schedule(std::chrono::minutes(1));
+  }
+
+  void OnExpireTimer() noexcept {
+    shards.Expire(GetEventLoop().SteadyNow() - std::chrono::minutes(10));
+    ScheduleExpire();
+  }
+
+  void ScheduleExpire() {
+    expire_timer.Schedule(std::chrono::minutes(5));
+  }
+
+#ifndef _WIN32
+  void OnQuitSignal() noexcept {
+    GetEventLoop().Break();
+  }
+
+  void OnReloadSignal() noexcept {
+    StartSnapshot();
+  }
+
+  void OnDumpSignal() noexcept {
+    shards.DumpClients();
+  }
+
+  void OnChildSignal() noexcept {
+    int status;
+    if (snapshot_pid > 0 &&
+        waitpid(snapshot_pid, &status, WNOHANG) == snapshot_pid)
+      OnSnapshotFinished(status);
+  }
+#endif
+};
+
+/**
+ * Read the journal generation at the end of a snapshot.
+ *
+ * @return the generation or 1 if the snapshot has none
+ */
+static unsigned
+ReadGeneration(Deserialiser &s)
+{
+  while (s.Read().size() < 8)
+    if (!s.Fill(true))
+      return 1;
+
+  if (s.Read32() != JOURNAL_MAGIC)
+    return 1;
+
+  return s.Read32();
+}
+
+AllocatedPath
+CloudInstance::GetJournalPath(unsigned generation) const noexcept
+{
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".journal.%u", generation);
+  return db_path + suffix;
+}
+
 void
-CloudServer::Load()
+CloudInstance::DeleteJournals(unsigned generation) noexcept
 {
-  FileReader fr(db_path);
-  Deserialiser s(fr);
-  CloudData::Load(s);
+  for (unsigned i = generation - 1; i > 0; --i)
+    if (!File::Delete(GetJournalPath(i)))
+      break;
 }
 
 void
-CloudServer::Save()
+CloudInstance::Load()
 {
-  cout << "Saving data to " << db_path.c_str() << endl;
+  unsigned generation = 1;
 
+  try {
+    FileReader fr(db_path);
+    Deserialiser s(fr);
+    shards.Load(s);
+    generation = ReadGeneration(s);
+  } catch (const std::runtime_error &e) {
+    cerr << "Failed to load database" << endl;
+    PrintException(e);
+  }
+
+  snapshot_generation = generation;
+
+  /* replay all journals which are not included in the snapshot */
+  for (;; ++generation) {
+    const auto path = GetJournalPath(generation);
+    if (!File::Exists(path))
+      break;
+
+    try {
+      FileReader fr(path);
+      BufferedReader r(fr);
+      ForEachEvent(r, [this](const CloudEvent &event){
+        shards.Replay(event);
+      });
+    } catch (const std::runtime_error &e) {
+      cerr << "Failed to replay journal" << endl;
+      PrintException(e);
+    }
+  }
+
+  /* never append to an existing journal, which may end with a
+     truncated record */
+  journal_generation = generation;
+  journal.Rotate(GetJournalPath(journal_generation));
+  shards.SetJournal(&journal);
+}
+
+bool
+CloudInstance::WriteSnapshot(unsigned generation, bool locked) noexcept
+try {
   FileOutputStream fos(db_path);
 
   {
     Serialiser s(fos);
-    CloudData::Save(s);
+    if (locked)
+      shards.SaveLocked(s);
+    else
+      shards.Save(s);
+    s.Write32(JOURNAL_MAGIC);
+    s.Write32(generation);
     s.Flush();
   }
 
+  fos.Sync();
   fos.Commit();
+  return true;
+} catch (...) {
+  return false;
+}
+
+void
+CloudInstance::StartSnapshot() noexcept
+{
+  if (snapshot_pid > 0)
+    /* still busy with the previous one */
+    return;
+
+  const unsigned generation = journal_generation + 1;
+
+  cout << "Saving data to " << db_path.c_str() << endl;
+
+  pid_t pid = -1;
+
+  try {
+    /* freeze the data, switch to a new journal and fork; the child
+       process sees exactly the state described by the old
+       journals */
+    shards.LockAll([&]{
+      journal.Rotate(GetJournalPath(generation));
+      journal_generation = generation;
+
+      pid = fork();
+      if (pid == 0)
+        /* in the child process: don't touch any lock or thread */
+        _exit(WriteSnapshot(generation, true) ? EXIT_SUCCESS : EXIT_FAILURE);
+    });
+  } catch (...) {
+    cerr << "Failed to rotate journal: "
+         << GetFullMessage(std::current_exception()) << endl;
+    return;
+  }
+
+  if (pid < 0) {
+    cerr << "fork() failed: " << strerror(errno) << endl;
+    return;
+  }
+
+  snapshot_pid = pid;
+  pending_generation = generation;
+}
+
+void
+CloudInstance::OnSnapshotFinished(int status) noexcept
+{
+  snapshot_pid = -1;
+
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+    cerr << "Failed to save data to " << db_path.c_str() << endl;
+    return;
+  }
+
+  DeleteJournals(pending_generation);
+  snapshot_generation = pending_generation;
+}
+
+void
+CloudInstance::Save()
+{
+  if (snapshot_pid > 0) {
+    int status;
+    if (waitpid(snapshot_pid, &status, 0) == snapshot_pid)
+      OnSnapshotFinished(status);
+  }
+
+  cout << "Saving data to " << db_path.c_str() << endl;
+
+  /* the journal has been stopped, so this snapshot includes all of
+     it */
+  const unsigned generation = journal_generation + 1;
+  if (!WriteSnapshot(generation, false)) {
+    cerr << "Failed to save data to " << db_path.c_str() << endl;
+    return;
+  }
+
+  DeleteJournals(generation);
+  snapshot_generation = generation;
 }
 
 int
 main(int argc, char **argv)
 try {
-  if (argc != 2) {
-    cerr << "Usage: " << argv[0] << " DBPATH" << endl;
+  if (argc < 2 || argc > 4) {
+    cerr << "Usage: " << argv[0] << " DBPATH [WORKERS [EVENTLOG]]" << endl;
     return EXIT_FAILURE;
   }
 
   const Path db_path(argv[1]);
 
+  const unsigned n_workers = argc > 2 ? ParseUnsigned(argv[2]) : 1;
+  if (n_workers < 1) {
+    cerr << "Need at least one worker" << endl;
+    return EXIT_FAILURE;
+  }
+
+  const Path event_log_path = argc > 3 ? Path(argv[3]) : Path(nullptr);
+
   EventLoop event_loop;
   SignalMonitorInit(event_loop);
   AtScopeExit() { SignalMonitorFinish(); };
 
-  CloudServer server(db_path, event_loop,
-                     IPv4Address(CloudServer::GetDefaultPort()));
+  CloudInstance instance(db_path, event_loop,
+                         IPv4Address(CloudServer::GetDefaultPort()),
+                         n_workers, event_log_path);
 
-  try {
-    server.Load();
-  } catch (const std::runtime_error &e) {
-    cerr << "Failed to load database" << endl;
-    PrintException(e);
-  }
+  instance.Load();
+
+  instance.StartThreads();
 
   event_loop.Run();
 
-  server.Save();
+  instance.StopThreads();
+  instance.Save();
 
   return EXIT_SUCCESS;
 } catch (const std::exception &exception) {
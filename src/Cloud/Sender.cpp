@@ -40,6 +40,37 @@ TrafficResponseSender::Flush()
   server.SendBuffer(address, {(const std::byte *)&data, size});
 }
 
+void
+TrafficResponseQueue::Add(SocketAddress address, uint64_t key,
+                          uint32_t pilot_id, uint32_t time,
+                          GeoPoint location, int altitude)
+{
+  auto &destination = destinations[key];
+  destination.address = address;
+
+  for (auto &i : destination.traffic) {
+    if (i.pilot_id == pilot_id) {
+      i = {pilot_id, time, location, altitude};
+      return;
+    }
+  }
+
+  destination.traffic.push_back({pilot_id, time, location, altitude});
+}
+
+void
+TrafficResponseQueue::Flush(SkyLinesTracking::Server &server)
+{
+  for (const auto &[key, destination] : destinations) {
+    TrafficResponseSender s(server, destination.address, key);
+    for (const auto &i : destination.traffic)
+      s.Add(i.pilot_id, i.time, i.location, i.altitude);
+    s.Flush();
+  }
+
+  destinations.clear();
+}
+
 void
 ThermalResponseSender::Add(SkyLinesTracking::Thermal t)
 {
@@ -7,10 +7,11 @@
 #include "Tracking/SkyLines/Protocol.hpp"
 #include "util/ByteOrder.hxx"
 #include "net/StaticSocketAddress.hxx"
+#include "Geo/GeoPoint.hpp"
 
 #include <array>
-
-struct GeoPoint;
+#include <unordered_map>
+#include <vector>
 
 class TrafficResponseSender {
   SkyLinesTracking::Server &server;
@@ -45,6 +46,41 @@ public:
   void Flush();
 };
 
+/**
+ * Collects traffic updates for many clients.  All updates for one
+ * client which are added until the next Flush() call are coalesced
+ * into as few #TrafficResponsePacket datagrams as possible; a newer
+ * update of the same pilot replaces the older one.
+ */
+class TrafficResponseQueue {
+  struct Traffic {
+    uint32_t pilot_id, time;
+    GeoPoint location;
+    int altitude;
+  };
+
+  struct Destination {
+    StaticSocketAddress address;
+    std::vector<Traffic> traffic;
+  };
+
+  /**
+   * Key is the destination's #CloudClient::key.
+   */
+  std::unordered_map<uint64_t, Destination> destinations;
+
+public:
+  bool empty() const noexcept {
+    return destinations.empty();
+  }
+
+  void Add(SocketAddress address, uint64_t key,
+           uint32_t pilot_id, uint32_t time,
+           GeoPoint location, int altitude);
+
+  void Flush(SkyLinesTracking::Server &server);
+};
+
 class ThermalResponseSender {
   SkyLinesTracking::Server &server;
   const SocketAddress address;
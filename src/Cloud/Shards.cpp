@@ -0,0 +1,311 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Shards.hpp"
+#include "Event.hpp"
+#include "EventLog.hpp"
+#include "Tracking/SkyLines/Import.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+static CloudClientInfo
+ToInfo(const CloudClient &client) noexcept
+{
+  return {
+    StaticSocketAddress(client.address),
+    client.key,
+    client.id,
+    client.location,
+    client.altitude,
+  };
+}
+
+CloudShards::CloudShards(unsigned _n_shards)
+  :n_shards(_n_shards), shards(std::make_unique<Shard[]>(_n_shards))
+{
+  assert(n_shards > 0);
+}
+
+CloudShards::~CloudShards() noexcept = default;
+
+unsigned
+CloudShards::GetShardIndex(Angle longitude) const noexcept
+{
+  const double x = (longitude.AsDelta().Degrees() + 180) / 360;
+  return std::min(unsigned(std::max(x, 0.) * n_shards), n_shards - 1);
+}
+
+std::pair<unsigned, unsigned>
+CloudShards::GetShardRange(GeoPoint location, double range) const noexcept
+{
+  const auto box = BoostRangeBox(location, range);
+  return {
+    GetShardIndex(box.min_corner()),
+    GetShardIndex(box.max_corner()),
+  };
+}
+
+CloudClientInfo
+CloudShards::ApplyFix(SocketAddress address, uint64_t key, unsigned id,
+                      const GeoPoint &location, int altitude,
+                      std::chrono::steady_clock::time_point stamp,
+                      bool record)
+{
+  const unsigned shard_index = GetShardIndex(location);
+
+  auto &stripe = GetKeyStripe(key);
+  const std::scoped_lock stripe_lock{stripe.mutex};
+
+  const auto [i, inserted] = stripe.shards.try_emplace(key, shard_index);
+
+  CloudClientPtr moved;
+  if (!inserted && i->second != shard_index) {
+    /* the client has crossed a shard border; remove it from the old
+       shard (and release its lock before locking the new one) */
+    auto &old_shard = shards[i->second];
+    const std::scoped_lock lock{old_shard.mutex};
+
+    auto *client = old_shard.data.clients.Find(key);
+    if (client != nullptr) {
+      moved = client->shared_from_this();
+      old_shard.data.clients.Remove(*client);
+    }
+
+    i->second = shard_index;
+  }
+
+  auto &shard = shards[shard_index];
+  const std::scoped_lock lock{shard.mutex};
+  auto &clients = shard.data.clients;
+
+  CloudClient *client;
+  if (moved) {
+    client = moved.get();
+    client->Refresh(address);
+    client->location = location;
+    client->altitude = altitude;
+    clients.Insert(*client);
+  } else if ((client = clients.Find(key)) != nullptr) {
+    clients.Refresh(*client, address, location, altitude);
+  } else {
+    if (id == 0)
+      id = next_id++;
+    else if (id >= next_id)
+      next_id = id + 1;
+
+    auto ptr = std::make_shared<CloudClient>(address, key, id,
+                                             location, altitude);
+    client = ptr.get();
+    clients.Insert(*client);
+  }
+
+  client->stamp = stamp;
+
+  if (record && journal != nullptr)
+    journal->Add(MakeFixEvent(address, key, client->id,
+                              location, altitude));
+
+  return ToInfo(*client);
+}
+
+std::optional<CloudClientInfo>
+CloudShards::RefreshClient(SocketAddress address, uint64_t key)
+{
+  std::optional<CloudClientInfo> result;
+  WithClient(key, [&](Shard &shard, CloudClient &client){
+    shard.data.clients.Refresh(client, address);
+    result = ToInfo(client);
+  });
+  return result;
+}
+
+std::optional<CloudClientInfo>
+CloudShards::FindClient(uint64_t key)
+{
+  std::optional<CloudClientInfo> result;
+  VisitClient(key, [&](const CloudClient &client){
+    result = ToInfo(client);
+  });
+  return result;
+}
+
+SkyLinesTracking::Thermal
+CloudShards::AddThermal(const CloudClientInfo &client,
+                        const AGeoPoint &bottom_location,
+                        const AGeoPoint &top_location,
+                        double lift)
+{
+  auto &shard = shards[GetShardIndex(top_location)];
+  const std::scoped_lock lock{shard.mutex};
+
+  if (journal != nullptr)
+    journal->Add(MakeThermalEvent(client.address, client.key, client.id,
+                                  bottom_location, bottom_location.altitude,
+                                  top_location, top_location.altitude,
+                                  lift));
+
+  return shard.data.thermals.Make(client.key, bottom_location, top_location,
+                                  lift).Pack();
+}
+
+bool
+CloudShards::Expire(std::chrono::steady_clock::time_point before)
+{
+  bool empty = true;
+
+  std::vector<uint64_t> keys;
+
+  for (unsigned i = 0; i < n_shards; ++i) {
+    auto &shard = shards[i];
+
+    /* collect the expired keys first, because the key stripe must
+       be locked before the shard */
+    keys.clear();
+
+    {
+      const std::scoped_lock lock{shard.mutex};
+      for (const auto &client : shard.data.clients)
+        if (client.stamp < before)
+          keys.push_back(client.key);
+    }
+
+    for (const uint64_t key : keys) {
+      auto &stripe = GetKeyStripe(key);
+      const std::scoped_lock stripe_lock{stripe.mutex};
+
+      const auto j = stripe.shards.find(key);
+      if (j == stripe.shards.end() || j->second != i)
+        /* moved to another shard in the meantime */
+        continue;
+
+      const std::scoped_lock lock{shard.mutex};
+      auto *client = shard.data.clients.Find(key);
+      if (client != nullptr) {
+        if (client->stamp >= before)
+          /* refreshed in the meantime */
+          continue;
+
+        shard.data.clients.Remove(*client);
+      }
+
+      stripe.shards.erase(j);
+    }
+
+    const std::scoped_lock lock{shard.mutex};
+    if (!shard.data.clients.empty())
+      empty = false;
+  }
+
+  return !empty;
+}
+
+void
+CloudShards::DumpClients()
+{
+  for (unsigned i = 0; i < n_shards; ++i) {
+    auto &shard = shards[i];
+    const std::scoped_lock lock{shard.mutex};
+    shard.data.DumpClients();
+  }
+}
+
+void
+CloudShards::Save(Serialiser &s) const
+{
+  /* lock all key stripes and shards, so clients moving between
+     shards during the snapshot are neither lost nor duplicated */
+  LockAll([&]{
+    SaveLocked(s);
+  });
+}
+
+void
+CloudShards::SaveLocked(Serialiser &s) const
+{
+  std::vector<const CloudData *> parts;
+  parts.reserve(n_shards);
+  for (unsigned i = 0; i < n_shards; ++i)
+    parts.push_back(&shards[i].data);
+
+  CloudData::Save(s, parts, next_id);
+}
+
+void
+CloudShards::Load(Deserialiser &s)
+{
+  /* the file contains one big CloudData; load it and then move each
+     item to its shard */
+  const auto data = std::make_unique<CloudData>();
+  data->Load(s);
+
+  next_id = std::max(next_id.load(), data->clients.GetNextId());
+
+  while (!data->clients.empty()) {
+    auto client = data->clients.PopBack();
+
+    const unsigned shard_index = GetShardIndex(client->location);
+    auto &stripe = GetKeyStripe(client->key);
+    if (!stripe.shards.try_emplace(client->key, shard_index).second)
+      /* duplicate key */
+      continue;
+
+    shards[shard_index].data.clients.Insert(*client);
+  }
+
+  while (!data->thermals.empty()) {
+    auto thermal = data->thermals.PopBack();
+    shards[GetShardIndex(thermal->top_location)].data.thermals.Insert(*thermal);
+  }
+}
+
+/**
+ * Convert a time stamp from the journal to the steady clock.
+ */
+static std::chrono::steady_clock::time_point
+ImportTime(uint64_t time_be) noexcept
+{
+  const std::chrono::system_clock::time_point t{
+    std::chrono::milliseconds(FromBE64(time_be))};
+  const auto age = std::chrono::system_clock::now() - t;
+  return std::chrono::steady_clock::now() -
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(age);
+}
+
+void
+CloudShards::Replay(const CloudEvent &event)
+{
+  const auto &geo = event.geo;
+
+  switch (event.type) {
+  case CloudEvent::Type::FIX:
+    ApplyFix(GetAddress(event), FromBE64(event.client_key),
+             FromBE32(event.client_id),
+             SkyLinesTracking::ImportGeoPoint(geo.location),
+             (int16_t)FromBE16(geo.altitude),
+             ImportTime(event.time), false);
+    break;
+
+  case CloudEvent::Type::THERMAL:
+    {
+      const AGeoPoint bottom(SkyLinesTracking::ImportGeoPoint(geo.location),
+                             (int16_t)FromBE16(geo.altitude));
+      const AGeoPoint top(SkyLinesTracking::ImportGeoPoint(geo.location2),
+                          (int16_t)FromBE16(geo.altitude2));
+
+      auto &thermal = shards[GetShardIndex(top)].data.thermals
+        .Make(FromBE64(event.client_key), bottom, top,
+              (int16_t)FromBE16(geo.lift) / 256.);
+      thermal.time = ImportTime(event.time);
+    }
+    break;
+
+  case CloudEvent::Type::WAVE:
+  case CloudEvent::Type::SEND_ERROR:
+    /* not part of the database */
+    break;
+  }
+}
@@ -0,0 +1,312 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Data.hpp"
+#include "thread/Mutex.hxx"
+#include "net/StaticSocketAddress.hxx"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace SkyLinesTracking { struct Thermal; }
+struct CloudEvent;
+class CloudEventLog;
+
+/**
+ * A copy of the public attributes of a #CloudClient, which may be
+ * used after the shard lock has been released.
+ */
+struct CloudClientInfo {
+  StaticSocketAddress address;
+  uint64_t key;
+  unsigned id;
+  GeoPoint location;
+  int altitude;
+};
+
+/**
+ * A thread-safe container for the clients and thermals of
+ * xcsoar-cloud-server.  They are partitioned into shards, each
+ * covering a stripe of longitude and protected by its own lock, so
+ * worker threads serving different regions do not contend with each
+ * other.  Neighbour queries near a stripe border visit all
+ * overlapping shards, one after the other.
+ *
+ * A client's secret key is mapped to its shard by a separate index,
+ * which is itself split into stripes with their own locks.  Locking
+ * order: key stripe before shard, and never more than one shard at a
+ * time (except in LockAll(), which locks all key stripes and then all
+ * shards, each in ascending order).
+ */
+class CloudShards {
+  struct Shard {
+    mutable Mutex mutex;
+    CloudData data;
+  };
+
+  struct KeyStripe {
+    mutable Mutex mutex;
+
+    /**
+     * Maps the secret key of each client to the index of the
+     * #Shard which contains it.
+     */
+    std::unordered_map<uint64_t, unsigned> shards;
+  };
+
+  static constexpr unsigned N_KEY_STRIPES = 64;
+
+  const unsigned n_shards;
+  const std::unique_ptr<Shard[]> shards;
+
+  std::array<KeyStripe, N_KEY_STRIPES> key_stripes;
+
+  /**
+   * The public id assigned to the next new #CloudClient.  It is
+   * global (and not per shard) because clients move between shards.
+   */
+  std::atomic_uint next_id{1};
+
+  /**
+   * If set, all changes are recorded in this journal (while holding
+   * the shard lock).
+   */
+  CloudEventLog *journal = nullptr;
+
+public:
+  explicit CloudShards(unsigned _n_shards);
+  ~CloudShards() noexcept;
+
+  CloudShards(const CloudShards &) = delete;
+  CloudShards &operator=(const CloudShards &) = delete;
+
+  /**
+   * Record all further changes in the given journal.  Must be
+   * called before any worker thread uses this object.
+   */
+  void SetJournal(CloudEventLog *_journal) noexcept {
+    journal = _journal;
+  }
+
+  /**
+   * Create a new #CloudClient, or refresh the existing one.  If it
+   * has crossed the border to another shard, it is moved there.
+   *
+   * @return a copy of the client's attributes
+   */
+  CloudClientInfo UpdateClient(SocketAddress address, uint64_t key,
+                               const GeoPoint &location, int altitude) {
+    return ApplyFix(address, key, 0, location, altitude,
+                    std::chrono::steady_clock::now(), true);
+  }
+
+  /**
+   * Refresh an existing #CloudClient, without changing its location.
+   *
+   * @return a copy of the client's attributes or std::nullopt if
+   * the client is unknown
+   */
+  std::optional<CloudClientInfo> RefreshClient(SocketAddress address,
+                                               uint64_t key);
+
+  std::optional<CloudClientInfo> FindClient(uint64_t key);
+
+  /**
+   * Invoke the given function with a reference to the #CloudClient
+   * with the specified secret key (while holding the shard lock).
+   *
+   * @return false if the client is unknown
+   */
+  template<typename F>
+  bool VisitClient(uint64_t key, F &&f) {
+    return WithClient(key, [&f](Shard &, CloudClient &client){
+      f(client);
+    });
+  }
+
+  /**
+   * Invoke the given function for each #CloudClient within the given
+   * range.  It is called while holding the lock of the shard
+   * containing the client, and must not call back into this object.
+   * Iteration stops as soon as it returns false.
+   */
+  template<typename F>
+  void VisitClientsWithinRange(GeoPoint location, double range, F &&f) const {
+    ForEachShardWithinRange(location, range, [&](const Shard &shard){
+      for (const auto &i : shard.data.clients.QueryWithinRange(location, range))
+        if (!f(*i))
+          return false;
+
+      return true;
+    });
+  }
+
+  /**
+   * Like VisitClientsWithinRange(), but for #CloudThermal instances.
+   */
+  template<typename F>
+  void VisitThermalsWithinRange(GeoPoint location, double range, F &&f) const {
+    ForEachShardWithinRange(location, range, [&](const Shard &shard){
+      for (const auto &i : shard.data.thermals.QueryWithinRange(location, range))
+        if (!f(*i))
+          return false;
+
+      return true;
+    });
+  }
+
+  /**
+   * Create a new #CloudThermal in the shard of its top location.
+   *
+   * @param client the client which has submitted the thermal
+   * @return the packed thermal, to be sent to other clients
+   */
+  SkyLinesTracking::Thermal AddThermal(const CloudClientInfo &client,
+                                       const AGeoPoint &bottom_location,
+                                       const AGeoPoint &top_location,
+                                       double lift);
+
+  /**
+   * Remove all clients which have not sent anything since the given
+   * time stamp.
+   *
+   * @return true if there are still clients left
+   */
+  bool Expire(std::chrono::steady_clock::time_point before);
+
+  void DumpClients();
+
+  /**
+   * Write all shards into one file in the format of
+   * CloudData::Save().
+   */
+  void Save(Serialiser &s) const;
+
+  /**
+   * Invoke the given function while holding the locks of all key
+   * stripes and all shards, i.e. while no worker can modify the
+   * data.  The key stripes are needed because a client moving to
+   * another shard is in neither shard while ApplyFix() holds only
+   * its key stripe.
+   */
+  template<typename F>
+  void LockAll(F &&f) const {
+    std::vector<std::unique_lock<Mutex>> locks;
+    locks.reserve(N_KEY_STRIPES + n_shards);
+    for (const auto &stripe : key_stripes)
+      locks.emplace_back(stripe.mutex);
+    for (unsigned i = 0; i < n_shards; ++i)
+      locks.emplace_back(shards[i].mutex);
+
+    f();
+  }
+
+  /**
+   * Like Save(), but without locking.  This may only be called
+   * inside LockAll() (or in a process forked inside it).
+   */
+  void SaveLocked(Serialiser &s) const;
+
+  /**
+   * Load a file written by Save() or CloudData::Save() and
+   * distribute its contents to the shards.  This must be called
+   * before any worker thread uses this object.
+   */
+  void Load(Deserialiser &s);
+
+  /**
+   * Apply a record from the journal (see SetJournal()).  Like
+   * Load(), this must be called before any worker thread uses this
+   * object.
+   */
+  void Replay(const CloudEvent &event);
+
+private:
+  /**
+   * Implementation of UpdateClient() and Replay().
+   *
+   * @param id the public id of a new client, 0 to allocate a new one
+   * @param stamp the time of the fix
+   * @param record record the fix in the journal?
+   */
+  CloudClientInfo ApplyFix(SocketAddress address, uint64_t key, unsigned id,
+                           const GeoPoint &location, int altitude,
+                           std::chrono::steady_clock::time_point stamp,
+                           bool record);
+
+  [[gnu::pure]]
+  unsigned GetShardIndex(Angle longitude) const noexcept;
+
+  [[gnu::pure]]
+  unsigned GetShardIndex(const GeoPoint &location) const noexcept {
+    return GetShardIndex(location.longitude);
+  }
+
+  KeyStripe &GetKeyStripe(uint64_t key) noexcept {
+    return key_stripes[key % N_KEY_STRIPES];
+  }
+
+  /**
+   * Determine the (first and last) shards overlapping with the given
+   * range.  The range may wrap around at the date line, i.e. the
+   * first index may be larger than the last one.
+   */
+  [[gnu::pure]]
+  std::pair<unsigned, unsigned> GetShardRange(GeoPoint location,
+                                              double range) const noexcept;
+
+  /**
+   * Invoke the given function for each shard overlapping the given
+   * range, while holding its lock.  Stops as soon as the function
+   * returns false.
+   */
+  template<typename F>
+  void ForEachShardWithinRange(GeoPoint location, double range, F &&f) const {
+    const auto [first, last] = GetShardRange(location, range);
+    for (unsigned i = first;; i = (i + 1) % n_shards) {
+      const auto &shard = shards[i];
+
+      {
+        const std::scoped_lock lock{shard.mutex};
+        if (!f(shard))
+          break;
+      }
+
+      if (i == last)
+        break;
+    }
+  }
+
+  /**
+   * Look up a client and invoke the given function with its shard
+   * and the #CloudClient, while holding the locks.
+   */
+  template<typename F>
+  bool WithClient(uint64_t key, F &&f) {
+    auto &stripe = GetKeyStripe(key);
+    const std::scoped_lock stripe_lock{stripe.mutex};
+
+    const auto i = stripe.shards.find(key);
+    if (i == stripe.shards.end())
+      return false;
+
+    auto &shard = shards[i->second];
+    const std::scoped_lock lock{shard.mutex};
+
+    auto *client = shard.data.clients.Find(key);
+    if (client == nullptr)
+      return false;
+
+    f(shard, *client);
+    return true;
+  }
+};
@@ -12,6 +12,8 @@
 #include <boost/geometry/algorithms/intersection.hpp>
 #include <boost/geometry/strategies/strategies.hpp>
 
+#include <cassert>
+
 CloudThermalContainer::CloudThermalContainer()
 {
 }
@@ -54,6 +56,17 @@ CloudThermalContainer::Remove(CloudThermal &thermal)
   rtree.remove(thermal.shared_from_this());
 }
 
+CloudThermalPtr
+CloudThermalContainer::PopBack()
+{
+  assert(!list.empty());
+
+  auto &item = list.back();
+  auto ptr = item.shared_from_this();
+  Remove(item);
+  return ptr;
+}
+
 void
 CloudThermalContainer::Expire(std::chrono::steady_clock::time_point before)
 {
@@ -111,19 +124,35 @@ CloudThermal::Load(Deserialiser &s)
 }
 
 void
-CloudThermalContainer::Save(Serialiser &s) const
+CloudThermalContainer::SaveHeader(Serialiser &s)
 {
   s.Write8(1);
+}
 
+void
+CloudThermalContainer::SaveRecords(Serialiser &s) const
+{
   for (const auto &thermal : list) {
     s.Write8(1);
     thermal.Save(s);
   }
+}
 
+void
+CloudThermalContainer::SaveTrailer(Serialiser &s)
+{
   s.Write8(0);
   s.Write8(0);
 }
 
+void
+CloudThermalContainer::Save(Serialiser &s) const
+{
+  SaveHeader(s);
+  SaveRecords(s);
+  SaveTrailer(s);
+}
+
 void
 CloudThermalContainer::Load(Deserialiser &s)
 {
@@ -121,6 +121,13 @@ public:
    */
   void Remove(CloudThermal &client);
 
+  /**
+   * Remove the oldest #CloudThermal and return it, e.g. to insert it
+   * into another container.  Must not be called if the container is
+   * empty.
+   */
+  CloudThermalPtr PopBack();
+
   void Expire(std::chrono::steady_clock::time_point before);
 
   typedef Tree::const_query_iterator query_iterator;
@@ -129,6 +136,15 @@ public:
   [[gnu::pure]]
   query_iterator_range QueryWithinRange(GeoPoint location, double range) const;
 
+  /**
+   * Save() consists of SaveHeader(), SaveRecords() and SaveTrailer();
+   * calling SaveRecords() of several containers in between writes
+   * them as one (see CloudData::Save()).
+   */
+  static void SaveHeader(Serialiser &s);
+  void SaveRecords(Serialiser &s) const;
+  static void SaveTrailer(Serialiser &s);
+
   void Save(Serialiser &s) const;
   void Load(Deserialiser &s);
 };
@@ -5,6 +5,7 @@
 #include "Settings.hpp"
 #include "NMEA/MoreData.hpp"
 #include "NMEA/Derived.hpp"
+#include "Engine/Trace/Snapshot.hpp"
 
 static constexpr unsigned full_trace_size = 1024;
 static constexpr unsigned contest_trace_size = 256;
@@ -19,6 +20,8 @@ TraceComputer::TraceComputer()
 {
 }
 
+TraceComputer::~TraceComputer() noexcept = default;
+
 void
 TraceComputer::Reset()
 {
@@ -48,6 +51,27 @@ TraceComputer::LockedCopyTo(TracePointVector &v,
   full.GetPoints(v, min_time, location, resolution);
 }
 
+std::shared_ptr<const TraceSnapshot>
+TraceComputer::GetSnapshot() const
+{
+  const std::lock_guard lock{mutex};
+
+  if (snapshot == nullptr)
+    snapshot = std::make_shared<TraceSnapshot>();
+  else if (snapshot->IsUpToDate(full))
+    return snapshot;
+  else if (snapshot.use_count() > 1)
+    /* the published snapshot is still in use and must not be
+       modified; continue with a copy if only points were appended
+       (copying the arrays is cheaper than walking the trace) */
+    snapshot = snapshot->IsAppendable(full)
+      ? std::make_shared<TraceSnapshot>(*snapshot)
+      : std::make_shared<TraceSnapshot>();
+
+  snapshot->Sync(full);
+  return snapshot;
+}
+
 void
 TraceComputer::Update(const ComputerSettings &settings_computer,
                       const MoreData &basic, const DerivedInfo &calculated)
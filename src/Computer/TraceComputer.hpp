@@ -6,9 +6,12 @@
 #include "thread/Mutex.hxx"
 #include "Engine/Trace/Trace.hpp"
 
+#include <memory>
+
 struct ComputerSettings;
 struct MoreData;
 struct DerivedInfo;
+class TraceSnapshot;
 
 /**
  * Record a trace of the current flight.
@@ -23,8 +26,15 @@ class TraceComputer {
 
   Trace full, contest, sprint;
 
+  /**
+   * The latest snapshot of #full, updated lazily by GetSnapshot().
+   * Protected by #mutex.
+   */
+  mutable std::shared_ptr<TraceSnapshot> snapshot;
+
 public:
   TraceComputer();
+  ~TraceComputer() noexcept;
 
   operator Mutex &() const {
     return const_cast<Mutex &>(mutex);
@@ -70,6 +80,16 @@ public:
                     std::chrono::duration<unsigned> min_time,
                     const GeoPoint &location, double resolution) const;
 
+  /**
+   * Obtain an immutable snapshot of the full trace.  The trace is
+   * locked briefly, and the method may be called from any thread.
+   *
+   * The snapshot is updated incrementally; if the caller holds the
+   * previous snapshot, it should release it before calling this
+   * method, which allows updating it in place instead of copying it.
+   */
+  std::shared_ptr<const TraceSnapshot> GetSnapshot() const;
+
   void Update(const ComputerSettings &settings_computer,
               const MoreData &basic, const DerivedInfo &calculated);
 };
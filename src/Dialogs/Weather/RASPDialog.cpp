@@ -26,6 +26,7 @@ class RASPSettingsPanel final
     FILE,
     ITEM,
     TIME,
+    INTERPOLATE,
   };
 
   std::shared_ptr<RaspStore> rasp;
@@ -79,6 +80,7 @@ RASPSettingsPanel::UpdateTimeControl() noexcept
 
   const int item_index = item.GetValue();
   SetRowEnabled(TIME, item_index >= 0);
+  SetRowEnabled(INTERPOLATE, item_index >= 0);
 
   if (item_index >= 0) {
     DataFieldEnum &time_df = (DataFieldEnum &)GetDataField(TIME);
@@ -133,6 +135,10 @@ RASPSettingsPanel::Prepare([[maybe_unused]] ContainerWindow &parent,
       ? BrokenTime::FromMinuteOfDay(value)
       : BrokenTime::Invalid();
   });
+
+  AddBoolean(_("Interpolate"),
+             _("Blend the two nearest forecast times, instead of showing the nearest one."),
+             state.interpolate);
   UpdateTimeControl();
 }
 
@@ -143,6 +149,7 @@ RASPSettingsPanel::Save([[maybe_unused]] bool &_changed) noexcept
 
   state.map = GetValueEnum(ITEM);
   state.time = time;
+  state.interpolate = GetValueBoolean(INTERPOLATE);
 
   ActionInterface::SendUIState(true);
 
@@ -242,6 +242,7 @@ GlidePolar::IsGlidePossible(const GlideState &task) const noexcept
   return true;
 }
 
+#if 0
 /**
  * Finds speed to fly for a given MacCready setting
  * Intended to be used temporarily.
@@ -301,14 +302,40 @@ public:
     return Vopt + m_head_wind;
   }
 };
+#endif
 
 double
 GlidePolar::SpeedToFly(const double stf_sink_rate,
                        const double head_wind) const noexcept
 {
   assert(IsValid());
+
+#if 0
+  // this method to be used if polar is not parabolic
   GlidePolarSpeedToFly gp_stf(*this, stf_sink_rate, head_wind, Vmin, Vmax);
   return gp_stf.solve(Vmax);
+#else
+  assert(polar.IsValid());
+
+  /* for the parabolic polar, the MacCready-adjusted inverse glide
+     ratio over ground (see GlidePolarSpeedToFly::f()) is
+
+       f(Vg) = a*Vg + (2*a*hw + b) + k/Vg
+
+     with k = w(hw) + mc + netto; its minimum is at sqrt(k/a) */
+  const auto k = SinkRate(head_wind) + mc + stf_sink_rate;
+
+  const auto vg_min = std::max(1., Vmin - head_wind);
+  const auto vg_max = Vmax - head_wind;
+
+  /* if k is not positive, f() is strictly increasing, and the
+     minimum is at the lower bound of the search range */
+  const auto vg = k > 0
+    ? std::clamp(sqrt(k / polar.a), vg_min, std::max(vg_min, vg_max))
+    : vg_min;
+
+  return vg + head_wind;
+#endif
 }
 
 double
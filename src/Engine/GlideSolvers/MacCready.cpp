@@ -6,7 +6,9 @@
 #include "GlidePolar.hpp"
 #include "GlideResult.hpp"
 #include "Math/ZeroFinder.hpp"
+#include "Math/Util.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 MacCready::MacCready(const GlideSettings &_settings,
@@ -256,6 +258,88 @@ MacCready::SolveStraight(const GlideState &task) const
   return SolveGlide(task, glide_polar.GetVBestLD());
 }
 
+void
+MacCready::SolveStraight(const SpeedVector wind,
+                         std::span<const double> distance,
+                         std::span<const Angle> bearing,
+                         std::span<const double> altitude_difference,
+                         std::span<double> arrival_altitude_difference,
+                         std::span<double> time_elapsed,
+                         std::span<GlideResult::Validity> validity) const noexcept
+{
+  const std::size_t n = distance.size();
+  assert(bearing.size() == n);
+  assert(altitude_difference.size() == n);
+  assert(arrival_altitude_difference.size() == n);
+  assert(time_elapsed.size() == n);
+  assert(validity.size() == n);
+
+  if (!glide_polar.IsValid() || glide_polar.GetMC() <= 0) {
+    /* these are rare special cases which need the ZeroFinder; use
+       the scalar solver */
+    for (std::size_t i = 0; i < n; ++i) {
+      const GlideState task(GeoVector(distance[i], bearing[i]),
+                            0, altitude_difference[i], wind);
+      const GlideResult result = SolveStraight(task);
+      arrival_altitude_difference[i] = result.altitude_difference;
+      time_elapsed[i] = result.IsOk() ? result.time_elapsed.count() : 0;
+      validity[i] = result.validity;
+    }
+
+    return;
+  }
+
+  const auto v_set = glide_polar.GetVBestLD();
+  const auto sink_rate = glide_polar.SinkRate(v_set);
+  const auto v_eff_squared = Square(v_set * cruise_efficiency);
+
+  /* the head wind component of each destination; use
+     #time_elapsed as scratch buffer */
+  const auto head_wind = time_elapsed;
+  double wind_speed_squared = 0;
+  if (wind.IsNonZero()) {
+    wind_speed_squared = Square(wind.norm);
+    const Angle wind_reciprocal = wind.bearing.Reciprocal();
+    for (std::size_t i = 0; i < n; ++i)
+      head_wind[i] = -wind.norm * (wind_reciprocal - bearing[i]).cos();
+  } else
+    std::fill(head_wind.begin(), head_wind.end(), 0.);
+
+  for (std::size_t i = 0; i < n; ++i) {
+    /* see GlideState::CalcAverageSpeed(); this is the larger
+       solution of the quadratic equation, or a negative value if
+       there is no solution */
+    const auto hw = head_wind[i];
+    const auto discriminant = Square(hw) - wind_speed_squared + v_eff_squared;
+    const auto estimated_speed = discriminant >= 0
+      ? std::sqrt(std::max(discriminant, 0.)) - hw
+      : -1.;
+
+    const bool ok = estimated_speed > 0;
+    const auto time_cruise = ok ? distance[i] / estimated_speed : 0.;
+
+    time_elapsed[i] = time_cruise;
+    arrival_altitude_difference[i] =
+      altitude_difference[i] - time_cruise * sink_rate;
+    validity[i] = ok
+      ? GlideResult::Validity::OK
+      : GlideResult::Validity::WIND_EXCESSIVE;
+  }
+
+  /* SolveVertical() handles destinations at zero distance
+     differently; this is rare, and is fixed up afterwards */
+  for (std::size_t i = 0; i < n; ++i) {
+    if (distance[i] <= 0) {
+      const GlideState task(GeoVector(distance[i], bearing[i]),
+                            0, altitude_difference[i], wind);
+      const GlideResult result = SolveVertical(task);
+      arrival_altitude_difference[i] = result.altitude_difference;
+      time_elapsed[i] = result.IsOk() ? result.time_elapsed.count() : 0;
+      validity[i] = result.validity;
+    }
+  }
+}
+
 GlideResult
 MacCready::Solve(const GlideState &task) const
 {
@@ -3,11 +3,15 @@
 
 #pragma once
 
+#include "GlideResult.hpp"
 #include "util/Compiler.h"
 
+#include <span>
+
 struct GlideSettings;
 struct GlideState;
-struct GlideResult;
+struct SpeedVector;
+class Angle;
 class GlidePolar;
 
 /**
@@ -68,6 +72,34 @@ public:
   [[gnu::pure]]
   GlideResult SolveStraight(const GlideState &task) const;
 
+  /**
+   * Batch version of SolveStraight() for many destinations which
+   * share this polar and the same wind.  The parameters are passed
+   * in "structure of arrays" layout, all of the same size.  The main
+   * loop has no branches and no function calls, which allows the
+   * compiler to vectorise it.
+   *
+   * Only the attributes GlideResult::altitude_difference,
+   * GlideResult::time_elapsed and GlideResult::validity are
+   * calculated.
+   *
+   * @param distance the distance to each destination [m]
+   * @param bearing the bearing to each destination
+   * @param altitude_difference aircraft altitude minus minimum
+   * arrival altitude of each destination [m]
+   * @param arrival_altitude_difference receives the altitude
+   * difference after the glide [m]
+   * @param time_elapsed receives the glide duration [s]
+   * @param validity receives the validity of each solution
+   */
+  void SolveStraight(const SpeedVector wind,
+                     std::span<const double> distance,
+                     std::span<const Angle> bearing,
+                     std::span<const double> altitude_difference,
+                     std::span<double> arrival_altitude_difference,
+                     std::span<double> time_elapsed,
+                     std::span<GlideResult::Validity> validity) const noexcept;
+
   /** 
    * Calculates the glide solution for a classical MacCready theory task.
    * Internally different calculations are used depending on the nature of the
@@ -9,6 +9,8 @@
 #include "util/GlobalSliceAllocator.hxx"
 #include "Geo/Flat/FlatProjection.hpp"
 
+#include <algorithm>
+
 #define REACH_SWEEP (ROUTEPOLAR_Q1-BUFFER)
 
 static bool
@@ -268,6 +270,49 @@ FlatTriangleFanTree::FindPositiveArrival(const FlatGeoPoint n,
   return retval;
 }
 
+void
+FlatTriangleFanTree::FindPositiveArrivals(std::span<const FlatGeoPoint> n,
+                                          const ReachFanParms &parms,
+                                          std::span<int> arrival_height,
+                                          std::span<bool> found,
+                                          std::span<unsigned> indices) const noexcept
+{
+  const int height = GetHeight();
+
+  /* move all destinations which are in scope and which can possibly
+     be improved to the front */
+  const auto in_scope_end =
+    std::partition(indices.begin(), indices.end(), [&](unsigned i){
+      return height >= arrival_height[i] && bb_children.IsInside(n[i]);
+    });
+
+  /* resolve those inside this segment; it is impossible for a child
+     to find a positive arrival height if this one didn't, so they
+     are moved out of the list which is passed to the children */
+  const auto children_end =
+    std::partition(indices.begin(), in_scope_end, [&](unsigned i){
+      if (!fan.IsInside(n[i], IsRoot()))
+        return true;
+
+      const int h =
+        parms.rpolars.CalcGlideArrival(fan.GetOrigin(), n[i],
+                                       parms.projection);
+      if (h > arrival_height[i]) {
+        arrival_height[i] = h;
+        found[i] = true;
+      }
+
+      return false;
+    });
+
+  const auto remaining = indices.first(children_end - indices.begin());
+  if (remaining.empty())
+    return;
+
+  for (const auto &child : children)
+    child.FindPositiveArrivals(n, parms, arrival_height, found, remaining);
+}
+
 void
 FlatTriangleFanTree::AcceptInRange(const FlatBoundingBox &bb,
                                    FlatTriangleFanVisitor &visitor) const noexcept
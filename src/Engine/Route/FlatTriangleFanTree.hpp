@@ -9,6 +9,7 @@
 
 #include <cstdint>
 #include <forward_list>
+#include <span>
 
 class FlatProjection;
 struct GeoPoint;
@@ -83,6 +84,26 @@ public:
                            const ReachFanParms &parms,
                            int &arrival_height) const noexcept;
 
+  /**
+   * Batch version of FindPositiveArrival(): looks up many
+   * destinations in one traversal of the tree, so nodes are visited
+   * (and their bounding boxes are checked) once for all destinations
+   * instead of once per destination.
+   *
+   * @param n the destinations
+   * @param arrival_height the arrival heights to be improved; indexed
+   * like #n
+   * @param found set to true for each destination where a better
+   * arrival height was found; indexed like #n
+   * @param indices a scratch list of indices into #n which shall be
+   * checked; it will be reordered
+   */
+  void FindPositiveArrivals(std::span<const FlatGeoPoint> n,
+                            const ReachFanParms &parms,
+                            std::span<int> arrival_height,
+                            std::span<bool> found,
+                            std::span<unsigned> indices) const noexcept;
+
   void AcceptInRange(const FlatBoundingBox &bb,
                      FlatTriangleFanVisitor &visitor) const noexcept;
 
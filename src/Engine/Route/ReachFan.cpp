@@ -6,6 +6,9 @@
 #include "ReachFanParms.hpp"
 #include "ReachResult.hpp"
 
+#include <cassert>
+#include <memory>
+
 static constexpr int MIN_FLOOR_CLEARANCE = 100;
 
 void
@@ -98,6 +101,71 @@ ReachFan::FindPositiveArrival(const AGeoPoint dest,
   return result_r;
 }
 
+bool
+ReachFan::FindPositiveArrivals(std::span<const AGeoPoint> dests,
+                               const RoutePolars &rpolars,
+                               std::span<ReachResult> results) const noexcept
+{
+  assert(dests.size() == results.size());
+
+  if (root.IsEmpty())
+    return false;
+
+  const ReachFanParms parms(rpolars, projection, terrain_base);
+  const std::size_t n = dests.size();
+
+  const auto d = std::make_unique<FlatGeoPoint[]>(n);
+  const auto heights = std::make_unique<int[]>(n);
+  const auto found = std::make_unique<bool[]>(n);
+  const auto indices = std::make_unique<unsigned[]>(n);
+  std::size_t n_indices = 0;
+
+  const bool dummy = root.IsDummy();
+
+  for (std::size_t i = 0; i < n; ++i) {
+    d[i] = projection.ProjectInteger(dests[i]);
+
+    ReachResult &r = results[i];
+    r.Clear();
+
+    // first calculate direct (terrain-independent height)
+    r.direct = root.DirectArrival(d[i], parms);
+
+    if (dummy)
+      /* terrain reach is not available */
+      continue;
+
+    // if can't reach even with no terrain, skip the turning solution
+    if (std::min(root.GetHeight(), r.direct) < dests[i].altitude) {
+      r.terrain = r.direct;
+      r.terrain_valid = ReachResult::Validity::UNREACHABLE;
+      continue;
+    }
+
+    heights[i] = dests[i].altitude - 1;
+    found[i] = false;
+    indices[n_indices++] = i;
+  }
+
+  if (n_indices == 0)
+    return true;
+
+  // now calculate turning solutions for all remaining destinations
+  root.FindPositiveArrivals({d.get(), n}, parms, {heights.get(), n},
+                            {found.get(), n}, {indices.get(), n_indices});
+
+  for (std::size_t j = 0; j < n_indices; ++j) {
+    const unsigned i = indices[j];
+    ReachResult &r = results[i];
+    r.terrain = heights[i];
+    r.terrain_valid = found[i]
+      ? ReachResult::Validity::VALID
+      : ReachResult::Validity::UNREACHABLE;
+  }
+
+  return true;
+}
+
 void
 ReachFan::AcceptInRange(const GeoBounds &bounds,
                         FlatTriangleFanVisitor &visitor) const noexcept
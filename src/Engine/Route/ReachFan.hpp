@@ -7,6 +7,7 @@
 #include "FlatTriangleFanTree.hpp"
 
 #include <optional>
+#include <span>
 
 class RoutePolars;
 class RasterMap;
@@ -50,6 +51,19 @@ public:
   std::optional<ReachResult> FindPositiveArrival(const AGeoPoint dest,
                                                  const RoutePolars &rpolars) const noexcept;
 
+  /**
+   * Find arrival heights at many destinations at once.  This is
+   * equivalent to calling FindPositiveArrival() for each destination,
+   * but the fan tree is traversed only once.
+   *
+   * @param results the results, indexed like #dests
+   * @return false if no reach has been calculated (and #results
+   * was not filled)
+   */
+  bool FindPositiveArrivals(std::span<const AGeoPoint> dests,
+                            const RoutePolars &rpolars,
+                            std::span<ReachResult> results) const noexcept;
+
   /** Visit reach (working or terrain reach) */
   void AcceptInRange(const GeoBounds &bounds,
                      FlatTriangleFanVisitor &visitor) const noexcept;
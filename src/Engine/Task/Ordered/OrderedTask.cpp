@@ -6,6 +6,7 @@
 #include "Points/OrderedTaskPoint.hpp"
 #include "Points/StartPoint.hpp"
 #include "Points/FinishPoint.hpp"
+#include "Points/AATPoint.hpp"
 #include "Task/Solvers/TaskMacCreadyTravelled.hpp"
 #include "Task/Solvers/TaskMacCreadyRemaining.hpp"
 #include "Task/Solvers/TaskMacCreadyTotal.hpp"
@@ -99,6 +100,8 @@ OrderedTask::SetTaskBehaviour(const TaskBehaviour &tb) noexcept
 
   ::SetTaskBehaviour(task_points, tb);
   ::SetTaskBehaviour(optional_start_points, tb);
+
+  InvalidateTargetInputs();
 }
 
 static void
@@ -172,6 +175,7 @@ OrderedTask::UpdateGeometry() noexcept
   }
 
   force_full_update = true;
+  InvalidateTargetInputs();
 }
 
 // TIMES
@@ -214,6 +218,8 @@ OrderedTask::RunDijsktraMin(const GeoPoint &location) noexcept
     dijkstra.SetBoundary(i - active_index, boundary);
   }
 
+  ++update_counters.dijkstra_min;
+
   SearchPoint ac(location, task_projection);
   if (!dijkstra.DistanceMin(ac))
     return false;
@@ -224,6 +230,19 @@ OrderedTask::RunDijsktraMin(const GeoPoint &location) noexcept
   return true;
 }
 
+bool
+OrderedTask::IsMaxSearchSameAsMaxTotal() const noexcept
+{
+  const unsigned active_index = GetActiveIndex();
+  for (unsigned i = 0, n = TaskSize(); i != n; ++i)
+    if (i != active_index &&
+        &task_points[i]->GetSearchPoints() !=
+        &task_points[i]->GetBoundaryPoints())
+      return false;
+
+  return true;
+}
+
 inline double
 OrderedTask::ScanDistanceMin(const GeoPoint &location, bool full) noexcept
 {
@@ -333,8 +352,19 @@ OrderedTask::ScanDistanceMax() noexcept
   if (dijkstra_max == nullptr)
     dijkstra_max = std::make_unique<TaskDijkstraMax>();
 
-  SearchPointVector maxDistancePoints(task_size); 
-  bool updated = RunDijsktraMax(*dijkstra_max, maxDistancePoints, false);
+  SearchPointVector maxDistancePoints;
+  bool updated;
+  if (!max_total_solution.empty() && IsMaxSearchSameAsMaxTotal()) {
+    /* ScanDistanceMaxTotal() has just searched the same points */
+    maxDistancePoints = std::move(max_total_solution);
+    updated = true;
+  } else {
+    maxDistancePoints.resize(task_size);
+    ++update_counters.dijkstra_max;
+    updated = RunDijsktraMax(*dijkstra_max, maxDistancePoints, false);
+  }
+
+  max_total_solution.clear();
 
   if (updated) {
     for (unsigned i = 0; i < maxDistancePoints.size(); ++i) {
@@ -360,11 +390,17 @@ OrderedTask::ScanDistanceMaxTotal() noexcept
     dijkstra_max_total = std::make_unique<TaskDijkstraMax>();
 
   SearchPointVector maxDistancePoints(task_size); 
+  ++update_counters.dijkstra_max_total;
   bool updated = RunDijsktraMax(*dijkstra_max_total, maxDistancePoints, true);
   
+  max_total_solution.clear();
+
   if (updated) {
     for (unsigned i = 0; i < maxDistancePoints.size(); ++i)
       SetPointSearchMaxTotal(i, maxDistancePoints[i]);
+
+    if (IsMaxSearchSameAsMaxTotal())
+      max_total_solution = std::move(maxDistancePoints);
   }
 
   return task_points.front()->ScanDistanceMaxTotal();
@@ -614,6 +650,58 @@ OrderedTask::CheckTransitionPoint(OrderedTaskPoint &point,
 
 // ADDITIONAL FUNCTIONS
 
+bool
+OrderedTask::TargetInputs::operator==(const TargetInputs &other) const noexcept
+{
+  return valid && other.valid &&
+    location == other.location && altitude == other.altitude &&
+    wind.bearing.Native() == other.wind.bearing.Native() &&
+    wind.norm == other.wind.norm &&
+    mc == other.mc && bugs == other.bugs && ballast == other.ballast &&
+    cruise_efficiency == other.cruise_efficiency &&
+    polar.a == other.polar.a && polar.b == other.polar.b &&
+    polar.c == other.polar.c &&
+    reference_mass == other.reference_mass &&
+    empty_mass == other.empty_mass && crew_mass == other.crew_mass &&
+    v_max == other.v_max &&
+    time_remaining == other.time_remaining &&
+    active_task_point == other.active_task_point &&
+    targets == other.targets;
+}
+
+void
+OrderedTask::GetTargetInputs(TargetInputs &inputs, const AircraftState &state,
+                             const GlidePolar &glide_polar,
+                             const FloatDuration t_target) const noexcept
+{
+  inputs.location = state.location;
+  inputs.altitude = state.altitude;
+  inputs.wind = state.wind;
+  inputs.mc = glide_polar.GetMC();
+  inputs.bugs = glide_polar.GetBugs();
+  inputs.ballast = glide_polar.GetBallast();
+  inputs.cruise_efficiency = glide_polar.GetCruiseEfficiency();
+  inputs.polar = glide_polar.GetCoefficients();
+  inputs.reference_mass = glide_polar.GetReferenceMass();
+  inputs.empty_mass = glide_polar.GetEmptyMass();
+  inputs.crew_mass = glide_polar.GetCrewMass();
+  inputs.v_max = glide_polar.IsValid() ? glide_polar.GetVMax() : 0;
+  inputs.time_remaining = fdim(t_target, stats.total.time_elapsed);
+  inputs.active_task_point = active_task_point;
+
+  inputs.targets.clear();
+  for (const auto &tp : task_points) {
+    if (tp->GetType() != TaskPointType::AAT)
+      continue;
+
+    const AATPoint &ap = (const AATPoint &)*tp;
+    inputs.targets.emplace_back(ap.GetTargetLocation(),
+                                ap.IsTargetLocked());
+  }
+
+  inputs.valid = true;
+}
+
 bool
 OrderedTask::UpdateIdle(const AircraftState &state,
                         const GlidePolar &glide_polar) noexcept
@@ -622,12 +710,23 @@ OrderedTask::UpdateIdle(const AircraftState &state,
 
   if (HasStart() && task_behaviour.optimise_targets_range &&
       GetOrderedTaskSettings().aat_min_time.count() > 0) {
+    const FloatDuration t_target = GetOrderedTaskSettings().aat_min_time
+      + task_behaviour.optimise_targets_margin;
 
-    CalcMinTarget(state, glide_polar,
-                  GetOrderedTaskSettings().aat_min_time + task_behaviour.optimise_targets_margin);
+    /* the target searches are expensive; skip them if none of their
+       inputs has changed since the last run (e.g. on the ground or
+       while replay is paused) */
+    TargetInputs inputs;
+    GetTargetInputs(inputs, state, glide_polar, t_target);
+    if (inputs == last_target_inputs)
+      return retval;
+
+    ++update_counters.min_target;
+    CalcMinTarget(state, glide_polar, t_target);
 
     if (task_behaviour.optimise_targets_bearing &&
         task_points[active_task_point]->GetType() == TaskPointType::AAT) {
+      ++update_counters.opt_target;
       TaskPointList tps(task_points);
       AATPoint *ap = (AATPoint *)task_points[active_task_point].get();
       // very nasty hack
@@ -636,6 +735,11 @@ OrderedTask::UpdateIdle(const AircraftState &state,
                         *ap, task_projection, *taskpoint_start);
       tot.search(0.5);
     }
+
+    /* the searches have moved the targets; remember their new
+       locations so only external modifications trigger a new run */
+    GetTargetInputs(last_target_inputs, state, glide_polar, t_target);
+
     retval = true;
   }
 
@@ -889,6 +993,7 @@ OrderedTask::SetActiveTaskPoint(unsigned index) noexcept
   task_advance.SetArmed(false);
   active_task_point = index;
   force_full_update = true;
+  InvalidateTargetInputs();
 }
 
 TaskWaypoint*
@@ -1131,6 +1236,7 @@ OrderedTask::Reset() noexcept
   task_advance.Reset();
   SetActiveTaskPoint(0);
   UpdateStatsGeometry();
+  InvalidateTargetInputs();
 }
 
 bool
@@ -1401,6 +1507,7 @@ OrderedTask::SetOrderedTaskSettings(const OrderedTaskSettings &ob) noexcept
   ordered_settings = ob;
 
   PropagateOrderedTaskSettings();
+  InvalidateTargetInputs();
 }
 
 void
@@ -4,18 +4,21 @@
 #pragma once
 
 #include "Geo/Flat/TaskProjection.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "GlideSolvers/PolarCoefficients.hpp"
 #include "Task/AbstractTask.hpp"
 #include "SmartTaskAdvance.hpp"
 #include "Waypoint/Ptr.hpp"
 #include "util/DereferenceIterator.hxx"
 #include "util/StaticString.hxx"
+#include "time/FloatDuration.hxx"
 
 #include <cassert>
 #include <memory>
 #include <vector>
 
 class SearchPoint;
-class SearchPointVector;
 class OrderedTaskPoint;
 class StartPoint;
 class FinishPoint;
@@ -54,7 +57,59 @@ public:
     DereferenceContainerAdapter<const OrderedTaskPointVector,
                                 OrderedTaskPoint>;
 
+  /**
+   * Counts how often each of the expensive stages of Update() and
+   * UpdateIdle() was really calculated (and not skipped because its
+   * inputs were unchanged).  This is meant for diagnostics and unit
+   * tests.
+   */
+  struct UpdateCounters {
+    unsigned dijkstra_min = 0;
+    unsigned dijkstra_max = 0;
+    unsigned dijkstra_max_total = 0;
+    unsigned min_target = 0;
+    unsigned opt_target = 0;
+  };
+
 private:
+  /**
+   * The inputs of the AAT target optimisation in UpdateIdle().  If
+   * none of them has changed since the last run, the optimisation is
+   * skipped.
+   */
+  struct TargetInputs {
+    GeoPoint location;
+    double altitude;
+    SpeedVector wind;
+
+    double mc, bugs, ballast, cruise_efficiency;
+
+    /**
+     * The glider itself: a new polar or new masses change the
+     * optimal targets even with the same settings.
+     */
+    PolarCoefficients polar;
+    double reference_mass, empty_mass, crew_mass, v_max;
+
+    FloatDuration time_remaining;
+
+    unsigned active_task_point;
+
+    /**
+     * The target location and lock state of each AAT point after
+     * the last run; this detects target modifications by the user.
+     */
+    std::vector<std::pair<GeoPoint, bool>> targets;
+
+    bool valid = false;
+
+    bool operator==(const TargetInputs &other) const noexcept;
+  };
+
+  TargetInputs last_target_inputs;
+
+  UpdateCounters update_counters;
+
   OrderedTaskPointVector task_points;
   OrderedTaskPointVector optional_start_points;
 
@@ -73,6 +128,15 @@ private:
   std::unique_ptr<TaskDijkstraMax> dijkstra_max;
   std::unique_ptr<TaskDijkstraMax> dijkstra_max_total;
 
+  /**
+   * The solution of the last ScanDistanceMaxTotal() call, if
+   * ScanDistanceMax() would have searched the very same points (see
+   * IsMaxSearchSameAsMaxTotal()).  It is consumed by the next
+   * ScanDistanceMax() call, which then doesn't need to run its own
+   * search.
+   */
+  SearchPointVector max_total_solution;
+
   StaticString<64> name;
 
 public:
@@ -370,6 +434,10 @@ public:
    */
   void UpdateSummary(TaskSummary &summary) const noexcept;
 
+  const UpdateCounters &GetUpdateCounters() const noexcept {
+    return update_counters;
+  }
+
 public:
   /**
    * Retrieve vector of search points to be used in max/min distance
@@ -432,6 +500,20 @@ private:
 
   double ScanDistanceMin(const GeoPoint &ref, bool full) noexcept;
 
+  /**
+   * Collect the current inputs of the AAT target optimisation.
+   */
+  void GetTargetInputs(TargetInputs &inputs, const AircraftState &state,
+                       const GlidePolar &glide_polar,
+                       FloatDuration t_target) const noexcept;
+
+  /**
+   * Force the next UpdateIdle() call to optimise the targets.
+   */
+  void InvalidateTargetInputs() noexcept {
+    last_target_inputs.valid = false;
+  }
+
   /**
    * Search the points that give the maximum distance
    * 
@@ -452,6 +534,15 @@ private:
    */
   double ScanDistanceMax() noexcept;
 
+  /**
+   * Would the ScanDistanceMax() search use the same points as the
+   * ScanDistanceMaxTotal() search?  This is the case as long as no
+   * task point (other than the active one) has sampled points,
+   * i.e. before the task has been started and in the task editor.
+   */
+  [[gnu::pure]]
+  bool IsMaxSearchSameAsMaxTotal() const noexcept;
+
   /**
    * Optimise target ranges (for adjustable tasks) to produce an estimated
    * time remaining with the current glide polar, equal to a target value.
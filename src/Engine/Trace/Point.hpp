@@ -125,6 +125,14 @@ public:
     return engine_noise_level;
   }
 
+  /**
+   * Returns the thermal drift factor (256 = drift rate equal to wind
+   * speed).
+   */
+  constexpr unsigned GetDriftFactor() const noexcept {
+    return drift_factor;
+  }
+
   /**
    * Returns the altitude as an integer.  Some calculations may not
    * need the fractional part.
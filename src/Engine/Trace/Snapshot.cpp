@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Snapshot.hpp"
+#include "Trace.hpp"
+#include "Geo/GeoBounds.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+bool
+TraceSnapshot::IsUpToDate(const Trace &trace) const noexcept
+{
+  return trace.GetModifySerial() == modify_serial &&
+    trace.GetAppendSerial() == append_serial;
+}
+
+bool
+TraceSnapshot::IsAppendable(const Trace &trace) const noexcept
+{
+  return trace.GetModifySerial() == modify_serial;
+}
+
+void
+TraceSnapshot::Clear() noexcept
+{
+  times.clear();
+  locations.clear();
+  flat_x.clear();
+  flat_y.clear();
+  altitudes.clear();
+  varios.clear();
+  engine_noise_levels.clear();
+  drift_factors.clear();
+}
+
+void
+TraceSnapshot::Reserve(std::size_t n) noexcept
+{
+  times.reserve(n);
+  locations.reserve(n);
+  flat_x.reserve(n);
+  flat_y.reserve(n);
+  altitudes.reserve(n);
+  varios.reserve(n);
+  engine_noise_levels.reserve(n);
+  drift_factors.reserve(n);
+}
+
+inline void
+TraceSnapshot::Append(const TracePoint &point) noexcept
+{
+  times.push_back(point.GetTime());
+  locations.push_back(point.GetLocation());
+  flat_x.push_back(point.GetFlatLocation().x);
+  flat_y.push_back(point.GetFlatLocation().y);
+  altitudes.push_back(point.GetAltitude());
+  varios.push_back(point.GetVario());
+  engine_noise_levels.push_back(point.GetEngineNoiseLevel());
+  drift_factors.push_back(point.GetDriftFactor());
+}
+
+void
+TraceSnapshot::Sync(const Trace &trace) noexcept
+{
+  if (!IsAppendable(trace)) {
+    /* points were removed: start from scratch */
+    Clear();
+    modify_serial = trace.GetModifySerial();
+  } else if (IsUpToDate(trace))
+    return;
+
+  assert(size() <= trace.size());
+
+  projection = trace.GetProjection();
+
+  const std::size_t n_new = trace.size() - size();
+  Reserve(trace.size());
+
+  for (auto i = std::prev(trace.end(), n_new), end = trace.end();
+       i != end; ++i)
+    Append(*i);
+
+  append_serial = trace.GetAppendSerial();
+}
+
+std::size_t
+TraceSnapshot::FindTime(Time min_time) const noexcept
+{
+  return std::distance(times.begin(),
+                       std::lower_bound(times.begin(), times.end(),
+                                        min_time));
+}
+
+void
+TraceSnapshot::Select(std::vector<unsigned> &dest, Time min_time,
+                      const GeoPoint &location,
+                      double resolution) const noexcept
+{
+  dest.clear();
+
+  const std::size_t start = FindTime(min_time), n = size();
+  if (start >= n)
+    return;
+
+  dest.reserve(n - start);
+
+  const unsigned range = projection.ProjectRangeInteger(location, resolution);
+  const unsigned sq_range = range * range;
+
+  const int *const x = flat_x.data(), *const y = flat_y.data();
+
+  int last_x = x[start], last_y = y[start];
+  dest.push_back(start);
+
+  for (std::size_t i = start + 1; i < n; ++i) {
+    const int dx = x[i] - last_x, dy = y[i] - last_y;
+    if (unsigned(dx * dx + dy * dy) >= sq_range) {
+      dest.push_back(i);
+      last_x = x[i];
+      last_y = y[i];
+    }
+  }
+}
+
+void
+TraceSnapshot::ScanBounds(GeoBounds &bounds,
+                          std::span<const unsigned> selection) const noexcept
+{
+  for (const unsigned i : selection)
+    bounds.Extend(locations[i]);
+}
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Point.hpp"
+#include "util/Serial.hpp"
+#include "Geo/Flat/TaskProjection.hpp"
+#include "time/Stamp.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class Trace;
+class GeoBounds;
+
+/**
+ * A copy of a #Trace in "structure of arrays" layout: each attribute
+ * of the trace points is stored in a separate array, so filters can
+ * scan one column without loading the others.
+ *
+ * Once published (see TraceComputer::GetSnapshot()), an instance is
+ * immutable and shared with std::shared_ptr, so readers need neither
+ * copy nor lock.  Sync() uses the serials of the #Trace to append
+ * only the new points, unless the trace was thinned or cleared.
+ */
+class TraceSnapshot {
+public:
+  using Time = TracePoint::Time;
+
+private:
+  /**
+   * The serials of the #Trace this snapshot was synchronised with.
+   */
+  Serial append_serial, modify_serial;
+
+  TaskProjection projection;
+
+  std::vector<Time> times;
+  std::vector<GeoPoint> locations;
+  std::vector<int> flat_x, flat_y;
+  std::vector<float> altitudes, varios;
+  std::vector<uint16_t> engine_noise_levels, drift_factors;
+
+public:
+  std::size_t size() const noexcept {
+    return times.size();
+  }
+
+  bool empty() const noexcept {
+    return times.empty();
+  }
+
+  const Serial &GetAppendSerial() const noexcept {
+    return append_serial;
+  }
+
+  const Serial &GetModifySerial() const noexcept {
+    return modify_serial;
+  }
+
+  /**
+   * The projection of the flat coordinates.
+   */
+  const TaskProjection &GetProjection() const noexcept {
+    return projection;
+  }
+
+  /**
+   * The time stamps, in ascending order.
+   */
+  std::span<const Time> GetTimes() const noexcept {
+    return times;
+  }
+
+  std::span<const GeoPoint> GetLocations() const noexcept {
+    return locations;
+  }
+
+  std::span<const int> GetFlatX() const noexcept {
+    return flat_x;
+  }
+
+  std::span<const int> GetFlatY() const noexcept {
+    return flat_y;
+  }
+
+  /**
+   * The NavAltitude values [m].
+   */
+  std::span<const float> GetAltitudes() const noexcept {
+    return altitudes;
+  }
+
+  /**
+   * The NettoVario values [m/s].
+   */
+  std::span<const float> GetVarios() const noexcept {
+    return varios;
+  }
+
+  std::span<const uint16_t> GetEngineNoiseLevels() const noexcept {
+    return engine_noise_levels;
+  }
+
+  /**
+   * @see TracePoint::CalculateDrift()
+   */
+  [[gnu::pure]]
+  double CalculateDrift(std::size_t i, TimeStamp now) const noexcept {
+    assert(i < size());
+
+    const double dt = (now.ToDuration() -
+                       std::chrono::duration_cast<FloatDuration>(times[i])).count();
+    return dt * drift_factors[i] / 256;
+  }
+
+  /**
+   * Is this snapshot equal to the current state of the #Trace?
+   */
+  [[gnu::pure]]
+  bool IsUpToDate(const Trace &trace) const noexcept;
+
+  /**
+   * Can Sync() update this snapshot by appending points, i.e. has
+   * the #Trace only been appended to since the last Sync()?
+   */
+  [[gnu::pure]]
+  bool IsAppendable(const Trace &trace) const noexcept;
+
+  /**
+   * Update this snapshot to the current state of the #Trace.  Only
+   * the new points are copied if IsAppendable(); otherwise, the
+   * snapshot is rebuilt.  Must not be called after the snapshot has
+   * been published.
+   */
+  void Sync(const Trace &trace) noexcept;
+
+  /**
+   * Returns the index of the first point not before the given time
+   * (or size()).
+   */
+  [[gnu::pure]]
+  std::size_t FindTime(Time min_time) const noexcept;
+
+  /**
+   * Select the points not before #min_time, skipping points closer
+   * than #resolution to the previous selected point.  This is the
+   * equivalent of Trace::GetPoints() with the same parameters.
+   *
+   * @param dest receives the indices of the selected points
+   */
+  void Select(std::vector<unsigned> &dest, Time min_time,
+              const GeoPoint &location, double resolution) const noexcept;
+
+  /**
+   * Extend the bounds to include the selected points.
+   */
+  void ScanBounds(GeoBounds &bounds,
+                  std::span<const unsigned> selection) const noexcept;
+
+private:
+  void Clear() noexcept;
+  void Reserve(std::size_t n) noexcept;
+  void Append(const TracePoint &point) noexcept;
+};
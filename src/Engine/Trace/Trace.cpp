@@ -3,7 +3,6 @@
 
 #include "Trace.hpp"
 #include "Vector.hpp"
-#include "util/GlobalSliceAllocator.hxx"
 
 #include <algorithm>
 #include <iterator>
@@ -22,19 +21,17 @@ Trace::Trace(const Time _no_thin_time, const Time max_time,
 void
 Trace::clear() noexcept
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  assert(cached_size == heap.size());
 
   average_delta_distance = 0;
   average_delta_time = {};
 
-  delta_list.clear();
-  chronological_list.clear_and_dispose(MakeDisposer());
+  /* this keeps the capacity */
+  nodes.clear();
+  heap.clear();
+  first = last = free_head = NIL;
   cached_size = 0;
 
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
   ++modify_serial;
   ++append_serial;
 }
@@ -52,44 +49,176 @@ Trace::GetRecentTime(const Time t) const noexcept
   return {};
 }
 
+unsigned
+Trace::AllocateNode(const TracePoint &point) noexcept
+{
+  unsigned i;
+  if (free_head != NIL) {
+    i = free_head;
+    free_head = nodes[i].next;
+    nodes[i] = TraceDelta(point);
+  } else {
+    if (nodes.capacity() == 0) {
+      nodes.reserve(max_size);
+      heap.reserve(max_size);
+    }
+
+    /* never grow beyond the reserved capacity, because that would
+       move all points */
+    assert(nodes.size() < max_size);
+
+    i = nodes.size();
+    nodes.emplace_back(point);
+  }
+
+  TraceDelta &td = nodes[i];
+  td.prev = last;
+  td.next = NIL;
+  td.heap_index = NIL;
+
+  if (last != NIL)
+    nodes[last].next = i;
+  else
+    first = i;
+  last = i;
+
+  ++cached_size;
+  return i;
+}
+
 void
-Trace::UpdateDelta(TraceDelta &td) noexcept
+Trace::FreeNode(unsigned i) noexcept
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  assert(cached_size > 0);
+
+  TraceDelta &td = nodes[i];
+  assert(td.heap_index == NIL);
+
+  if (td.prev != NIL)
+    nodes[td.prev].next = td.next;
+  else
+    first = td.next;
+
+  if (td.next != NIL)
+    nodes[td.next].prev = td.prev;
+  else
+    last = td.prev;
+
+  td.next = free_head;
+  free_head = i;
+
+  --cached_size;
+}
+
+void
+Trace::HeapSiftUp(unsigned position) noexcept
+{
+  const unsigned i = heap[position];
+
+  while (position > 0) {
+    const unsigned parent = (position - 1) / HEAP_ARITY;
+    if (!TraceDelta::DeltaRank(nodes[i], nodes[heap[parent]]))
+      break;
+
+    HeapSet(position, heap[parent]);
+    position = parent;
+  }
+
+  HeapSet(position, i);
+}
+
+void
+Trace::HeapSiftDown(unsigned position) noexcept
+{
+  const unsigned i = heap[position];
+  const unsigned n = heap.size();
+
+  while (true) {
+    const unsigned first_child = position * HEAP_ARITY + 1;
+    if (first_child >= n)
+      break;
+
+    const unsigned end_child = std::min(first_child + HEAP_ARITY, n);
+    unsigned best = first_child;
+    for (unsigned c = first_child + 1; c < end_child; ++c)
+      if (HeapLess(c, best))
+        best = c;
+
+    if (!TraceDelta::DeltaRank(nodes[heap[best]], nodes[i]))
+      break;
 
-  if (&td == &chronological_list.front() ||
-      &td == &chronological_list.back())
+    HeapSet(position, heap[best]);
+    position = best;
+  }
+
+  HeapSet(position, i);
+}
+
+void
+Trace::HeapPush(unsigned i) noexcept
+{
+  assert(nodes[i].heap_index == NIL);
+
+  heap.push_back(i);
+  HeapSiftUp(heap.size() - 1);
+}
+
+void
+Trace::HeapRemove(unsigned i) noexcept
+{
+  const unsigned position = nodes[i].heap_index;
+  assert(position < heap.size());
+  assert(heap[position] == i);
+
+  nodes[i].heap_index = NIL;
+
+  const unsigned moved = heap.back();
+  heap.pop_back();
+  if (moved == i)
+    return;
+
+  HeapSet(position, moved);
+  HeapUpdate(moved);
+}
+
+void
+Trace::HeapUpdate(unsigned i) noexcept
+{
+  const unsigned position = nodes[i].heap_index;
+  if (position == NIL)
     return;
 
-  const auto ci = chronological_list.iterator_to(td);
-  const TraceDelta &previous = *std::prev(ci);
-  const TraceDelta &next = *std::next(ci);
+  if (position > 0 &&
+      TraceDelta::DeltaRank(nodes[i],
+                            nodes[heap[(position - 1) / HEAP_ARITY]]))
+    HeapSiftUp(position);
+  else
+    HeapSiftDown(position);
+}
+
+void
+Trace::UpdateDelta(unsigned i) noexcept
+{
+  TraceDelta &td = nodes[i];
+  if (i == first || i == last)
+    return;
 
-  delta_list.erase(delta_list.iterator_to(td));
-  td.Update(previous.point, next.point);
-  delta_list.insert(td);
+  td.Update(nodes[td.prev].point, nodes[td.next].point);
+  HeapUpdate(i);
 }
 
 void
-Trace::EraseInside(DeltaList::iterator it) noexcept
+Trace::EraseInside(unsigned i) noexcept
 {
   assert(cached_size > 0);
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-  assert(it != delta_list.end());
 
-  const TraceDelta &td = *it;
+  const TraceDelta &td = nodes[i];
   assert(!td.IsEdge());
 
-  const auto ci = chronological_list.iterator_to(td);
-  TraceDelta &previous = const_cast<TraceDelta &>(*std::prev(ci));
-  TraceDelta &next = const_cast<TraceDelta &>(*std::next(ci));
+  const unsigned previous = td.prev, next = td.next;
 
   // now delete the item
-  chronological_list.erase(chronological_list.iterator_to(td));
-  delta_list.erase_and_dispose(it, MakeDisposer());
-  --cached_size;
+  FreeNode(i);
 
   // and update the deltas
   UpdateDelta(previous);
@@ -99,8 +228,7 @@ Trace::EraseInside(DeltaList::iterator it) noexcept
 bool
 Trace::EraseDelta(const unsigned target_size, const Time recent) noexcept
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  assert(cached_size == heap.size());
 
   if (size() <= 2)
     return false;
@@ -109,45 +237,48 @@ Trace::EraseDelta(const unsigned target_size, const Time recent) noexcept
 
   const Time recent_time = GetRecentTime(recent);
 
-  auto candidate = delta_list.begin();
-  while (size() > target_size) {
-    const TraceDelta &td = *candidate;
+  /* points which may not be removed are taken out of the heap until
+     the loop is finished; this does not change the result, because
+     whether a point is suppressed does not change during the loop
+     (the edges stay, and the recent time is constant) */
+  assert(suppressed.empty());
+
+  while (size() > target_size && !heap.empty()) {
+    const unsigned i = heap.front();
+    HeapRemove(i);
+
+    const TraceDelta &td = nodes[i];
     if (!td.IsEdge() && td.point.GetTime() < recent_time) {
-      EraseInside(candidate);
-      candidate = delta_list.begin(); // find new top
+      EraseInside(i);
       modified = true;
     } else {
-      ++candidate;
       // suppressed removal, skip it.
+      suppressed.push_back(i);
     }
   }
 
+  for (const unsigned i : suppressed)
+    HeapPush(i);
+  suppressed.clear();
+
   return modified;
 }
 
 bool
 Trace::EraseEarlierThan(const Time p_time) noexcept
 {
-  if (p_time == Time{} || empty() || GetFront().point.GetTime() >= p_time)
+  if (p_time == Time{} || empty() || front().GetTime() >= p_time)
     // there will be nothing to remove
     return false;
 
   do {
-    auto ci = chronological_list.begin();
-    TraceDelta &td = *ci;
-    chronological_list.erase(ci);
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase_and_dispose(i, MakeDisposer());
-
-    --cached_size;
-  } while (!empty() && GetFront().point.GetTime() < p_time);
+    EraseNode(first);
+  } while (!empty() && front().GetTime() < p_time);
 
   // need to set deltas for first point, only one of these
   // will occur (have to search for this point)
   if (!empty())
-    EraseStart(GetFront());
+    EraseStart(first);
 
   ++modify_serial;
   ++append_serial;
@@ -160,43 +291,32 @@ Trace::EraseLaterThan(const Time min_time) noexcept
   assert(min_time.count() > 0);
   assert(!empty());
 
-  while (!empty() && GetBack().point.GetTime() > min_time) {
-    TraceDelta &td = GetBack();
-
-    chronological_list.erase(chronological_list.iterator_to(td));
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase_and_dispose(i, MakeDisposer());
-
-    --cached_size;
-  }
+  while (!empty() && back().GetTime() > min_time)
+    EraseNode(last);
 
   /* need to set deltas for first point, only one of these will occur
      (have to search for this point) */
   if (!empty())
-    EraseStart(GetBack());
+    EraseStart(last);
 }
 
 /**
  * Update start node (and neighbour) after min time pruning
  */
 void
-Trace::EraseStart(TraceDelta &td) noexcept
+Trace::EraseStart(unsigned i) noexcept
 {
-  delta_list.erase(delta_list.iterator_to(td));
-
+  TraceDelta &td = nodes[i];
   td.elim_distance = null_delta;
   td.elim_time = null_time;
 
-  delta_list.insert(td);
+  HeapUpdate(i);
 }
 
 void
 Trace::push_back(const TracePoint &point) noexcept
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  assert(cached_size == heap.size());
 
   const Time min_delta = std::chrono::seconds{2};
 
@@ -230,17 +350,14 @@ Trace::push_back(const TracePoint &point) noexcept
 
   assert(size() < max_size);
 
-  TraceDelta *td = allocator.allocate(1);
-  std::allocator_traits<Allocator>::construct(allocator, td, point);
-  td->point.Project(task_projection);
-
-  delta_list.insert(*td);
-  chronological_list.push_back(*td);
+  const unsigned i = AllocateNode(point);
+  TraceDelta &td = nodes[i];
+  td.point.Project(task_projection);
 
-  ++cached_size;
+  HeapPush(i);
 
-  if (td != &chronological_list.front())
-    UpdateDelta(*std::prev(chronological_list.iterator_to(*td)));
+  if (td.prev != NIL)
+    UpdateDelta(td.prev);
 
   ++append_serial;
 }
@@ -252,10 +369,10 @@ Trace::CalcAverageDeltaDistance(const Time no_thin) const noexcept
   unsigned acc = 0;
   unsigned counter = 0;
 
-  const auto end = chronological_list.end();
-  for (auto it = chronological_list.begin();
-       it != end && it->point.GetTime() < r; ++it, ++counter)
-    acc += it->delta_distance;
+  for (unsigned i = first;
+       i != NIL && nodes[i].point.GetTime() < r;
+       i = nodes[i].next, ++counter)
+    acc += nodes[i].delta_distance;
 
   if (counter)
     return acc / counter;
@@ -270,19 +387,21 @@ Trace::CalcAverageDeltaTime(const Time no_thin) const noexcept
   unsigned counter = 0;
 
   /* find the last item before the "r" timestamp */
-  const auto end = chronological_list.end();
-  ChronologicalList::const_iterator it;
-  for (it = chronological_list.begin(); it != end && it->point.GetTime() < r; ++it)
+  unsigned previous = NIL;
+  for (unsigned i = first;
+       i != NIL && nodes[i].point.GetTime() < r;
+       i = nodes[i].next) {
+    previous = i;
     ++counter;
+  }
 
   if (counter < 2)
     return {};
 
-  --it;
   --counter;
 
   Time start_time = front().GetTime();
-  Time end_time = it->point.GetTime();
+  Time end_time = nodes[previous].point.GetTime();
   return (end_time - start_time) / counter;
 }
 
@@ -323,8 +442,7 @@ Trace::Thin2() noexcept
 void
 Trace::Thin() noexcept
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  assert(cached_size == heap.size());
   assert(size() == max_size);
 
   Thin2();
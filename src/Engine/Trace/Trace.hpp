@@ -5,17 +5,15 @@
 
 #include "Point.hpp"
 #include "util/NonCopyable.hpp"
-#include "util/Sanitizer.hxx"
-#include "util/SliceAllocator.hxx"
 #include "util/Serial.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "time/Stamp.hpp"
 
-#include <boost/intrusive/list.hpp>
-#include <boost/intrusive/set.hpp>
 #include <algorithm>
 #include <cassert>
-#include <type_traits>
+#include <cstddef>
+#include <iterator>
+#include <vector>
 #include <stdlib.h>
 
 class TracePointVector;
@@ -30,14 +28,25 @@ class TracePointerVector;
  * the candidate point removed.  In this version, time differences is also a
  * secondary factor, such that thinning attempts to remove points such that,
  * for equal distance ranking, smaller time step details are removed first.
+ *
+ * The points live in one contiguous array which is allocated once
+ * (#max_size elements), chained in chronological order by indices.
+ * The elimination candidates are ranked by an indexed 4-ary heap of
+ * array indices; each point knows its heap position, so updating the
+ * ranking after a neighbour was removed costs O(log n) without any
+ * allocation.  Removed points become "tombstones" on a free list and
+ * are reused by push_back().
  */
 class Trace : private NonCopyable
 {
   using Time = TracePoint::Time;
 
-  struct TraceDelta
-    : boost::intrusive::set_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>,
-      boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>> {
+  /**
+   * A "null" index for the chronological chain and the heap.
+   */
+  static constexpr unsigned NIL = 0 - 1;
+
+  struct TraceDelta {
 
     /**
      * Function used to points for sorting by deltas.
@@ -72,19 +81,25 @@ class Trace : private NonCopyable
       return false;
     }
 
-    struct DeltaRankOp {
-      constexpr bool operator()(const TraceDelta &s1,
-                                const TraceDelta &s2) const noexcept {
-        return DeltaRank(s1, s2);
-      }
-    };
-
     TracePoint point;
 
     Time elim_time;
     unsigned elim_distance;
     unsigned delta_distance;
 
+    /**
+     * The array indices of the chronological neighbours (or #NIL).
+     * For a tombstone, #next links the free list.
+     */
+    unsigned prev, next;
+
+    /**
+     * The position of this point in #Trace::heap, or #NIL if it is
+     * not in the heap (a tombstone, or temporarily suppressed by
+     * EraseDelta()).
+     */
+    unsigned heap_index;
+
     explicit TraceDelta(const TracePoint &p) noexcept
       :point(p),
        elim_time(null_time), elim_distance(null_delta),
@@ -152,30 +167,42 @@ class Trace : private NonCopyable
     }
   };
 
-  /* using multiset, not because we need multiple values (we don't),
-     but to avoid set's overhead for duplicate elimination */
-  typedef boost::intrusive::multiset<TraceDelta,
-                                     boost::intrusive::compare<TraceDelta::DeltaRankOp>,
-                                     boost::intrusive::constant_time_size<false>> DeltaList;
+  /**
+   * The number of children of each heap node.  4 keeps the heap
+   * shallow while the children of a node share a cache line.
+   */
+  static constexpr unsigned HEAP_ARITY = 4;
 
-  typedef boost::intrusive::list<TraceDelta,
-                                 boost::intrusive::constant_time_size<false>> ChronologicalList;
+  /**
+   * All points, including tombstones.  Its capacity is reserved for
+   * #max_size elements on the first push_back(), and it never grows
+   * beyond that, so pointers to points remain valid until they are
+   * removed (see #TracePointerVector).
+   */
+  std::vector<TraceDelta> nodes;
 
   /**
-   * Use a SliceAllocator for allocating TraceDelta instances.  This
-   * reduces a lot of allocation overhead (both CPU and memory),
-   * because there will be lots of these objects.  Fall back to
-   * std::allocator when compiled with AddressSanitizer, because that
-   * avoids hiding memory errors.
+   * The indices of all points in #nodes ordered as a min-heap by
+   * TraceDelta::DeltaRank().
    */
-  using Allocator = std::conditional_t<HaveAddressSanitizer(),
-                                       std::allocator<TraceDelta>,
-                                       SliceAllocator<TraceDelta, 128u>>;
+  std::vector<unsigned> heap;
 
-  Allocator allocator;
+  /**
+   * Scratch buffer for EraseDelta(): points which may not be removed
+   * and were taken out of the heap.
+   */
+  std::vector<unsigned> suppressed;
+
+  /**
+   * The indices of the oldest and the newest point (or #NIL).
+   */
+  unsigned first = NIL, last = NIL;
+
+  /**
+   * The head of the tombstone list linked by TraceDelta::next.
+   */
+  unsigned free_head = NIL;
 
-  DeltaList delta_list;
-  ChronologicalList chronological_list;
   unsigned cached_size;
 
   TaskProjection task_projection;
@@ -185,30 +212,11 @@ class Trace : private NonCopyable
   const unsigned max_size;
   const unsigned opt_size;
 
-  Time average_delta_time;
-  unsigned average_delta_distance;
+  Time average_delta_time{};
+  unsigned average_delta_distance = 0;
 
   Serial append_serial, modify_serial;
 
-  template<typename Alloc>
-  struct Disposer {
-    Alloc &alloc;
-
-    void operator()(typename std::allocator_traits<Alloc>::pointer td) {
-      std::allocator_traits<Alloc>::destroy(alloc, td);
-      alloc.deallocate(td, 1);
-    }
-  };
-
-  template<typename Alloc>
-  static Disposer<Alloc> MakeDisposer(Alloc &alloc) {
-    return {alloc};
-  }
-
-  Disposer<decltype(allocator)> MakeDisposer() {
-    return MakeDisposer(allocator);
-  }
-
 public:
   /**
    * Constructor.  Task projection is updated after first call to append().
@@ -222,9 +230,7 @@ public:
                  const Time max_time = null_time,
                  const unsigned max_size = 1000) noexcept;
 
-  ~Trace() noexcept {
-    clear();
-  }
+  ~Trace() noexcept = default;
 
 protected:
   /**
@@ -239,25 +245,21 @@ protected:
   Time GetRecentTime(Time t) const noexcept;
 
   /**
-   * Update delta values for specified item in the delta list and the
-   * tree.  This repositions the item after into its sorted position.
-   *
-   * @param it Item to update
-   * @param tree Tree containing leaf
+   * Update delta values for specified item and reposition it in the
+   * heap.
    *
-   * @return Iterator to updated item
+   * @param i Index of the item to update
    */
-  void UpdateDelta(TraceDelta &td) noexcept;
+  void UpdateDelta(unsigned i) noexcept;
 
   /**
-   * Erase a non-edge item from delta list and tree, updating
-   * deltas in the process.  This Invalidates the calling iterator.
-   *
-   * @param it Item to erase
-   * @param tree Tree to remove from
+   * Erase a non-edge item, updating the deltas of its neighbours in
+   * the process.  The item must have been removed from the heap
+   * already.
    *
+   * @param i Index of the item to erase
    */
-  void EraseInside(DeltaList::iterator it) noexcept;
+  void EraseInside(unsigned i) noexcept;
 
   /**
    * Erase elements based on delta metric until the size is
@@ -296,7 +298,7 @@ protected:
   /**
    * Update start node (and neighbour) after min time pruning
    */
-  void EraseStart(TraceDelta &td_start) noexcept;
+  void EraseStart(unsigned i) noexcept;
 
 public:
   /**
@@ -395,13 +397,13 @@ public:
   const TracePoint &front() const noexcept {
     assert(!empty());
 
-    return chronological_list.front().point;
+    return nodes[first].point;
   }
 
   const TracePoint &back() const noexcept {
     assert(!empty());
 
-    return chronological_list.back().point;
+    return nodes[last].point;
   }
 
 private:
@@ -428,16 +430,50 @@ private:
    */
   void Thin() noexcept;
 
-  TraceDelta &GetFront() noexcept {
-    assert(!empty());
+  /**
+   * Allocate a point from the free list or from the reserved
+   * capacity of #nodes.
+   *
+   * @return the index of the new point
+   */
+  unsigned AllocateNode(const TracePoint &point) noexcept;
+
+  /**
+   * Unlink the point from the chronological chain and move it to the
+   * free list.  It must have been removed from the heap already.
+   */
+  void FreeNode(unsigned i) noexcept;
 
-    return chronological_list.front();
+  /* indexed heap operations */
+
+  [[gnu::pure]]
+  bool HeapLess(unsigned a, unsigned b) const noexcept {
+    return TraceDelta::DeltaRank(nodes[heap[a]], nodes[heap[b]]);
   }
 
-  TraceDelta &GetBack() noexcept {
-    assert(!empty());
+  void HeapSet(unsigned position, unsigned i) noexcept {
+    heap[position] = i;
+    nodes[i].heap_index = position;
+  }
 
-    return chronological_list.back();
+  void HeapSiftUp(unsigned position) noexcept;
+  void HeapSiftDown(unsigned position) noexcept;
+  void HeapPush(unsigned i) noexcept;
+  void HeapRemove(unsigned i) noexcept;
+
+  /**
+   * Restore the heap order after the rank of the point has changed.
+   * This is a no-op if the point is not in the heap.
+   */
+  void HeapUpdate(unsigned i) noexcept;
+
+  /**
+   * Remove a point (which is in the heap) from the heap and from the
+   * chronological chain.
+   */
+  void EraseNode(unsigned i) noexcept {
+    HeapRemove(i);
+    FreeNode(i);
   }
 
   [[gnu::pure]]
@@ -460,15 +496,28 @@ public:
   }
 
 public:
-  class const_iterator : public ChronologicalList::const_iterator {
+  class const_iterator {
     friend class Trace;
 
-    const_iterator(ChronologicalList::const_iterator &&_iterator) noexcept
-      :ChronologicalList::const_iterator(std::move(_iterator)) {}
+    const std::vector<TraceDelta> *nodes = nullptr;
+
+    /**
+     * The index of the current point, or #NIL for end().
+     */
+    unsigned i;
+
+    /**
+     * Needed to decrement end().
+     */
+    unsigned last;
+
+    const_iterator(const std::vector<TraceDelta> &_nodes, unsigned _i,
+                   unsigned _last) noexcept
+      :nodes(&_nodes), i(_i), last(_last) {}
 
   public:
-    using ChronologicalList::const_iterator::iterator_category;
-    using ChronologicalList::const_iterator::difference_type;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type = std::ptrdiff_t;
     typedef const TracePoint value_type;
     typedef const TracePoint *pointer;
     typedef const TracePoint &reference;
@@ -476,13 +525,46 @@ public:
     const_iterator() = default;
 
     const TracePoint &operator*() const noexcept {
-      const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-      return td.point;
+      assert(i != NIL);
+
+      return (*nodes)[i].point;
     }
 
     const TracePoint *operator->() const noexcept {
-      const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-      return &td.point;
+      return &**this;
+    }
+
+    const_iterator &operator++() noexcept {
+      assert(i != NIL);
+
+      i = (*nodes)[i].next;
+      return *this;
+    }
+
+    const_iterator operator++(int) noexcept {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    const_iterator &operator--() noexcept {
+      i = i == NIL ? last : (*nodes)[i].prev;
+      assert(i != NIL);
+      return *this;
+    }
+
+    const_iterator operator--(int) noexcept {
+      auto old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const const_iterator &other) const noexcept {
+      return i == other.i;
+    }
+
+    bool operator!=(const const_iterator &other) const noexcept {
+      return i != other.i;
     }
 
     const_iterator &NextSquareRange(unsigned sq_resolution,
@@ -494,19 +576,18 @@ public:
         if (*this == end)
           return *this;
 
-        const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-        if (td.point.FlatSquareDistanceTo(previous) >= sq_resolution)
+        if ((**this).FlatSquareDistanceTo(previous) >= sq_resolution)
           return *this;
       }
     }
   };
 
   const_iterator begin() const noexcept {
-    return chronological_list.begin();
+    return {nodes, first, last};
   }
 
   const_iterator end() const noexcept {
-    return chronological_list.end();
+    return {nodes, NIL, last};
   }
 
   const TaskProjection &GetProjection() const noexcept {
@@ -2,32 +2,59 @@
 // Copyright The XCSoar Project
 
 #include "Waypoints.hpp"
-#include "util/AllocatedArray.hxx"
 #include "util/StringUtil.hpp"
 
 static constexpr std::size_t NORMALIZE_BUFFER_SIZE = 4096;
 
+/**
+ * Normalise the given string with NormalizeSearchString() and pass
+ * the result to the given function.  Strings which are too long are
+ * ignored.
+ */
+template<typename F>
+static void
+WithNormalised(tstring_view src, F &&f)
+{
+  if (src.size() >= NORMALIZE_BUFFER_SIZE)
+    return;
+
+  TCHAR normalized[NORMALIZE_BUFFER_SIZE];
+  NormalizeSearchString(normalized, src);
+  f(tstring_view{normalized});
+}
+
+/**
+ * Invoke the given function with each normalised key of the
+ * waypoint (name and short name).
+ */
+template<typename F>
+static void
+ForEachNormalisedKey(const Waypoint &wp, F &&f)
+{
+  WithNormalised(wp.name, f);
+
+  if (!wp.shortname.empty())
+    WithNormalised(wp.shortname, f);
+}
+
 inline WaypointPtr
 Waypoints::WaypointNameTree::Get(tstring_view name) const noexcept
 {
-  if (name.size() >= NORMALIZE_BUFFER_SIZE)
-    return {};
-
-  TCHAR normalized_name[NORMALIZE_BUFFER_SIZE];
-  NormalizeSearchString(normalized_name, name);
-  return RadixTree<WaypointPtr>::Get(normalized_name, nullptr);
+  WaypointPtr result;
+  WithNormalised(name, [this, &result](tstring_view key){
+    if (const auto *wp = PrefixIndex::Get(key))
+      result = *wp;
+  });
+  return result;
 }
 
 inline void
 Waypoints::WaypointNameTree::VisitNormalisedPrefix(tstring_view prefix,
                                                    const WaypointVisitor &visitor) const
 {
-  if (prefix.size() >= NORMALIZE_BUFFER_SIZE)
-    return;
-
-  TCHAR normalized[NORMALIZE_BUFFER_SIZE];
-  NormalizeSearchString(normalized, prefix);
-  VisitPrefix(normalized, visitor);
+  WithNormalised(prefix, [this, &visitor](tstring_view key){
+    VisitPrefix(key, visitor);
+  });
 }
 
 TCHAR *
@@ -35,40 +62,35 @@ Waypoints::WaypointNameTree::SuggestNormalisedPrefix(tstring_view prefix,
                                                      TCHAR *dest,
                                                      size_t max_length) const noexcept
 {
-  if (prefix.size() >= NORMALIZE_BUFFER_SIZE)
-    return nullptr;
+  TCHAR *result = nullptr;
+  WithNormalised(prefix, [this, dest, max_length, &result](tstring_view key){
+    result = Suggest(key, dest, max_length);
+  });
+  return result;
+}
 
-  TCHAR normalized[NORMALIZE_BUFFER_SIZE];
-  NormalizeSearchString(normalized, prefix);
-  return Suggest(normalized, dest, max_length);
+inline void
+Waypoints::WaypointNameTree::Add(const WaypointPtr &wp) noexcept
+{
+  ForEachNormalisedKey(*wp, [this, &wp](tstring_view key){
+    PrefixIndex::Add(key, wp);
+  });
 }
 
 inline void
-Waypoints::WaypointNameTree::Add(WaypointPtr wp) noexcept
+Waypoints::WaypointNameTree::Add(Batch &batch, const WaypointPtr &wp) noexcept
 {
-  AllocatedArray<TCHAR> buffer(wp->name.length() + 1);
-  NormalizeSearchString(buffer.data(), wp->name);
-  RadixTree<WaypointPtr>::Add(buffer.data(), wp);
-
-  if (!wp->shortname.empty()) {
-    buffer.GrowDiscard(wp->shortname.length() + 1);
-    NormalizeSearchString(buffer.data(), wp->shortname);
-    RadixTree<WaypointPtr>::Add(buffer.data(), std::move(wp));
-  }
+  ForEachNormalisedKey(*wp, [&batch, &wp](tstring_view key){
+    batch.Add(key, wp);
+  });
 }
 
 inline void
 Waypoints::WaypointNameTree::Remove(const WaypointPtr &wp) noexcept
 {
-  AllocatedArray<TCHAR> buffer(wp->name.length() + 1);
-  NormalizeSearchString(buffer.data(), wp->name);
-  RadixTree<WaypointPtr>::Remove(buffer.data(), wp);
-
-  if (!wp->shortname.empty()) {
-    buffer.GrowDiscard(wp->shortname.length() + 1);
-    NormalizeSearchString(buffer.data(), wp->shortname);
-    RadixTree<WaypointPtr>::Remove(buffer.data(), wp);
-  }
+  ForEachNormalisedKey(*wp, [this, &wp](tstring_view key){
+    PrefixIndex::Remove(key, wp);
+  });
 }
 
 Waypoints::Waypoints() noexcept = default;
@@ -76,6 +98,8 @@ Waypoints::Waypoints() noexcept = default;
 void
 Waypoints::Optimise() noexcept
 {
+  name_tree.Commit();
+
   if (waypoint_tree.IsEmpty() || waypoint_tree.HaveBounds())
     /* empty or already optimised */
     return;
@@ -115,6 +139,51 @@ Waypoints::Append(WaypointPtr wp) noexcept
   ++serial;
 }
 
+void
+Waypoints::Append(std::vector<Waypoint> &&list) noexcept
+{
+  if (list.empty())
+    return;
+
+  if (waypoint_tree.HaveBounds()) {
+    /* the tree is optimised already; insert each waypoint into it
+       (and only rebuild it if one of them is out of bounds) */
+    for (auto &i : list)
+      Append(std::move(i));
+    list.clear();
+    return;
+  }
+
+  /* the tree has no bounds yet, so this is just a quick add, and the
+     whole tree is built in one pass by the next Optimise() call */
+  if (IsEmpty())
+    task_projection.Reset(list.front().location);
+
+  WaypointNameTree::Batch names;
+  names.reserve(list.size() * 2);
+
+  waypoint_tree.reserve(waypoint_tree.size() + list.size());
+
+  for (auto &i : list) {
+    WaypointPtr wp(new Waypoint(std::move(i)));
+
+    // TODO: eliminate this const_cast hack
+    Waypoint &w = const_cast<Waypoint &>(*wp);
+    w.flags.watched = w.origin == WaypointOrigin::WATCHED;
+
+    task_projection.Scan(w.location);
+    w.id = next_id++;
+
+    WaypointNameTree::Add(names, wp);
+    waypoint_tree.Add(std::move(wp));
+  }
+
+  name_tree.Add(std::move(names));
+
+  list.clear();
+  ++serial;
+}
+
 WaypointPtr
 Waypoints::GetNearest(const GeoPoint &loc, double range) const noexcept
 {
@@ -236,6 +305,22 @@ Waypoints::VisitWithinRange(const GeoPoint &loc, const double range,
   waypoint_tree.VisitWithinRange(point, mrange, visitor);
 }
 
+void
+Waypoints::VisitNearest(const GeoPoint &loc, const double range, unsigned n,
+                        WaypointVisitor visitor) const
+{
+  if (IsEmpty())
+    return; // nothing to do
+
+  const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
+  const WaypointTree::Point point(flat_location.x, flat_location.y);
+  const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
+
+  waypoint_tree.VisitNearestIf(point, mrange, n,
+                               [](const WaypointPtr &){ return true; },
+                               visitor);
+}
+
 void
 Waypoints::VisitNamePrefix(tstring_view prefix,
                            WaypointVisitor visitor) const
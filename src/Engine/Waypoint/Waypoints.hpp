@@ -6,12 +6,13 @@
 #include "Ptr.hpp"
 #include "Waypoint.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
-#include "util/RadixTree.hpp"
-#include "util/QuadTree.hxx"
+#include "util/PrefixIndex.hpp"
+#include "util/PackedKDTree.hxx"
 #include "util/Serial.hpp"
 #include "util/tstring_view.hxx"
 
 #include <functional>
+#include <vector>
 
 using WaypointVisitor = std::function<void(const WaypointPtr &)>;
 
@@ -22,7 +23,7 @@ using WaypointVisitor = std::function<void(const WaypointPtr &)>;
 class Waypoints {
   /**
    * Function object used to provide access to coordinate values by
-   * QuadTree.
+   * PackedKDTree.
    */
   struct WaypointAccessor {
     [[gnu::pure]]
@@ -39,18 +40,30 @@ class Waypoints {
   /**
    * Type of KD-tree data structure for waypoint container
    */
-  using WaypointTree = QuadTree<WaypointPtr, WaypointAccessor>;
+  using WaypointTree = PackedKDTree<WaypointPtr, WaypointAccessor>;
 
-  class WaypointNameTree : public RadixTree<WaypointPtr> {
+  /**
+   * Maps the normalised name and short name of each waypoint to the
+   * waypoint.
+   */
+  class WaypointNameTree : public PrefixIndex<WaypointPtr> {
   public:
+    using PrefixIndex::Add;
+
     [[gnu::pure]]
     WaypointPtr Get(tstring_view name) const noexcept;
 
     void VisitNormalisedPrefix(tstring_view prefix, const WaypointVisitor &visitor) const;
     TCHAR *SuggestNormalisedPrefix(tstring_view prefix,
                                    TCHAR *dest, size_t max_length) const noexcept;
-    void Add(WaypointPtr wp) noexcept;
+    void Add(const WaypointPtr &wp) noexcept;
     void Remove(const WaypointPtr &wp) noexcept;
+
+    /**
+     * Add the waypoint to a #Batch which will be passed to
+     * PrefixIndex::Add().
+     */
+    static void Add(Batch &batch, const WaypointPtr &wp) noexcept;
   };
 
   /**
@@ -107,6 +120,14 @@ public:
     return ptr;
   }
 
+  /**
+   * Add a list of waypoints to the internal store, in the given
+   * order.  This is equivalent to calling Append() for each of them,
+   * but the search tree is rebuilt only once by the next Optimise()
+   * call instead of being checked for each waypoint.
+   */
+  void Append(std::vector<Waypoint> &&list) noexcept;
+
   /**
    * Erase waypoint from the internal store.  Requires Optimise() to
    * be called afterwards
@@ -142,7 +163,8 @@ public:
 
   /**
    * Optimise the internal search tree after adding/removing elements.
-   * Also performs projection to flat earth for new elements.
+   * Also performs projection to flat earth for new elements and
+   * merges new names into the name index.
    * This updates the task_projection.
    *
    * Note: currently this code doesn't check for task projections
@@ -278,6 +300,19 @@ public:
   void VisitWithinRange(const GeoPoint &loc, double range,
                         WaypointVisitor visitor) const;
 
+  /**
+   * Call visitor function on the waypoints nearest to the search
+   * location (at most #n of them, within the given range), nearest
+   * first.
+   *
+   * @param loc Location from which to search
+   * @param range Distance in meters of search radius
+   * @param n Maximum number of waypoints to visit
+   * @param visitor Visitor to be called on the waypoints
+   */
+  void VisitNearest(const GeoPoint &loc, double range, unsigned n,
+                    WaypointVisitor visitor) const;
+
   /**
    * Call visitor function on waypoints with the specified name
    * prefix.
@@ -2,9 +2,158 @@
 // Copyright The XCSoar Project
 
 #include "FlarmNetDatabase.hpp"
-#include "util/StringAPI.hxx"
+#include "io/FileMapping.hpp"
+#include "io/OutputStream.hxx"
+#include "system/Path.hpp"
+#include "util/SpanCast.hxx"
 
-#include <cassert>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<FlarmNetRecord>,
+              "FlarmNetRecord must be trivially copyable for the image file");
+
+/**
+ * The header of an image file written by
+ * FlarmNetDatabase::SaveImage().  It is followed by the records, the
+ * id hash table and the callsign index, each aligned to 4 bytes.
+ * All values are in host byte order; the file is a cache which is
+ * only ever read by the build which wrote it.
+ */
+struct FlarmNetImageHeader {
+  static constexpr uint32_t MAGIC = 0x464c4e49; // "FLNI"
+  static constexpr uint32_t VERSION = 2;
+
+  uint32_t magic, version;
+
+  /**
+   * sizeof(FlarmNetRecord), which depends on the character type.
+   */
+  uint32_t record_size;
+
+  uint32_t n_records;
+  uint32_t id_table_bits;
+  uint32_t reserved;
+
+  uint64_t source_size, source_time;
+
+  /**
+   * A hash of the path of the source file.
+   */
+  uint64_t source_path_hash;
+};
+
+static_assert(sizeof(FlarmNetImageHeader) == 48);
+
+/**
+ * The 64 bit FNV-1a hash of a path name.
+ */
+[[gnu::pure]]
+static uint64_t
+HashSourcePath(Path path) noexcept
+{
+  const std::basic_string_view name{path.c_str()};
+
+  uint64_t value = 0xcbf29ce484222325ULL;
+  for (const std::byte b : std::as_bytes(std::span{name})) {
+    value ^= static_cast<uint64_t>(b);
+    value *= 0x100000001b3ULL;
+  }
+
+  return value;
+}
+
+static constexpr std::size_t
+AlignImageOffset(std::size_t offset) noexcept
+{
+  return (offset + 3) & ~std::size_t(3);
+}
+
+/**
+ * Does the buffer contain a null terminator?  This checks the whole
+ * buffer, not just the string (whose end would be found by looking
+ * for the terminator).
+ */
+template<typename B>
+[[gnu::pure]]
+static bool
+IsTerminated(const B &buffer) noexcept
+{
+  const auto *begin = buffer.c_str(), *end = begin + buffer.capacity();
+  return std::find(begin, end, B::SENTINEL) != end;
+}
+
+/**
+ * Are all strings of the record terminated within their buffers?
+ * The strings of a mapped image are used as C strings, so an
+ * unterminated one would be read beyond its end.
+ */
+[[gnu::pure]]
+static bool
+IsTerminated(const FlarmNetRecord &record) noexcept
+{
+  return IsTerminated(record.id) && IsTerminated(record.pilot) &&
+    IsTerminated(record.airfield) && IsTerminated(record.plane_type) &&
+    IsTerminated(record.registration) && IsTerminated(record.callsign) &&
+    IsTerminated(record.frequency);
+}
+
+static constexpr TCHAR
+NormaliseCallSignChar(TCHAR ch) noexcept
+{
+  return ch >= _T('a') && ch <= _T('z')
+    ? TCHAR(ch - _T('a') + _T('A'))
+    : ch;
+}
+
+/**
+ * Compare two callsigns after normalising them to upper case.
+ */
+[[gnu::pure]]
+static int
+CompareCallSign(const TCHAR *a, const TCHAR *b) noexcept
+{
+  while (true) {
+    const TCHAR ca = NormaliseCallSignChar(*a++);
+    const TCHAR cb = NormaliseCallSignChar(*b++);
+    if (ca != cb)
+      return ca < cb ? -1 : 1;
+
+    if (ca == 0)
+      return 0;
+  }
+}
+
+[[gnu::pure]]
+static bool
+CallSignStartsWith(const TCHAR *callsign, const TCHAR *prefix) noexcept
+{
+  for (; *prefix != 0; ++callsign, ++prefix)
+    if (NormaliseCallSignChar(*callsign) != NormaliseCallSignChar(*prefix))
+      return false;
+
+  return true;
+}
+
+FlarmNetDatabase::FlarmNetDatabase() noexcept = default;
+FlarmNetDatabase::~FlarmNetDatabase() noexcept = default;
+
+void
+FlarmNetDatabase::Clear() noexcept
+{
+  pending.clear();
+  owned_records.clear();
+  owned_id_table.clear();
+  owned_callsign_index.clear();
+  mapping.reset();
+
+  records = {};
+  id_table = {};
+  id_table_bits = 0;
+  callsign_index = {};
+}
 
 void
 FlarmNetDatabase::Insert(const FlarmNetRecord &record) noexcept
@@ -14,34 +163,236 @@ FlarmNetDatabase::Insert(const FlarmNetRecord &record) noexcept
     /* ignore malformed records */
     return;
 
-  map.insert(std::make_pair(id, record));
+  pending.push_back(record);
+}
+
+void
+FlarmNetDatabase::Commit() noexcept
+{
+  auto new_records = std::move(pending);
+  pending = {};
+
+  Clear();
+
+  /* sort by id; the stable sort and std::unique() keep the first of
+     several records with the same id */
+  std::stable_sort(new_records.begin(), new_records.end(),
+                   [](const FlarmNetRecord &a, const FlarmNetRecord &b){
+                     return a.GetId() < b.GetId();
+                   });
+  new_records.erase(std::unique(new_records.begin(), new_records.end(),
+                                [](const FlarmNetRecord &a,
+                                   const FlarmNetRecord &b){
+                                  return a.GetId() == b.GetId();
+                                }),
+                    new_records.end());
+
+  owned_records = std::move(new_records);
+  records = owned_records;
+
+  BuildIndexes();
+}
+
+void
+FlarmNetDatabase::BuildIndexes() noexcept
+{
+  /* a load factor of at most 50% keeps the probe sequences short */
+  id_table_bits = 4;
+  while ((std::size_t(1) << id_table_bits) < records.size() * 2)
+    ++id_table_bits;
+
+  owned_id_table.assign(std::size_t(1) << id_table_bits, 0);
+  const uint32_t mask = owned_id_table.size() - 1;
+
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    uint32_t slot = records[i].GetId().Hash() >> (32 - id_table_bits);
+    while (owned_id_table[slot] != 0)
+      slot = (slot + 1) & mask;
+
+    owned_id_table[slot] = i + 1;
+  }
+
+  id_table = owned_id_table;
+
+  owned_callsign_index.resize(records.size());
+  for (std::size_t i = 0; i < records.size(); ++i)
+    owned_callsign_index[i] = i;
+
+  /* the records are sorted by id already, so a stable sort orders
+     equal callsigns by id */
+  std::stable_sort(owned_callsign_index.begin(), owned_callsign_index.end(),
+                   [this](uint32_t a, uint32_t b){
+                     return CompareCallSign(records[a].callsign,
+                                            records[b].callsign) < 0;
+                   });
+
+  callsign_index = owned_callsign_index;
+}
+
+void
+FlarmNetDatabase::SaveImage(OutputStream &os, Path source_path,
+                            uint64_t source_size, uint64_t source_time) const
+{
+  const FlarmNetImageHeader header{
+    FlarmNetImageHeader::MAGIC,
+    FlarmNetImageHeader::VERSION,
+    sizeof(FlarmNetRecord),
+    uint32_t(records.size()),
+    id_table_bits,
+    0,
+    source_size, source_time,
+    HashSourcePath(source_path),
+  };
+
+  static constexpr std::byte padding[4]{};
+
+  os.Write(ReferenceAsBytes(header));
+
+  std::size_t offset = sizeof(header) + records.size_bytes();
+  os.Write(std::as_bytes(records));
+  os.Write(std::span{padding}.first(AlignImageOffset(offset) - offset));
+
+  os.Write(std::as_bytes(id_table));
+  os.Write(std::as_bytes(callsign_index));
+}
+
+bool
+FlarmNetDatabase::LoadImage(Path path, Path source_path,
+                            uint64_t source_size, uint64_t source_time)
+{
+  auto new_mapping = std::make_unique<FileMapping>(path);
+  const std::span<const std::byte> image = *new_mapping;
+
+  if (image.size() < sizeof(FlarmNetImageHeader))
+    return false;
+
+  FlarmNetImageHeader header;
+  memcpy(&header, image.data(), sizeof(header));
+
+  if (header.magic != FlarmNetImageHeader::MAGIC ||
+      header.version != FlarmNetImageHeader::VERSION ||
+      header.record_size != sizeof(FlarmNetRecord) ||
+      header.source_size != source_size ||
+      header.source_time != source_time ||
+      header.source_path_hash != HashSourcePath(source_path) ||
+      header.id_table_bits < 4 || header.id_table_bits >= 32)
+    return false;
+
+  const std::size_t n = header.n_records;
+  const std::size_t id_table_size = std::size_t(1) << header.id_table_bits;
+  if (id_table_size < n * 2)
+    return false;
+
+  const std::size_t id_table_offset =
+    AlignImageOffset(sizeof(header) + n * sizeof(FlarmNetRecord));
+  const std::size_t callsign_index_offset =
+    id_table_offset + id_table_size * sizeof(uint32_t);
+  if (image.size() != callsign_index_offset + n * sizeof(uint32_t))
+    return false;
+
+  /* the mapping is page-aligned and all offsets are multiples of the
+     alignment of their types */
+  const auto *base = image.data();
+  const std::span new_records{
+    reinterpret_cast<const FlarmNetRecord *>(base + sizeof(header)), n,
+  };
+  const std::span new_id_table{
+    reinterpret_cast<const uint32_t *>(base + id_table_offset), id_table_size,
+  };
+  const std::span new_callsign_index{
+    reinterpret_cast<const uint32_t *>(base + callsign_index_offset), n,
+  };
+
+  /* validate the records and the indexes, so lookups never go out
+     of bounds even if the file is corrupt */
+  if (!std::all_of(new_records.begin(), new_records.end(),
+                   [](const FlarmNetRecord &record){
+                     return IsTerminated(record);
+                   }) ||
+      std::any_of(new_id_table.begin(), new_id_table.end(),
+                  [n](uint32_t i){ return i > n; }) ||
+      std::any_of(new_callsign_index.begin(), new_callsign_index.end(),
+                  [n](uint32_t i){ return i >= n; }))
+    return false;
+
+  /* FindRecordById() probes until it finds an empty slot; with at
+     most n used slots in a table of at least 2n slots, there is
+     always one */
+  if (std::size_t(std::count_if(new_id_table.begin(), new_id_table.end(),
+                                [](uint32_t i){ return i != 0; })) > n)
+    return false;
+
+  Clear();
+
+  mapping = std::move(new_mapping);
+  records = new_records;
+  id_table = new_id_table;
+  id_table_bits = header.id_table_bits;
+  callsign_index = new_callsign_index;
+  return true;
 }
 
 const FlarmNetRecord *
-FlarmNetDatabase::FindFirstRecordByCallSign(const TCHAR *cn) const noexcept
+FlarmNetDatabase::FindRecordById(FlarmId id) const noexcept
 {
-  for (const auto &[id, record] : map) {
-    assert(id.IsDefined());
+  if (id_table.empty())
+    return nullptr;
+
+  const uint32_t mask = id_table.size() - 1;
+  for (uint32_t slot = id.Hash() >> (32 - id_table_bits);;
+       slot = (slot + 1) & mask) {
+    const uint32_t i = id_table[slot];
+    if (i == 0)
+      return nullptr;
 
-    if (StringIsEqual(record.callsign, cn))
+    const FlarmNetRecord &record = records[i - 1];
+    if (record.GetId() == id)
       return &record;
   }
+}
 
-  return NULL;
+std::span<const uint32_t>
+FlarmNetDatabase::FindCallSign(const TCHAR *cn, bool prefix) const noexcept
+{
+  const auto first =
+    std::partition_point(callsign_index.begin(), callsign_index.end(),
+                         [this, cn](uint32_t i){
+                           return CompareCallSign(records[i].callsign, cn) < 0;
+                         });
+
+  const auto last =
+    std::partition_point(first, callsign_index.end(),
+                         [this, cn, prefix](uint32_t i){
+                           const TCHAR *callsign = records[i].callsign;
+                           return prefix
+                             ? CallSignStartsWith(callsign, cn)
+                             : CompareCallSign(callsign, cn) == 0;
+                         });
+
+  return {first, last};
+}
+
+const FlarmNetRecord *
+FlarmNetDatabase::FindFirstRecordByCallSign(const TCHAR *cn) const noexcept
+{
+  const auto range = FindCallSign(cn, false);
+  return range.empty()
+    ? nullptr
+    : &records[range.front()];
 }
 
 unsigned
 FlarmNetDatabase::FindRecordsByCallSign(const TCHAR *cn,
                                         const FlarmNetRecord *array[],
-                                        [[maybe_unused]] unsigned size) const noexcept
+                                        unsigned size) const noexcept
 {
   unsigned count = 0;
 
-  for (const auto &[id, record] : map) {
-    assert(id.IsDefined());
+  for (const uint32_t i : FindCallSign(cn, false)) {
+    if (count >= size)
+      break;
 
-    if (StringIsEqual(record.callsign, cn))
-      array[count++] = &record;
+    array[count++] = &records[i];
   }
 
   return count;
@@ -49,15 +400,32 @@ FlarmNetDatabase::FindRecordsByCallSign(const TCHAR *cn,
 
 unsigned
 FlarmNetDatabase::FindIdsByCallSign(const TCHAR *cn, FlarmId array[],
-                                    [[maybe_unused]] unsigned size) const noexcept
+                                    unsigned size) const noexcept
+{
+  unsigned count = 0;
+
+  for (const uint32_t i : FindCallSign(cn, false)) {
+    if (count >= size)
+      break;
+
+    array[count++] = records[i].GetId();
+  }
+
+  return count;
+}
+
+unsigned
+FlarmNetDatabase::FindIdsByCallSignPrefix(const TCHAR *prefix,
+                                          FlarmId array[],
+                                          unsigned size) const noexcept
 {
   unsigned count = 0;
 
-  for (const auto &[id, record] : map) {
-    assert(id.IsDefined());
+  for (const uint32_t i : FindCallSign(prefix, true)) {
+    if (count >= size)
+      break;
 
-    if (StringIsEqual(record.callsign, cn))
-      array[count++] = id;
+    array[count++] = records[i].GetId();
   }
 
   return count;
@@ -6,42 +6,134 @@
 #include "Id.hpp"
 #include "FlarmNetRecord.hpp"
 
-#include <map>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
 #include <tchar.h>
 
+class Path;
+class OutputStream;
+class FileMapping;
+
 /**
  * An in-memory representation of the FlarmNet.org database.
+ *
+ * After all records have been added with Insert(), Commit() sorts
+ * them by id and builds two indexes: an open-addressing hash table
+ * mapping the FLARM id to the record, and a list of records sorted
+ * by their normalised (upper case) callsign, which allows binary
+ * searches for a callsign or a callsign prefix.
+ *
+ * Records and indexes form a flat "image" which can be saved to a
+ * file with SaveImage() and later be mapped into memory with
+ * LoadImage(), which is much cheaper than parsing the FlarmNet file.
  */
 class FlarmNetDatabase {
-  typedef std::map<FlarmId, FlarmNetRecord> RecordMap;
-  RecordMap map;
+  /**
+   * The records added by Insert(), not yet committed.
+   */
+  std::vector<FlarmNetRecord> pending;
+
+  /**
+   * The storage of the committed image if it was built in memory.
+   */
+  std::vector<FlarmNetRecord> owned_records;
+  std::vector<uint32_t> owned_id_table, owned_callsign_index;
+
+  /**
+   * The storage of the committed image if it was loaded with
+   * LoadImage().
+   */
+  std::unique_ptr<FileMapping> mapping;
+
+  /**
+   * All records, sorted by id.
+   */
+  std::span<const FlarmNetRecord> records;
+
+  /**
+   * A hash table with a power-of-two size; each slot contains a
+   * record index plus one, or zero if empty.  Collisions are
+   * resolved by linear probing.
+   */
+  std::span<const uint32_t> id_table;
+
+  /**
+   * The binary logarithm of the size of #id_table.
+   */
+  unsigned id_table_bits = 0;
+
+  /**
+   * Indexes into #records, sorted by the normalised callsign (and
+   * then by id).
+   */
+  std::span<const uint32_t> callsign_index;
 
 public:
+  FlarmNetDatabase() noexcept;
+  ~FlarmNetDatabase() noexcept;
+
+  FlarmNetDatabase(const FlarmNetDatabase &) = delete;
+  FlarmNetDatabase &operator=(const FlarmNetDatabase &) = delete;
+
   bool IsEmpty() const noexcept {
-    return map.empty();
+    return records.empty();
   }
 
-  void Clear() noexcept {
-    map.clear();
+  std::size_t size() const noexcept {
+    return records.size();
   }
 
+  void Clear() noexcept;
+
+  /**
+   * Add a record.  It will not be visible before Commit() is called.
+   * Records with a malformed id are ignored; of several records with
+   * the same id, only the first one is kept.
+   */
   void Insert(const FlarmNetRecord &record) noexcept;
 
+  /**
+   * Replace the current contents with the records added by
+   * Insert(), and build the indexes.
+   */
+  void Commit() noexcept;
+
+  /**
+   * Write the committed image to a file.  The given "source" values
+   * (path, size and modification time of the FlarmNet file it was
+   * parsed from) are stored in the header, to be verified by
+   * LoadImage().
+   *
+   * Throws on I/O error.
+   */
+  void SaveImage(OutputStream &os, Path source_path,
+                 uint64_t source_size, uint64_t source_time) const;
+
+  /**
+   * Replace the current contents with an image file written by
+   * SaveImage() by mapping it into memory.
+   *
+   * Throws on I/O error.
+   *
+   * @return false if the file is not compatible with this build or
+   * does not match the given "source" values
+   */
+  bool LoadImage(Path path, Path source_path,
+                 uint64_t source_size, uint64_t source_time);
+
   /**
    * Finds a FLARMNetRecord object based on the given FLARM id
    * @param id FLARM id
    * @return FLARMNetRecord object
    */
   [[gnu::pure]]
-  const FlarmNetRecord *FindRecordById(FlarmId id) const noexcept {
-    auto i = map.find(id);
-    return i != map.end()
-      ? &i->second
-      : NULL;
-  }
+  const FlarmNetRecord *FindRecordById(FlarmId id) const noexcept;
 
   /**
    * Finds a FLARMNetRecord object based on the given Callsign
+   * (case-insensitive)
    * @param cn Callsign
    * @return FLARMNetRecord object
    */
@@ -54,13 +146,31 @@ public:
   unsigned FindIdsByCallSign(const TCHAR *cn, FlarmId array[],
                              unsigned size) const noexcept;
 
+  /**
+   * Like FindIdsByCallSign(), but finds all callsigns beginning with
+   * the given (case-insensitive) prefix.
+   */
+  unsigned FindIdsByCallSignPrefix(const TCHAR *prefix, FlarmId array[],
+                                   unsigned size) const noexcept;
+
   [[gnu::pure]]
   auto begin() const noexcept {
-    return map.begin();
+    return records.begin();
   }
 
   [[gnu::pure]]
   auto end() const noexcept {
-    return map.end();
+    return records.end();
   }
+
+private:
+  /**
+   * Returns the range of #callsign_index whose callsigns are equal to
+   * (or, if #prefix is set, begin with) the given string.
+   */
+  [[gnu::pure]]
+  std::span<const uint32_t> FindCallSign(const TCHAR *cn,
+                                         bool prefix) const noexcept;
+
+  void BuildIndexes() noexcept;
 };
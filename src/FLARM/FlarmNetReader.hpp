@@ -13,7 +13,8 @@ class NLineReader;
 namespace FlarmNetReader
 {
   /**
-   * Reads all records from the FlarmNet.org file
+   * Reads all records from the FlarmNet.org file and commits them
+   * to the database (see FlarmNetDatabase::Commit())
    *
    * @param reader A NLineReader instance to read from
    * @return the number of records read from the file
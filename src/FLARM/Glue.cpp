@@ -10,6 +10,7 @@
 #include "BackendComponents.hpp"
 #include "MergeThread.hpp"
 #include "LocalPath.hpp"
+#include "system/FileUtil.hpp"
 #include "io/DataFile.hpp"
 #include "io/Reader.hxx"
 #include "io/BufferedReader.hxx"
@@ -23,7 +24,26 @@
 #include "Profile/Keys.hpp"
 
 /**
- * Loads the FLARMnet file
+ * Returns the path of the binary image of the FLARMnet database (see
+ * FlarmNetDatabase::SaveImage()).
+ */
+static AllocatedPath
+GetFLARMnetCachePath() noexcept
+{
+  return AllocatedPath::Build(MakeCacheDirectory(_T("flarmnet")),
+                              _T("flarmnet.bin"));
+}
+
+static uint64_t
+ToCacheTime(std::chrono::system_clock::time_point t) noexcept
+{
+  return std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count();
+}
+
+/**
+ * Loads the FLARMnet file, preferably from the binary image in the
+ * cache directory; if that is missing or outdated, the file is parsed
+ * and a new image is written.
  */
 static void
 LoadFLARMnet(FlarmNetDatabase &db) noexcept
@@ -33,9 +53,34 @@ try {
     return;
   }
 
+  const uint64_t source_size = File::GetSize(path);
+  const uint64_t source_time = ToCacheTime(File::GetLastModification(path));
+
+  const auto cache_path = GetFLARMnetCachePath();
+
+  try {
+    if (File::Exists(cache_path) &&
+        db.LoadImage(cache_path, path, source_size, source_time)) {
+      LogFormat("%u FLARMnet ids loaded from cache", (unsigned)db.size());
+      return;
+    }
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to load FLARMnet cache");
+  }
+
   unsigned num_records = FlarmNetReader::LoadFile(path, db);
-  if (num_records > 0)
-    LogFormat("%u FLARMnet ids found", num_records);
+  if (num_records == 0)
+    return;
+
+  LogFormat("%u FLARMnet ids found", num_records);
+
+  try {
+    FileOutputStream fos(cache_path);
+    db.SaveImage(fos, path, source_size, source_time);
+    fos.Commit();
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to save FLARMnet cache");
+  }
 } catch (...) {
   LogError(std::current_exception());
 }
@@ -39,6 +39,14 @@ public:
   friend constexpr auto operator<=>(const FlarmId &,
                                     const FlarmId &) noexcept = default;
 
+  /**
+   * Returns a hash of this id for hash tables.  It is the same in all
+   * builds, so it may be used in files.
+   */
+  constexpr uint32_t Hash() const noexcept {
+    return value * 0x9e3779b1U;
+  }
+
   static FlarmId Parse(const char *input, char **endptr_r) noexcept;
 #ifdef _UNICODE
   static FlarmId Parse(const TCHAR *input, TCHAR **endptr_r) noexcept;
@@ -65,6 +65,36 @@ FlatProjection::ProjectInteger(const GeoPoint &tp) const
   return FlatGeoPoint(iround(f.x), iround(f.y));
 }
 
+/**
+ * Round to the nearest integer, away from zero at half-way; this
+ * equals iround() (i.e. lround()), but it is not a library call, and
+ * so it does not prevent vectorization.
+ */
+static constexpr int
+RoundAwayFromZero(double x) noexcept
+{
+  const double t = int(x);
+  const double fraction = x - t;
+  return int(t + (fraction >= 0.5 ? 1. : (fraction <= -0.5 ? -1. : 0.)));
+}
+
+void
+FlatProjection::ProjectInteger(std::span<const GeoPoint> src,
+                               FlatGeoPoint *dest) const noexcept
+{
+  assert(IsValid());
+
+  const std::size_t n = src.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    const GeoPoint &tp = src[i];
+    const double x = (tp.longitude - center.longitude)
+      .AsSmallDelta().Native() * cos;
+    const double y = (tp.latitude - center.latitude)
+      .AsSmallDelta().Native() * fixed_scale;
+    dest[i] = FlatGeoPoint(RoundAwayFromZero(x), RoundAwayFromZero(y));
+  }
+}
+
 GeoPoint
 FlatProjection::Unproject(const FlatGeoPoint &fp) const
 {
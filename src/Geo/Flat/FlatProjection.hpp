@@ -5,6 +5,8 @@
 
 #include "Geo/GeoPoint.hpp"
 
+#include <span>
+
 struct FlatPoint;
 struct FlatGeoPoint;
 struct FlatBoundingBox;
@@ -73,6 +75,16 @@ public:
   [[gnu::pure]]
   FlatGeoPoint ProjectInteger(const GeoPoint &tp) const;
 
+  /**
+   * Batch version of ProjectInteger(const GeoPoint &).  The loop is
+   * branch-free, which allows the compiler to vectorize it; the
+   * results are identical to the scalar version.
+   *
+   * @param dest an array of (at least) src.size() elements
+   */
+  void ProjectInteger(std::span<const GeoPoint> src,
+                      FlatGeoPoint *dest) const noexcept;
+
   /**
    * Projects a GeoBounds to integer 2-d representation bounding box
    *
@@ -7,6 +7,9 @@
 #include "ConvexHull/PolygonInterior.hpp"
 #include "Flat/FlatRay.hpp"
 #include "Flat/FlatBoundingBox.hpp"
+#include "Flat/FlatProjection.hpp"
+
+#include <algorithm>
 
 #include <limits.h> // for UINT_MAX
 
@@ -32,8 +35,23 @@ SearchPointVector::ThinToSize(const unsigned max_size) noexcept
 void
 SearchPointVector::Project(const FlatProjection &tp) noexcept
 {
-  for (auto &i : *this)
-    i.Project(tp);
+  /* gather the locations in small blocks and project each block
+     with the batch kernel */
+  constexpr std::size_t BLOCK = 64;
+  GeoPoint src[BLOCK];
+  FlatGeoPoint dest[BLOCK];
+
+  for (auto i = begin(); i != end();) {
+    const std::size_t n = std::min<std::size_t>(std::distance(i, end()),
+                                                BLOCK);
+    for (std::size_t j = 0; j < n; ++j)
+      src[j] = i[j].GetLocation();
+
+    tp.ProjectInteger({src, n}, dest);
+
+    for (std::size_t j = 0; j < n; ++j, ++i)
+      *i = SearchPoint(src[j], dest[j]);
+  }
 }
 
 [[gnu::pure]]
@@ -5,6 +5,7 @@
 #include "FAISphere.hpp"
 #include "GeoPoint.hpp"
 #include "Math/Util.hpp"
+#include "Math/PolynomialTrig.hpp"
 
 #include <cassert>
 
@@ -67,6 +68,77 @@ DistanceBearingS(const GeoPoint &loc1, const GeoPoint &loc2,
     DistanceBearingS(loc1, loc2, (Angle *)nullptr, bearing);
 }
 
+/**
+ * The loop of the bulk DistanceBearingS(), specialised for the
+ * requested outputs, so it has no branches.
+ */
+template<bool want_distance, bool want_bearing>
+static void
+DistanceBearingS(const GeoPoint &origin,
+                 const double *latitudes, const double *longitudes,
+                 std::size_t n,
+                 double *distances, Angle *bearings) noexcept
+{
+  const double latitude1 = origin.latitude.Radians();
+  const double longitude1 = origin.longitude.Radians();
+  const auto sc1 = origin.latitude.SinCos();
+  const double sin_lat1 = sc1.first, cos_lat1 = sc1.second;
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const double latitude2 = latitudes[i];
+    const double dlon = longitudes[i] - longitude1;
+
+    const auto sc2 = PolynomialSinCos(latitude2);
+    const double sin_lat2 = sc2.first, cos_lat2 = sc2.second;
+
+    if constexpr (want_distance) {
+      /* haversine, see EarthDistance() */
+      const double s1 = PolynomialSinCos((latitude2 - latitude1) / 2).first;
+      const double s2 = PolynomialSinCos(dlon / 2).first;
+      const double a = std::clamp(Square(s1) + cos_lat1 * cos_lat2 * Square(s2),
+                                  0., 1.);
+
+      distances[i] = FAISphere::REARTH * 2 *
+        PolynomialAtan2(std::sqrt(a), std::sqrt(1 - a));
+    }
+
+    if constexpr (want_bearing) {
+      const auto sc = PolynomialSinCos(dlon);
+      const double sin_dlon = sc.first, cos_dlon = sc.second;
+
+      const double y = sin_dlon * cos_lat2;
+      const double x = cos_lat1 * sin_lat2 - sin_lat1 * cos_lat2 * cos_dlon;
+
+      /* normalise to 0..2π, see Angle::AsBearing() */
+      double bearing = PolynomialAtan2(y, x);
+      bearing = bearing < 0 ? bearing + 2 * M_PI : bearing;
+      bearing = bearing >= 2 * M_PI ? bearing - 2 * M_PI : bearing;
+      bearings[i] = Angle::Radians(bearing);
+    }
+  }
+}
+
+void
+DistanceBearingS(const GeoPoint &origin,
+                 std::span<const double> latitudes,
+                 std::span<const double> longitudes,
+                 double *distances, Angle *bearings) noexcept
+{
+  assert(origin.IsValid());
+  assert(latitudes.size() == longitudes.size());
+
+  const std::size_t n = latitudes.size();
+  if (distances != nullptr && bearings != nullptr)
+    DistanceBearingS<true, true>(origin, latitudes.data(), longitudes.data(),
+                                 n, distances, bearings);
+  else if (distances != nullptr)
+    DistanceBearingS<true, false>(origin, latitudes.data(), longitudes.data(),
+                                  n, distances, bearings);
+  else if (bearings != nullptr)
+    DistanceBearingS<false, true>(origin, latitudes.data(), longitudes.data(),
+                                  n, distances, bearings);
+}
+
 GeoPoint
 FindLatitudeLongitudeS(const GeoPoint &loc, const Angle bearing,
                        double distance) noexcept
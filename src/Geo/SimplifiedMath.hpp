@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <span>
+
 struct GeoPoint;
 class Angle;
 
@@ -30,6 +32,32 @@ void
 DistanceBearingS(const GeoPoint &loc1, const GeoPoint &loc2,
                  double *distance, Angle *bearing) noexcept;
 
+/**
+ * Bulk version of DistanceBearingS() for one origin and many
+ * destinations.  The destinations are passed in
+ * structure-of-arrays form, and the implementation uses the
+ * polynomial approximations from Math/PolynomialTrig.hpp, which
+ * allows the compiler to vectorize the loop.
+ *
+ * Compared with DistanceBearingS(), the distance error is below
+ * 0.01 mm for distances above 1 km (below that, the rounding error
+ * of the acos() in DistanceBearingS() dominates, which is up to a few
+ * millimetres).  The bearing error is equivalent to a displacement
+ * of less than 0.1 mm at the destination.
+ *
+ * @param latitudes the destination latitudes [radians]
+ * @param longitudes the destination longitudes [radians]; same size
+ * as #latitudes
+ * @param distances an array for the distances [m] or nullptr
+ * @param bearings an array for the bearings (0 to 360 degrees) or
+ * nullptr
+ */
+void
+DistanceBearingS(const GeoPoint &origin,
+                 std::span<const double> latitudes,
+                 std::span<const double> longitudes,
+                 double *distances, Angle *bearings) noexcept;
+
 /**
  * @see FindLatitudeLongitude()
  */
@@ -3,6 +3,7 @@
 
 #include "InputEvents.hpp"
 #include "util/Macros.hpp"
+#include "util/StringCompare.hxx"
 #include "Language/Language.hpp"
 #include "Message.hpp"
 #include "Interface.hpp"
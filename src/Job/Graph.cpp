@@ -0,0 +1,297 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Graph.hpp"
+#include "Operation/Operation.hpp"
+#include "thread/Thread.hpp"
+#include "LogFile.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <list>
+#include <utility>
+
+/**
+ * The #OperationEnvironment passed to a job function.  It records the
+ * job's progress in the #JobGraph, which merges and forwards it.
+ */
+class JobGraph::Environment final : public NullOperationEnvironment {
+  JobGraph &graph;
+  Job &job;
+
+  /**
+   * If set, updates are forwarded immediately (because the job runs
+   * in the thread which owns this #OperationEnvironment).
+   */
+  OperationEnvironment *const direct;
+
+public:
+  Environment(JobGraph &_graph, Job &_job,
+              OperationEnvironment *_direct) noexcept
+    :graph(_graph), job(_job), direct(_direct) {}
+
+  /* virtual methods from class OperationEnvironment */
+  void SetErrorMessage(const TCHAR *_error) noexcept override {
+    {
+      const std::lock_guard lock{graph.mutex};
+      graph.error = _error;
+      graph.error_modified = true;
+    }
+
+    Flush();
+  }
+
+  void SetText(const TCHAR *_text) noexcept override {
+    {
+      const std::lock_guard lock{graph.mutex};
+      graph.text = _text;
+      graph.text_modified = true;
+    }
+
+    Flush();
+  }
+
+  void SetProgressRange(unsigned range) noexcept override {
+    {
+      const std::lock_guard lock{graph.mutex};
+      job.progress_range = range;
+      job.progress_position = 0;
+      graph.progress_modified = true;
+    }
+
+    Flush();
+  }
+
+  void SetProgressPosition(unsigned position) noexcept override {
+    {
+      const std::lock_guard lock{graph.mutex};
+      job.progress_position = position;
+      graph.progress_modified = true;
+    }
+
+    Flush();
+  }
+
+private:
+  void Flush() noexcept {
+    if (direct != nullptr)
+      graph.Forward(*direct);
+  }
+};
+
+class JobGraph::Worker final : public Thread {
+  JobGraph &graph;
+
+public:
+  explicit Worker(JobGraph &_graph) noexcept
+    :Thread("JobGraph"), graph(_graph) {}
+
+protected:
+  void Run() noexcept override {
+    graph.RunJobs();
+  }
+};
+
+std::size_t
+JobGraph::Add(const char *name, unsigned weight, Function function,
+              std::initializer_list<std::size_t> dependencies)
+{
+  /* a job may only depend on jobs added before it, which rules out
+     cycles, and makes the insertion order a valid sequential order */
+  assert(std::all_of(dependencies.begin(), dependencies.end(),
+                     [this](std::size_t i){ return i < jobs.size(); }));
+
+  jobs.push_back({name, std::move(function), dependencies, weight});
+  return jobs.size() - 1;
+}
+
+std::size_t
+JobGraph::StartNextJob() noexcept
+{
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    Job &job = jobs[i];
+    if (job.started)
+      continue;
+
+    if (std::all_of(job.dependencies.begin(), job.dependencies.end(),
+                    [this](std::size_t d){ return jobs[d].finished; })) {
+      job.started = true;
+      return i;
+    }
+  }
+
+  return jobs.size();
+}
+
+void
+JobGraph::RunJob(std::size_t i, OperationEnvironment *direct) noexcept
+{
+  Job &job = jobs[i];
+  Environment env(*this, job, direct);
+
+  const auto start_time = Clock::now();
+
+  try {
+    job.function(env);
+  } catch (...) {
+    LogError(std::current_exception(), job.name);
+  }
+
+  const auto end_time = Clock::now();
+
+  {
+    const std::lock_guard lock{mutex};
+    job.start_time = start_time;
+    job.end_time = end_time;
+    job.finished = true;
+    ++n_finished;
+    progress_modified = true;
+  }
+
+  cond.notify_all();
+}
+
+void
+JobGraph::RunJobs() noexcept
+{
+  while (true) {
+    std::size_t i;
+
+    {
+      std::unique_lock lock{mutex};
+      while ((i = StartNextJob()) == jobs.size()) {
+        if (std::all_of(jobs.begin(), jobs.end(),
+                        [](const Job &job){ return job.started; }))
+          return;
+
+        cond.wait(lock);
+      }
+    }
+
+    RunJob(i, nullptr);
+  }
+}
+
+void
+JobGraph::Forward(OperationEnvironment &env) noexcept
+{
+  StaticString<256> new_error;
+  StaticString<128> new_text;
+  bool update_error, update_text, update_progress;
+  unsigned position = 0;
+
+  {
+    const std::lock_guard lock{mutex};
+
+    update_error = std::exchange(error_modified, false);
+    if (update_error)
+      new_error = error;
+
+    update_text = std::exchange(text_modified, false);
+    if (update_text)
+      new_text = text;
+
+    update_progress = std::exchange(progress_modified, false);
+    for (const auto &job : jobs) {
+      if (job.finished)
+        position += job.weight;
+      else if (job.progress_range > 0)
+        position += uint64_t(job.weight) *
+          std::min(job.progress_position, job.progress_range) /
+          job.progress_range;
+    }
+  }
+
+  if (update_error)
+    env.SetErrorMessage(new_error);
+
+  if (update_text)
+    env.SetText(new_text);
+
+  if (update_progress)
+    env.SetProgressPosition(position);
+}
+
+void
+JobGraph::LogTimes(Clock::time_point start_time) const noexcept
+{
+  using std::chrono::duration_cast, std::chrono::milliseconds;
+
+  Clock::duration sum{};
+  Clock::time_point end_time = start_time;
+
+  for (const auto &job : jobs) {
+    LogFormat("Job %s: %u ms (started after %u ms)", job.name,
+              (unsigned)duration_cast<milliseconds>(job.end_time - job.start_time).count(),
+              (unsigned)duration_cast<milliseconds>(job.start_time - start_time).count());
+
+    sum += job.end_time - job.start_time;
+    end_time = std::max(end_time, job.end_time);
+  }
+
+  LogFormat("%u jobs finished in %u ms (%u ms sequentially)",
+            (unsigned)jobs.size(),
+            (unsigned)duration_cast<milliseconds>(end_time - start_time).count(),
+            (unsigned)duration_cast<milliseconds>(sum).count());
+}
+
+void
+JobGraph::Run(OperationEnvironment &env, unsigned n_threads)
+{
+  unsigned total_weight = 0;
+  for (const auto &job : jobs)
+    total_weight += job.weight;
+
+  env.SetProgressRange(total_weight);
+  env.SetProgressPosition(0);
+
+  const auto start_time = Clock::now();
+
+  std::list<Worker> workers;
+  if (n_threads > 1) {
+    for (unsigned i = 0; i < std::min<std::size_t>(n_threads, jobs.size()); ++i) {
+      auto &worker = workers.emplace_back(*this);
+      try {
+        worker.Start();
+      } catch (...) {
+        LogError(std::current_exception(), "Failed to start job thread");
+        workers.pop_back();
+        break;
+      }
+    }
+  }
+
+  if (workers.empty()) {
+    /* run all jobs in this thread, in the order they were added */
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+      {
+        const std::lock_guard lock{mutex};
+        jobs[i].started = true;
+      }
+
+      RunJob(i, &env);
+      Forward(env);
+    }
+  } else {
+    /* this thread only forwards the merged progress (the
+       #OperationEnvironment must not be used by other threads) */
+    std::unique_lock lock{mutex};
+    while (n_finished < jobs.size()) {
+      cond.wait_for(lock, std::chrono::milliseconds(100));
+
+      lock.unlock();
+      Forward(env);
+      lock.lock();
+    }
+
+    lock.unlock();
+
+    for (auto &worker : workers)
+      worker.Join();
+
+    Forward(env);
+  }
+
+  LogTimes(start_time);
+}
@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "util/StaticString.hxx"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+#include <tchar.h>
+
+class OperationEnvironment;
+
+/**
+ * A set of jobs with dependencies between them.  Run() executes them
+ * on a pool of worker threads; a job is started only after all jobs
+ * it depends on have finished, and independent jobs run
+ * concurrently.
+ *
+ * The progress of all jobs is merged into one progress bar (each
+ * job's share is specified by its weight), and the duration of each
+ * job is written to the log.
+ */
+class JobGraph {
+public:
+  /**
+   * The function of a job.  The #OperationEnvironment must be used
+   * only for progress reporting; it may be called from any thread.
+   * Exceptions are caught and logged.
+   */
+  using Function = std::function<void(OperationEnvironment &env)>;
+
+private:
+  class Environment;
+  class Worker;
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Job {
+    const char *name;
+    Function function;
+    std::vector<std::size_t> dependencies;
+
+    /**
+     * The share of this job in the merged progress.
+     */
+    unsigned weight;
+
+    unsigned progress_range = 0, progress_position = 0;
+
+    Clock::time_point start_time, end_time;
+
+    bool started = false, finished = false;
+  };
+
+  std::vector<Job> jobs;
+
+  /**
+   * Protects all attributes below and the progress attributes and
+   * flags of all jobs while Run() executes.
+   */
+  Mutex mutex;
+
+  /**
+   * Signalled when a job has finished, or when the progress has been
+   * updated.
+   */
+  Cond cond;
+
+  StaticString<128> text;
+  StaticString<256> error;
+
+  /**
+   * Set when #text or #error has been modified and not yet
+   * forwarded.
+   */
+  bool text_modified = false, error_modified = false;
+
+  /**
+   * Set when any job's progress has been modified and not yet
+   * forwarded.
+   */
+  bool progress_modified = false;
+
+  std::size_t n_finished = 0;
+
+public:
+  /**
+   * Add a job.
+   *
+   * @param name a name for the log
+   * @param weight the share of this job in the merged progress
+   * @param dependencies the indices (returned by earlier Add() calls)
+   * of jobs which must have finished before this one starts
+   * @return the index of the new job
+   */
+  std::size_t Add(const char *name, unsigned weight, Function function,
+                  std::initializer_list<std::size_t> dependencies={});
+
+  /**
+   * Run all jobs and wait until they have finished.  Must be called
+   * only once.
+   *
+   * @param env receives the merged progress; it is only used by the
+   * calling thread
+   * @param n_threads the maximum number of worker threads; 0 or 1
+   * runs all jobs in the calling thread, in the order they were
+   * added
+   */
+  void Run(OperationEnvironment &env, unsigned n_threads);
+
+private:
+  /**
+   * Find a job which can be started now, and mark it as started.
+   * Caller must lock the mutex.
+   *
+   * @return the index of the job or jobs.size() if there is none
+   */
+  std::size_t StartNextJob() noexcept;
+
+  /**
+   * Execute the specified job (which has been marked as started).
+   * Must be called without holding the mutex.
+   *
+   * @param direct if not nullptr, then the job's progress is
+   * forwarded to this #OperationEnvironment immediately (only allowed
+   * in the thread which owns it)
+   */
+  void RunJob(std::size_t i, OperationEnvironment *direct) noexcept;
+
+  /**
+   * Execute jobs until all have been started.
+   */
+  void RunJobs() noexcept;
+
+  /**
+   * Pass the merged progress to the #OperationEnvironment.  Caller
+   * must not lock the mutex.
+   */
+  void Forward(OperationEnvironment &env) noexcept;
+
+  void LogTimes(Clock::time_point start_time) const noexcept;
+};
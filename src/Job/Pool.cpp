@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Pool.hpp"
+#include "thread/Thread.hpp"
+#include "LogFile.hpp"
+
+#include <cassert>
+
+class JobPool::Worker final : public Thread {
+  JobPool &pool;
+
+public:
+  Worker(JobPool &_pool, const char *_name) noexcept
+    :Thread(_name), pool(_pool) {}
+
+protected:
+  void Run() noexcept override {
+    pool.WorkerRun();
+  }
+};
+
+JobPool::JobPool(const char *_name, unsigned _n_threads) noexcept
+  :name(_name), n_threads(_n_threads) {}
+
+JobPool::~JobPool() noexcept
+{
+  {
+    const std::lock_guard lock{mutex};
+    quit = true;
+  }
+
+  submit_cond.notify_all();
+
+  for (auto &worker : workers)
+    worker.Join();
+}
+
+void
+JobPool::Start() noexcept
+{
+  started = true;
+
+  for (unsigned i = 0; i < n_threads; ++i) {
+    auto &worker = workers.emplace_back(*this, name);
+    try {
+      worker.Start();
+    } catch (...) {
+      LogError(std::current_exception(), "Failed to start job thread");
+      workers.pop_back();
+      break;
+    }
+  }
+}
+
+void
+JobPool::RunJobs(std::unique_lock<Mutex> &lock) noexcept
+{
+  while (next < batch.size()) {
+    const Function &function = batch[next++];
+
+    lock.unlock();
+
+    try {
+      function();
+    } catch (...) {
+      LogError(std::current_exception(), name);
+    }
+
+    lock.lock();
+
+    if (++n_finished == batch.size())
+      finish_cond.notify_one();
+  }
+}
+
+void
+JobPool::WorkerRun() noexcept
+{
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    submit_cond.wait(lock, [this]{ return quit || next < batch.size(); });
+    if (quit)
+      return;
+
+    RunJobs(lock);
+  }
+}
+
+void
+JobPool::Run(std::span<const Function> functions) noexcept
+{
+  if (functions.empty())
+    return;
+
+  if (!started)
+    Start();
+
+  std::unique_lock lock{mutex};
+  assert(n_finished == batch.size());
+
+  batch = functions;
+  next = 0;
+  n_finished = 0;
+
+  if (!workers.empty() && functions.size() > 1)
+    submit_cond.notify_all();
+
+  RunJobs(lock);
+
+  finish_cond.wait(lock, [this]{ return n_finished == batch.size(); });
+  batch = {};
+  next = n_finished = 0;
+}
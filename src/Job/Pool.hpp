@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <span>
+
+/**
+ * A fixed set of worker threads which execute batches of independent
+ * functions.  Run() distributes the functions of one batch to the
+ * workers and the calling thread, and returns when all of them have
+ * finished.
+ *
+ * Unlike #JobGraph, the threads are kept alive between batches, so
+ * this is cheap enough to be used for every frame.  The threads are
+ * started lazily by the first Run() call.
+ */
+class JobPool {
+public:
+  /**
+   * The function of a job.  Exceptions are caught and logged.
+   */
+  using Function = std::function<void()>;
+
+private:
+  class Worker;
+
+  const char *const name;
+
+  /**
+   * The number of worker threads to be started (not counting the
+   * thread calling Run()).
+   */
+  const unsigned n_threads;
+
+  std::list<Worker> workers;
+
+  /**
+   * Protects all attributes below.
+   */
+  Mutex mutex;
+
+  /**
+   * Signalled when a batch has been submitted, or when the workers
+   * shall quit.
+   */
+  Cond submit_cond;
+
+  /**
+   * Signalled when the last job of the batch has finished.
+   */
+  Cond finish_cond;
+
+  std::span<const Function> batch;
+
+  /**
+   * The index of the next job of #batch to be started.
+   */
+  std::size_t next = 0;
+
+  std::size_t n_finished = 0;
+
+  bool quit = false;
+
+  bool started = false;
+
+public:
+  /**
+   * @param name the name of the worker threads
+   * @param n_threads the number of worker threads; 0 runs all jobs
+   * in the thread calling Run()
+   */
+  JobPool(const char *_name, unsigned _n_threads) noexcept;
+
+  ~JobPool() noexcept;
+
+  JobPool(const JobPool &) = delete;
+  JobPool &operator=(const JobPool &) = delete;
+
+  /**
+   * Run all functions and wait until they have finished.  The calling
+   * thread executes jobs, too.  With no worker threads, the functions
+   * run in order.
+   *
+   * This must not be called concurrently, and not from within a job.
+   */
+  void Run(std::span<const Function> functions) noexcept;
+
+private:
+  void Start() noexcept;
+
+  /**
+   * Execute jobs of the current batch until all have been started.
+   * Caller must lock the mutex.
+   */
+  void RunJobs(std::unique_lock<Mutex> &lock) noexcept;
+
+  /**
+   * The main loop of a worker thread.
+   */
+  void WorkerRun() noexcept;
+};
@@ -73,10 +73,11 @@ MapItemListBuilder::AddSelfIfNear(const GeoPoint &self, Angle bearing)
 void
 MapItemListBuilder::AddWaypoints(const Waypoints &waypoints)
 {
-  waypoints.VisitWithinRange(location, range, [&list=list](const auto &w){
-    if (!list.full())
-      list.append(new WaypointMapItem(w));
-  });
+  /* if there are too many, show the nearest ones */
+  waypoints.VisitNearest(location, range, list.max_size() - list.size(),
+                         [&list=list](const auto &w){
+                           list.append(new WaypointMapItem(w));
+                         });
 }
 
 void
@@ -42,8 +42,9 @@ void
 MapCanvas::Project(const Projection &projection,
                    const SearchPointVector &points, BulkPixelPoint *screen) noexcept
 {
-  for (const auto i : points)
-    *screen++ = projection.GeoToScreen(i.GetLocation());
+  projection.GeoToScreen(points, [](const SearchPoint &i){
+    return i.GetLocation();
+  }, screen);
 }
 
 bool
@@ -67,8 +68,8 @@ MapCanvas::PreparePolygon(const SearchPointVector &points) noexcept
 
   /* project all GeoPoints to screen coordinates */
   raster_points.GrowDiscard(num_raster_points);
-  for (unsigned i = 0; i < num_raster_points; ++i)
-    raster_points[i] = projection.GeoToScreen(geo_points[i]);
+  projection.GeoToScreen({geo_points.data(), num_raster_points},
+                         raster_points.data());
 
   return true;
 }
@@ -14,6 +14,20 @@
 #include "ui/canvas/opengl/Scissor.hpp"
 #endif
 
+#include <algorithm>
+#include <thread>
+
+/**
+ * The number of #JobPool threads for MapWindow::PrepareLayers().
+ * There are only three jobs, and the DrawThread runs one of them.
+ */
+static unsigned
+GetPrepareThreadCount() noexcept
+{
+  const unsigned n = std::thread::hardware_concurrency();
+  return n > 1 ? std::min(n - 1, 2u) : 0;
+}
+
 /**
  * Constructor of the MapWindow class
  */
@@ -24,7 +38,8 @@ MapWindow::MapWindow(const MapLook &_look,
    waypoint_renderer(nullptr, look.waypoint),
    airspace_renderer(look.airspace),
    airspace_label_renderer(look.airspace),
-   trail_renderer(look.trail) {}
+   trail_renderer(look.trail),
+   prepare_pool("MapPrepare", GetPrepareThreadCount()) {}
 
 MapWindow::~MapWindow() noexcept
 {
@@ -16,6 +16,7 @@
 #include "Renderer/BackgroundRenderer.hpp"
 #include "Renderer/WaypointRenderer.hpp"
 #include "Renderer/TrailRenderer.hpp"
+#include "Job/Pool.hpp"
 #include "Weather/Features.hpp"
 #include "Tracking/SkyLines/Features.hpp"
 
@@ -126,6 +127,11 @@ protected:
 
   TrailRenderer trail_renderer;
 
+  /**
+   * Runs the PrepareLayers() jobs.
+   */
+  JobPool prepare_pool;
+
   ProtectedTaskManager *task = nullptr;
   const ProtectedRoutePlanner *route_planner = nullptr;
   GlideComputer *glide_computer = nullptr;
@@ -332,6 +338,13 @@ protected:
   void OnPaintBuffer(Canvas& canvas) noexcept override;
 
 private:
+  /**
+   * Collect the waypoints, airspace labels and topography label
+   * positions for #render_projection in parallel, before the
+   * (single-threaded) drawing starts.
+   */
+  void PrepareLayers() noexcept;
+
   /**
    * Renders the terrain background
    * @param canvas The drawing canvas
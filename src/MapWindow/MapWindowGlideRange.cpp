@@ -107,13 +107,20 @@ struct ProjectedFans {
     return fans.back();
   }
 
-  void Append(const PixelPoint &pt) noexcept {
+  /**
+   * Project the points of the fan which was started by
+   * Append(unsigned).
+   */
+  void Append(const Projection &projection,
+              std::span<const GeoPoint> src) noexcept {
 #ifndef NDEBUG
-    assert(remaining > 0);
-    --remaining;
+    assert(remaining == src.size());
+    remaining = 0;
 #endif
 
-    points.push_back(pt);
+    const std::size_t offset = points.size();
+    points.resize(offset + src.size());
+    projection.GeoToScreen(src, points.data() + offset);
   }
 
   void DrawFill([[maybe_unused]] Canvas &canvas) const noexcept {
@@ -200,8 +207,7 @@ public:
     fans.Append(size);
 
     // Convert GeoPoints to PixelPoints
-    for (unsigned i = 0; i < size; ++i)
-      fans.Append(proj.GeoToScreen(clipped[i]));
+    fans.Append(proj, {clipped, size});
   }
 };
 
@@ -58,6 +58,7 @@ MapWindow::RenderRasp(Canvas &canvas) noexcept
   }
 
   rasp_renderer->SetTime(state.time);
+  rasp_renderer->SetInterpolate(state.interpolate);
 
   {
     QuietOperationEnvironment operation;
@@ -113,11 +114,7 @@ MapWindow::RenderAirspace(Canvas &canvas) noexcept
                            GetComputerSettings().airspace,
                            GetMapSettings().airspace);
 
-    airspace_label_renderer.Draw(canvas,
-                                 render_projection,
-                                 Basic(), Calculated(),
-                                 GetComputerSettings().airspace,
-                                 GetMapSettings().airspace);
+    airspace_label_renderer.Draw(canvas, render_projection);
   }
 }
 
@@ -158,6 +155,41 @@ MapWindow::RenderGlide(Canvas &canvas) noexcept
     DrawGlideThroughTerrain(canvas);
 }
 
+void
+MapWindow::PrepareLayers() noexcept
+{
+  /* the blackboard may only be accessed by the DrawThread, so obtain
+     all references here and pass them to the jobs */
+  const MapSettings &settings = GetMapSettings();
+  const ComputerSettings &computer_settings = GetComputerSettings();
+  const MoreData &basic = Basic();
+  const DerivedInfo &calculated = Calculated();
+
+  JobPool::Function jobs[3];
+  std::size_t n_jobs = 0;
+
+  jobs[n_jobs++] = [&]{
+    waypoint_renderer.Prepare(render_projection, settings.waypoint,
+                              computer_settings.polar,
+                              computer_settings.task,
+                              basic, calculated, task, route_planner);
+  };
+
+  if (settings.airspace.enable)
+    jobs[n_jobs++] = [&]{
+      airspace_label_renderer.Prepare(render_projection, basic, calculated,
+                                      computer_settings.airspace,
+                                      settings.airspace);
+    };
+
+  if (topography_renderer != nullptr && settings.topography_enabled)
+    jobs[n_jobs++] = [this]{
+      topography_renderer->Prepare(render_projection);
+    };
+
+  prepare_pool.Run({jobs, n_jobs});
+}
+
 void
 MapWindow::Render(Canvas &canvas, const PixelRect &rc) noexcept
 {
@@ -173,6 +205,9 @@ MapWindow::Render(Canvas &canvas, const PixelRect &rc) noexcept
     return;
   }
 
+  draw_sw.Mark("PrepareLayers");
+  PrepareLayers();
+
   // Calculate screen position of the aircraft
   PixelPoint aircraft_pos{0,0};
   if (basic.location_available)
@@ -71,10 +71,9 @@ MapWindow::DrawRoute(Canvas &canvas) noexcept
   const auto r_size = route.size();
   constexpr std::size_t capacity = std::decay_t<decltype(route)>::capacity();
   BulkPixelPoint p[capacity];
-  std::transform(route.begin(), route.end(), p,
-                 [this](const auto &i) {
-                   return render_projection.GeoToScreen(i);
-                 });
+  render_projection.GeoToScreen(route, [](const AGeoPoint &i) -> GeoPoint {
+    return i;
+  }, p);
 
   p[r_size - 1] = ScreenClosestPoint(p[r_size-1], p[r_size-2], p[r_size-1], Layout::Scale(20));
 
@@ -6,10 +6,5 @@
 void
 MapWindow::DrawWaypoints(Canvas &canvas) noexcept
 {
-  waypoint_renderer.Render(canvas, label_block,
-                           render_projection, GetMapSettings().waypoint,
-                           GetComputerSettings().polar,
-                           GetComputerSettings().task,
-                           Basic(), Calculated(),
-                           task, route_planner);
+  waypoint_renderer.Render(canvas, label_block, render_projection);
 }
@@ -251,6 +251,21 @@ public:
   [[gnu::pure]]
   Angle AsDelta() const noexcept;
 
+  /**
+   * Like AsDelta(), but without a loop; this is only valid if the
+   * angle is between -540 and +540 degrees, e.g. the difference of
+   * two normalized angles.  It is cheap enough to be used in
+   * (vectorized) batch loops.
+   */
+  constexpr
+  Angle AsSmallDelta() const noexcept {
+    return Angle(value + (value <= -HalfCircle().value
+                          ? FullCircle().value
+                          : (value > HalfCircle().value
+                             ? -FullCircle().value
+                             : 0.)));
+  }
+
   /**
    * Limits the angle (theta) to 0 - 360 degrees
    * @return Output angle (0-360 degrees)
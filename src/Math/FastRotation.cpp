@@ -2,3 +2,25 @@
 // Copyright The XCSoar Project
 
 #include "Math/FastRotation.hpp"
+
+#include <cassert>
+
+void
+FastIntegerRotation::Rotate(std::span<int> x,
+                            std::span<int> y) const noexcept
+{
+  assert(x.size() == y.size());
+
+  /* copy the attributes to local variables, because the compiler
+     cannot know that they do not alias the arrays */
+  const int c = cost, s = sint;
+  int *const xp = x.data(), *const yp = y.data();
+  const std::size_t n = x.size();
+
+  for (std::size_t i = 0; i < n; ++i) {
+    const int rx = xp[i] * c - yp[i] * s;
+    const int ry = yp[i] * c + xp[i] * s;
+    xp[i] = (rx + HALF) >> SHIFT;
+    yp[i] = (ry + HALF) >> SHIFT;
+  }
+}
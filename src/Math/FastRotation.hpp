@@ -6,6 +6,8 @@
 #include "Math/Angle.hpp"
 #include "Point2D.hpp"
 
+#include <span>
+
 /**
  * Rotate coordinates around the zero origin.
  */
@@ -96,6 +98,13 @@ public:
   constexpr P Rotate(P p) const noexcept {
     return Rotate(Point{p});
   }
+
+  /**
+   * Rotates many points in-place.  The coordinates are passed in two
+   * separate arrays of the same size, which allows the compiler to
+   * vectorize the loop.
+   */
+  void Rotate(std::span<int> x, std::span<int> y) const noexcept;
 };
 
 /**
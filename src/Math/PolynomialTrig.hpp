@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*! @file
+ * @brief Polynomial approximations of trigonometric functions
+ *
+ * Unlike the libm functions, these are inline and branch-free (all
+ * conditions are selects), which allows the compiler to vectorize
+ * loops calling them.  Unlike the table lookups in FastTrig.hpp, they
+ * are nearly as accurate as libm; the error bounds are documented
+ * for each function and verified by test/src/TestPolynomialTrig.cpp.
+ */
+
+#pragma once
+
+#include "Constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/**
+ * Calculate the sine and cosine of an angle [radians].
+ *
+ * The argument is reduced to [-π/4, π/4] by subtracting the nearest
+ * multiple of π/2, and then the Taylor polynomials of degree 13
+ * (sine) and 14 (cosine) are evaluated.  The truncation error is
+ * below 3e-14; the reduction adds a rounding error of about
+ * |x|*1e-16, i.e. the absolute error is below 5e-14 for |x| < 4π.
+ *
+ * @return a pair of sine and cosine
+ */
+[[gnu::const]]
+static inline std::pair<double, double>
+PolynomialSinCos(double x) noexcept
+{
+  /* the int casts truncate; unlike std::trunc() and std::floor(),
+     they can be vectorized without SSE4.1 */
+  const double quadrant = int(x * (2 / M_PI) + (x >= 0 ? 0.5 : -0.5));
+  const double r = x - quadrant * (M_PI / 2);
+  const double r2 = r * r;
+
+  const double s = r + r * r2 *
+    (-1. / 6 + r2 *
+     (1. / 120 + r2 *
+      (-1. / 5040 + r2 *
+       (1. / 362880 + r2 *
+        (-1. / 39916800 + r2 *
+         (1. / 6227020800))))));
+
+  const double c = 1 + r2 *
+    (-1. / 2 + r2 *
+     (1. / 24 + r2 *
+      (-1. / 720 + r2 *
+       (1. / 40320 + r2 *
+        (-1. / 3628800 + r2 *
+         (1. / 479001600 + r2 *
+          (-1. / 87178291200.)))))));
+
+  /* the quadrant modulo 4 (0..3), as a double to keep all lanes
+     the same width */
+  const double q0 = quadrant - 4 * double(int(quadrant * 0.25));
+  const double q = q0 < 0 ? q0 + 4 : q0;
+  const bool odd = q == 1 || q == 3;
+  const bool negate_sin = q >= 2;
+  const bool negate_cos = q == 1 || q == 2;
+
+  const double sin_x = odd ? c : s, cos_x = odd ? s : c;
+  return {negate_sin ? -sin_x : sin_x, negate_cos ? -cos_x : cos_x};
+}
+
+/**
+ * Calculate atan2(y, x) [radians].
+ *
+ * The ratio of the smaller and the larger magnitude is reduced to
+ * [-tan(π/8), tan(π/8)], and the Taylor series of atan() is
+ * evaluated up to the term of degree 27.  The series is
+ * alternating, so the truncation error is below the first omitted
+ * term, tan(π/8)^29/29 < 3e-13.
+ *
+ * Returns 0 if both parameters are zero.
+ */
+[[gnu::const]]
+static inline double
+PolynomialAtan2(double y, double x) noexcept
+{
+  constexpr double TAN_PI_8 = 0.41421356237309503;
+
+  const double ax = std::fabs(x), ay = std::fabs(y);
+  const double max = std::max(ax, ay), min = std::min(ax, ay);
+  const double t = max > 0 ? min / max : 0.;
+
+  const bool reduce = t > TAN_PI_8;
+  const double u = reduce ? (t - 1) / (t + 1) : t;
+  const double u2 = u * u;
+
+  const double atan_u = u + u * u2 *
+    (-1. / 3 + u2 *
+     (1. / 5 + u2 *
+      (-1. / 7 + u2 *
+       (1. / 9 + u2 *
+        (-1. / 11 + u2 *
+         (1. / 13 + u2 *
+          (-1. / 15 + u2 *
+           (1. / 17 + u2 *
+            (-1. / 19 + u2 *
+             (1. / 21 + u2 *
+              (-1. / 23 + u2 *
+               (1. / 25 + u2 *
+                (-1. / 27)))))))))))));
+
+  double a = (reduce ? M_PI / 4 : 0.) + atan_u;
+  a = ay > ax ? M_PI / 2 - a : a;
+  a = x < 0 ? M_PI - a : a;
+  return y < 0 ? -a : a;
+}
@@ -2,10 +2,19 @@
 // Copyright The XCSoar Project
 
 #include "Settings.hpp"
+#include "Profile.hpp"
+#include "Snapshot.hpp"
 #include "SystemProfile.hpp"
 #include "ComputerProfile.hpp"
 #include "UIProfile.hpp"
 #include "Interface.hpp"
+#include "LocalPath.hpp"
+#include "LogFile.hpp"
+#include "Version.hpp"
+#include "time/Zone.hxx"
+#include "system/FileUtil.hpp"
+#include "system/Path.hpp"
+#include "io/FileOutputStream.hxx"
 
 void
 Profile::Use(const ProfileMap &map)
@@ -14,3 +23,61 @@ Profile::Use(const ProfileMap &map)
   Load(map, CommonInterface::SetComputerSettings());
   Load(map, CommonInterface::SetUISettings());
 }
+
+/**
+ * Returns the path of the settings snapshot of the current profile
+ * (see Profile::SaveSnapshot()).
+ */
+static AllocatedPath
+GetSnapshotPath() noexcept
+{
+  const Path profile_path = Profile::GetPath();
+  if (profile_path == nullptr)
+    return nullptr;
+
+  const Path base = profile_path.GetBase();
+  if (base == nullptr)
+    return nullptr;
+
+  return AllocatedPath::Build(MakeCacheDirectory(_T("profile")), base) +
+    _T(".bin");
+}
+
+bool
+Profile::UseSnapshot(const ProfileMap &map) noexcept
+{
+  const auto path = GetSnapshotPath();
+  if (path == nullptr) {
+    Use(map);
+    return false;
+  }
+
+  const uint64_t key = GetSnapshotKey(map, XCSoar_ProductToken,
+                                      GetTimeZoneOffset());
+
+  try {
+    if (File::Exists(path) &&
+        LoadSnapshot(path, key,
+                     CommonInterface::SetSystemSettings(),
+                     CommonInterface::SetComputerSettings(),
+                     CommonInterface::SetUISettings()))
+      return true;
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to load profile snapshot");
+  }
+
+  Use(map);
+
+  try {
+    FileOutputStream fos(path);
+    SaveSnapshot(fos, key,
+                 CommonInterface::GetSystemSettings(),
+                 CommonInterface::GetComputerSettings(),
+                 CommonInterface::GetUISettings());
+    fos.Commit();
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to save profile snapshot");
+  }
+
+  return false;
+}
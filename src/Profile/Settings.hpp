@@ -11,4 +11,14 @@ namespace Profile
    * Adjusts the application settings according to the profile settings
    */
   void Use(const ProfileMap &map);
+
+  /**
+   * Like Use(), but takes the decoded settings from the binary
+   * snapshot in the cache directory if it was created from the same
+   * profile contents.  Otherwise, Use() is called and a new snapshot
+   * is written.
+   *
+   * @return true if the snapshot was used
+   */
+  bool UseSnapshot(const ProfileMap &map) noexcept;
 };
@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Snapshot.hpp"
+#include "Map.hpp"
+#include "SystemSettings.hpp"
+#include "Computer/Settings.hpp"
+#include "UISettings.hpp"
+#include "io/FileReader.hxx"
+#include "io/OutputStream.hxx"
+#include "system/Path.hpp"
+#include "util/SpanCast.hxx"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<SystemSettings>,
+              "SystemSettings must be trivially copyable for the snapshot");
+static_assert(std::is_trivially_copyable_v<ComputerSettings>,
+              "ComputerSettings must be trivially copyable for the snapshot");
+static_assert(std::is_trivially_copyable_v<UISettings>,
+              "UISettings must be trivially copyable for the snapshot");
+
+/**
+ * The header of a snapshot file written by Profile::SaveSnapshot().
+ * It is followed by the three settings structs.  All values are in
+ * host byte order; the file is a cache which is only ever read by
+ * the build which wrote it.
+ */
+struct ProfileSnapshotHeader {
+  static constexpr uint32_t MAGIC = 0x50524653; // "PRFS"
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic, version;
+
+  uint32_t system_size, computer_size, ui_size;
+  uint32_t reserved;
+
+  uint64_t key;
+};
+
+static_assert(sizeof(ProfileSnapshotHeader) == 32);
+
+static constexpr std::size_t SNAPSHOT_SIZE =
+  sizeof(ProfileSnapshotHeader) +
+  sizeof(SystemSettings) + sizeof(ComputerSettings) + sizeof(UISettings);
+
+/**
+ * Bump this whenever a field of one of the settings structs (or of
+ * the structs they contain) is added, removed or changes its
+ * meaning.  The layout hashed by GetSnapshotKey() only detects
+ * changes which move the top-level members.
+ */
+static constexpr uint32_t SNAPSHOT_SCHEMA_VERSION = 1;
+
+#define SNAPSHOT_MEMBER(s, m) offsetof(s, m), sizeof(s::m)
+
+/**
+ * The sizes and member offsets of the settings structs.
+ */
+static constexpr std::size_t snapshot_layout[] = {
+  sizeof(SystemSettings),
+  SNAPSHOT_MEMBER(SystemSettings, devices),
+
+  sizeof(ComputerSettings),
+  SNAPSHOT_MEMBER(ComputerSettings, wind),
+  SNAPSHOT_MEMBER(ComputerSettings, polar),
+  SNAPSHOT_MEMBER(ComputerSettings, team_code),
+  SNAPSHOT_MEMBER(ComputerSettings, poi),
+  SNAPSHOT_MEMBER(ComputerSettings, features),
+  SNAPSHOT_MEMBER(ComputerSettings, circling),
+  SNAPSHOT_MEMBER(ComputerSettings, wave),
+  SNAPSHOT_MEMBER(ComputerSettings, average_eff_time),
+  SNAPSHOT_MEMBER(ComputerSettings, set_system_time_from_gps),
+  SNAPSHOT_MEMBER(ComputerSettings, utc_offset),
+  SNAPSHOT_MEMBER(ComputerSettings, forecast_temperature),
+  SNAPSHOT_MEMBER(ComputerSettings, pressure),
+  SNAPSHOT_MEMBER(ComputerSettings, pressure_available),
+  SNAPSHOT_MEMBER(ComputerSettings, airspace),
+  SNAPSHOT_MEMBER(ComputerSettings, plane),
+  SNAPSHOT_MEMBER(ComputerSettings, task),
+  SNAPSHOT_MEMBER(ComputerSettings, contest),
+  SNAPSHOT_MEMBER(ComputerSettings, logger),
+  SNAPSHOT_MEMBER(ComputerSettings, weglide),
+#ifdef HAVE_TRACKING
+  SNAPSHOT_MEMBER(ComputerSettings, tracking),
+#endif
+  SNAPSHOT_MEMBER(ComputerSettings, weather),
+  SNAPSHOT_MEMBER(ComputerSettings, radio),
+  SNAPSHOT_MEMBER(ComputerSettings, transponder),
+
+  sizeof(UISettings),
+  SNAPSHOT_MEMBER(UISettings, display),
+  SNAPSHOT_MEMBER(UISettings, menu_timeout),
+  SNAPSHOT_MEMBER(UISettings, scale),
+  SNAPSHOT_MEMBER(UISettings, custom_dpi),
+  SNAPSHOT_MEMBER(UISettings, thermal_assistant_position),
+  SNAPSHOT_MEMBER(UISettings, enable_airspace_warning_dialog),
+  SNAPSHOT_MEMBER(UISettings, show_menu_button),
+  SNAPSHOT_MEMBER(UISettings, show_zoom_button),
+  SNAPSHOT_MEMBER(UISettings, popup_message_position),
+  SNAPSHOT_MEMBER(UISettings, haptic_feedback),
+  SNAPSHOT_MEMBER(UISettings, dark_mode),
+  SNAPSHOT_MEMBER(UISettings, format),
+  SNAPSHOT_MEMBER(UISettings, map),
+  SNAPSHOT_MEMBER(UISettings, info_boxes),
+  SNAPSHOT_MEMBER(UISettings, vario),
+  SNAPSHOT_MEMBER(UISettings, traffic),
+  SNAPSHOT_MEMBER(UISettings, pages),
+  SNAPSHOT_MEMBER(UISettings, dialog),
+  SNAPSHOT_MEMBER(UISettings, sound),
+};
+
+#undef SNAPSHOT_MEMBER
+
+/**
+ * The 64 bit FNV-1a hash.
+ */
+class SnapshotHash {
+  uint64_t value = 0xcbf29ce484222325ULL;
+
+public:
+  void Update(std::span<const std::byte> src) noexcept {
+    for (const std::byte b : src) {
+      value ^= static_cast<uint64_t>(b);
+      value *= 0x100000001b3ULL;
+    }
+  }
+
+  void Update(std::string_view s) noexcept {
+    static constexpr char terminator = '\0';
+
+    Update(AsBytes(s));
+    /* the terminator separates this string from the next one */
+    Update(ReferenceAsBytes(terminator));
+  }
+
+  uint64_t Get() const noexcept {
+    return value;
+  }
+};
+
+uint64_t
+Profile::GetSnapshotKey(const ProfileMap &map, tstring_view build,
+                        int utc_offset) noexcept
+{
+  SnapshotHash hash;
+  hash.Update(std::as_bytes(std::span{build}));
+  hash.Update(ReferenceAsBytes(SNAPSHOT_SCHEMA_VERSION));
+  hash.Update(std::as_bytes(std::span{snapshot_layout}));
+
+  hash.Update(ReferenceAsBytes(utc_offset));
+
+  for (const auto &[key, value] : map) {
+    hash.Update(key);
+    hash.Update(value);
+  }
+
+  return hash.Get();
+}
+
+void
+Profile::SaveSnapshot(OutputStream &os, uint64_t key,
+                      const SystemSettings &system,
+                      const ComputerSettings &computer,
+                      const UISettings &ui)
+{
+  const ProfileSnapshotHeader header{
+    ProfileSnapshotHeader::MAGIC,
+    ProfileSnapshotHeader::VERSION,
+    sizeof(system), sizeof(computer), sizeof(ui),
+    0,
+    key,
+  };
+
+  os.Write(ReferenceAsBytes(header));
+  os.Write(ReferenceAsBytes(system));
+  os.Write(ReferenceAsBytes(computer));
+  os.Write(ReferenceAsBytes(ui));
+}
+
+bool
+Profile::LoadSnapshot(Path path, uint64_t key,
+                      SystemSettings &system,
+                      ComputerSettings &computer,
+                      UISettings &ui)
+{
+  FileReader reader{path};
+  if (reader.GetSize() != SNAPSHOT_SIZE)
+    return false;
+
+  const auto buffer = std::make_unique<std::byte[]>(SNAPSHOT_SIZE);
+  reader.ReadFull({buffer.get(), SNAPSHOT_SIZE});
+
+  ProfileSnapshotHeader header;
+  memcpy(&header, buffer.get(), sizeof(header));
+
+  if (header.magic != ProfileSnapshotHeader::MAGIC ||
+      header.version != ProfileSnapshotHeader::VERSION ||
+      header.system_size != sizeof(system) ||
+      header.computer_size != sizeof(computer) ||
+      header.ui_size != sizeof(ui) ||
+      header.key != key)
+    return false;
+
+  const std::byte *p = buffer.get() + sizeof(header);
+  memcpy(&system, p, sizeof(system));
+  p += sizeof(system);
+  memcpy(&computer, p, sizeof(computer));
+  p += sizeof(computer);
+  memcpy(&ui, p, sizeof(ui));
+  return true;
+}
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "util/tstring_view.hxx"
+
+#include <cstdint>
+
+class ProfileMap;
+class Path;
+class OutputStream;
+struct SystemSettings;
+struct ComputerSettings;
+struct UISettings;
+
+/*
+ * A binary snapshot of the settings structs decoded from a profile
+ * by Profile::Use().  Loading it at startup avoids parsing all the
+ * profile strings again.  The snapshot is only a cache: the text
+ * profile remains the source of truth, and the snapshot is rejected
+ * if it was not created from the same profile contents by the same
+ * build.
+ */
+namespace Profile {
+
+/**
+ * Calculate the key which identifies the settings decoded from this
+ * profile.  Apart from the given parameters, the key includes the
+ * snapshot schema version and the layout of the settings structs,
+ * so a snapshot is rejected after they have changed.
+ *
+ * @param build identifies the program version (the default settings
+ * depend on it)
+ * @param utc_offset the time zone offset of the system in seconds;
+ * it is the default of ComputerSettings::utc_offset, which is used
+ * if the profile doesn't specify one
+ */
+[[gnu::pure]]
+uint64_t
+GetSnapshotKey(const ProfileMap &map, tstring_view build,
+               int utc_offset) noexcept;
+
+/**
+ * Throws on I/O error.
+ */
+void
+SaveSnapshot(OutputStream &os, uint64_t key,
+             const SystemSettings &system,
+             const ComputerSettings &computer,
+             const UISettings &ui);
+
+/**
+ * Load a snapshot written by SaveSnapshot().  The settings are only
+ * modified if the snapshot is valid.
+ *
+ * Throws on I/O error.
+ *
+ * @return true on success, false if the snapshot does not match the
+ * key or is malformed
+ */
+bool
+LoadSnapshot(Path path, uint64_t key,
+             SystemSettings &system,
+             ComputerSettings &computer,
+             UISettings &ui);
+
+} // namespace Profile
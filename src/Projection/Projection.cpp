@@ -53,6 +53,40 @@ Projection::GeoToScreen(const GeoPoint &g) const noexcept
   return sc;
 }
 
+void
+Projection::GeoToScreen(std::span<const GeoPoint> src,
+                        int *x, int *y) const noexcept
+{
+  assert(IsValid());
+
+  /* pass 1: the (unrotated) offset from the screen origin in
+     pixels; this is the same as the scalar version, but with
+     loop-free normalisation */
+  const std::size_t n = src.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    const GeoPoint &g = src[i];
+
+    const Angle longitude = (geo_location.longitude - g.longitude)
+      .AsSmallDelta();
+    const Angle latitude = std::clamp(geo_location.latitude - g.latitude,
+                                      -Angle::QuarterCircle(),
+                                      Angle::QuarterCircle());
+
+    x[i] = int(g.latitude.fastcosine() * AngleToPixels(longitude));
+    y[i] = (int)AngleToPixels(latitude);
+  }
+
+  /* pass 2: rotate */
+  screen_rotation.Rotate({x, n}, {y, n});
+
+  /* pass 3: translate */
+  const int origin_x = screen_origin.x, origin_y = screen_origin.y;
+  for (std::size_t i = 0; i < n; ++i) {
+    x[i] = origin_x - x[i];
+    y[i] = origin_y + y[i];
+  }
+}
+
 void
 Projection::SetScale(const double _scale) noexcept
 {
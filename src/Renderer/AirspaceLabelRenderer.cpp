@@ -37,12 +37,14 @@ public:
 };
 
 void
-AirspaceLabelRenderer::Draw(Canvas &canvas,
-                            const WindowProjection &projection,
-                            const MoreData &basic, const DerivedInfo &calculated,
-                            const AirspaceComputerSettings &computer_settings,
-                            const AirspaceRendererSettings &settings) noexcept
+AirspaceLabelRenderer::Prepare(const WindowProjection &projection,
+                               const MoreData &basic,
+                               const DerivedInfo &calculated,
+                               const AirspaceComputerSettings &computer_settings,
+                               const AirspaceRendererSettings &settings) noexcept
 {
+  labels.Clear();
+
   if (settings.label_selection != AirspaceRendererSettings::LabelSelection::ALL ||
       airspaces == nullptr || airspaces->IsEmpty())
     return;
@@ -55,17 +57,14 @@ AirspaceLabelRenderer::Draw(Canvas &canvas,
   const AirspaceMapVisible visible(computer_settings, settings,
                                    aircraft, awc);
 
-  DrawInternal(canvas,
-               projection, visible, computer_settings.warnings);
+  PrepareInternal(projection, visible, computer_settings.warnings);
 }
 
 inline void
-AirspaceLabelRenderer::DrawInternal(Canvas &canvas,
-                                    const WindowProjection &projection,
-                                    AirspacePredicate visible,
-                                    const AirspaceWarningConfig &config) noexcept
+AirspaceLabelRenderer::PrepareInternal(const WindowProjection &projection,
+                                       AirspacePredicate visible,
+                                       const AirspaceWarningConfig &config) noexcept
 {
-  AirspaceLabelList labels;
   for (const auto &i : airspaces->QueryWithinRange(projection.GetGeoScreenCenter(),
                                                    projection.GetScreenDistanceMeters())) {
     const AbstractAirspace &airspace = i.GetAirspace();
@@ -75,6 +74,14 @@ AirspaceLabelRenderer::DrawInternal(Canvas &canvas,
   }
 
   labels.Sort(config);
+}
+
+void
+AirspaceLabelRenderer::Draw(Canvas &canvas,
+                            const WindowProjection &projection) noexcept
+{
+  if (labels.begin() == labels.end())
+    return;
 
   // default paint settings
   canvas.SetTextColor(look.label_text_color);
@@ -86,6 +93,19 @@ AirspaceLabelRenderer::DrawInternal(Canvas &canvas,
   // draw
   for (const auto &label : labels)
     DrawLabel(canvas, projection, label);
+
+  labels.Clear();
+}
+
+void
+AirspaceLabelRenderer::Draw(Canvas &canvas,
+                            const WindowProjection &projection,
+                            const MoreData &basic, const DerivedInfo &calculated,
+                            const AirspaceComputerSettings &computer_settings,
+                            const AirspaceRendererSettings &settings) noexcept
+{
+  Prepare(projection, basic, calculated, computer_settings, settings);
+  Draw(canvas, projection);
 }
 
 inline void
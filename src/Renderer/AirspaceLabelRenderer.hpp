@@ -23,6 +23,11 @@ class AirspaceLabelRenderer
   const Airspaces *airspaces = nullptr;
   const ProtectedAirspaceWarningManager *warning_manager = nullptr;
 
+  /**
+   * The labels collected by Prepare(), to be drawn by Draw().
+   */
+  AirspaceLabelList labels;
+
 public:
   explicit AirspaceLabelRenderer(const AirspaceLook &_look) noexcept
     :look(_look) {}
@@ -53,17 +58,32 @@ public:
   }
 
 private:
-  void DrawInternal(Canvas &canvas,
-                    const WindowProjection &projection,
-                    AirspacePredicate visible,
-                    const AirspaceWarningConfig &config) noexcept;
+  void PrepareInternal(const WindowProjection &projection,
+                       AirspacePredicate visible,
+                       const AirspaceWarningConfig &config) noexcept;
 
   void DrawLabel(Canvas &canvas, const WindowProjection &projection,
                  const AirspaceLabelList::Label &label) noexcept;
 
 public:
-   /**
-   * Draw labels that are visible according to standard rules.
+  /**
+   * Collect and sort the labels that are visible according to
+   * standard rules.  This does not draw anything and may be called
+   * from any thread.
+   */
+  void Prepare(const WindowProjection &projection,
+               const MoreData &basic, const DerivedInfo &calculated,
+               const AirspaceComputerSettings &computer_settings,
+               const AirspaceRendererSettings &settings) noexcept;
+
+  /**
+   * Draw the labels collected by the last Prepare() call.
+   */
+  void Draw(Canvas &canvas, const WindowProjection &projection) noexcept;
+
+  /**
+   * Draw labels that are visible according to standard rules
+   * (Prepare() and Draw() in one call).
    */
   void Draw(Canvas &canvas,
             const WindowProjection &projection,
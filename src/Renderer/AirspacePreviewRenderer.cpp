@@ -35,9 +35,11 @@ GetPolygonPoints(std::vector<BulkPixelPoint> &pts,
 
   const SearchPointVector &border = airspace.GetPoints();
 
-  pts.reserve(border.size());
-  for (auto it = border.begin(), it_end = border.end(); it != it_end; ++it)
-    pts.push_back(projection.GeoToScreen(it->GetLocation()));
+  const std::size_t offset = pts.size();
+  pts.resize(offset + border.size());
+  projection.GeoToScreen(border, [](const SearchPoint &i){
+    return i.GetLocation();
+  }, pts.data() + offset);
 }
 
 bool
@@ -3,11 +3,45 @@
 
 #include "LabelBlock.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+/**
+ * Find the smallest power of two which is larger than the given
+ * average label dimension.
+ */
+static constexpr unsigned
+CalcCellShift(unsigned average, unsigned min, unsigned max) noexcept
+{
+  return std::clamp(unsigned(std::bit_width(average)), min, max);
+}
+
+LabelBlock::LabelBlock() noexcept
+  :buckets(MIN_BUCKETS, NONE) {}
+
+inline unsigned
+LabelBlock::GetBucket(int x, int y) const noexcept
+{
+  return (unsigned(x) * 73856093u ^ unsigned(y) * 19349663u)
+    & (buckets.size() - 1);
+}
+
+inline bool
+LabelBlock::CheckLarge(const PixelRect rc) const noexcept
+{
+  for (const unsigned i : large)
+    if (blocks[i].OverlapsWith(rc))
+      return false;
+
+  return true;
+}
+
 inline bool
-LabelBlock::Bucket::Check(const PixelRect rc) const noexcept
+LabelBlock::CheckAll(const PixelRect rc) const noexcept
 {
-  for (auto i = blocks.begin(), end = blocks.end(); i != end; ++i)
-    if (i->OverlapsWith(rc))
+  for (const auto &i : blocks)
+    if (i.OverlapsWith(rc))
       return false;
 
   return true;
@@ -16,28 +50,74 @@ LabelBlock::Bucket::Check(const PixelRect rc) const noexcept
 void
 LabelBlock::reset() noexcept
 {
-  for (auto &i : buckets)
-    i.Clear();
+  if (!blocks.empty()) {
+    /* adapt the grid to the labels of the previous frame: cells
+       about as large as an average label, and about two entries per
+       bucket */
+
+    uint_least64_t width = 0, height = 0;
+    for (const auto &i : blocks) {
+      width += i.GetWidth();
+      height += i.GetHeight();
+    }
+
+    cell_shift_x = CalcCellShift(width / blocks.size(),
+                                 MIN_CELL_SHIFT, MAX_CELL_SHIFT);
+    cell_shift_y = CalcCellShift(height / blocks.size(),
+                                 MIN_CELL_SHIFT, MAX_CELL_SHIFT);
+
+    const std::size_t n_buckets =
+      std::max<std::size_t>(std::bit_ceil(entries.size() / 2), MIN_BUCKETS);
+    if (n_buckets != buckets.size())
+      buckets.resize(n_buckets);
+  }
+
+  blocks.clear();
+  entries.clear();
+  large.clear();
+  std::fill(buckets.begin(), buckets.end(), NONE);
 }
 
 bool
 LabelBlock::check(const PixelRect rc) noexcept
 {
-  unsigned top = rc.top >> BUCKET_SHIFT;
-  unsigned bottom = rc.bottom >> BUCKET_SHIFT;
-
-  if (top >= BUCKET_COUNT)
-    top = BUCKET_COUNT - 1;
+  /* OverlapsWith() includes the right and bottom edges, so they must
+     be included in the cell range, too */
+  const int x0 = rc.left >> cell_shift_x;
+  const int x1 = std::max(rc.right >> cell_shift_x, x0);
+  const int y0 = rc.top >> cell_shift_y;
+  const int y1 = std::max(rc.bottom >> cell_shift_y, y0);
 
-  if (bottom < BUCKET_COUNT && !buckets[bottom].Check(rc))
+  if (!CheckLarge(rc))
     return false;
 
-  if (top < bottom && !buckets[top].Check(rc))
-    return false;
+  const unsigned index = blocks.size();
+
+  if (uint_least64_t(x1 - x0 + 1) * uint_least64_t(y1 - y0 + 1) > MAX_CELLS) {
+    if (!CheckAll(rc))
+      return false;
+
+    blocks.push_back(rc);
+    large.push_back(index);
+    return true;
+  }
+
+  for (int y = y0; y <= y1; ++y)
+    for (int x = x0; x <= x1; ++x)
+      for (unsigned i = buckets[GetBucket(x, y)]; i != NONE;
+           i = entries[i].next)
+        if (blocks[entries[i].block].OverlapsWith(rc))
+          return false;
+
+  blocks.push_back(rc);
 
-  buckets[top].Add(rc);
-  if (bottom < BUCKET_COUNT && top != bottom)
-    buckets[bottom].Add(rc);
+  for (int y = y0; y <= y1; ++y) {
+    for (int x = x0; x <= x1; ++x) {
+      unsigned &head = buckets[GetBucket(x, y)];
+      entries.push_back({index, head});
+      head = entries.size() - 1;
+    }
+  }
 
   return true;
 }
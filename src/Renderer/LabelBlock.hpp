@@ -4,43 +4,92 @@
 #pragma once
 
 #include "ui/dim/Rect.hpp"
-#include "util/StaticArray.hxx"
+
+#include <vector>
 
 /**
  * Simple code to prevent text writing over map city names.
+ *
+ * The rectangles of all labels drawn so far are stored in a spatial
+ * hash: the screen is divided into cells, and each rectangle is
+ * registered in the hash bucket of every cell it touches, so a hit
+ * test only needs to look at the rectangles near the new one.  The
+ * cell size and the number of buckets are adapted to the labels of
+ * the previous frame by reset().
  */
 class LabelBlock {
-  static constexpr unsigned SCREEN_HEIGHT = 4096;
-  static constexpr unsigned BUCKET_SIZE = 64;
-  static constexpr unsigned BUCKET_SHIFT = 7;
-  static constexpr unsigned BUCKET_HEIGHT = 1 << BUCKET_SHIFT;
-  static constexpr unsigned BUCKET_COUNT = SCREEN_HEIGHT / BUCKET_HEIGHT;
+  static constexpr unsigned NONE = ~0u;
+
+  static constexpr unsigned MIN_CELL_SHIFT = 4;
+  static constexpr unsigned MAX_CELL_SHIFT = 9;
+
+  static constexpr unsigned MIN_BUCKETS = 64;
 
   /**
-   * A bucket is responsible for hit tests in one horizontal section
-   * of the screen.
+   * Rectangles touching more cells than this are not hashed; they
+   * are stored in #large and checked by every hit test.
    */
-  class Bucket {
-    typedef StaticArray<PixelRect, BUCKET_SIZE> BlockArray;
-    BlockArray blocks;
-
-  public:
-    void Clear() noexcept {
-      blocks.clear();
-    }
-
-    [[gnu::pure]]
-    bool Check(const PixelRect rc) const noexcept;
-
-    void Add(const PixelRect rc) noexcept {
-      if (!blocks.full())
-        blocks.append(rc);
-    }
+  static constexpr unsigned MAX_CELLS = 16;
+
+  struct Entry {
+    /**
+     * Index into #blocks.
+     */
+    unsigned block;
+
+    /**
+     * The next entry in the same bucket or #NONE.
+     */
+    unsigned next;
   };
 
-  Bucket buckets[BUCKET_COUNT];
+  /**
+   * The rectangles of all labels accepted since the last reset().
+   */
+  std::vector<PixelRect> blocks;
+
+  std::vector<Entry> entries;
+
+  /**
+   * The first entry of each bucket or #NONE.  The size is a power of
+   * two.
+   */
+  std::vector<unsigned> buckets;
+
+  /**
+   * Indexes of rectangles which are too large to be hashed.
+   */
+  std::vector<unsigned> large;
+
+  /**
+   * The cell size is (1 << cell_shift_x) * (1 << cell_shift_y)
+   * pixels.
+   */
+  unsigned cell_shift_x = 7, cell_shift_y = 5;
 
 public:
+  LabelBlock() noexcept;
+
+  /**
+   * Check whether the given rectangle overlaps with a label which was
+   * added before.  If not, it is added.
+   *
+   * @return true if the rectangle was added
+   */
   bool check(const PixelRect rc) noexcept;
+
+  /**
+   * Remove all rectangles (at the start of a new frame).
+   */
   void reset() noexcept;
+
+private:
+  [[gnu::pure]]
+  unsigned GetBucket(int x, int y) const noexcept;
+
+  [[gnu::pure]]
+  bool CheckLarge(const PixelRect rc) const noexcept;
+
+  [[gnu::pure]]
+  bool CheckAll(const PixelRect rc) const noexcept;
 };
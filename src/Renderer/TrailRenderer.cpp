@@ -8,18 +8,36 @@
 #include "NMEA/Derived.hpp"
 #include "MapSettings.hpp"
 #include "Computer/TraceComputer.hpp"
+#include "Engine/Trace/Snapshot.hpp"
 #include "Projection/WindowProjection.hpp"
 #include "Geo/Math.hpp"
 #include "Engine/Contest/ContestTrace.hpp"
 
 #include <algorithm>
+#include <numeric>
+
+TrailRenderer::TrailRenderer(const TrailLook &_look) noexcept
+  :look(_look) {}
+
+TrailRenderer::~TrailRenderer() noexcept = default;
+
+inline void
+TrailRenderer::LoadSnapshot(const TraceComputer &trace_computer) noexcept
+{
+  /* drop our reference first, which allows the TraceComputer to
+     update the snapshot in place instead of copying it */
+  trace.reset();
+  trace = trace_computer.GetSnapshot();
+}
 
 bool
 TrailRenderer::LoadTrace(const TraceComputer &trace_computer) noexcept
 {
-  trace.clear();
-  trace_computer.LockedCopyTo(trace);
-  return !trace.empty();
+  LoadSnapshot(trace_computer);
+
+  selection.resize(trace->size());
+  std::iota(selection.begin(), selection.end(), 0u);
+  return !selection.empty();
 }
 
 bool
@@ -27,12 +45,20 @@ TrailRenderer::LoadTrace(const TraceComputer &trace_computer,
                          TimeStamp min_time,
                          const WindowProjection &projection) noexcept
 {
-  trace.clear();
-  trace_computer.LockedCopyTo(trace,
-                              min_time.Cast<std::chrono::duration<unsigned>>(),
-                              projection.GetGeoScreenCenter(),
-                              projection.DistancePixelsToMeters(3));
-  return !trace.empty();
+  LoadSnapshot(trace_computer);
+
+  trace->Select(selection,
+                min_time.Cast<std::chrono::duration<unsigned>>(),
+                projection.GetGeoScreenCenter(),
+                projection.DistancePixelsToMeters(3));
+  return !selection.empty();
+}
+
+void
+TrailRenderer::ScanBounds(GeoBounds &bounds) const noexcept
+{
+  if (trace != nullptr)
+    trace->ScanBounds(bounds, selection);
 }
 
 /**
@@ -58,28 +84,36 @@ GetAltitudeColorIndex(double alt, double min_alt, double max_alt) noexcept
   return std::clamp((int)(relative_altitude * _max), 0, _max);
 }
 
+/**
+ * Determine the minimum and maximum of the selected values, but at
+ * least the given range.
+ */
 [[gnu::pure]]
 static std::pair<double, double>
-GetMinMax(TrailSettings::Type type, const TracePointVector &trace) noexcept
+GetMinMax(std::span<const float> values, std::span<const unsigned> selection,
+          float value_min, float value_max) noexcept
+{
+  for (const unsigned i : selection) {
+    value_max = std::max(values[i], value_max);
+    value_min = std::min(values[i], value_min);
+  }
+
+  return std::make_pair(value_min, value_max);
+}
+
+[[gnu::pure]]
+static std::pair<double, double>
+GetMinMax(TrailSettings::Type type, const TraceSnapshot &trace,
+          std::span<const unsigned> selection) noexcept
 {
   double value_min, value_max;
 
   if (type == TrailSettings::Type::ALTITUDE) {
-    value_max = 1000;
-    value_min = 500;
-
-    for (const auto &i : trace) {
-      value_max = std::max(i.GetAltitude(), value_max);
-      value_min = std::min(i.GetAltitude(), value_min);
-    }
+    std::tie(value_min, value_max) =
+      GetMinMax(trace.GetAltitudes(), selection, 500, 1000);
   } else {
-    value_max = 0.75;
-    value_min = -2.0;
-
-    for (const auto &i : trace) {
-      value_max = std::max(i.GetVario(), value_max);
-      value_min = std::min(i.GetVario(), value_min);
-    }
+    std::tie(value_min, value_max) =
+      GetMinMax(trace.GetVarios(), selection, -2.0, 0.75);
 
     value_max = std::min(7.5, value_max);
     value_min = std::max(-5.0, value_min);
@@ -113,7 +147,7 @@ TrailRenderer::Draw(Canvas &canvas, const TraceComputer &trace_computer,
     traildrift = basic.location - tp1;
   }
 
-  auto minmax = GetMinMax(settings.type, trace);
+  auto minmax = GetMinMax(settings.type, *trace, selection);
   auto value_min = minmax.first;
   auto value_max = minmax.second;
 
@@ -122,30 +156,50 @@ TrailRenderer::Draw(Canvas &canvas, const TraceComputer &trace_computer,
 
   const GeoBounds bounds = projection.GetScreenBounds().Scale(4);
 
-  PixelPoint last_point(0, 0);
-  bool last_valid = false;
-  for (const auto &i : trace) {
+  const auto locations = trace->GetLocations();
+  const auto altitudes = trace->GetAltitudes();
+  const auto varios = trace->GetVarios();
+
+  /* collect the visible points and project them in one batch */
+  visible.clear();
+  visible_locations.GrowDiscard(selection.size());
+  for (std::size_t j = 0; j < selection.size(); ++j) {
+    const unsigned i = selection[j];
     const GeoPoint gp = enable_traildrift
-      ? i.GetLocation().Parametric(traildrift, i.CalculateDrift(basic.time))
-      : i.GetLocation();
-    if (!bounds.IsInside(gp)) {
+      ? locations[i].Parametric(traildrift, trace->CalculateDrift(i, basic.time))
+      : locations[i];
+    if (!bounds.IsInside(gp))
       /* the point is outside of the MapWindow; don't paint it */
-      last_valid = false;
       continue;
-    }
 
-    auto pt = projection.GeoToScreen(gp);
+    visible_locations[visible.size()] = gp;
+    visible.push_back(j);
+  }
+
+  const std::size_t n_visible = visible.size();
+  visible_points.GrowDiscard(n_visible);
+  projection.GeoToScreen(std::span<const GeoPoint>{visible_locations.data(), n_visible},
+                         visible_points.data());
+
+  PixelPoint last_point(0, 0);
+  for (std::size_t k = 0; k < n_visible; ++k) {
+    const unsigned j = visible[k], i = selection[j];
+    const PixelPoint pt = visible_points[k];
+
+    /* connect only to the previous point of the selection, not
+       across invisible points */
+    const bool last_valid = k > 0 && visible[k - 1] + 1 == j;
 
     if (last_valid) {
       if (settings.type == TrailSettings::Type::ALTITUDE) {
-        unsigned index = GetAltitudeColorIndex(i.GetAltitude(),
+        unsigned index = GetAltitudeColorIndex(altitudes[i],
                                                value_min, value_max);
         canvas.Select(look.trail_pens[index]);
         canvas.DrawLinePiece(last_point, pt);
       } else {
-        unsigned color_index = GetSnailColorIndex(i.GetVario(),
+        unsigned color_index = GetSnailColorIndex(varios[i],
                                                   value_min, value_max);
-        if (i.GetVario() < 0 &&
+        if (varios[i] < 0 &&
             (settings.type == TrailSettings::Type::VARIO_1_DOTS ||
              settings.type == TrailSettings::Type::VARIO_2_DOTS ||
              settings.type == TrailSettings::Type::VARIO_DOTS_AND_LINES ||
@@ -173,10 +227,9 @@ TrailRenderer::Draw(Canvas &canvas, const TraceComputer &trace_computer,
       }
     }
     last_point = pt;
-    last_valid = true;
   }
 
-  if (last_valid)
+  if (n_visible > 0 && visible.back() + 1 == selection.size())
     canvas.DrawLine(last_point, pos);
 }
 
@@ -184,7 +237,7 @@ void
 TrailRenderer::Draw(Canvas &canvas, const WindowProjection &projection) noexcept
 {
   canvas.Select(look.trace_pen);
-  DrawTraceVector(canvas, projection, trace);
+  DrawSelection(canvas, projection);
 }
 
 void
@@ -225,9 +278,9 @@ TrailRenderer::DrawTraceVector(Canvas &canvas, const Projection &projection,
 {
   const unsigned n = trace.size();
 
-  std::transform(trace.begin(), trace.end(), Prepare(n), [&projection](const auto &i){
-    return projection.GeoToScreen(i.GetLocation());
-  });
+  projection.GeoToScreen(trace, [](const auto &i){
+    return i.GetLocation();
+  }, Prepare(n));
 
   DrawPreparedPolyline(canvas, n);
 }
@@ -249,14 +302,15 @@ TrailRenderer::DrawTriangle(Canvas &canvas, const Projection &projection,
 }
 
 void
-TrailRenderer::DrawTraceVector(Canvas &canvas, const Projection &projection,
-                               const TracePointVector &trace) noexcept
+TrailRenderer::DrawSelection(Canvas &canvas,
+                             const Projection &projection) noexcept
 {
-  const unsigned n = trace.size();
+  const unsigned n = selection.size();
+  const auto locations = trace->GetLocations();
 
-  std::transform(trace.begin(), trace.end(), Prepare(n), [&projection](const auto &i){
-    return projection.GeoToScreen(i.GetLocation());
-  });
+  projection.GeoToScreen(selection, [locations](unsigned i){
+    return locations[i];
+  }, Prepare(n));
 
   DrawPreparedPolyline(canvas, n);
 }
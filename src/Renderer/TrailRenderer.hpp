@@ -4,14 +4,18 @@
 #pragma once
 
 #include "util/AllocatedArray.hxx"
-#include "Engine/Trace/Point.hpp"
-#include "Engine/Trace/Vector.hpp"
 #include "time/Stamp.hpp"
 
+#include <memory>
+#include <vector>
+
 struct PixelPoint;
 struct BulkPixelPoint;
+struct GeoPoint;
 class Canvas;
 class TraceComputer;
+class TraceSnapshot;
+class GeoBounds;
 class Projection;
 class WindowProjection;
 class ContestTraceVector;
@@ -29,11 +33,27 @@ struct TrailSettings;
 class TrailRenderer {
   const TrailLook &look;
 
-  TracePointVector trace;
+  std::shared_ptr<const TraceSnapshot> trace;
+
+  /**
+   * The indices of the #trace points loaded by LoadTrace().
+   */
+  std::vector<unsigned> selection;
+
   AllocatedArray<BulkPixelPoint> points;
 
+  /**
+   * Buffers for Draw(): the positions (in #selection) of the points
+   * which are visible, and their (drifted) locations and screen
+   * coordinates.
+   */
+  std::vector<unsigned> visible;
+  AllocatedArray<GeoPoint> visible_locations;
+  AllocatedArray<PixelPoint> visible_points;
+
 public:
-  TrailRenderer(const TrailLook &_look) noexcept:look(_look) {}
+  TrailRenderer(const TrailLook &_look) noexcept;
+  ~TrailRenderer() noexcept;
 
   /**
    * Load the full trace into this object.
@@ -47,9 +67,7 @@ public:
                  TimeStamp min_time,
                  const WindowProjection &projection) noexcept;
 
-  void ScanBounds(GeoBounds &bounds) const noexcept {
-    trace.ScanBounds(bounds);
-  }
+  void ScanBounds(GeoBounds &bounds) const noexcept;
 
   void Draw(Canvas &canvas, const TraceComputer &trace_computer,
             const WindowProjection &projection,
@@ -87,6 +105,13 @@ public:
                     const ContestTraceVector &trace) noexcept;
 
 private:
-  void DrawTraceVector(Canvas &canvas, const Projection &projection,
-                       const TracePointVector &trace) noexcept;
+  /**
+   * Release the previous snapshot and obtain a new one.
+   */
+  void LoadSnapshot(const TraceComputer &trace_computer) noexcept;
+
+  /**
+   * Draw the points selected by LoadTrace() as a polyline.
+   */
+  void DrawSelection(Canvas &canvas, const Projection &projection) noexcept;
 };
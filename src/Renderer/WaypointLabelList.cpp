@@ -55,10 +55,10 @@ WaypointLabelList::Add(const TCHAR *Name, PixelPoint p,
   if (!clip_rect.Contains(p))
     return;
 
-  if (labels.full())
+  if (labels.size() >= max_labels)
     return;
 
-  auto &l = labels.append();
+  auto &l = labels.emplace_back();
 
   CopyString(l.Name, ARRAY_SIZE(l.Name), Name);
   l.Pos = p;
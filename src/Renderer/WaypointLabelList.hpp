@@ -7,9 +7,11 @@
 #include "ui/dim/Point.hpp"
 #include "ui/dim/Rect.hpp"
 #include "util/NonCopyable.hpp"
-#include "util/StaticArray.hxx"
 #include "Sizes.h" /* for NAME_SIZE */
 
+#include <cstddef>
+#include <vector>
+
 #include <tchar.h>
 
 class WaypointLabelList : private NonCopyable {
@@ -28,14 +30,25 @@ public:
     bool bold;
   };
 
+  /**
+   * The default for the maximum number of labels.
+   */
+  static constexpr std::size_t DEFAULT_MAX_LABELS = 256;
+
 protected:
   PixelRect clip_rect;
 
-  StaticArray<Label, 256u> labels;
+  /**
+   * The maximum number of labels; more are ignored.
+   */
+  std::size_t max_labels;
+
+  std::vector<Label> labels;
 
 public:
-  explicit WaypointLabelList(PixelRect _rect) noexcept
-    :clip_rect(_rect)
+  explicit WaypointLabelList(PixelRect _rect,
+                             std::size_t _max_labels=DEFAULT_MAX_LABELS) noexcept
+    :clip_rect(_rect), max_labels(_max_labels)
   {
     clip_rect.Grow(WPCIRCLESIZE);
     clip_rect.right += WPCIRCLESIZE * 2;
@@ -46,6 +59,10 @@ public:
            int AltArivalAGL,
            bool inTask, bool isLandable, bool isAirport,
            bool isWatchedWaypoint) noexcept;
+
+  /**
+   * Sort the labels by priority, the most important one first.
+   */
   void Sort() noexcept;
 
   auto begin() const noexcept {
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <vector>
+
+/**
+ * The importance of a waypoint on the map, used to choose which ones
+ * to keep when there are too many visible waypoints.  This is the
+ * order of WaypointLabelList::Sort() without the arrival altitude,
+ * which is not yet known when the waypoints are collected.
+ */
+struct WaypointPriority {
+  bool in_task, airport, landable, watched;
+
+  constexpr auto operator<=>(const WaypointPriority &) const noexcept = default;
+};
+
+/**
+ * A list of up to a fixed number of items.  Once it is full, a new
+ * item replaces the one of the lowest priority (if its own priority
+ * is higher), so the result does not depend on the order in which
+ * the items are added.
+ *
+ * @param T the item type; it must have a public #WaypointPriority
+ * attribute called "priority"
+ */
+template<typename T>
+class WaypointPriorityList {
+  /**
+   * When the list is full, this is a heap with the item of the
+   * lowest priority at the front.
+   */
+  std::vector<T> items;
+
+  const std::size_t max_size;
+
+public:
+  explicit WaypointPriorityList(std::size_t _max_size) noexcept
+    :max_size(_max_size) {
+    assert(max_size > 0);
+  }
+
+  std::size_t GetMaxSize() const noexcept {
+    return max_size;
+  }
+
+  bool IsFull() const noexcept {
+    return items.size() >= max_size;
+  }
+
+  /**
+   * Would an item with the given priority be added?  This allows
+   * the caller to skip expensive preparations for items which would
+   * be discarded anyway.
+   */
+  [[gnu::pure]]
+  bool Accepts(WaypointPriority priority) const noexcept {
+    return !IsFull() || priority > items.front().priority;
+  }
+
+  /**
+   * Add a new item; if the list is full, it replaces the item of the
+   * lowest priority.  The caller must check Accepts() first.
+   *
+   * @param f a function which initialises the new item (including
+   * its priority)
+   */
+  template<typename F>
+  void Add(F &&f) noexcept {
+    if (IsFull()) {
+      std::pop_heap(items.begin(), items.end(), Compare);
+      f(items.back());
+      std::push_heap(items.begin(), items.end(), Compare);
+    } else {
+      f(items.emplace_back());
+
+      if (IsFull())
+        std::make_heap(items.begin(), items.end(), Compare);
+    }
+  }
+
+  std::size_t size() const noexcept {
+    return items.size();
+  }
+
+  auto begin() noexcept {
+    return items.begin();
+  }
+
+  auto end() noexcept {
+    return items.end();
+  }
+
+  auto begin() const noexcept {
+    return items.begin();
+  }
+
+  auto end() const noexcept {
+    return items.end();
+  }
+
+private:
+  static bool Compare(const T &a, const T &b) noexcept {
+    return a.priority > b.priority;
+  }
+};
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Engine/Route/ReachResult.hpp"
+#include "util/Serial.hpp"
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * Remembers the terrain reach results of recently drawn waypoints,
+ * so they don't need to be looked up again in each frame.  The
+ * cache is bound to a #ProtectedRoutePlanner reach serial and gets
+ * flushed as soon as a new reach has been calculated.
+ */
+class WaypointReachCache {
+  struct Item {
+    unsigned id;
+
+    /**
+     * The arrival altitude which was used for the lookup; the item
+     * is only valid if it matches.
+     */
+    double altitude;
+
+    ReachResult reach;
+  };
+
+  /**
+   * Sorted by #Item::id.
+   */
+  std::vector<Item> items;
+
+  Serial serial;
+
+public:
+  /**
+   * Flush the cache if it was filled from a different reach.
+   */
+  void Validate(Serial current) noexcept {
+    if (current != serial) {
+      items.clear();
+      serial = current;
+    }
+  }
+
+  [[gnu::pure]]
+  const ReachResult *Find(unsigned id, double altitude) const noexcept {
+    const auto i = LowerBound(id);
+    if (i == items.end() || i->id != id || i->altitude != altitude)
+      return nullptr;
+
+    return &i->reach;
+  }
+
+  void Put(unsigned id, double altitude, const ReachResult &reach) noexcept {
+    const auto i = LowerBound(id);
+    if (i != items.end() && i->id == id)
+      *i = {id, altitude, reach};
+    else
+      items.insert(i, {id, altitude, reach});
+  }
+
+private:
+  std::vector<Item>::iterator LowerBound(unsigned id) noexcept {
+    return std::lower_bound(items.begin(), items.end(), id,
+                            [](const Item &item, unsigned _id){
+                              return item.id < _id;
+                            });
+  }
+
+  std::vector<Item>::const_iterator LowerBound(unsigned id) const noexcept {
+    return std::lower_bound(items.begin(), items.end(), id,
+                            [](const Item &item, unsigned _id){
+                              return item.id < _id;
+                            });
+  }
+};
@@ -5,13 +5,13 @@
 #include "WaypointRendererSettings.hpp"
 #include "WaypointIconRenderer.hpp"
 #include "WaypointLabelList.hpp"
+#include "WaypointPriority.hpp"
 #include "Projection/MapWindowProjection.hpp"
 #include "Computer/Settings.hpp"
 #include "Task/Visitors/TaskPointVisitor.hpp"
 #include "Engine/Util/Gradient.hpp"
 #include "Engine/Waypoint/Waypoint.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
-#include "Engine/GlideSolvers/GlideState.hpp"
 #include "Engine/GlideSolvers/GlideResult.hpp"
 #include "Engine/GlideSolvers/MacCready.hpp"
 #include "Engine/Task/TaskManager.hpp"
@@ -23,14 +23,15 @@
 #include "ui/canvas/Canvas.hpp"
 #include "Units/Units.hpp"
 #include "util/TruncateString.hpp"
-#include "util/StaticArray.hxx"
 #include "util/Macros.hpp"
 #include "NMEA/MoreData.hpp"
 #include "NMEA/Derived.hpp"
 #include "Engine/Route/ReachResult.hpp"
 #include "Look/WaypointLook.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 #include <stdio.h>
 
 /**
@@ -47,68 +48,43 @@ struct VisibleWaypoint {
 
   bool in_task;
 
+  WaypointPriority priority;
+
   void Set(const WaypointPtr &_waypoint, PixelPoint &_point,
-           bool _in_task) noexcept {
+           WaypointPriority _priority) noexcept {
     waypoint = _waypoint;
     point = _point;
     reach.Clear();
     reachable = WaypointReachability::INVALID;
-    in_task = _in_task;
+    in_task = _priority.in_task;
+    priority = _priority;
   }
 
   bool IsReachable() const noexcept {
     return ::IsReachable(reachable);
   }
 
-  void CalculateReachabilityDirect(const MoreData &basic,
-                                   const SpeedVector &wind,
-                                   const MacCready &mac_cready,
-                                   const TaskBehaviour &task_behaviour) noexcept {
-    assert(basic.location_available);
-    assert(basic.NavAltitudeAvailable());
-
-    if (!waypoint->has_elevation)
-      return;
-
-    const auto elevation = waypoint->elevation +
-      task_behaviour.safety_height_arrival;
-    const GlideState state(GeoVector(basic.location, waypoint->location),
-                           elevation, basic.nav_altitude, wind);
-
-    const GlideResult result = mac_cready.SolveStraight(state);
-    if (!result.IsOk())
-      return;
-
-    reach.direct = result.pure_glide_altitude_difference;
-    if (result.pure_glide_altitude_difference > 0)
+  /**
+   * Apply a straight glide result obtained by
+   * MacCready::SolveStraight().
+   */
+  void SetDirect(double arrival_altitude_difference) noexcept {
+    reach.direct = arrival_altitude_difference;
+    if (arrival_altitude_difference > 0)
       reachable = WaypointReachability::TERRAIN;
     else
       reachable = WaypointReachability::UNREACHABLE;
   }
 
-  bool CalculateRouteArrival(const ProtectedRoutePlanner &route_planner,
-                             const TaskBehaviour &task_behaviour) noexcept {
-    if (!waypoint->has_elevation)
-      return false;
-
-    const double elevation = waypoint->elevation +
-      task_behaviour.safety_height_arrival;
-    const AGeoPoint p_dest (waypoint->location, elevation);
-
-    auto _reach = route_planner.FindPositiveArrival(p_dest);
-    if (!_reach)
-      return false;
-
-    reach = *_reach;
-    reach.Subtract(elevation);
-    return true;
-  }
-
-  void CalculateReachability(const ProtectedRoutePlanner &route_planner,
-                             const TaskBehaviour &task_behaviour) noexcept
+  /**
+   * Apply a terrain reach result obtained for this waypoint's arrival
+   * altitude.
+   */
+  void SetReach(const ReachResult &_reach, double elevation,
+                const TaskBehaviour &task_behaviour) noexcept
   {
-    if (!CalculateRouteArrival(route_planner, task_behaviour))
-      return;
+    reach = _reach;
+    reach.Subtract(elevation);
 
     if (!reach.IsReachableDirect())
       reachable = WaypointReachability::UNREACHABLE;
@@ -125,6 +101,26 @@ struct VisibleWaypoint {
   }
 };
 
+[[gnu::pure]]
+static WaypointPriority
+GetPriority(const Waypoint &waypoint, bool in_task) noexcept
+{
+  return {in_task, waypoint.IsAirport(), waypoint.IsLandable(),
+          waypoint.flags.watched};
+}
+
+/**
+ * The maximum number of waypoints (and labels) on the map: one per
+ * 32x32 pixels, but not less than the #WaypointLabelList default.
+ */
+static constexpr std::size_t
+GetMaxWaypoints(PixelSize screen_size) noexcept
+{
+  return std::max<std::size_t>(std::size_t(screen_size.width) *
+                               screen_size.height / (32 * 32),
+                               WaypointLabelList::DEFAULT_MAX_LABELS);
+}
+
 class WaypointVisitorMap final
   : public TaskPointConstVisitor
 {
@@ -140,20 +136,18 @@ class WaypointVisitorMap final
   /**
    * A list of waypoints that are going to be drawn.  This list is
    * filled in the Visitor methods.  In the second stage, their
-   * reachability is calculated, and the third stage draws them.  This
-   * should ensure that the drawing methods don't need to hold a
-   * mutex.
+   * reachability is calculated and their labels are built; these
+   * stages don't need a #Canvas and may run in any thread.  The third
+   * stage draws them.  This should ensure that the drawing methods
+   * don't need to hold a mutex.
    */
-  StaticArray<VisibleWaypoint, 256> waypoints;
-
-  WaypointIconRenderer icon_renderer;
+  WaypointPriorityList<VisibleWaypoint> waypoints;
 
 public:
   WaypointLabelList labels;
 
 public:
-  WaypointVisitorMap(Canvas &_canvas,
-                     const MapWindowProjection &_projection,
+  WaypointVisitorMap(const MapWindowProjection &_projection,
                      const WaypointRendererSettings &_settings,
                      const WaypointLook &_look,
                      const TaskBehaviour &_task_behaviour,
@@ -162,11 +156,8 @@ public:
      settings(_settings), look(_look), task_behaviour(_task_behaviour),
      basic(_basic),
      task_valid(false),
-     icon_renderer(settings, look,
-                   _canvas,
-                   projection.GetMapScale() > 4000,
-                   projection.GetScreenAngle()),
-     labels(projection.GetScreenRect())
+     waypoints(GetMaxWaypoints(projection.GetScreenSize())),
+     labels(projection.GetScreenRect(), waypoints.GetMaxSize())
   {
     _tcscpy(altitude_unit, Units::GetAltitudeName());
   }
@@ -296,12 +287,10 @@ protected:
     StringFormatUnsafe(buffer + length, _T("%d%s"), uah_glide, altitude_unit);
   }
 
-  void DrawWaypoint(const VisibleWaypoint &vwp) noexcept {
+  void AddLabel(const VisibleWaypoint &vwp) noexcept {
     const Waypoint &way_point = *vwp.waypoint;
     bool watchedWaypoint = way_point.flags.watched;
 
-    vwp.DrawSymbol(icon_renderer);
-
     // Determine whether to draw the waypoint label or not
     switch (settings.label_selection) {
     case WaypointRendererSettings::LabelSelection::NONE:
@@ -361,16 +350,22 @@ protected:
   }
 
   void AddWaypoint(const WaypointPtr &way_point, bool in_task) noexcept {
-    if (waypoints.full())
+    /* when the list is full, only a waypoint which is more important
+       than the least important one is added (replacing it) */
+    const auto priority = GetPriority(*way_point, in_task);
+    if (!waypoints.Accepts(priority))
       return;
 
     if (!projection.WaypointInScaleFilter(*way_point) && !in_task)
       return;
 
-    if (auto p = projection.GeoToScreenIfVisible(way_point->location)) {
-      VisibleWaypoint &vwp = waypoints.append();
-      vwp.Set(way_point, *p, in_task);
-    }
+    auto p = projection.GeoToScreenIfVisible(way_point->location);
+    if (!p)
+      return;
+
+    waypoints.Add([&](VisibleWaypoint &vwp){
+      vwp.Set(way_point, *p, priority);
+    });
   }
 
 public:
@@ -398,12 +393,45 @@ public:
     task_valid = true;
   }
 
-  void CalculateRoute(const ProtectedRoutePlanner &route_planner) noexcept {
+  void CalculateRoute(const ProtectedRoutePlanner &route_planner,
+                      WaypointReachCache &cache) noexcept {
+    cache.Validate(route_planner.GetReachSerial());
+
+    /* collect all waypoints which are not in the cache, and look them
+       up with one single (batch) call */
+    std::vector<VisibleWaypoint *> pending;
+    std::vector<AGeoPoint> destinations;
+
     for (VisibleWaypoint &vwp : waypoints) {
       const Waypoint &way_point = *vwp.waypoint;
 
-      if (way_point.IsLandable() || way_point.flags.watched)
-        vwp.CalculateReachability(route_planner, task_behaviour);
+      if (!(way_point.IsLandable() || way_point.flags.watched) ||
+          !way_point.has_elevation)
+        continue;
+
+      const double elevation = way_point.elevation +
+        task_behaviour.safety_height_arrival;
+
+      if (const auto *cached = cache.Find(way_point.id, elevation)) {
+        vwp.SetReach(*cached, elevation, task_behaviour);
+      } else {
+        pending.push_back(&vwp);
+        destinations.emplace_back(way_point.location, elevation);
+      }
+    }
+
+    if (pending.empty())
+      return;
+
+    std::vector<ReachResult> results(destinations.size());
+    if (!route_planner.FindPositiveArrivals(destinations, results))
+      return;
+
+    for (std::size_t i = 0; i < pending.size(); ++i) {
+      VisibleWaypoint &vwp = *pending[i];
+      const double elevation = destinations[i].altitude;
+      vwp.SetReach(results[i], elevation, task_behaviour);
+      cache.Put(vwp.waypoint->id, elevation, results[i]);
     }
   }
 
@@ -419,39 +447,82 @@ public:
       : calculated.glide_polar_safety;
     const MacCready mac_cready(task_behaviour.glide, glide_polar);
 
+    /* solve all glides with one batch call */
+    const std::size_t max = waypoints.size();
+    std::vector<VisibleWaypoint *> pending;
+    std::vector<double> distance(max), altitude_difference(max);
+    std::vector<Angle> bearing(max);
+
     for (VisibleWaypoint &vwp : waypoints) {
       const Waypoint &way_point = *vwp.waypoint;
 
-      if (way_point.IsLandable() || way_point.flags.watched)
-        vwp.CalculateReachabilityDirect(basic, calculated.GetWindOrZero(),
-                                        mac_cready, task_behaviour);
+      if (!(way_point.IsLandable() || way_point.flags.watched) ||
+          !way_point.has_elevation)
+        continue;
+
+      const auto elevation = way_point.elevation +
+        task_behaviour.safety_height_arrival;
+
+      /* WGS84, like the other arrival altitudes (e.g. the
+         alternates); the FAI sphere would be off by up to 0.5% */
+      const GeoVector vector(basic.location, way_point.location);
+
+      const std::size_t i = pending.size();
+      distance[i] = vector.distance;
+      bearing[i] = vector.bearing;
+      altitude_difference[i] = basic.nav_altitude - elevation;
+      pending.push_back(&vwp);
     }
+
+    const std::size_t n = pending.size();
+    if (n == 0)
+      return;
+
+    std::vector<double> arrival(n), time_elapsed(n);
+    std::vector<GlideResult::Validity> validity(n);
+    mac_cready.SolveStraight(calculated.GetWindOrZero(),
+                             {distance.data(), n}, {bearing.data(), n},
+                             {altitude_difference.data(), n},
+                             {arrival.data(), n}, {time_elapsed.data(), n},
+                             {validity.data(), n});
+
+    for (std::size_t i = 0; i < n; ++i)
+      if (validity[i] == GlideResult::Validity::OK)
+        pending[i]->SetDirect(arrival[i]);
   }
 
   void Calculate(const ProtectedRoutePlanner *route_planner,
+                 WaypointReachCache &reach_cache,
                  const PolarSettings &polar_settings,
                  const TaskBehaviour &task_behaviour,
                  const DerivedInfo &calculated) noexcept {
     if (route_planner != nullptr && !route_planner->IsTerrainReachEmpty())
-      CalculateRoute(*route_planner);
+      CalculateRoute(*route_planner, reach_cache);
     else
       CalculateDirect(polar_settings, task_behaviour, calculated);
   }
 
-  void Draw() noexcept {
+  void AddLabels() noexcept {
+    for (const VisibleWaypoint &vwp : waypoints)
+      AddLabel(vwp);
+  }
+
+  void DrawSymbols(Canvas &canvas) const noexcept {
+    WaypointIconRenderer icon_renderer(settings, look, canvas,
+                                       projection.GetMapScale() > 4000,
+                                       projection.GetScreenAngle());
+
     for (const VisibleWaypoint &vwp : waypoints)
-      DrawWaypoint(vwp);
+      vwp.DrawSymbol(icon_renderer);
   }
 };
 
 static void
 MapWaypointLabelRender(Canvas &canvas, PixelSize clip_size,
                        LabelBlock &label_block,
-                       WaypointLabelList &labels,
+                       const WaypointLabelList &labels,
                        const WaypointLook &look) noexcept
 {
-  labels.Sort();
-
   for (const auto &l : labels) {
     canvas.Select(l.bold ? *look.bold_font : *look.font);
 
@@ -459,20 +530,29 @@ MapWaypointLabelRender(Canvas &canvas, PixelSize clip_size,
   }
 }
 
+WaypointRenderer::WaypointRenderer(const Waypoints *_way_points,
+                                   const WaypointLook &_look) noexcept
+  :way_points(_way_points), look(_look) {}
+
+WaypointRenderer::~WaypointRenderer() noexcept = default;
+
 void
-WaypointRenderer::Render(Canvas &canvas, LabelBlock &label_block,
-                         const MapWindowProjection &projection,
-                         const struct WaypointRendererSettings &settings,
-                         const PolarSettings &polar_settings,
-                         const TaskBehaviour &task_behaviour,
-                         const MoreData &basic, const DerivedInfo &calculated,
-                         const ProtectedTaskManager *task,
-                         const ProtectedRoutePlanner *route_planner) noexcept
+WaypointRenderer::Prepare(const MapWindowProjection &projection,
+                          const struct WaypointRendererSettings &settings,
+                          const PolarSettings &polar_settings,
+                          const TaskBehaviour &task_behaviour,
+                          const MoreData &basic, const DerivedInfo &calculated,
+                          const ProtectedTaskManager *task,
+                          const ProtectedRoutePlanner *route_planner) noexcept
 {
+  prepared.reset();
+
   if (way_points == nullptr || way_points->IsEmpty())
     return;
 
-  WaypointVisitorMap v(canvas, projection, settings, look, task_behaviour, basic);
+  prepared = std::make_unique<WaypointVisitorMap>(projection, settings, look,
+                                                  task_behaviour, basic);
+  auto &v = *prepared;
 
   if (task != nullptr) {
     ProtectedTaskManager::Lease task_manager(*task);
@@ -493,10 +573,39 @@ WaypointRenderer::Render(Canvas &canvas, LabelBlock &label_block,
                                projection.GetScreenDistanceMeters(),
                                [&v](const auto &w){ v.Add(w); });
 
-  v.Calculate(route_planner, polar_settings, task_behaviour, calculated);
+  v.Calculate(route_planner, reach_cache, polar_settings, task_behaviour,
+              calculated);
 
-  v.Draw();
+  v.AddLabels();
+  v.labels.Sort();
+}
+
+void
+WaypointRenderer::Render(Canvas &canvas, LabelBlock &label_block,
+                         const MapWindowProjection &projection) noexcept
+{
+  if (!prepared)
+    return;
+
+  prepared->DrawSymbols(canvas);
 
   MapWaypointLabelRender(canvas, projection.GetScreenSize(),
-                         label_block, v.labels, look);
+                         label_block, prepared->labels, look);
+
+  prepared.reset();
+}
+
+void
+WaypointRenderer::Render(Canvas &canvas, LabelBlock &label_block,
+                         const MapWindowProjection &projection,
+                         const struct WaypointRendererSettings &settings,
+                         const PolarSettings &polar_settings,
+                         const TaskBehaviour &task_behaviour,
+                         const MoreData &basic, const DerivedInfo &calculated,
+                         const ProtectedTaskManager *task,
+                         const ProtectedRoutePlanner *route_planner) noexcept
+{
+  Prepare(projection, settings, polar_settings, task_behaviour,
+          basic, calculated, task, route_planner);
+  Render(canvas, label_block, projection);
 }
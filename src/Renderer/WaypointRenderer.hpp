@@ -3,8 +3,11 @@
 
 #pragma once
 
+#include "WaypointReachCache.hpp"
 #include "util/NonCopyable.hpp"
 
+#include <memory>
+
 struct WaypointRendererSettings;
 struct WaypointLook;
 class Canvas;
@@ -17,6 +20,7 @@ struct MoreData;
 struct DerivedInfo;
 class ProtectedTaskManager;
 class ProtectedRoutePlanner;
+class WaypointVisitorMap;
 
 /**
  * Renders way point icons and labels into a #Canvas.
@@ -26,10 +30,19 @@ class WaypointRenderer : private NonCopyable {
 
   const WaypointLook &look;
 
+  WaypointReachCache reach_cache;
+
+  /**
+   * The waypoints and labels collected by Prepare(), to be drawn by
+   * Render().
+   */
+  std::unique_ptr<WaypointVisitorMap> prepared;
+
 public:
   WaypointRenderer(const Waypoints *_way_points,
-                   const WaypointLook &_look) noexcept
-    :way_points(_way_points), look(_look) {}
+                   const WaypointLook &_look) noexcept;
+
+  ~WaypointRenderer() noexcept;
 
   const WaypointLook &GetLook() const noexcept {
     return look;
@@ -39,6 +52,29 @@ public:
     way_points = _way_points;
   }
 
+  /**
+   * Collect the visible waypoints, calculate their reachability and
+   * build their labels.  This does not draw anything and may be
+   * called from any thread, but the referenced objects must remain
+   * valid until Render() is called.
+   */
+  void Prepare(const MapWindowProjection &projection,
+               const WaypointRendererSettings &settings,
+               const PolarSettings &polar_settings,
+               const TaskBehaviour &task_behaviour,
+               const MoreData &basic, const DerivedInfo &calculated,
+               const ProtectedTaskManager *task,
+               const ProtectedRoutePlanner *route_planner) noexcept;
+
+  /**
+   * Draw the waypoints collected by the last Prepare() call (if any).
+   */
+  void Render(Canvas &canvas, LabelBlock &label_block,
+              const MapWindowProjection &projection) noexcept;
+
+  /**
+   * Prepare() and Render() in one call.
+   */
   void Render(Canvas &canvas, LabelBlock &label_block,
               const MapWindowProjection &projection,
               const WaypointRendererSettings &settings,
@@ -95,6 +95,11 @@
 #include "lua/Background.hpp"
 
 #include "util/ScopeExit.hxx"
+#include "Job/Graph.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 #ifdef ENABLE_OPENGL
 #include "ui/canvas/opengl/Globals.hpp"
@@ -108,6 +113,11 @@
 #include "Android/NativeView.hpp"
 #endif
 
+/**
+ * The maximum number of threads loading data files at startup.
+ */
+static constexpr unsigned MAX_STARTUP_THREADS = 4;
+
 static TaskManager *task_manager;
 static GlideComputerEvents *glide_computer_events;
 static AllMonitors *all_monitors;
@@ -121,8 +131,17 @@ LoadProfile()
       !dlgStartupShowModal())
     return false;
 
+  const auto t0 = std::chrono::steady_clock::now();
   Profile::Load();
-  Profile::Use(Profile::map);
+  const auto t1 = std::chrono::steady_clock::now();
+  const bool from_snapshot = Profile::UseSnapshot(Profile::map);
+  const auto t2 = std::chrono::steady_clock::now();
+
+  using std::chrono::microseconds, std::chrono::duration_cast;
+  LogFormat("Profile: file parsed in %u us, settings %s in %u us",
+            (unsigned)duration_cast<microseconds>(t1 - t0).count(),
+            from_snapshot ? "loaded from snapshot" : "decoded",
+            (unsigned)duration_cast<microseconds>(t2 - t1).count());
 
   Units::SetConfig(CommonInterface::GetUISettings().format.units);
   SetUserCoordinateFormat(CommonInterface::GetUISettings().format.coordinate_format);
@@ -414,32 +433,58 @@ Startup(UI::Display &display)
                          CommonInterface::SetComputerSettings(), gp);
   task_manager->SetGlidePolar(gp);
 
-  // Read the topography file(s)
-  data_components->topography = std::make_unique<TopographyStore>();
-  {
-    LogString("Loading Topography File...");
-    operation.SetText(_("Loading Topography File..."));
-    LoadConfiguredTopography(*data_components->topography);
-    operation.SetProgressPosition(256);
-  }
+  /* load the data files; most of them are independent of each
+     other, and are loaded concurrently */
+  std::shared_ptr<RaspStore> rasp;
 
-  // Read the waypoint files
-  LogString("ReadWaypoints");
   {
-    SubOperationEnvironment sub_env(operation, 256, 512);
-    sub_env.SetText(_("Loading Waypoints..."));
-    WaypointGlue::LoadWaypoints(*data_components->waypoints,
-                                data_components->terrain.get(),
-                                sub_env);
-  }
+    JobGraph jobs;
+
+    data_components->topography = std::make_unique<TopographyStore>();
+    jobs.Add("topography", 256, [](OperationEnvironment &env){
+      LogString("Loading Topography File...");
+      env.SetText(_("Loading Topography File..."));
+      LoadConfiguredTopography(*data_components->topography);
+    });
+
+    const auto waypoints_job =
+      jobs.Add("waypoints", 256, [](OperationEnvironment &env){
+        LogString("ReadWaypoints");
+        env.SetText(_("Loading Waypoints..."));
+        WaypointGlue::LoadWaypoints(*data_components->waypoints,
+                                    data_components->terrain.get(),
+                                    env);
+      });
+
+    // Read and parse the airfield info file
+    jobs.Add("airfield details", 256, [](OperationEnvironment &env){
+      env.SetText(_("Loading Airfield Details File..."));
+      WaypointDetails::ReadFileFromProfile(*data_components->waypoints, env);
+    }, {waypoints_job});
+
+    // Scan for weather forecast
+    jobs.Add("RASP", 0, [&rasp](OperationEnvironment &){
+      LogString("RASP load");
+      rasp = LoadConfiguredRasp();
+    });
+
+    // Reads the airspace files
+    jobs.Add("airspace", 256, [&computer_settings](OperationEnvironment &env){
+      ReadAirspace(*data_components->airspaces,
+                   computer_settings.pressure,
+                   env);
+    });
 
-  // Read and parse the airfield info file
-  try {
-    SubOperationEnvironment sub_env(operation, 512, 768);
-    sub_env.SetText(_("Loading Airfield Details File..."));
-    WaypointDetails::ReadFileFromProfile(*data_components->waypoints, sub_env);
-  } catch (...) {
-    LogError(std::current_exception());
+#ifdef HAVE_NOAA
+    jobs.Add("NOAA", 0, [](OperationEnvironment &){
+      noaa_store = new NOAAStore();
+      noaa_store->LoadFromProfile();
+    });
+#endif
+
+    SubOperationEnvironment sub_env(operation, 0, 1024);
+    jobs.Run(sub_env, std::min(std::thread::hardware_concurrency(),
+                               MAX_STARTUP_THREADS));
   }
 
   // Set the home waypoint
@@ -454,18 +499,6 @@ Startup(UI::Display &display)
   backend_components->device_blackboard->Merge();
   CommonInterface::ReadBlackboardBasic(backend_components->device_blackboard->Basic());
 
-  // Scan for weather forecast
-  LogString("RASP load");
-  auto rasp = LoadConfiguredRasp();
-
-  // Reads the airspace files
-  {
-    SubOperationEnvironment sub_env(operation, 768, 1024);
-    ReadAirspace(*data_components->airspaces,
-                 computer_settings.pressure,
-                 sub_env);
-  }
-
   if (data_components->terrain)
     SetAirspaceGroundLevels(*data_components->airspaces,
                             *data_components->terrain);
@@ -478,11 +511,6 @@ Startup(UI::Display &display)
     lease->Reset(aircraft_state);
   }
 
-#ifdef HAVE_NOAA
-  noaa_store = new NOAAStore();
-  noaa_store->LoadFromProfile();
-#endif
-
 #ifdef HAVE_VOLUME_CONTROLLER
   volume_controller->SetVolume(ui_settings.sound.master_volume);
 #endif
@@ -57,6 +57,7 @@ ProtectedRoutePlanner::SolveReach(const AGeoPoint &origin,
   const std::scoped_lock lock{reach_mutex};
   reach_terrain = std::move(rt);
   reach_working = std::move(rw);
+  ++reach_serial;
 }
 
 const FlatProjection
@@ -73,6 +74,14 @@ ProtectedRoutePlanner::FindPositiveArrival(const AGeoPoint &dest) const noexcept
   return reach_terrain.FindPositiveArrival(dest, rpolars_reach);
 }
 
+bool
+ProtectedRoutePlanner::FindPositiveArrivals(std::span<const AGeoPoint> dests,
+                                            std::span<ReachResult> results) const noexcept
+{
+  const std::scoped_lock lock{reach_mutex};
+  return reach_terrain.FindPositiveArrivals(dests, rpolars_reach, results);
+}
+
 void
 ProtectedRoutePlanner::AcceptInRange(const GeoBounds &bounds,
                                      FlatTriangleFanVisitor &visitor,
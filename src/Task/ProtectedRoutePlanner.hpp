@@ -7,6 +7,9 @@
 #include "Engine/Route/ReachFan.hpp"
 #include "Engine/Route/RoutePolars.hpp"
 #include "thread/Mutex.hxx"
+#include "util/Serial.hpp"
+
+#include <span>
 
 struct GlideSettings;
 struct RoutePlannerConfig;
@@ -37,6 +40,12 @@ class ProtectedRoutePlanner
   ReachFan reach_terrain;
   ReachFan reach_working;
 
+  /**
+   * Incremented each time the "reach" fields are modified.  Can be
+   * used by callers to invalidate cached arrival heights.
+   */
+  Serial reach_serial;
+
 public:
   ProtectedRoutePlanner(RoutePlannerGlue &route, const Airspaces &_airspaces,
                         const ProtectedAirspaceWarningManager *_warnings) noexcept
@@ -54,6 +63,13 @@ public:
     const std::scoped_lock lock{reach_mutex};
     reach_terrain.Reset();
     reach_working.Reset();
+    ++reach_serial;
+  }
+
+  [[gnu::pure]]
+  Serial GetReachSerial() const noexcept {
+    const std::scoped_lock lock{reach_mutex};
+    return reach_serial;
   }
 
   [[gnu::pure]]
@@ -83,6 +99,15 @@ public:
   [[gnu::pure]]
   std::optional<ReachResult> FindPositiveArrival(const AGeoPoint &dest) const noexcept;
 
+  /**
+   * Find the arrival heights for many destinations, with only one
+   * mutex lock and one traversal of the terrain reach fan.
+   *
+   * @return false if there is no terrain reach
+   */
+  bool FindPositiveArrivals(std::span<const AGeoPoint> dests,
+                            std::span<ReachResult> results) const noexcept;
+
   void AcceptInRange(const GeoBounds &bounds,
                      FlatTriangleFanVisitor &visitor,
                      bool working) const noexcept;
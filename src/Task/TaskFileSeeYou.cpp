@@ -23,6 +23,7 @@
 #include "util/DecimalParser.hxx"
 #include "util/IterableSplitString.hxx"
 #include "util/NumberParser.hxx"
+#include "util/StringCompare.hxx"
 
 #include <stdlib.h>
 
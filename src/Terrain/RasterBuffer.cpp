@@ -16,6 +16,33 @@ RasterBuffer::Resize(RasterLocation _size) noexcept
   data.GrowDiscard(_size.x, _size.y);
 }
 
+void
+RasterBuffer::Interpolate(const RasterBuffer &a, const RasterBuffer &b,
+                          unsigned ratio) noexcept
+{
+  assert(a.IsDefined());
+  assert(a.GetSize() == b.GetSize());
+  assert(ratio <= 0x100);
+
+  Resize(a.GetSize());
+
+  const bool nearer_b = ratio >= 0x80;
+  const int weight_b = ratio, weight_a = 0x100 - weight_b;
+
+  const TerrainHeight *gcc_restrict src_a = a.GetData();
+  const TerrainHeight *gcc_restrict src_b = b.GetData();
+  TerrainHeight *gcc_restrict dest = GetData();
+
+  for (const auto *end = src_a + a.GetSize().Area(); src_a != end;
+       ++src_a, ++src_b, ++dest) {
+    if (src_a->IsSpecial() || src_b->IsSpecial())
+      *dest = nearer_b ? *src_b : *src_a;
+    else
+      *dest = TerrainHeight((src_a->GetValue() * weight_a +
+                             src_b->GetValue() * weight_b) >> 8);
+  }
+}
+
 TerrainHeight
 RasterBuffer::GetInterpolated(unsigned lx, unsigned ly,
                               unsigned ix, unsigned iy) const noexcept
@@ -9,6 +9,8 @@
 #include "util/AllocatedGrid.hxx"
 #include "util/Compiler.h"
 
+#include <cstddef>
+
 class RasterBuffer {
   AllocatedGrid<TerrainHeight> data;
 
@@ -50,6 +52,25 @@ public:
 
   void Resize(RasterLocation _size) noexcept;
 
+  /**
+   * Returns the number of bytes allocated for the height values.
+   */
+  [[gnu::pure]]
+  std::size_t GetMemoryUsage() const noexcept {
+    return std::size_t(data.GetWidth()) * data.GetHeight()
+      * sizeof(TerrainHeight);
+  }
+
+  /**
+   * Fill this buffer with a linear interpolation between two buffers
+   * of the same size.  Where one of them has a special value
+   * (invalid or water), the nearer one is copied.
+   *
+   * @param ratio the weight of #b (0..256)
+   */
+  void Interpolate(const RasterBuffer &a, const RasterBuffer &b,
+                   unsigned ratio) noexcept;
+
   [[gnu::pure]]
   TerrainHeight GetInterpolated(unsigned lx, unsigned ly,
                                 unsigned ix, unsigned iy) const noexcept;
@@ -21,6 +21,18 @@ RasterMap::LoadCache(BufferedReader &r)
   UpdateProjection();
 }
 
+bool
+RasterMap::Interpolate(const RasterMap &a, const RasterMap &b,
+                       unsigned ratio) noexcept
+{
+  if (!raster_tile_cache.Interpolate(a.raster_tile_cache,
+                                     b.raster_tile_cache, ratio))
+    return false;
+
+  UpdateProjection();
+  return true;
+}
+
 TerrainHeight
 RasterMap::GetHeight(const GeoPoint &location) const noexcept
 {
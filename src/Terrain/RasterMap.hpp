@@ -37,6 +37,28 @@ public:
    */
   void LoadCache(BufferedReader &r);
 
+  /**
+   * Fill this map with a linear interpolation between two maps with
+   * the same geometry.
+   *
+   * @param ratio the weight of #b (0..256)
+   * @return false if the geometries of #a and #b differ
+   *
+   * @see RasterTileCache::Interpolate()
+   */
+  bool Interpolate(const RasterMap &a, const RasterMap &b,
+                   unsigned ratio) noexcept;
+
+  /**
+   * Returns the approximate number of bytes occupied by this object
+   * and its buffers.
+   */
+  [[gnu::pure]]
+  std::size_t GetMemoryUsage() const noexcept {
+    return sizeof(*this) - sizeof(raster_tile_cache)
+      + raster_tile_cache.GetMemoryUsage();
+  }
+
   bool IsDefined() const noexcept {
     return raster_tile_cache.IsValid();
   }
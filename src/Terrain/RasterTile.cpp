@@ -8,6 +8,7 @@
 #include "util/SpanCast.hxx"
 
 #include <algorithm>
+#include <cassert>
 
 #include <stdlib.h>
 
@@ -49,6 +50,22 @@ RasterTile::CopyFrom(const struct jas_matrix &m) noexcept
   }
 }
 
+void
+RasterTile::Interpolate(const RasterTile &a, const RasterTile &b,
+                        unsigned ratio) noexcept
+{
+  assert(a.start == b.start);
+  assert(a.end == b.end);
+
+  Set(a.start, a.end);
+  request = false;
+
+  if (a.IsLoaded() && b.IsLoaded())
+    buffer.Interpolate(a.buffer, b.buffer, ratio);
+  else
+    buffer.Reset();
+}
+
 TerrainHeight
 RasterTile::GetHeight(RasterLocation p) const noexcept
 {
@@ -87,6 +87,16 @@ public:
 
   void CopyFrom(const struct jas_matrix &m) noexcept;
 
+  /**
+   * Copy the geometry of tile #a, and interpolate the height values
+   * of #a and #b (which must have the same geometry) if both are
+   * loaded.
+   *
+   * @param ratio the weight of #b (0..256)
+   */
+  void Interpolate(const RasterTile &a, const RasterTile &b,
+                   unsigned ratio) noexcept;
+
   /**
    * Determine the non-interpolated height at the specified pixel
    * location.
@@ -221,6 +221,52 @@ RasterTileCache::Reset() noexcept
     i.Unload();
 }
 
+bool
+RasterTileCache::Interpolate(const RasterTileCache &a,
+                             const RasterTileCache &b,
+                             unsigned ratio) noexcept
+{
+  if (!a.IsValid() || !b.IsValid() ||
+      a.size != b.size || a.tile_size != b.tile_size ||
+      a.tiles.GetWidth() != b.tiles.GetWidth() ||
+      a.tiles.GetHeight() != b.tiles.GetHeight() ||
+      a.overview.GetSize() != b.overview.GetSize())
+    return false;
+
+  for (unsigned i = 0; i < a.tiles.GetSize(); ++i) {
+    const auto &ta = a.tiles.GetLinear(i), &tb = b.tiles.GetLinear(i);
+    if (ta.start != tb.start || ta.end != tb.end)
+      return false;
+  }
+
+  Reset();
+  SetSize({a.size.x, a.size.y}, a.tile_size,
+          {a.tiles.GetWidth(), a.tiles.GetHeight()});
+  bounds = a.bounds;
+
+  for (unsigned i = 0; i < tiles.GetSize(); ++i)
+    tiles.GetLinear(i).Interpolate(a.tiles.GetLinear(i),
+                                   b.tiles.GetLinear(i), ratio);
+
+  overview.Interpolate(a.overview, b.overview, ratio);
+
+  dirty = false;
+  ++serial;
+  return true;
+}
+
+std::size_t
+RasterTileCache::GetMemoryUsage() const noexcept
+{
+  std::size_t result = sizeof(*this) + overview.GetMemoryUsage() +
+    tiles.GetSize() * sizeof(RasterTile);
+
+  for (const auto &tile : tiles)
+    result += tile.buffer.GetMemoryUsage();
+
+  return result;
+}
+
 const RasterTileCache::MarkerSegmentInfo *
 RasterTileCache::FindMarkerSegment(uint32_t file_offset) const noexcept
 {
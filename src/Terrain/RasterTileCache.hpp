@@ -11,6 +11,7 @@
 #include "util/Serial.hpp"
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 
@@ -206,6 +207,26 @@ public:
    */
   void LoadCache(BufferedReader &r);
 
+  /**
+   * Fill this object with a linear interpolation between two maps
+   * with the same geometry, e.g. two forecast times of the same RASP
+   * parameter.  Only the overview and the loaded tiles are
+   * interpolated; the marker segments are not copied, so
+   * UpdateTiles() cannot be used on the result.
+   *
+   * @param ratio the weight of #b (0..256)
+   * @return false if the geometries of #a and #b differ
+   */
+  bool Interpolate(const RasterTileCache &a, const RasterTileCache &b,
+                   unsigned ratio) noexcept;
+
+  /**
+   * Returns the approximate number of bytes occupied by this object
+   * and its buffers.
+   */
+  [[gnu::pure]]
+  std::size_t GetMemoryUsage() const noexcept;
+
   /**
    * Determines if there are still tiles scheduled to be loaded.  Call
    * this after UpdateTiles() to determine if UpdateTiles() should be
@@ -184,6 +184,7 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 #else // !ENABLE_OPENGL
   const GeoClip clip(projection.GetScreenBounds().Scale(1.1));
   AllocatedArray<GeoPoint> geo_points;
+  AllocatedArray<PixelPoint> pixel_points;
 
   const unsigned iskip = file.GetSkipSteps(map_scale);
 #endif
@@ -236,12 +237,15 @@ TopographyFileRenderer::Paint(Canvas &canvas,
         for (unsigned msize : lines) {
         shape_renderer.Begin(msize);
 
-        const GeoPoint *end = points + msize - 1;
-        for (; points < end; ++points)
-          shape_renderer.AddPointIfDistant(projection.GeoToScreen(*points));
+        pixel_points.GrowDiscard(msize);
+        projection.GeoToScreen({points, msize}, pixel_points.data());
+        points += msize;
+
+        for (unsigned i = 0; i < msize - 1; ++i)
+          shape_renderer.AddPointIfDistant(pixel_points[i]);
 
         // make sure we always draw the last point
-        shape_renderer.AddPoint(projection.GeoToScreen(*points));
+        shape_renderer.AddPoint(pixel_points[msize - 1]);
 
         shape_renderer.FinishPolyline(canvas);
       }
@@ -294,10 +298,12 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 
           shape_renderer.Begin(msize);
 
-          for (unsigned i = 0; i < msize; ++i) {
-            GeoPoint g = geo_points[i];
-            shape_renderer.AddPointIfDistant(projection.GeoToScreen(g));
-          }
+          pixel_points.GrowDiscard(msize);
+          projection.GeoToScreen({geo_points.data(), msize},
+                                 pixel_points.data());
+
+          for (unsigned i = 0; i < msize; ++i)
+            shape_renderer.AddPointIfDistant(pixel_points[i]);
 
           shape_renderer.FinishPolygon(canvas);
 
@@ -344,39 +350,18 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 }
 
 void
-TopographyFileRenderer::PaintLabels(Canvas &canvas,
-                                    const WindowProjection &projection,
-                                    LabelBlock &label_block) noexcept
+TopographyFileRenderer::UpdateLabelAnchors(const WindowProjection &projection) noexcept
 {
-  const std::lock_guard lock{file.mutex};
-
-  const auto map_scale = projection.GetMapScale();
-  if (!file.IsVisible(map_scale) || !file.IsLabelVisible(map_scale))
-    return;
-
-  UpdateVisibleShapes(projection);
-
-  if (visible_labels.empty())
-    return;
-
-  canvas.Select(file.IsLabelImportant(map_scale)
-                ? look.important_label_font
-                : look.regular_label_font);
-  canvas.SetTextColor(file.IsLabelImportant(map_scale) ?
-                COLOR_BLACK : COLOR_VERY_DARK_GRAY);
-  canvas.SetBackgroundTransparent();
+  label_anchors_serial = file.GetSerial();
+  label_anchors_valid = true;
+  label_anchors.clear();
 
-  // get drawing info
-
-  int iskip = file.GetSkipSteps(map_scale);
-
-  std::set<tstring> drawn_labels;
+  const int iskip = file.GetSkipSteps(projection.GetMapScale());
+  const PixelSize screen_size = projection.GetScreenSize();
 
-  // Iterate over all shapes in the file
   for (const XShape *shape_p : visible_labels) {
     const XShape &shape = *shape_p;
 
-    // Skip shapes without a label
     const TCHAR *label = shape.GetLabel();
     assert(label != nullptr);
 
@@ -384,8 +369,8 @@ TopographyFileRenderer::PaintLabels(Canvas &canvas,
     const auto *points = shape.GetPoints();
 
     for (const unsigned n : lines) {
-      int minx = canvas.GetWidth();
-      int miny = canvas.GetHeight();
+      int minx = screen_size.width;
+      int miny = screen_size.height;
 
       const auto *end = points + n;
       for (; points < end; points += iskip) {
@@ -403,23 +388,74 @@ TopographyFileRenderer::PaintLabels(Canvas &canvas,
 
       points = end;
 
-      minx += 2;
-      miny += 2;
+      label_anchors.push_back({label, {minx + 2, miny + 2}});
+    }
+  }
+}
 
-      PixelSize tsize = canvas.CalcTextSize(label);
-      PixelRect brect;
-      brect.left = minx;
-      brect.right = brect.left + tsize.width;
-      brect.top = miny;
-      brect.bottom = brect.top + tsize.height;
+void
+TopographyFileRenderer::Prepare(const WindowProjection &projection) noexcept
+{
+  const std::lock_guard lock{file.mutex};
 
-      if (!label_block.check(brect))
-        continue;
+  label_anchors_valid = false;
 
-      if (!drawn_labels.insert(label).second)
-        continue;
+  const auto map_scale = projection.GetMapScale();
+  if (!file.IsVisible(map_scale))
+    return;
 
-      canvas.DrawText({minx, miny}, label);
-    }
+  UpdateVisibleShapes(projection);
+
+  if (file.IsLabelVisible(map_scale))
+    UpdateLabelAnchors(projection);
+}
+
+void
+TopographyFileRenderer::PaintLabels(Canvas &canvas,
+                                    const WindowProjection &projection,
+                                    LabelBlock &label_block) noexcept
+{
+  const std::lock_guard lock{file.mutex};
+
+  const auto map_scale = projection.GetMapScale();
+  if (!file.IsVisible(map_scale) || !file.IsLabelVisible(map_scale))
+    return;
+
+  /* use the anchors calculated by Prepare() unless the file has been
+     modified since then */
+  if (!label_anchors_valid || label_anchors_serial != file.GetSerial()) {
+    UpdateVisibleShapes(projection);
+    UpdateLabelAnchors(projection);
+  }
+
+  label_anchors_valid = false;
+
+  if (label_anchors.empty())
+    return;
+
+  canvas.Select(file.IsLabelImportant(map_scale)
+                ? look.important_label_font
+                : look.regular_label_font);
+  canvas.SetTextColor(file.IsLabelImportant(map_scale) ?
+                COLOR_BLACK : COLOR_VERY_DARK_GRAY);
+  canvas.SetBackgroundTransparent();
+
+  std::set<tstring> drawn_labels;
+
+  for (const auto &anchor : label_anchors) {
+    PixelSize tsize = canvas.CalcTextSize(anchor.label);
+    PixelRect brect;
+    brect.left = anchor.position.x;
+    brect.right = brect.left + tsize.width;
+    brect.top = anchor.position.y;
+    brect.bottom = brect.top + tsize.height;
+
+    if (!label_block.check(brect))
+      continue;
+
+    if (!drawn_labels.insert(anchor.label).second)
+      continue;
+
+    canvas.DrawText(anchor.position, anchor.label);
   }
 }
@@ -7,6 +7,7 @@
 #include "ui/canvas/Icon.hpp"
 #include "util/Serial.hpp"
 #include "Geo/GeoBounds.hpp"
+#include "ui/dim/Point.hpp"
 
 #ifdef ENABLE_OPENGL
 #else
@@ -17,6 +18,8 @@
 #include <memory>
 #include <vector>
 
+#include <tchar.h>
+
 class TopographyFile;
 class Canvas;
 class GLArrayBuffer;
@@ -54,6 +57,28 @@ class TopographyFileRenderer final
 
   std::vector<GeoPoint> visible_points;
 
+  /**
+   * The screen position of a label (one per line of a labelled
+   * shape), calculated by UpdateLabelAnchors().
+   */
+  struct LabelAnchor {
+    const TCHAR *label;
+    PixelPoint position;
+  };
+
+  std::vector<LabelAnchor> label_anchors;
+
+  /**
+   * The file serial #label_anchors were calculated for.
+   */
+  Serial label_anchors_serial;
+
+  /**
+   * Have #label_anchors been calculated by Prepare() for the current
+   * frame?  PaintLabels() clears this flag.
+   */
+  bool label_anchors_valid = false;
+
 #ifdef ENABLE_OPENGL
   std::unique_ptr<GLArrayBuffer> array_buffer;
   Serial array_buffer_serial;
@@ -67,6 +92,13 @@ public:
 
   ~TopographyFileRenderer() noexcept;
 
+  /**
+   * Determine the visible shapes and the label positions for the
+   * following Paint() and PaintLabels() calls.  This does not draw
+   * anything and may be called from any thread.
+   */
+  void Prepare(const WindowProjection &projection) noexcept;
+
   /**
    * Paints the polygons, lines and points/icons in the TopographyFile
    * @param canvas The canvas to paint on
@@ -88,6 +120,8 @@ public:
 private:
   void UpdateVisibleShapes(const WindowProjection &projection) noexcept;
 
+  void UpdateLabelAnchors(const WindowProjection &projection) noexcept;
+
 #ifdef ENABLE_OPENGL
   void UpdateArrayBuffer() noexcept;
 #endif
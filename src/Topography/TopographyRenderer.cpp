@@ -17,6 +17,13 @@ TopographyRenderer::TopographyRenderer(const TopographyStore &_store,
 
 TopographyRenderer::~TopographyRenderer() noexcept = default;
 
+void
+TopographyRenderer::Prepare(const WindowProjection &projection) noexcept
+{
+  for (auto &i : files)
+    i.Prepare(projection);
+}
+
 void
 TopographyRenderer::Draw(Canvas &canvas,
                          const WindowProjection &projection) noexcept
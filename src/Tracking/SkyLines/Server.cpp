@@ -10,13 +10,32 @@
 #include "net/UniqueSocketDescriptor.hxx"
 #include "util/CRC16CCITT.hpp"
 
+#include <stdexcept>
+
+#ifdef __linux__
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#endif
+
 static UniqueSocketDescriptor
-CreateBindUDP(SocketAddress address)
+CreateBindUDP(SocketAddress address, bool reuse_port)
 {
   UniqueSocketDescriptor s;
   if (!s.Create(address.GetFamily(), SOCK_DGRAM, 0))
     throw MakeSocketError("Failed to create socket");
 
+  if (reuse_port) {
+#ifdef __linux__
+    if (!s.SetReusePort())
+      throw MakeSocketError("Failed to set SO_REUSEPORT");
+#else
+    throw std::runtime_error("SO_REUSEPORT not supported");
+#endif
+  }
+
   if (!s.Bind(address))
     throw MakeSocketError("Failed to connect socket");
 
@@ -25,10 +44,100 @@ CreateBindUDP(SocketAddress address)
 
 namespace SkyLinesTracking {
 
+#ifdef __linux__
+
+struct Server::Batch {
+  /**
+   * The maximum number of datagrams received with one recvmmsg()
+   * call.
+   */
+  static constexpr std::size_t MAX_RECEIVE = 32;
+
+  /**
+   * The maximum number of datagrams sent with one sendmmsg() call.
+   */
+  static constexpr std::size_t MAX_SEND = 64;
+
+  static constexpr std::size_t MAX_RECEIVE_SIZE = 4096;
+
+  /**
+   * Large enough for all responses generated by xcsoar-cloud
+   * (traffic/thermal responses carry up to 1 kB of payload); larger
+   * datagrams bypass the queue.
+   */
+  static constexpr std::size_t MAX_SEND_SIZE = 1536;
+
+  struct Receive {
+    StaticSocketAddress address;
+    struct iovec iov;
+    alignas(uint64_t) std::byte buffer[MAX_RECEIVE_SIZE];
+  };
+
+  struct Send {
+    StaticSocketAddress address;
+    struct iovec iov;
+    alignas(uint64_t) std::byte buffer[MAX_SEND_SIZE];
+  };
+
+  std::array<Receive, MAX_RECEIVE> receive;
+  std::array<struct mmsghdr, MAX_RECEIVE> receive_msgs;
+
+  std::array<Send, MAX_SEND> send;
+  std::array<struct mmsghdr, MAX_SEND> send_msgs;
+  std::size_t n_send = 0;
+
+  Batch() noexcept {
+    for (std::size_t i = 0; i < MAX_RECEIVE; ++i) {
+      auto &r = receive[i];
+      r.iov = {r.buffer, sizeof(r.buffer)};
+
+      auto &msg = receive_msgs[i];
+      msg = {};
+      msg.msg_hdr.msg_name = r.address;
+      msg.msg_hdr.msg_iov = &r.iov;
+      msg.msg_hdr.msg_iovlen = 1;
+    }
+
+    for (std::size_t i = 0; i < MAX_SEND; ++i) {
+      auto &s = send[i];
+      s.iov.iov_base = s.buffer;
+
+      auto &msg = send_msgs[i];
+      msg = {};
+      msg.msg_hdr.msg_name = s.address;
+      msg.msg_hdr.msg_iov = &s.iov;
+      msg.msg_hdr.msg_iovlen = 1;
+    }
+  }
+
+  bool IsSendQueueFull() const noexcept {
+    return n_send == MAX_SEND;
+  }
+
+  void Queue(SocketAddress address,
+             std::span<const std::byte> buffer) noexcept {
+    assert(n_send < MAX_SEND);
+    assert(buffer.size() <= MAX_SEND_SIZE);
+
+    auto &s = send[n_send];
+    s.address = address;
+    std::memcpy(s.buffer, buffer.data(), buffer.size());
+    s.iov.iov_len = buffer.size();
+    send_msgs[n_send].msg_hdr.msg_namelen = s.address.GetSize();
+    ++n_send;
+  }
+};
+
+#endif
+
 Server::Server(EventLoop &event_loop,
-               SocketAddress server_address)
+               SocketAddress server_address, bool reuse_port)
   :socket(event_loop, BIND_THIS_METHOD(OnSocketReady),
-          CreateBindUDP(server_address).Release())
+          CreateBindUDP(server_address, reuse_port).Release())
+#ifdef __linux__
+  , batch(std::make_unique<Batch>()),
+   flush_event(event_loop, BIND_THIS_METHOD(FlushSendQueue))
+#endif
 {
   socket.ScheduleRead();
 }
@@ -42,8 +151,19 @@ void
 Server::SendBuffer(SocketAddress address,
                    std::span<const std::byte> buffer) noexcept
 {
+#ifdef __linux__
+  if (buffer.size() <= Batch::MAX_SEND_SIZE) {
+    if (batch->IsSendQueueFull())
+      FlushSendQueue();
+
+    batch->Queue(address, buffer);
+    flush_event.Schedule();
+    return;
+  }
+#endif
+
   try {
-    ssize_t nbytes = socket.GetSocket().WriteNoWait(buffer);
+    ssize_t nbytes = socket.GetSocket().WriteNoWait(buffer, address);
     if (nbytes < 0)
       throw MakeSocketError("Failed to send");
   } catch (...) {
@@ -51,6 +171,34 @@ Server::SendBuffer(SocketAddress address,
   }
 }
 
+void
+Server::FlushSendQueue() noexcept
+{
+#ifdef __linux__
+  flush_event.Cancel();
+
+  const int fd = socket.GetSocket().Get();
+  const std::size_t n = batch->n_send;
+  batch->n_send = 0;
+
+  for (std::size_t i = 0; i < n;) {
+    int result = sendmmsg(fd, &batch->send_msgs[i], n - i,
+                          MSG_DONTWAIT|MSG_NOSIGNAL);
+    if (result > 0) {
+      i += result;
+      continue;
+    }
+
+    /* the datagram at position "i" has failed; report it and
+       continue with the next one, just like individual sendto()
+       calls would */
+    OnSendError(batch->send[i].address,
+                std::make_exception_ptr(MakeSocketError("Failed to send")));
+    ++i;
+  }
+#endif
+}
+
 void
 Server::OnPing(const Client &client, unsigned id)
 {
@@ -162,11 +310,51 @@ Server::OnDatagramReceived(Client &&client,
   }
 }
 
+#ifdef __linux__
+
+inline void
+Server::ReceiveBatch()
+{
+  auto &receive = batch->receive;
+  auto &msgs = batch->receive_msgs;
+
+  for (std::size_t i = 0; i < msgs.size(); ++i)
+    msgs[i].msg_hdr.msg_namelen = receive[i].address.GetCapacity();
+
+  int n = recvmmsg(socket.GetSocket().Get(), msgs.data(), msgs.size(),
+                   MSG_DONTWAIT, nullptr);
+  if (n < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      return;
+
+    throw MakeSocketError("Failed to receive");
+  }
+
+  for (int i = 0; i < n; ++i) {
+    if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC)
+      /* too large, can't be a valid packet */
+      continue;
+
+    receive[i].address.SetSize(msgs[i].msg_hdr.msg_namelen);
+
+    Client client;
+    client.address = receive[i].address;
+
+    OnDatagramReceived(std::move(client), receive[i].buffer, msgs[i].msg_len);
+  }
+}
+
+#endif
+
 void
 Server::OnSocketReady(unsigned) noexcept
 try {
-  // TODO: use recvmmsg() on Linux
+#ifdef __linux__
+  ReceiveBatch();
 
+  /* submit all responses to this batch with one system call */
+  FlushSendQueue();
+#else
   Client client;
   socklen_t address_size = sizeof(client.address);
   char buffer[4096];
@@ -181,7 +369,12 @@ try {
   // TODO: set client.key
 
   OnDatagramReceived(std::move(client), buffer, nbytes);
+#endif
 } catch (...) {
+#ifdef __linux__
+  flush_event.Cancel();
+  batch->n_send = 0;
+#endif
   socket.Close();
   OnError(std::current_exception());
 }
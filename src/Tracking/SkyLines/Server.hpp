@@ -4,12 +4,14 @@
 #pragma once
 
 #include "event/SocketEvent.hxx"
+#include "event/DeferEvent.hxx"
 #include "net/StaticSocketAddress.hxx"
 #include "util/SpanCast.hxx"
 
 #include <chrono>
 #include <cstdint>
 #include <exception>
+#include <memory>
 #include <span>
 
 struct GeoPoint;
@@ -25,6 +27,20 @@ namespace SkyLinesTracking {
 class Server {
   SocketEvent socket;
 
+#ifdef __linux__
+  /**
+   * Buffers for recvmmsg() and sendmmsg(), see Server.cpp.
+   */
+  struct Batch;
+  const std::unique_ptr<Batch> batch;
+
+  /**
+   * Sends the datagrams queued by SendBuffer() at the end of the
+   * current #EventLoop iteration.
+   */
+  DeferEvent flush_event;
+#endif
+
 public:
   struct Client {
     StaticSocketAddress address;
@@ -32,7 +48,15 @@ public:
   };
 
 public:
-  Server(EventLoop &event_loop, SocketAddress server_address);
+  /**
+   * Throws on error.
+   *
+   * @param reuse_port set SO_REUSEPORT, which allows binding several
+   * sockets (e.g. one per thread) to the same address; the kernel
+   * then distributes incoming datagrams among them (Linux only)
+   */
+  Server(EventLoop &event_loop, SocketAddress server_address,
+         bool reuse_port=false);
 
   ~Server();
 
@@ -50,9 +74,20 @@ public:
     return socket.GetEventLoop();
   }
 
+  /**
+   * Send a datagram to the specified client.  On Linux, it is only
+   * copied to a queue which gets submitted with one sendmmsg() call
+   * at the end of the current #EventLoop iteration (or when it is
+   * full).
+   */
   void SendBuffer(SocketAddress address,
                   std::span<const std::byte> buffer) noexcept;
 
+  /**
+   * Send all datagrams queued by SendBuffer() now.
+   */
+  void FlushSendQueue() noexcept;
+
   template<typename P>
   void SendPacket(SocketAddress address, const P &packet) noexcept {
     SendBuffer(address, ReferenceAsBytes(packet));
@@ -62,6 +97,10 @@ private:
   void OnDatagramReceived(Client &&client, void *data, size_t length);
   void OnSocketReady(unsigned events) noexcept;
 
+#ifdef __linux__
+  void ReceiveBatch();
+#endif
+
 protected:
   virtual void OnPing(const Client &client, unsigned id);
 
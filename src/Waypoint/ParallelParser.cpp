@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ParallelParser.hpp"
+#include "Engine/Waypoint/Waypoint.hpp"
+#include "thread/Thread.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <forward_list>
+#include <iterator>
+
+std::vector<std::string_view>
+SplitWaypointFile(std::string_view contents, unsigned n, bool csv) noexcept
+{
+  std::vector<std::string_view> chunks;
+
+  const std::size_t chunk_size = contents.size() / std::max(n, 1U);
+
+  std::size_t start = 0, next_boundary = chunk_size;
+
+  /* the CSV state machine follows ReadCsvRecord(): a field is quoted
+     only if its first non-blank character is a double quote, and a
+     doubled quote inside it is an escaped quote */
+  bool field_start = true, quoted = false;
+
+  for (std::size_t i = 0; i < contents.size() && chunks.size() + 1 < n; ++i) {
+    const char ch = contents[i];
+
+    if (csv) {
+      if (quoted) {
+        if (ch == '"') {
+          if (i + 1 < contents.size() && contents[i + 1] == '"')
+            ++i;
+          else
+            quoted = false;
+        }
+
+        continue;
+      }
+
+      if (field_start && ch != ' ') {
+        field_start = false;
+        if (ch == '"') {
+          quoted = true;
+          continue;
+        }
+      }
+
+      if (ch == ',')
+        field_start = true;
+    }
+
+    if (ch != '\n')
+      continue;
+
+    field_start = true;
+
+    if (i + 1 >= next_boundary) {
+      chunks.push_back(contents.substr(start, i + 1 - start));
+      start = i + 1;
+      next_boundary = start + chunk_size;
+    }
+  }
+
+  if (start < contents.size() || chunks.empty())
+    chunks.push_back(contents.substr(start));
+
+  return chunks;
+}
+
+namespace {
+
+struct WaypointChunkJob {
+  std::vector<Waypoint> waypoints;
+  std::exception_ptr error;
+  bool end = false;
+
+  void Run(const WaypointChunkParser &parser, std::size_t i,
+           std::string_view chunk) noexcept {
+    try {
+      end = parser(i, chunk, waypoints);
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+};
+
+class WaypointChunkThread final : public Thread {
+  const WaypointChunkParser &parser;
+  const std::size_t index;
+  const std::string_view chunk;
+  WaypointChunkJob &job;
+
+public:
+  WaypointChunkThread(const WaypointChunkParser &_parser, std::size_t _index,
+                      std::string_view _chunk, WaypointChunkJob &_job) noexcept
+    :Thread("WaypointParser"),
+     parser(_parser), index(_index), chunk(_chunk), job(_job) {}
+
+protected:
+  void Run() noexcept override {
+    job.Run(parser, index, chunk);
+  }
+};
+
+} // anonymous namespace
+
+void
+ParseWaypointChunks(std::span<const std::string_view> chunks,
+                    const WaypointChunkParser &parser,
+                    std::vector<Waypoint> &dest)
+{
+  if (chunks.empty())
+    return;
+
+  std::vector<WaypointChunkJob> jobs(chunks.size());
+
+  /* the first chunk is parsed by the calling thread, all others by
+     new threads */
+  std::forward_list<WaypointChunkThread> threads;
+  for (std::size_t i = 1; i < chunks.size(); ++i) {
+    auto &thread = threads.emplace_front(parser, i, chunks[i], jobs[i]);
+    try {
+      thread.Start();
+    } catch (...) {
+      /* fall back to parsing it in this thread */
+      threads.pop_front();
+      jobs[i].Run(parser, i, chunks[i]);
+    }
+  }
+
+  jobs.front().Run(parser, 0, chunks.front());
+
+  for (auto &thread : threads)
+    thread.Join();
+
+  std::size_t size = dest.size();
+  for (const auto &job : jobs)
+    size += job.waypoints.size();
+  dest.reserve(size);
+
+  for (auto &job : jobs) {
+    if (job.error)
+      std::rethrow_exception(job.error);
+
+    dest.insert(dest.end(),
+                std::make_move_iterator(job.waypoints.begin()),
+                std::make_move_iterator(job.waypoints.end()));
+
+    if (job.end)
+      break;
+  }
+}
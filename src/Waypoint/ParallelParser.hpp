@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+struct Waypoint;
+
+/**
+ * Split the contents of a waypoint file into at most #n chunks of
+ * roughly equal size, each consisting of whole lines.
+ *
+ * @param csv if true, line breaks inside quoted CSV fields are not
+ * considered as chunk boundaries
+ */
+std::vector<std::string_view>
+SplitWaypointFile(std::string_view contents, unsigned n, bool csv) noexcept;
+
+/**
+ * Parses one chunk (the second parameter) into the given list.  The
+ * first parameter is the index of the chunk.
+ *
+ * @return true if this chunk contains the end of the waypoint
+ * section, i.e. all following chunks shall be ignored
+ */
+using WaypointChunkParser =
+  std::function<bool(std::size_t, std::string_view, std::vector<Waypoint> &)>;
+
+/**
+ * Invoke the parser for each chunk, each in its own thread, and
+ * append the results to #dest in the order of the chunks, which
+ * gives the same list as parsing the chunks one after the other.
+ *
+ * Throws the first exception thrown by a parser (ignoring those
+ * thrown for chunks after the end of the waypoint section).
+ */
+void
+ParseWaypointChunks(std::span<const std::string_view> chunks,
+                    const WaypointChunkParser &parser,
+                    std::vector<Waypoint> &dest);
@@ -14,6 +14,7 @@
 #include "io/ProgressReader.hpp"
 #include "io/StringConverter.hpp"
 #include "Operation/ProgressListener.hpp"
+#include "util/StringCompare.hxx"
 
 namespace WaypointDetails {
 
@@ -3,6 +3,7 @@
 
 #include "WaypointList.hpp"
 #include "Waypoint/Waypoint.hpp"
+#include "Geo/SimplifiedMath.hpp"
 
 #include <algorithm>
 
@@ -24,6 +25,25 @@ WaypointListItem::GetVector(const GeoPoint &location) const noexcept
 void
 WaypointList::SortByDistance(const GeoPoint &location) noexcept
 {
+  const std::size_t n = size();
+
+  /* calculate all vectors with one bulk call (FAI sphere); they are
+     cached, so the displayed distances match the order */
+  std::vector<double> latitudes, longitudes, distances(n);
+  std::vector<Angle> bearings(n);
+  latitudes.reserve(n);
+  longitudes.reserve(n);
+  for (const auto &i : *this) {
+    latitudes.push_back(i.waypoint->location.latitude.Radians());
+    longitudes.push_back(i.waypoint->location.longitude.Radians());
+  }
+
+  DistanceBearingS(location, latitudes, longitudes,
+                   distances.data(), bearings.data());
+
+  for (std::size_t i = 0; i < n; ++i)
+    (*this)[i].SetVector(GeoVector(distances[i], bearings[i]));
+
   std::sort(begin(), end(), [location](const auto &a, const auto &b){
     return a.GetVector(location).distance < b.GetVector(location).distance;
   });
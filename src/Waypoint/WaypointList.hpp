@@ -26,6 +26,10 @@ public:
 
   void ResetVector() noexcept;
 
+  void SetVector(const GeoVector &_vec) noexcept {
+    vec = _vec;
+  }
+
   [[gnu::pure]]
   const GeoVector &GetVector(const GeoPoint &location) const noexcept;
 };
@@ -14,8 +14,14 @@
 #include "io/ZipReader.hpp"
 #include "io/ProgressReader.hpp"
 #include "io/BufferedReader.hxx"
+#include "Waypoint/Waypoints.hpp"
 
+#include <algorithm>
 #include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
 
 static WaypointReaderBase *
 CreateWaypointReader(WaypointFileType type, WaypointFactory factory)
@@ -46,6 +52,41 @@ CreateWaypointReader(WaypointFileType type, WaypointFactory factory)
   return nullptr;
 }
 
+/**
+ * Files smaller than this are parsed sequentially, because starting
+ * threads would cost more than it saves.
+ */
+static constexpr uint_least64_t PARALLEL_PARSER_THRESHOLD = 256 * 1024;
+
+/**
+ * The maximum number of threads used for parsing one file.
+ */
+static constexpr unsigned MAX_PARSER_THREADS = 8;
+
+void
+ParseWaypointFile(std::string_view contents, WaypointFileType file_type,
+                  Waypoints &way_points, WaypointFactory factory,
+                  unsigned n_threads)
+{
+  std::vector<Waypoint> list;
+
+  switch (file_type) {
+  case WaypointFileType::SEEYOU:
+    ParseSeeYou(factory, list, contents, n_threads);
+    break;
+  default:
+    std::unique_ptr<WaypointReaderBase> reader { CreateWaypointReader(file_type,
+                                                                      factory) };
+    if (!reader)
+      throw std::runtime_error{"Unrecognised waypoint file"};
+
+    reader->Parse(list, contents, n_threads);
+    break;
+  }
+
+  way_points.Append(std::move(list));
+}
+
 static void
 ReadWaypointFile(Reader &file_reader, WaypointFileType file_type,
                  uint_least64_t total_size,
@@ -53,6 +94,31 @@ ReadWaypointFile(Reader &file_reader, WaypointFileType file_type,
                  ProgressListener &progress)
 {
   ProgressReader progress_reader{file_reader, total_size, progress};
+
+  const unsigned n_threads =
+    std::min(std::thread::hardware_concurrency(), MAX_PARSER_THREADS);
+  if (n_threads > 1 && total_size >= PARALLEL_PARSER_THRESHOLD) {
+    /* load the whole file into memory, to be split into chunks
+       which are parsed in parallel */
+    std::string contents;
+    contents.resize(total_size);
+
+    std::size_t length = 0;
+    while (length < contents.size()) {
+      const std::size_t nbytes =
+        progress_reader.Read(std::as_writable_bytes(std::span{contents}.subspan(length)));
+      if (nbytes == 0)
+        break;
+
+      length += nbytes;
+    }
+
+    contents.resize(length);
+
+    ParseWaypointFile(contents, file_type, way_points, factory, n_threads);
+    return;
+  }
+
   BufferedReader buffered_reader{progress_reader};
 
   switch (file_type) {
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <cstdint>
+#include <string_view>
 
 enum class WaypointFileType: uint8_t;
 struct zzip_dir;
@@ -34,3 +35,15 @@ void
 ReadWaypointFile(struct zzip_dir *dir, const char *path,
                  WaypointFileType file_type, Waypoints &way_points,
                  WaypointFactory factory, ProgressListener &progress);
+
+/**
+ * Parse a waypoint file which has been loaded into memory, using up
+ * to #n_threads threads.  The resulting waypoint list is the same
+ * regardless of the number of threads.
+ *
+ * Throws on error.
+ */
+void
+ParseWaypointFile(std::string_view contents, WaypointFileType file_type,
+                  Waypoints &way_points, WaypointFactory factory,
+                  unsigned n_threads);
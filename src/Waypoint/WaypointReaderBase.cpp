@@ -2,15 +2,73 @@
 // Copyright The XCSoar Project
 
 #include "WaypointReaderBase.hpp"
+#include "ParallelParser.hpp"
+#include "Waypoint/Waypoints.hpp"
 #include "io/BufferedReader.hxx"
+#include "io/MemoryReader.hxx"
+#include "util/SpanCast.hxx"
+#include "util/UTF8.hpp"
 
 void
 WaypointReaderBase::Parse(Waypoints &way_points, BufferedReader &reader)
+{
+  std::vector<Waypoint> list;
+  Parse(list, reader);
+  way_points.Append(std::move(list));
+}
+
+void
+WaypointReaderBase::Parse(std::vector<Waypoint> &dest, BufferedReader &reader)
 {
   // Read through the lines of the file
   char *line;
   while ((line = reader.ReadLine()) != nullptr) {
     // and parse them
-    ParseLine(line, way_points);
+    ParseLine(line, dest);
+  }
+}
+
+void
+WaypointReaderBase::Parse(std::vector<Waypoint> &dest,
+                          std::string_view contents, unsigned n_threads)
+{
+  /* the character set detection of StringConverter depends on all
+     preceding strings; chunks can only be parsed independently if
+     there is no invalid UTF-8 which would switch it to Latin-1 */
+  if (n_threads > 1 && !ValidateUTF8(contents))
+    n_threads = 1;
+
+  const auto chunks = SplitWaypointFile(contents, n_threads, false);
+
+  std::vector<std::unique_ptr<WaypointReaderBase>> readers;
+  readers.reserve(chunks.size());
+
+  for (std::size_t i = 1; i < chunks.size(); ++i) {
+    const std::string_view before =
+      contents.substr(0, chunks[i].data() - contents.data());
+    auto reader = CreateChunkReader(before);
+    if (!reader) {
+      /* not supported by this format */
+      readers.clear();
+      break;
+    }
+
+    readers.push_back(std::move(reader));
+  }
+
+  if (readers.size() + 1 < chunks.size()) {
+    MemoryReader memory_reader{AsBytes(contents)};
+    BufferedReader buffered_reader{memory_reader};
+    Parse(dest, buffered_reader);
+    return;
   }
+
+  ParseWaypointChunks(chunks, [this, &readers](std::size_t i,
+                                               std::string_view chunk,
+                                               std::vector<Waypoint> &list){
+    MemoryReader memory_reader{AsBytes(chunk)};
+    BufferedReader buffered_reader{memory_reader};
+    (i == 0 ? *this : *readers[i - 1]).Parse(list, buffered_reader);
+    return false;
+  }, dest);
 }
@@ -5,6 +5,10 @@
 
 #include "Factory.hpp"
 
+#include <memory>
+#include <string_view>
+#include <vector>
+
 class Waypoints;
 class BufferedReader;
 
@@ -27,14 +31,39 @@ public:
    */
   void Parse(Waypoints &way_points, BufferedReader &reader);
 
+  /**
+   * Parses all lines from the reader into the given list.
+   */
+  void Parse(std::vector<Waypoint> &dest, BufferedReader &reader);
+
+  /**
+   * Parses a waypoint file which has been loaded into memory.  If
+   * this reader supports it (see CreateChunkReader()), the file is
+   * split into up to #n_threads chunks which are parsed in parallel.
+   * The result is the same as with sequential parsing.
+   */
+  void Parse(std::vector<Waypoint> &dest, std::string_view contents,
+             unsigned n_threads);
+
 protected:
+  /**
+   * Create a new reader which parses a chunk of the file in another
+   * thread.  It must be in the state this reader would be in after
+   * parsing the given lines preceding the chunk.
+   *
+   * @return nullptr if this format cannot be parsed in chunks
+   */
+  virtual std::unique_ptr<WaypointReaderBase>
+  CreateChunkReader([[maybe_unused]] std::string_view before) const noexcept {
+    return nullptr;
+  }
+
   /**
    * Parse a file line
    * @param line The line to parse
-   * @param linenum The line number in the file
-   * @param way_points The waypoint list to fill
+   * @param dest The list to append the new waypoint to
    * @return True if the line was parsed correctly or ignored, False if
    * parsing error occured
    */
-  virtual bool ParseLine(const char *line, Waypoints &way_points) = 0;
+  virtual bool ParseLine(const char *line, std::vector<Waypoint> &dest) = 0;
 };
@@ -4,9 +4,11 @@
 #include "WaypointReaderFS.hpp"
 #include "Waypoint/Waypoints.hpp"
 #include "Geo/UTM.hpp"
+#include "util/StringCompare.hxx"
 #include "util/StringStrip.hxx"
 
 #include <stdlib.h>
+#include <string.h>
 
 static bool
 ParseAngle(const char *src, Angle &angle) noexcept
@@ -110,7 +112,7 @@ ParseAltitude(const char *src, double &dest) noexcept
 }
 
 bool
-WaypointReaderFS::ParseLine(const char *line, Waypoints &way_points)
+WaypointReaderFS::ParseLine(const char *line, std::vector<Waypoint> &dest)
 {
   //$FormatGEO
   //ACONCAGU  S 32 39 12.00    W 070 00 42.00  6962  Aconcagua
@@ -160,7 +162,7 @@ WaypointReaderFS::ParseLine(const char *line, Waypoints &way_points)
   if (len > (is_utm ? 38 : 47))
     new_waypoint.comment = tstring{string_converter.Convert(line + (is_utm ? 38 : 47))};
 
-  way_points.Append(std::move(new_waypoint));
+  dest.emplace_back(std::move(new_waypoint));
   return true;
 }
 
@@ -5,6 +5,7 @@
 #include "Waypoint/Waypoints.hpp"
 #include "Units/System.hpp"
 #include "util/NumberParser.hxx"
+#include "util/StaticString.hxx"
 #include "util/StringSplit.hxx"
 #include "util/StringStrip.hxx"
 
@@ -31,7 +32,7 @@ NextColumn(std::string_view &line) noexcept
 }
 
 bool
-WaypointReaderOzi::ParseLine(const char *line, Waypoints &way_points)
+WaypointReaderOzi::ParseLine(const char *line, std::vector<Waypoint> &dest)
 {
   if (line[0] == '\0')
     return true;
@@ -93,7 +94,7 @@ WaypointReaderOzi::ParseLine(const char *line, Waypoints &way_points)
   } else
     factory.FallbackElevation(new_waypoint);
 
-  way_points.Append(std::move(new_waypoint));
+  dest.emplace_back(std::move(new_waypoint));
   return true;
 }
 
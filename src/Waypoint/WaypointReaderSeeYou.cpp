@@ -7,8 +7,15 @@
 #include "util/DecimalParser.hxx"
 #include "util/IterableSplitString.hxx"
 #include "util/NumberParser.hxx"
+#include "util/StringCompare.hxx"
 #include "io/StringConverter.hpp"
 #include "io/BufferedCsvReader.hpp"
+#include "io/MemoryReader.hxx"
+#include "ParallelParser.hpp"
+#include "util/SpanCast.hxx"
+#include "util/UTF8.hpp"
+
+#include <atomic>
 
 #include <stdlib.h>
 
@@ -175,32 +182,76 @@ ParseStyle(std::string_view src, Waypoint::Type &type)
   return true;
 }
 
-bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints, BufferedReader &reader) {
-  StringConverter string_converter;
+// 2018: name, code, country, lat, lon, elev, style, rwydir, rwylen, freq, desc
+// 2022: name, code, country, lat, lon, elev, style, rwdir, rwlen, rwwidth, freq, desc, userdata, pics
+enum {
+  iName = 0,
+  iShortname = 1,
+  iLatitude = 3,
+  iLongitude = 4,
+  iElevation = 5,
+  iStyle = 6,
+  iRWDir = 7,
+  iRWLen = 8,
+  iRWWidth = 9,
+  iUserData = 12,
+  iPics = 13
+};
+
+using SeeYouRecord = std::array<std::string_view, 14>;
+
+/**
+ * The positions of the columns which differ between the versions of
+ * the file format.
+ */
+struct SeeYouColumns {
+  unsigned frequency = 9;
+  unsigned description = 10;
+};
+
+/**
+ * Check whether this is a header (a line with only field names), and
+ * if yes, determine the column layout from it.
+ */
+static bool
+ParseSeeYouHeader(const SeeYouRecord &params, size_t params_num,
+                  SeeYouColumns &columns) noexcept
+{
+  if (!StringIsEqualIgnoreCase(params[iLatitude],"lat"sv))
+    return false;
 
-  // 2018: name, code, country, lat, lon, elev, style, rwydir, rwylen, freq, desc
-  // 2022: name, code, country, lat, lon, elev, style, rwdir, rwlen, rwwidth, freq, desc, userdata, pics
-  enum {
-    iName = 0,
-    iShortname = 1,
-    iLatitude = 3,
-    iLongitude = 4,
-    iElevation = 5,
-    iStyle = 6,
-    iRWDir = 7,
-    iRWLen = 8,
-    iRWWidth = 9,
-    iUserData = 12,
-    iPics = 13
-  };
-  unsigned iFrequency = 9;
-  unsigned iDescription = 10;
+  /*
+   * Newer cup/cupx specification adds rwwidth, shifts freq and desc
+   * right, and adds userdata and pics.
+   */
+  if ( params_num > iRWWidth &&
+       params[iRWWidth] == "rwwidth"sv ) {
+    columns.frequency = 10;
+    columns.description = 11;
+  }
+
+  return true;
+}
+
+/**
+ * Parse waypoint records until the end of the input or until the
+ * start of the task section.
+ *
+ * @param first_line true if the reader is at the beginning of the
+ * file (which may contain a header)
+ * @return true if the "Related Tasks" line was found
+ */
+static bool
+ParseSeeYouRecords(WaypointFactory factory, SeeYouColumns columns,
+                   BufferedReader &reader, std::vector<Waypoint> &dest,
+                   bool first_line)
+{
+  StringConverter string_converter;
 
   size_t params_num;
-  std::array<std::string_view,14> params;
+  SeeYouRecord params;
 
   bool tasks { false };
-  bool first_line = true;
 
   while ( true ) {
     params_num = ReadCsvRecord(reader, params);
@@ -213,20 +264,8 @@ bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints, BufferedReader &
       if (params_num == 0)
         return false;
 
-      // Check whether this is a header (a line with only field names).
-      if (StringIsEqualIgnoreCase(params[iLatitude],"lat"sv)) {
-
-        /*
-         * Newer cup/cupx specification adds rwwidth, shifts freq and desc
-         * right, and adds userdata and pics.
-         */
-        if ( params_num > iRWWidth &&
-             params[iRWWidth] == "rwwidth"sv ) {
-          iFrequency = 10;
-          iDescription = 11;
-        }
+      if (ParseSeeYouHeader(params, params_num, columns))
         continue;
-      }
     }
 
     // Tasks section
@@ -288,9 +327,9 @@ bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints, BufferedReader &
     // Frequency & runway direction/length (for airports and landables)
     // and description (e.g. "Some Description")
     if ( new_waypoint.IsLandable() ) {
-      if ( params_num > iFrequency &&
-           !params[iFrequency].empty() )
-        new_waypoint.radio_frequency = RadioFrequency::Parse(params[iFrequency]);
+      if ( params_num > columns.frequency &&
+           !params[columns.frequency].empty() )
+        new_waypoint.radio_frequency = RadioFrequency::Parse(params[columns.frequency]);
 
       // Runway length (e.g. 546.0m)
       double rwlen = -1;
@@ -320,12 +359,12 @@ bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints, BufferedReader &
      * (http://www.openaip.net/), since no waypoint type exists for
      * thermal hotspots.
      */
-    if ( params_num > iDescription &&
-         params[iDescription].starts_with("Hotspot"sv) )
+    if ( params_num > columns.description &&
+         params[columns.description].starts_with("Hotspot"sv) )
       new_waypoint.type = Waypoint::Type::THERMAL_HOTSPOT;
 
-    if ( params_num > iDescription )
-      new_waypoint.comment.assign(string_converter.Convert(params[iDescription]));
+    if ( params_num > columns.description )
+      new_waypoint.comment.assign(string_converter.Convert(params[columns.description]));
 
     if ( params_num > iUserData )
       new_waypoint.details.assign(string_converter.Convert(params[iUserData]));
@@ -336,8 +375,67 @@ bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints, BufferedReader &
         new_waypoint.files_embed.emplace_front(string_converter.Convert(i));
       }
     }
-    waypoints.Append(std::move(new_waypoint));
+    dest.emplace_back(std::move(new_waypoint));
   }
 
   return tasks;
 }
+
+bool
+ParseSeeYou(WaypointFactory factory, Waypoints &waypoints,
+            BufferedReader &reader)
+{
+  std::vector<Waypoint> list;
+  const bool tasks = ParseSeeYouRecords(factory, {}, reader, list, true);
+  waypoints.Append(std::move(list));
+  return tasks;
+}
+
+bool
+ParseSeeYou(WaypointFactory factory, std::vector<Waypoint> &dest,
+            std::string_view contents, unsigned n_threads)
+{
+  /* see WaypointReaderBase::Parse() */
+  if (n_threads > 1 && !ValidateUTF8(contents))
+    n_threads = 1;
+
+  if (n_threads <= 1) {
+    MemoryReader memory_reader{AsBytes(contents)};
+    BufferedReader reader{memory_reader};
+    return ParseSeeYouRecords(factory, {}, reader, dest, true);
+  }
+
+  /* the header determines the column layout of all chunks */
+  SeeYouColumns columns;
+
+  {
+    MemoryReader memory_reader{AsBytes(contents)};
+    BufferedReader reader{memory_reader};
+    SeeYouRecord params;
+    const size_t params_num = ReadCsvRecord(reader, params);
+    if (params_num == 0)
+      return false;
+
+    ParseSeeYouHeader(params, params_num, columns);
+  }
+
+  const auto chunks = SplitWaypointFile(contents, n_threads, true);
+
+  /* the chunks following the start of the task section are
+     discarded by ParseWaypointChunks() */
+  std::atomic_bool tasks{false};
+
+  ParseWaypointChunks(chunks, [factory, columns, &tasks](std::size_t i,
+                                                         std::string_view chunk,
+                                                         std::vector<Waypoint> &list){
+    MemoryReader memory_reader{AsBytes(chunk)};
+    BufferedReader reader{memory_reader};
+    const bool chunk_tasks =
+      ParseSeeYouRecords(factory, columns, reader, list, i == 0);
+    if (chunk_tasks)
+      tasks = true;
+    return chunk_tasks;
+  }, dest);
+
+  return tasks;
+}
@@ -5,6 +5,9 @@
 
 #include "Factory.hpp"
 
+#include <string_view>
+#include <vector>
+
 class Waypoints;
 class BufferedReader;
 
@@ -15,3 +18,17 @@ class BufferedReader;
  * Throws on error.
  */
 bool ParseSeeYou(WaypointFactory factory, Waypoints &waypoints, BufferedReader &reader);
+
+/**
+ * Parse a SeeYou file which has been loaded into memory.  The
+ * waypoint section is split into up to #n_threads chunks which are
+ * parsed in parallel; the result is the same as with sequential
+ * parsing.
+ *
+ * @return true if the "Related Tasks" line was found, false if the
+ * file contains no task
+ *
+ * Throws on error.
+ */
+bool ParseSeeYou(WaypointFactory factory, std::vector<Waypoint> &dest,
+                 std::string_view contents, unsigned n_threads);
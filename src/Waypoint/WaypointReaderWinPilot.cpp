@@ -6,8 +6,12 @@
 #include "Waypoint/Waypoints.hpp"
 #include "util/NumberParser.hxx"
 #include "util/StringSplit.hxx"
+#include "util/IterableSplitString.hxx"
 
 #include <math.h>
+#include <string.h>
+
+using std::string_view_literals::operator""sv;
 
 static std::string_view
 NextColumn(std::string_view &line) noexcept
@@ -197,8 +201,26 @@ ParseFlags(std::string_view src, Waypoint &dest)
   return true;
 }
 
+std::unique_ptr<WaypointReaderBase>
+WaypointReaderWinPilot::CreateChunkReader(std::string_view before) const noexcept
+{
+  auto reader = std::make_unique<WaypointReaderWinPilot>(factory);
+
+  /* the first comment line of the file determines the format */
+  for (const std::string_view line : IterableSplitString(before, '\n')) {
+    if (line.starts_with('*')) {
+      reader->first = false;
+      reader->welt2000_format =
+        line.find("WRITTEN BY WELT2000"sv) != line.npos;
+      break;
+    }
+  }
+
+  return reader;
+}
+
 bool
-WaypointReaderWinPilot::ParseLine(const char *line, Waypoints &waypoints)
+WaypointReaderWinPilot::ParseLine(const char *line, std::vector<Waypoint> &dest)
 {
   // If (end-of-file)
   if (line[0] == '\0')
@@ -253,6 +275,6 @@ WaypointReaderWinPilot::ParseLine(const char *line, Waypoints &waypoints)
   new_waypoint.comment = tstring{string_converter.Convert(comment)};
   ParseRunwayDirection(comment, new_waypoint.runway);
 
-  waypoints.Append(std::move(new_waypoint));
+  dest.emplace_back(std::move(new_waypoint));
   return true;
 }
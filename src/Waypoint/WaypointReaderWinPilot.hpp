@@ -21,5 +21,7 @@ public:
 
 protected:
   /* virtual methods from class WaypointReaderBase */
-  bool ParseLine(const char *line, Waypoints &way_points) override;
+  std::unique_ptr<WaypointReaderBase>
+  CreateChunkReader(std::string_view before) const noexcept override;
+  bool ParseLine(const char *line, std::vector<Waypoint> &dest) override;
 };
@@ -6,6 +6,7 @@
 #include "util/StringStrip.hxx"
 
 #include <stdlib.h>
+#include <string.h>
 
 static bool
 ParseString(StringConverter &string_converter,
@@ -129,8 +130,15 @@ ParseFlagsFromDescription(const char *src, Waypoint &dest) noexcept
   return false;
 }
 
+std::unique_ptr<WaypointReaderBase>
+WaypointReaderZander::CreateChunkReader([[maybe_unused]] std::string_view before) const noexcept
+{
+  /* this format has no header; each line is independent */
+  return std::make_unique<WaypointReaderZander>(factory);
+}
+
 bool
-WaypointReaderZander::ParseLine(const char *line, Waypoints &way_points)
+WaypointReaderZander::ParseLine(const char *line, std::vector<Waypoint> &dest)
 {
   // If (end-of-file or comment)
   if (line[0] == '\0' || line[0] == '*')
@@ -177,6 +185,6 @@ WaypointReaderZander::ParseLine(const char *line, Waypoints &way_points)
     if (len < 36 || !ParseFlagsFromDescription(line + 35, new_waypoint))
       new_waypoint.flags.turn_point = true;
 
-  way_points.Append(std::move(new_waypoint));
+  dest.emplace_back(std::move(new_waypoint));
   return true;
 }
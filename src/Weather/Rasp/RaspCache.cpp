@@ -6,17 +6,24 @@
 #include "Terrain/RasterMap.hpp"
 #include "Terrain/Loader.hpp"
 #include "Language/Language.hpp"
+#include "Operation/Operation.hpp"
 #include "system/Path.hpp"
 #include "io/ZipArchive.hpp"
 #include "LogFile.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <windef.h> // for MAX_PATH
 
 RaspCache::RaspCache(const RaspStore &_store, unsigned _parameter) noexcept
-  :store(_store), parameter(_parameter) {}
+  :StandbyThread("RaspCache"),
+   store(_store), parameter(_parameter),
+   loading(RaspStore::MAX_WEATHER_TIMES) {}
 
-RaspCache::~RaspCache() noexcept = default;
+RaspCache::~RaspCache() noexcept
+{
+  LockStop();
+}
 
 static constexpr unsigned
 ToQuarterHours(BrokenTime t)
@@ -54,12 +61,164 @@ RaspCache::GetTime() const
     : RaspStore::IndexToTime(time);
 }
 
+void
+RaspCache::SetInterpolate(bool _interpolate) noexcept
+{
+  if (_interpolate == interpolate)
+    return;
+
+  interpolate = _interpolate;
+
+  /* force Reload() to select the map(s) again */
+  last_time = 0;
+}
+
 bool
 RaspCache::IsInside(GeoPoint p) const
 {
   return map != nullptr && map->IsInside(p);
 }
 
+unsigned
+RaspCache::FindTimeBefore(unsigned time_index) const noexcept
+{
+  for (unsigned t = std::min(time_index + 1, RaspStore::MAX_WEATHER_TIMES);
+       t-- > 0;)
+    if (store.IsTimeAvailable(parameter, t))
+      return t;
+
+  return RaspStore::MAX_WEATHER_TIMES;
+}
+
+unsigned
+RaspCache::FindTimeAfter(unsigned time_index) const noexcept
+{
+  for (unsigned t = time_index; t < RaspStore::MAX_WEATHER_TIMES; ++t)
+    if (store.IsTimeAvailable(parameter, t))
+      return t;
+
+  return RaspStore::MAX_WEATHER_TIMES;
+}
+
+std::unique_ptr<RasterMap>
+RaspCache::LoadMap(unsigned time_index, OperationEnvironment &operation) const
+{
+  auto archive = store.OpenArchive();
+
+  char new_name[MAX_PATH];
+  store.NarrowWeatherFilename(new_name, Path(store.GetItemInfo(parameter).name),
+                              time_index);
+
+  auto new_map = std::make_unique<RasterMap>();
+  LoadTerrainOverview(archive->get(), new_name, nullptr,
+                      new_map->GetTileCache(),
+                      true, operation);
+  new_map->UpdateProjection();
+  return new_map;
+}
+
+RaspCache::Entry *
+RaspCache::FindEntry(unsigned time_index) noexcept
+{
+  auto i = std::find_if(entries.begin(), entries.end(),
+                        [time_index](const Entry &entry){
+                          return entry.time == time_index;
+                        });
+  return i != entries.end() ? &*i : nullptr;
+}
+
+void
+RaspCache::AddEntry(unsigned time_index,
+                    std::shared_ptr<const RasterMap> new_map) noexcept
+{
+  assert(FindEntry(time_index) == nullptr);
+
+  const std::size_t size = new_map->GetMemoryUsage();
+  entries.push_back({std::move(new_map), size, ++use_counter, time_index});
+
+  std::size_t total = 0;
+  for (const auto &entry : entries)
+    total += entry.size;
+
+  /* discard the least recently used maps which exceed the budget */
+  while (total > MEMORY_BUDGET) {
+    auto lru = entries.end();
+    for (auto i = entries.begin(); i != entries.end(); ++i)
+      if (!pinned.contains(i->time) &&
+          (lru == entries.end() || i->last_used < lru->last_used))
+        lru = i;
+
+    if (lru == entries.end())
+      break;
+
+    total -= lru->size;
+    entries.erase(lru);
+  }
+}
+
+std::shared_ptr<const RasterMap>
+RaspCache::ObtainMap(unsigned time_index, OperationEnvironment &operation)
+{
+  {
+    std::unique_lock lock{mutex};
+
+    /* if the thread is decoding this one right now, wait for it
+       instead of decoding it again */
+    loaded.wait(lock, [this, time_index]{ return loading != time_index; });
+
+    if (Entry *entry = FindEntry(time_index)) {
+      entry->last_used = ++use_counter;
+      return entry->map;
+    }
+
+    if (auto i = std::find(preload.begin(), preload.end(), time_index);
+        i != preload.end())
+      preload.remove(std::distance(preload.begin(), i));
+  }
+
+  std::shared_ptr<const RasterMap> new_map;
+  try {
+    new_map = LoadMap(time_index, operation);
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to load RASP file");
+    return nullptr;
+  }
+
+  const std::lock_guard lock{mutex};
+  AddEntry(time_index, new_map);
+  return new_map;
+}
+
+void
+RaspCache::Preload(unsigned before, unsigned after) noexcept
+{
+  /* prefer the following forecast times, because the forecast is
+     usually stepped (or "Now" advances) forward */
+  const unsigned next = FindTimeAfter(after + 1);
+  const unsigned next2 = FindTimeAfter(next + 1);
+  const unsigned previous = before > 0
+    ? FindTimeBefore(before - 1)
+    : RaspStore::MAX_WEATHER_TIMES;
+
+  const std::lock_guard lock{mutex};
+
+  preload.clear();
+  for (const unsigned t : {next, previous, next2})
+    if (t != RaspStore::MAX_WEATHER_TIMES && t != loading &&
+        FindEntry(t) == nullptr)
+      preload.push_back(t);
+
+  if (preload.empty())
+    return;
+
+  try {
+    Trigger();
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to start RASP thread");
+    preload.clear();
+  }
+}
+
 void
 RaspCache::Reload(BrokenTime time_local, OperationEnvironment &operation)
 {
@@ -81,31 +240,85 @@ RaspCache::Reload(BrokenTime time_local, OperationEnvironment &operation)
 
   last_time = effective_time;
 
-  effective_time = store.GetNearestTime(parameter, effective_time);
-  if (effective_time == RaspStore::MAX_WEATHER_TIMES)
+  unsigned before, after;
+  if (interpolate) {
+    before = FindTimeBefore(effective_time);
+    after = FindTimeAfter(effective_time);
+
+    if (before == RaspStore::MAX_WEATHER_TIMES)
+      before = after;
+    else if (after == RaspStore::MAX_WEATHER_TIMES)
+      after = before;
+  } else
+    before = after = store.GetNearestTime(parameter, effective_time);
+
+  if (before == RaspStore::MAX_WEATHER_TIMES)
     return;
 
+  {
+    const std::lock_guard lock{mutex};
+    pinned.clear();
+    pinned.push_back(before);
+    if (after != before)
+      pinned.push_back(after);
+  }
+
   map.reset();
 
-  auto archive = store.OpenArchive();
-  if (!archive)
+  auto new_map = ObtainMap(before, operation);
+  if (new_map == nullptr)
     return;
 
-  char new_name[MAX_PATH];
-  store.NarrowWeatherFilename(new_name, Path(store.GetItemInfo(parameter).name),
-                              effective_time);
+  if (after != before) {
+    const unsigned ratio = (effective_time - before) * 0x100 / (after - before);
 
-  auto new_map = std::make_unique<RasterMap>();
-  try {
-    LoadTerrainOverview(archive->get(), new_name, nullptr,
-                        new_map->GetTileCache(),
-                        true, operation);
-  } catch (...) {
-    LogError(std::current_exception(), "Failed to load RASP file");
-    return;
+    if (auto after_map = ObtainMap(after, operation)) {
+      auto interpolated = std::make_shared<RasterMap>();
+      if (interpolated->Interpolate(*new_map, *after_map, ratio))
+        new_map = std::move(interpolated);
+      else if (ratio >= 0x80)
+        /* different geometries; fall back to the nearest one */
+        new_map = std::move(after_map);
+    }
   }
 
-  new_map->UpdateProjection();
-
   map = std::move(new_map);
+
+  Preload(before, after);
+}
+
+void
+RaspCache::Tick() noexcept
+{
+  SetIdlePriority();
+
+  while (!preload.empty() && !IsStopped()) {
+    const unsigned time_index = preload.front();
+    preload.remove(0);
+
+    if (FindEntry(time_index) != nullptr)
+      continue;
+
+    loading = time_index;
+
+    std::unique_ptr<RasterMap> new_map;
+
+    {
+      const ScopeUnlock unlock(mutex);
+
+      try {
+        NullOperationEnvironment env;
+        new_map = LoadMap(time_index, env);
+      } catch (...) {
+        LogError(std::current_exception(), "Failed to preload RASP file");
+      }
+    }
+
+    loading = RaspStore::MAX_WEATHER_TIMES;
+
+    if (new_map != nullptr)
+      AddEntry(time_index, std::move(new_map));
+
+    loaded.notify_all();
+  }
 }
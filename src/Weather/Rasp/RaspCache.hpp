@@ -3,7 +3,13 @@
 
 #pragma once
 
+#include "thread/StandbyThread.hpp"
+#include "thread/Cond.hxx"
+#include "util/StaticArray.hxx"
+
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 #include <tchar.h>
 
@@ -16,8 +22,24 @@ class OperationEnvironment;
 /**
  * Class to manage the raster weather map, to be loaded/selected from
  * a #RaspStore instance.
+ *
+ * Decoded time steps of the parameter are kept in memory (up to
+ * #MEMORY_BUDGET bytes), and the neighbouring time steps of the one
+ * being displayed are decoded in a background thread, so stepping
+ * through the forecast does not need to decode each map again.
  */
-class RaspCache {
+class RaspCache final : StandbyThread {
+  /**
+   * The maximum number of bytes occupied by decoded maps.  The maps
+   * being displayed are never discarded, even if they exceed this
+   * budget.
+   */
+#if defined(ANDROID)
+  static constexpr std::size_t MEMORY_BUDGET = 16 * 1024 * 1024;
+#else
+  static constexpr std::size_t MEMORY_BUDGET = 64 * 1024 * 1024;
+#endif
+
   const RaspStore &store;
 
   const unsigned parameter;
@@ -25,7 +47,63 @@ class RaspCache {
   unsigned time = 0;
   unsigned last_time = 0;
 
-  std::unique_ptr<RasterMap> map;
+  /**
+   * Interpolate between the two nearest forecast times?
+   */
+  bool interpolate = false;
+
+  /**
+   * The map being displayed.  This may be an interpolated map which
+   * is not in #entries.
+   */
+  std::shared_ptr<const RasterMap> map;
+
+  struct Entry {
+    std::shared_ptr<const RasterMap> map;
+
+    /**
+     * The value of RasterMap::GetMemoryUsage().
+     */
+    std::size_t size;
+
+    /**
+     * The value of #RaspCache::use_counter when this entry was last
+     * used; the entry with the smallest value gets discarded first.
+     */
+    unsigned last_used;
+
+    unsigned time;
+  };
+
+  /**
+   * The decoded maps.  Protected by #mutex.
+   */
+  std::vector<Entry> entries;
+
+  unsigned use_counter = 0;
+
+  /**
+   * The time indices of the maps currently being displayed; they
+   * will not be discarded.  Protected by #mutex.
+   */
+  StaticArray<unsigned, 2> pinned;
+
+  /**
+   * The time indices which shall be decoded by the thread, nearest
+   * first.  Protected by #mutex.
+   */
+  StaticArray<unsigned, 4> preload;
+
+  /**
+   * The time index currently being decoded by the thread, or
+   * RaspStore::MAX_WEATHER_TIMES.  Protected by #mutex.
+   */
+  unsigned loading;
+
+  /**
+   * Signalled by the thread after it has finished decoding a map.
+   */
+  Cond loaded;
 
 public:
   RaspCache(const RaspStore &_store, unsigned _parameter) noexcept;
@@ -79,4 +157,64 @@ public:
    * Sets the current time index.
    */
   void SetTime(BrokenTime t);
+
+  /**
+   * Enable or disable linear interpolation between the two nearest
+   * forecast times.  If disabled, the nearest forecast time is
+   * displayed.
+   */
+  void SetInterpolate(bool _interpolate) noexcept;
+
+private:
+  /**
+   * Decode the map of the specified time index.
+   *
+   * Throws on error.
+   */
+  std::unique_ptr<RasterMap> LoadMap(unsigned time_index,
+                                     OperationEnvironment &operation) const;
+
+  /**
+   * Look up the map in the cache, or decode it.  Returns nullptr on
+   * error.
+   */
+  std::shared_ptr<const RasterMap> ObtainMap(unsigned time_index,
+                                             OperationEnvironment &operation);
+
+  /**
+   * Caller must lock the mutex.
+   */
+  [[gnu::pure]]
+  Entry *FindEntry(unsigned time_index) noexcept;
+
+  /**
+   * Add a decoded map to the cache, and discard the least recently
+   * used ones which exceed #MEMORY_BUDGET.  Caller must lock the
+   * mutex.
+   */
+  void AddEntry(unsigned time_index,
+                std::shared_ptr<const RasterMap> new_map) noexcept;
+
+  /**
+   * Schedule decoding the neighbours of the specified time index in
+   * background.
+   */
+  void Preload(unsigned before, unsigned after) noexcept;
+
+  /**
+   * Find the nearest available time index before (or at) the given
+   * one, or RaspStore::MAX_WEATHER_TIMES.
+   */
+  [[gnu::pure]]
+  unsigned FindTimeBefore(unsigned time_index) const noexcept;
+
+  /**
+   * Find the nearest available time index after (or at) the given
+   * one, or RaspStore::MAX_WEATHER_TIMES.
+   */
+  [[gnu::pure]]
+  unsigned FindTimeAfter(unsigned time_index) const noexcept;
+
+  /* virtual methods from class StandbyThread */
+  void Tick() noexcept override;
 };
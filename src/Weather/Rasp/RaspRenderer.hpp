@@ -61,6 +61,10 @@ public:
     cache.SetTime(t);
   }
 
+  void SetInterpolate(bool interpolate) noexcept {
+    cache.SetInterpolate(interpolate);
+  }
+
   void Update(BrokenTime time_local, OperationEnvironment &operation) {
     cache.Reload(time_local, operation);
   }
@@ -20,8 +20,15 @@ struct WeatherUIState {
    */
   BrokenTime time;
 
+  /**
+   * Interpolate between the two nearest forecast times instead of
+   * showing the nearest one?
+   */
+  bool interpolate;
+
   void Clear() {
     map = -1;
     time = BrokenTime::Invalid();
+    interpolate = false;
   }
 };
@@ -25,6 +25,7 @@ class GLTexture;
 
 #ifdef USE_FREETYPE
 typedef struct FT_FaceRec_ *FT_Face;
+class GlyphAtlas;
 #endif
 
 class FontDescription;
@@ -37,6 +38,12 @@ class Font {
 protected:
 #ifdef USE_FREETYPE
   FT_Face face = nullptr;
+
+  /**
+   * The rendered glyphs of this font; allocated by LoadFile(),
+   * freed by Destroy().
+   */
+  GlyphAtlas *atlas = nullptr;
 #elif defined(ANDROID)
   TextUtil *text_util_object = nullptr;
 
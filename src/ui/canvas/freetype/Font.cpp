@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "ui/canvas/Font.hpp"
+#include "GlyphAtlas.hpp"
 #include "Screen/Debug.hpp"
 #include "ui/canvas/custom/Files.hpp"
 #include "Look/FontDescription.hpp"
@@ -162,6 +163,7 @@ Font::LoadFile(const char *file, unsigned ptsize, [[maybe_unused]] bool bold, [[
   // TODO: handle bold/italic
 
   face = new_face;
+  atlas = new GlyphAtlas(IsMono());
 }
 
 void
@@ -205,6 +207,9 @@ Font::Destroy() noexcept
 
   assert(IsScreenInitialized());
 
+  delete atlas;
+  atlas = nullptr;
+
   ::FT_Done_Face(face);
   face = nullptr;
 }
@@ -269,11 +274,159 @@ ForEachGlyph(const FT_Face face, unsigned ascent_height, T &&text,
     });
 }
 
+static void
+ConvertMono(unsigned char *dest, const unsigned char *src, unsigned n) noexcept;
+
+/**
+ * Load and render a glyph for the #GlyphAtlas.  Caller must protect
+ * libfreetype.
+ */
+static GlyphAtlas::Glyph
+CreateGlyph(const FT_Face face, unsigned ascent_height,
+            GlyphAtlas &atlas, unsigned ch) noexcept
+{
+  GlyphAtlas::Glyph glyph;
+
+  const FT_UInt i = FT_Get_Char_Index(face, ch);
+  if (i == 0)
+    return glyph;
+
+  FT_Error error = FT_Load_Glyph(face, i, load_flags);
+  if (error)
+    return glyph;
+
+  const FT_GlyphSlot slot = face->glyph;
+  const FT_Glyph_Metrics &metrics = slot->metrics;
+
+  glyph.defined = true;
+  glyph.left = FT_FLOOR(metrics.horiBearingX);
+  glyph.top = ascent_height - FT_FLOOR(metrics.horiBearingY);
+  glyph.advance = FT_CEIL(metrics.horiAdvance);
+  glyph.metrics_width = FT_CEIL(metrics.width);
+
+  error = FT_Render_Glyph(slot, render_mode);
+  if (!error) {
+    const FT_Bitmap &src = slot->bitmap;
+    glyph.width = src.width;
+    glyph.rows = src.rows;
+
+    uint8_t *dest = atlas.AllocateBitmap(std::size_t(glyph.width) * glyph.rows);
+    glyph.bitmap = dest;
+
+    const unsigned char *s = src.buffer;
+    for (unsigned y = 0; y < glyph.rows;
+         ++y, dest += glyph.width, s += src.pitch) {
+      if (atlas.IsMono())
+        /* convert from 1 bit to 1 byte per pixel */
+        ConvertMono(dest, s, glyph.width);
+      else
+        std::copy_n(s, glyph.width, dest);
+    }
+  }
+
+  if (FT_HAS_KERNING(face)) {
+    /* collect the kerning pairs with all cacheable characters, so
+       laying out text does not need libfreetype */
+    for (unsigned next = 0; next < GlyphAtlas::TABLE_SIZE; ++next) {
+      const FT_UInt next_index = FT_Get_Char_Index(face, next);
+      if (next_index == 0)
+        continue;
+
+      FT_Vector delta;
+      FT_Get_Kerning(face, i, next_index, ft_kerning_default, &delta);
+      if ((delta.x >> 6) != 0)
+        glyph.kerning.push_back({uint16_t(next), int16_t(delta.x >> 6)});
+    }
+  }
+
+  return glyph;
+}
+
+static const GlyphAtlas::Glyph &
+ObtainGlyph(const FT_Face face, unsigned ascent_height,
+            GlyphAtlas &atlas, unsigned ch) noexcept
+{
+  if (const auto *glyph = atlas.Lookup(ch))
+    return *glyph;
+
+#ifndef ENABLE_OPENGL
+  const std::lock_guard lock{freetype_mutex};
+
+  /* another thread may have added it while we were waiting for the
+     lock */
+  if (const auto *glyph = atlas.Lookup(ch))
+    return *glyph;
+#endif
+
+  return atlas.Add(ch, CreateGlyph(face, ascent_height, atlas, ch));
+}
+
+/**
+ * Like ForEachGlyph(), but use the glyphs from the #GlyphAtlas.
+ * libfreetype is only used (and locked) for glyphs which are not yet
+ * cached.
+ *
+ * @return false if the text cannot be laid out with the atlas (it
+ * contains characters which are not cacheable); nothing has been
+ * done then
+ */
+static bool
+ForEachCachedGlyph(const FT_Face face, unsigned ascent_height,
+                   GlyphAtlas &atlas, tstring_view text,
+                   std::invocable<int, int, const GlyphAtlas::Glyph &> auto f) noexcept
+{
+  if (atlas.IsMono() != IsMono())
+    /* the rendering mode has been changed at runtime; the atlas is
+       stale */
+    return false;
+
+  bool cacheable = true;
+  ForEachChar(text, [&cacheable](unsigned ch){
+    if (!GlyphAtlas::IsCacheable(ch))
+      cacheable = false;
+  });
+
+  if (!cacheable)
+    return false;
+
+  int x = 0;
+  const GlyphAtlas::Glyph *previous = nullptr;
+
+  ForEachChar(text, [face, ascent_height, &atlas, &f,
+                     &x, &previous](unsigned ch){
+    const auto &glyph = ObtainGlyph(face, ascent_height, atlas, ch);
+    if (!glyph.defined)
+      return;
+
+    if (previous != nullptr)
+      x += previous->GetKerning(ch);
+
+    previous = &glyph;
+
+    f(x + glyph.left, glyph.top, glyph);
+
+    x += glyph.advance;
+  });
+
+  return true;
+}
+
 PixelSize
 Font::TextSize(tstring_view text) const noexcept
 {
   int maxx = 0;
 
+  if (ForEachCachedGlyph(face, ascent_height, *atlas, text,
+                         [&maxx](int x, [[maybe_unused]] int y,
+                                 const GlyphAtlas::Glyph &glyph){
+        /* same as the calculation below, which adds the
+           horizontal bearing to the glyph position again */
+        const int z = x + glyph.left + glyph.metrics_width;
+        if (z > maxx)
+          maxx = z;
+      }))
+    return PixelSize{unsigned(maxx), height};
+
   ForEachGlyph(face, ascent_height, text,
                [&maxx](int x, [[maybe_unused]] int y, const FT_GlyphSlot glyph){
       const FT_Glyph_Metrics &metrics = glyph->metrics;
@@ -298,12 +451,9 @@ MixLine(uint8_t *dest, const uint8_t *src, size_t n) noexcept
 
 static void
 RenderGlyph(uint8_t *buffer, unsigned buffer_width, unsigned buffer_height,
-            const FT_Bitmap &bitmap, int x, int y) noexcept
+            const uint8_t *src, int width, int height, int pitch,
+            int x, int y) noexcept
 {
-  const uint8_t *src = (const uint8_t *)bitmap.buffer;
-  int width = bitmap.width, height = bitmap.rows;
-  int pitch = bitmap.pitch;
-
   if (x < 0) {
     src -= x;
     width += x;
@@ -334,6 +484,16 @@ RenderGlyph(uint8_t *buffer, unsigned buffer_width, unsigned buffer_height,
     MixLine(buffer, src, width);
 }
 
+static void
+RenderGlyph(uint8_t *buffer, unsigned buffer_width, unsigned buffer_height,
+            const FT_Bitmap &bitmap, int x, int y) noexcept
+{
+  RenderGlyph(buffer, buffer_width, buffer_height,
+              (const uint8_t *)bitmap.buffer,
+              bitmap.width, bitmap.rows, bitmap.pitch,
+              x, y);
+}
+
 static void
 ConvertMono(unsigned char *dest, const unsigned char *src, unsigned n) noexcept
 {
@@ -385,6 +545,16 @@ Font::Render(tstring_view text, const PixelSize size,
   uint8_t *buffer = (uint8_t *)_buffer;
   std::fill_n(buffer, BufferSize(size), 0);
 
+  if (ForEachCachedGlyph(face, ascent_height, *atlas, text,
+                         [size, buffer](int x, int y,
+                                        const GlyphAtlas::Glyph &glyph){
+        if (glyph.bitmap != nullptr)
+          RenderGlyph(buffer, size.width, size.height,
+                      glyph.bitmap, glyph.width, glyph.rows, glyph.width,
+                      x, y);
+      }))
+    return;
+
   ForEachGlyph(face, ascent_height, text,
                [size, buffer](int x, int y, const FT_GlyphSlot glyph){
       RenderGlyph(buffer, size.width, size.height, glyph,
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "GlyphAtlas.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+int
+GlyphAtlas::Glyph::GetKerning(unsigned next) const noexcept
+{
+  const auto i = std::lower_bound(kerning.begin(), kerning.end(), next);
+  return i != kerning.end() && i->next == next
+    ? i->delta
+    : 0;
+}
+
+uint8_t *
+GlyphAtlas::AllocateBitmap(std::size_t size) noexcept
+{
+  if (size == 0)
+    return nullptr;
+
+  if (size > PAGE_SIZE / 4) {
+    /* large glyphs get a page of their own; insert it before the
+       current page, so its free space can still be used */
+    auto page = std::make_unique<uint8_t[]>(size);
+    uint8_t *result = page.get();
+    pages.emplace(pages.empty() ? pages.end() : std::prev(pages.end()),
+                  std::move(page));
+    return result;
+  }
+
+  if (page_fill + size > PAGE_SIZE) {
+    pages.emplace_back(std::make_unique<uint8_t[]>(PAGE_SIZE));
+    page_fill = 0;
+  }
+
+  uint8_t *result = pages.back().get() + page_fill;
+  page_fill += size;
+  return result;
+}
+
+const GlyphAtlas::Glyph &
+GlyphAtlas::Add(unsigned ch, Glyph &&glyph) noexcept
+{
+  assert(IsCacheable(ch));
+  assert(table[ch].load(std::memory_order_relaxed) == nullptr);
+  assert(std::is_sorted(glyph.kerning.begin(), glyph.kerning.end(),
+                        [](const Kerning &a, const Kerning &b){
+                          return a.next < b.next;
+                        }));
+
+  const Glyph &result = glyphs.emplace_front(std::move(glyph));
+
+  /* the "release" pairs with the "acquire" in Lookup(), so readers
+     see a fully initialised glyph (and bitmap) */
+  table[ch].store(&result, std::memory_order_release);
+  return result;
+}
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <forward_list>
+#include <memory>
+#include <vector>
+
+/**
+ * A cache of rendered glyphs of one #Font (i.e. one face at one
+ * size).  Text is composited from these glyphs, so strings which
+ * change often (e.g. numbers) do not need any FreeType work once all
+ * of their characters have been seen.
+ *
+ * Only the code points below #TABLE_SIZE are cached; they are looked
+ * up in a table of atomic pointers, which makes lookups lock-free.
+ * Glyphs are never modified or removed after they have been
+ * published, only when the whole atlas is destroyed.  Add() must be
+ * serialised by the caller (it needs FreeType anyway, which is not
+ * thread-safe).
+ */
+class GlyphAtlas {
+public:
+  /**
+   * Cache the code points below this one: ASCII, Latin-1 and
+   * Latin Extended-A, which covers the languages XCSoar is
+   * translated to, except for the non-Latin scripts.
+   */
+  static constexpr unsigned TABLE_SIZE = 0x180;
+
+  struct Kerning {
+    /**
+     * The code point of the following character.
+     */
+    uint16_t next;
+
+    /**
+     * The horizontal kerning offset [pixels].
+     */
+    int16_t delta;
+
+    constexpr bool operator<(unsigned other) const noexcept {
+      return next < other;
+    }
+  };
+
+  struct Glyph {
+    /**
+     * Horizontal bearing [pixels].
+     */
+    int left = 0;
+
+    /**
+     * Vertical offset of the bitmap from the top of the line
+     * [pixels].
+     */
+    int top = 0;
+
+    /**
+     * The advance to the next glyph [pixels].
+     */
+    int advance = 0;
+
+    /**
+     * The (rounded up) width of the glyph metrics [pixels], used to
+     * measure text.
+     */
+    int metrics_width = 0;
+
+    /**
+     * The dimensions of #bitmap.  The bitmap is 8 bit alpha, one
+     * byte per pixel, without padding.
+     */
+    unsigned width = 0, rows = 0;
+
+    const uint8_t *bitmap = nullptr;
+
+    /**
+     * The non-zero kerning offsets to cached characters following
+     * this one, sorted by #Kerning::next.
+     */
+    std::vector<Kerning> kerning;
+
+    /**
+     * False if the font has no such glyph (or it failed to load);
+     * the character is skipped.
+     */
+    bool defined = false;
+
+    [[gnu::pure]]
+    int GetKerning(unsigned next) const noexcept;
+  };
+
+private:
+  static constexpr std::size_t PAGE_SIZE = 16384;
+
+  std::array<std::atomic<const Glyph *>, TABLE_SIZE> table{};
+
+  /**
+   * Owns the #Glyph instances; a std::forward_list never moves its
+   * elements.
+   */
+  std::forward_list<Glyph> glyphs;
+
+  /**
+   * Memory for the glyph bitmaps.
+   */
+  std::vector<std::unique_ptr<uint8_t[]>> pages;
+
+  /**
+   * The number of bytes used in the last element of #pages.
+   */
+  std::size_t page_fill = PAGE_SIZE;
+
+  /**
+   * Were the glyphs rendered in monochrome mode?
+   */
+  const bool mono;
+
+public:
+  explicit GlyphAtlas(bool _mono) noexcept
+    :mono(_mono) {}
+
+  GlyphAtlas(const GlyphAtlas &) = delete;
+  GlyphAtlas &operator=(const GlyphAtlas &) = delete;
+
+  static constexpr bool IsCacheable(unsigned ch) noexcept {
+    return ch < TABLE_SIZE;
+  }
+
+  bool IsMono() const noexcept {
+    return mono;
+  }
+
+  /**
+   * Look up a cached glyph.  This method is lock-free and may be
+   * called from any thread.
+   *
+   * @return the glyph or nullptr if it has not been added yet
+   */
+  const Glyph *Lookup(unsigned ch) const noexcept {
+    return IsCacheable(ch)
+      ? table[ch].load(std::memory_order_acquire)
+      : nullptr;
+  }
+
+  /**
+   * Allocate memory for a glyph bitmap which will be passed to
+   * Add().  Calls must be serialised with Add().
+   */
+  uint8_t *AllocateBitmap(std::size_t size) noexcept;
+
+  /**
+   * Publish a new glyph.  Calls must be serialised, and the
+   * character must not have been added already.
+   */
+  const Glyph &Add(unsigned ch, Glyph &&glyph) noexcept;
+};
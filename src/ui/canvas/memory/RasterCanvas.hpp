@@ -5,11 +5,12 @@
 
 #include "Concepts.hpp"
 #include "Buffer.hpp"
-#include "Bresenham.hpp"
+#include "ScanlineEdge.hpp"
 #include "Murphy.hpp"
 #include "ui/dim/Point.hpp"
 #include "util/AllocatedArray.hxx"
 
+#include <algorithm>
 #include <cassert>
 
 /*
@@ -44,8 +45,7 @@ public:
 private:
   WritableImageBuffer<PixelTraits> buffer;
 
-  AllocatedArray<int> polygon_buffer;
-  AllocatedArray<BresenhamIterator> edge_buffer;
+  AllocatedArray<ScanlineEdge> edge_buffer;
 
 public:
   RasterCanvas(WritableImageBuffer<PixelTraits> _buffer,
@@ -456,6 +456,16 @@ public:
     }
   }
 
+  /**
+   * Fill a polygon (even-odd rule) with an active edge table: the
+   * edges are sorted by their top scanline, and only the edges
+   * crossing the current scanline are looked at.  Each span is
+   * submitted to PixelOperations::FillPixels() in one call.
+   *
+   * A pixel is filled if it is inside the polygon or on its top/left
+   * border; therefore, polygons sharing an edge do not overlap, and
+   * blending them does not leave a visible seam.
+   */
   template<typename PixelOperations>
   void FillPolygonFast(const PixelPoint *points, unsigned n, color_type color,
                        PixelOperations operations) noexcept {
@@ -465,169 +475,83 @@ public:
       return;
 
     edge_buffer.GrowDiscard(n);
+    ScanlineEdge *const edges = edge_buffer.data();
 
-    // initialise buffer of edge iterators, and find y range to scan
+    // initialise the edge table, and find y range to scan
     int miny = points[0].y;
     int maxy = points[0].y;
-
-    const auto *p_1 = points;
-    const auto *p_0 = points + n - 1;
-    int n_edges = 0;
-
-    while (p_1 < points+n) {
-      if (p_1->y == p_0->y) {
-        // don't add horizontal line, just draw it now?
-      } else if (p_1->y < p_0->y) {
-        edge_buffer[n_edges] = BresenhamIterator(*p_1, *p_0);
-        n_edges++;
-      } else {
-        edge_buffer[n_edges] = BresenhamIterator(*p_0, *p_1);
-        n_edges++;
-      }
-      miny = std::min(p_0->y, miny);
-      maxy = std::max(p_0->y, maxy);
-
-      p_0 = p_1;
-      p_1++;
+    unsigned n_edges = 0;
+
+    for (unsigned i = 0, j = n - 1; i < n; j = i++) {
+      const PixelPoint a = points[j], b = points[i];
+      miny = std::min(b.y, miny);
+      maxy = std::max(b.y, maxy);
+
+      // horizontal edges are implied by their neighbours
+      if (a.y < b.y)
+        edges[n_edges++] = ScanlineEdge(a, b);
+      else if (a.y > b.y)
+        edges[n_edges++] = ScanlineEdge(b, a);
     }
 
-    if (n_edges < 2)
+    const int y_start = std::max(miny, 0);
+    const int y_end = std::min(maxy, int(buffer.size.height));
+    if (n_edges < 2 || y_start >= y_end)
       return;
 
-    auto edge_start = edge_buffer.begin();
-    auto edge_end = edge_start+n_edges;
-
-    // sort array by y value (top best), then x value (left best)
-    std::sort(edge_start, edge_end, BresenhamIterator::CompareVerticalHorizontal);
-
-    // perform scans
-
-    for (int y = miny; y <= maxy; y++) {
-
-      bool changed = false;
-
-      // advance active items
-      int x = -1;
-      for (auto it= edge_start; it!= edge_end; ++it) {
-        // advance line until it gets to next y value (if possible)
-        changed |= it->AdvanceTo(y);
-        if (it->p.y == y) {
-          if (it->p.x < x)
-            changed = true; // order changed
-          else
-            x = it->p.x;
-        }
-      }
-
-      if (changed) {
-//        printf("re-sort\n");
-        std::sort(edge_start, edge_end, BresenhamIterator::CompareHorizontal);
-
-        while ((edge_start != edge_end) && (!edge_start->count)) {
-//          printf("skipping forward\n");
-          edge_start++;
-        }
-
-/*
-        for (auto it= edge_start; it!= edge_end; ++it) {
-          printf("%d,%d %d\n", it->x, it->y, it->count);
-        }
-*/
-      }
-
-      // draw line and determine status
-      bool mode = false;
-      int x0 = -1;
-      for (auto it= edge_start; it!= edge_end; ++it) {
-        // if this item is valid, it's a start point or end point of a line
-        if (it->p.y != y) 
+    std::sort(edges, edges + n_edges, ScanlineEdge::CompareTop);
+
+    /* the active edges are edges[active_begin..active_end), sorted
+       by x; the edges after that have not been reached yet */
+    unsigned active_begin = 0, active_end = 0;
+
+    for (int y = y_start; y < y_end; ++y) {
+      // activate edges beginning on this scanline (or above the buffer)
+      for (; active_end < n_edges && edges[active_end].top <= y;
+           ++active_end)
+        if (edges[active_end].top < y)
+          edges[active_end].SkipTo(y);
+
+      // remove edges which have ended
+      unsigned dest = active_end;
+      for (unsigned i = active_end; i-- > active_begin;)
+        if (edges[i].bottom > y)
+          edges[--dest] = edges[i];
+      active_begin = dest;
+
+      /* insertion sort: the order changes only where edges cross or
+         have just been activated */
+      for (unsigned i = active_begin + 1; i < active_end; ++i) {
+        if (edges[i].x >= edges[i - 1].x)
           continue;
 
-        int x1 = it->p.x;
-        if (mode) 
-          DrawHLine(x0, x1, y, color, operations);
-        mode = !mode;
-        x0 = x1;
+        const ScanlineEdge e = edges[i];
+        unsigned j = i;
+        do {
+          edges[j] = edges[j - 1];
+          --j;
+        } while (j > active_begin && e.x < edges[j - 1].x);
+        edges[j] = e;
       }
 
-    }
+      for (unsigned i = active_begin; i + 1 < active_end; i += 2)
+        DrawHLine(edges[i].x, edges[i + 1].x, y, color, operations);
 
+      for (unsigned i = active_begin; i < active_end; ++i)
+        edges[i].Next();
+    }
   }
 
   template<typename PixelOperations>
   void FillPolygon(const PixelPoint *points, unsigned n, color_type color,
                    PixelOperations operations) noexcept {
-    assert(points != nullptr);
-
-    if (n < 3)
-      return;
-
-    // Allocate temp array, only grow array
-    polygon_buffer.GrowDiscard(n);
-    int *const ints = polygon_buffer.data();
-
-    // Determine Y maxima
-    int miny = points[0].y;
-    int maxy = points[0].y;
-
-    for (unsigned i = 1; i < n; i++) {
-      if (points[i].y < miny)
-        miny = points[i].y;
-      else if (points[i].y > maxy)
-        maxy = points[i].y;
-    }
-
-    // Draw, scanning y
-    for (int y = miny; y <= maxy; y++) {
-      unsigned n_ints = 0;
-      for (unsigned i = 0; i < n; i++) {
-        unsigned ind1, ind2;
-        if (i == 0) {
-          ind1 = n - 1;
-          ind2 = 0;
-        } else {
-          ind1 = i - 1;
-          ind2 = i;
-        }
-
-        int y1 = points[ind1].y;
-        int y2 = points[ind2].y;
-        int x1, x2;
-
-        if (y1 < y2) {
-          x1 = points[ind1].x;
-          x2 = points[ind2].x;
-        } else if (y1 > y2) {
-          y2 = points[ind1].y;
-          y1 = points[ind2].y;
-          x2 = points[ind1].x;
-          x1 = points[ind2].x;
-        } else
-          continue;
-
-        if ( ((y >= y1) && (y < y2)) || ((y == maxy) && (y > y1) && (y <= y2)) ) {
-          ints[n_ints++] = ((65536 * (y - y1)) / (y2 - y1)) * (x2 - x1) + (65536 * x1);
-        }
-      }
-
-      std::sort(ints, ints + n_ints);
-
-      for (unsigned i = 0; i < n_ints; i += 2) {
-        int xa = ints[i] + 1;
-        xa = (xa >> 16) + ((xa & 32768) >> 15);
-        int xb = ints[i+1] - 1;
-        xb = (xb >> 16) + ((xb & 32768) >> 15);
-        DrawHLine(xa, xb, y, color, operations);
-      }
-    }
+    FillPolygonFast(points, n, color, operations);
   }
 
   void FillPolygon(const PixelPoint *points, unsigned n,
                    color_type color) noexcept {
     FillPolygonFast(points, n, color,
                     GetSolidPixelOperations());
-//    FillPolygon(points, n, color,
-//                GetSolidPixelOperations());
   }
 
   template<typename PixelOperations>
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "PixelTraits.hpp"
+#include "ui/canvas/PortableColor.hpp"
+
+#ifndef __SSE2__
+#error SSE2 required
+#endif
+
+#include <emmintrin.h>
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-align"
+#endif
+
+/**
+ * Implementation of AlphaPixelOperations using Intel SSE2
+ * instructions.  This calculates exactly the same results as
+ * #MMXAlphaPixelOperations, but processes 16 bytes per iteration, and
+ * does not need to switch the FPU state.
+ */
+class SSE2AlphaPixelOperations {
+protected:
+  uint8_t alpha;
+
+public:
+  constexpr SSE2AlphaPixelOperations(uint8_t _alpha):alpha(_alpha) {}
+
+  [[gnu::hot]] [[gnu::always_inline]]
+  static __m128i FillPixel(__m128i x, __m128i v_alpha, __m128i v_color) {
+    x = _mm_mullo_epi16(x, v_alpha);
+    x = _mm_add_epi16(x, v_color);
+    return _mm_srli_epi16(x, 8);
+  }
+
+  [[gnu::hot]] [[gnu::flatten]] [[gnu::nonnull]]
+  void _FillPixels(uint8_t *p, unsigned n, __m128i v_color) const {
+    const __m128i v_alpha = _mm_set1_epi16(alpha ^ 0xff);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (unsigned i = 0; i < n; ++i, p += 16) {
+      const __m128i x = _mm_loadu_si128((const __m128i *)p);
+
+      __m128i lo = FillPixel(_mm_unpacklo_epi8(x, zero), v_alpha, v_color);
+      __m128i hi = FillPixel(_mm_unpackhi_epi8(x, zero), v_alpha, v_color);
+
+      _mm_storeu_si128((__m128i *)p, _mm_packus_epi16(lo, hi));
+    }
+  }
+
+  [[gnu::hot]] [[gnu::always_inline]]
+  static __m128i AlphaBlend8(__m128i p, __m128i q,
+                             __m128i alpha, __m128i inverse_alpha) {
+    p = _mm_mullo_epi16(p, inverse_alpha);
+    q = _mm_mullo_epi16(q, alpha);
+    return _mm_srli_epi16(_mm_add_epi16(p, q), 8);
+  }
+
+  [[gnu::flatten]]
+  void _CopyPixels(uint8_t *gcc_restrict p,
+                   const uint8_t *gcc_restrict q, unsigned n) const {
+    const __m128i v_alpha = _mm_set1_epi16(alpha);
+    const __m128i inverse_alpha = _mm_set1_epi16(alpha ^ 0xff);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (unsigned i = 0; i < n / 16; ++i, p += 16, q += 16) {
+      const __m128i pv = _mm_loadu_si128((const __m128i *)p);
+      const __m128i qv = _mm_loadu_si128((const __m128i *)q);
+
+      __m128i lo = AlphaBlend8(_mm_unpacklo_epi8(pv, zero),
+                               _mm_unpacklo_epi8(qv, zero),
+                               v_alpha, inverse_alpha);
+
+      __m128i hi = AlphaBlend8(_mm_unpackhi_epi8(pv, zero),
+                               _mm_unpackhi_epi8(qv, zero),
+                               v_alpha, inverse_alpha);
+
+      _mm_storeu_si128((__m128i *)p, _mm_packus_epi16(lo, hi));
+    }
+  }
+};
+
+class SSE2Alpha8PixelOperations : SSE2AlphaPixelOperations {
+public:
+  using PixelTraits = GreyscalePixelTraits;
+  using SourcePixelTraits = GreyscalePixelTraits;
+
+  using SSE2AlphaPixelOperations::SSE2AlphaPixelOperations;
+
+  [[gnu::hot]] [[gnu::flatten]] [[gnu::nonnull]]
+  void FillPixels(Luminosity8 *p, unsigned n, Luminosity8 c) const {
+    _FillPixels((uint8_t *)p, n / 16,
+                _mm_set1_epi16(c.GetLuminosity() * alpha));
+  }
+
+  void CopyPixels(Luminosity8 *p, const Luminosity8 *q, unsigned n) const {
+    _CopyPixels((uint8_t *)p, (const uint8_t *)q, n);
+  }
+};
+
+#ifndef GREYSCALE
+
+class SSE2Alpha32PixelOperations : SSE2AlphaPixelOperations {
+public:
+  using PixelTraits = BGRAPixelTraits;
+  using SourcePixelTraits = BGRAPixelTraits;
+
+  using SSE2AlphaPixelOperations::SSE2AlphaPixelOperations;
+
+  [[gnu::hot]]
+  void FillPixels(BGRA8Color *p, unsigned n, BGRA8Color c) const {
+    const __m128i v_color = _mm_setr_epi16(c.Blue(), c.Green(),
+                                           c.Red(), c.Alpha(),
+                                           c.Blue(), c.Green(),
+                                           c.Red(), c.Alpha());
+
+    _FillPixels((uint8_t *)p, n / 4,
+                _mm_mullo_epi16(v_color, _mm_set1_epi16(alpha)));
+  }
+
+  void CopyPixels(BGRA8Color *p, const BGRA8Color *q, unsigned n) const {
+    _CopyPixels((uint8_t *)p, (const uint8_t *)q, n * 4);
+  }
+};
+
+#endif /* !GREYSCALE */
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Math/Point2D.hpp"
+
+#include <cassert>
+#include <cstdint>
+
+/**
+ * One non-horizontal polygon edge in the active edge table of the
+ * scanline polygon rasteriser (RasterCanvas::FillPolygonFast()).
+ *
+ * The edge covers the scanlines from #top (inclusive) to #bottom
+ * (exclusive).  On each scanline, #x is the intersection with the
+ * edge rounded to the nearest pixel (halves rounded up).  It is
+ * tracked exactly with an integer quotient/remainder pair, so there
+ * is no accumulated error even on very long edges.
+ */
+class ScanlineEdge {
+  /**
+   * The remainder of the current position, in units of 1/#denominator
+   * pixels, offset by half a pixel; always 0 <= remainder <
+   * #denominator.
+   */
+  int remainder;
+
+  /**
+   * Twice the height of the edge.
+   */
+  int denominator;
+
+  /**
+   * Per-scanline increment of #x and #remainder.
+   */
+  int step_x, step_remainder;
+
+public:
+  int top, bottom;
+
+  int x;
+
+  ScanlineEdge() noexcept = default;
+
+  /**
+   * @param a the upper end point
+   * @param b the lower end point; must be below #a
+   */
+  constexpr ScanlineEdge(IntPoint2D a, IntPoint2D b) noexcept
+    :remainder(b.y - a.y), denominator(2 * (b.y - a.y)),
+     top(a.y), bottom(b.y), x(a.x) {
+    assert(a.y < b.y);
+
+    const int height = b.y - a.y, width = b.x - a.x;
+
+    /* floor division, rounding towards negative infinity */
+    step_x = width / height;
+    if (width % height < 0)
+      --step_x;
+
+    step_remainder = 2 * (width - step_x * height);
+  }
+
+  /**
+   * Move to the next scanline.
+   */
+  constexpr void Next() noexcept {
+    x += step_x;
+    remainder += step_remainder;
+    if (remainder >= denominator) {
+      remainder -= denominator;
+      ++x;
+    }
+  }
+
+  /**
+   * Skip to the given scanline (without iterating all scanlines
+   * in between); used to clip the polygon at the top of the buffer.
+   */
+  constexpr void SkipTo(int y) noexcept {
+    assert(y >= top);
+
+    const int64_t n = y - top;
+    const int64_t r = remainder + n * step_remainder;
+    x += int(n * step_x + r / denominator);
+    remainder = int(r % denominator);
+    top = y;
+  }
+
+  static constexpr bool
+  CompareTop(const ScanlineEdge &a, const ScanlineEdge &b) noexcept {
+    return a.top < b.top;
+  }
+};
@@ -0,0 +1,489 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * A two-dimensional k-d tree stored in one flat array.  It replaces
+ * #QuadTree where all values are known at once and only few are
+ * added or removed later (e.g. waypoints).
+ *
+ * The values are stored in a std::vector in tree order: the median
+ * of each range is the node which splits it (alternating between the
+ * X and the Y axis), and small ranges are scanned linearly.  The
+ * positions are cached in a parallel array, so the searches don't
+ * need to dereference the values.
+ *
+ * Like #QuadTree, the tree has "bounds" which are determined by
+ * Optimise().  Values added before that (or after ClearBounds()) are
+ * appended to an unindexed tail which is scanned linearly; values
+ * added within the bounds are indexed again when the tail becomes
+ * too large.
+ */
+template<typename T, typename Accessor>
+class PackedKDTree {
+public:
+  using position_type = int;
+  using distance_type = unsigned;
+
+  /**
+   * A location on the plane.
+   */
+  struct Point {
+    position_type x, y;
+
+    constexpr Point(position_type _x, position_type _y) noexcept
+      :x(_x), y(_y) {}
+
+    constexpr position_type operator[](unsigned axis) const noexcept {
+      return axis == 0 ? x : y;
+    }
+
+    /**
+     * Calculate the square distance to another point (with 64 bit
+     * precision).
+     */
+    constexpr uint64_t SquareDistanceTo(const Point &other) const noexcept {
+      return Square(int64_t(other.x) - x) + Square(int64_t(other.y) - y);
+    }
+
+    constexpr bool operator==(const Point &other) const noexcept = default;
+  };
+
+  using const_iterator = typename std::vector<T>::const_iterator;
+
+private:
+  /**
+   * Ranges with up to this number of values are not split.
+   */
+  static constexpr std::size_t LEAF_SIZE = 8;
+
+  /**
+   * Index the tail when it has this number of values (or the square
+   * root of the size if that is larger).
+   */
+  static constexpr std::size_t MIN_REBUILD_TAIL = 32;
+
+  struct AlwaysTrue {
+    constexpr bool operator()(const T &) const noexcept {
+      return true;
+    }
+  };
+
+  /**
+   * All values; the first #n_indexed are in tree order, the rest is
+   * the unindexed tail.
+   */
+  std::vector<T> values;
+
+  /**
+   * The position of each item of #values.
+   */
+  std::vector<Point> positions;
+
+  std::size_t n_indexed = 0;
+
+  position_type left = 0, top = 0, right = 0, bottom = 0;
+  bool have_bounds = false;
+
+  static constexpr uint64_t Square(int64_t x) noexcept {
+    return uint64_t(x * x);
+  }
+
+public:
+  [[gnu::pure]]
+  static Point GetPosition(const T &value) noexcept {
+    const Accessor accessor;
+    return Point(accessor.GetX(value), accessor.GetY(value));
+  }
+
+  bool IsEmpty() const noexcept {
+    return values.empty();
+  }
+
+  std::size_t size() const noexcept {
+    return values.size();
+  }
+
+  const_iterator begin() const noexcept {
+    return values.begin();
+  }
+
+  const_iterator end() const noexcept {
+    return values.end();
+  }
+
+  void clear() noexcept {
+    values.clear();
+    positions.clear();
+    n_indexed = 0;
+    ClearBounds();
+  }
+
+  void reserve(std::size_t n) noexcept {
+    values.reserve(n);
+    positions.reserve(n);
+  }
+
+  /**
+   * Are the bounds known, i.e. has Optimise() been called?
+   */
+  bool HaveBounds() const noexcept {
+    return have_bounds;
+  }
+
+  void ClearBounds() noexcept {
+    have_bounds = false;
+  }
+
+  [[gnu::pure]]
+  bool IsWithinBounds(const Point p) const noexcept {
+    return have_bounds &&
+      p.x >= left && p.x <= right && p.y >= top && p.y <= bottom;
+  }
+
+  [[gnu::pure]]
+  bool IsWithinBounds(const T &value) const noexcept {
+    return IsWithinBounds(GetPosition(value));
+  }
+
+  /**
+   * Move all values to the unindexed tail, e.g. because their
+   * positions are going to be modified.  Call Optimise() afterwards.
+   */
+  void Flatten() noexcept {
+    n_indexed = 0;
+  }
+
+  /**
+   * Reload all positions, rescan the bounds and index all values.
+   */
+  void Optimise() noexcept {
+    std::transform(values.begin(), values.end(), positions.begin(),
+                   GetPosition);
+
+    have_bounds = !values.empty();
+    if (have_bounds) {
+      left = right = positions.front().x;
+      top = bottom = positions.front().y;
+      for (const Point p : positions) {
+        left = std::min(left, p.x);
+        right = std::max(right, p.x);
+        top = std::min(top, p.y);
+        bottom = std::max(bottom, p.y);
+      }
+    }
+
+    Rebuild();
+  }
+
+  /**
+   * Add a new value.  If it is outside of the bounds, the tree is
+   * flattened and the bounds are cleared, just like #QuadTree does.
+   */
+  template<typename U>
+  void Add(U &&value) noexcept {
+    const Point position = GetPosition(value);
+
+    if (have_bounds && !IsWithinBounds(position)) {
+      Flatten();
+      ClearBounds();
+    }
+
+    values.emplace_back(std::forward<U>(value));
+    positions.push_back(position);
+
+    if (have_bounds && IsTailTooLarge())
+      Rebuild();
+  }
+
+  void erase(const_iterator it) noexcept {
+    const std::size_t i = it - values.begin();
+    assert(i < values.size());
+
+    values.erase(values.begin() + i);
+    positions.erase(positions.begin() + i);
+
+    if (i < n_indexed)
+      Reindex();
+
+    if (IsEmpty())
+      ClearBounds();
+  }
+
+  /**
+   * Erase all elements that match the specified predicate.
+   */
+  template<class P>
+  void EraseIf(const P &predicate) noexcept {
+    std::size_t dest = 0;
+    bool erased_indexed = false;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      if (predicate(std::as_const(values[i]))) {
+        if (i < n_indexed)
+          erased_indexed = true;
+        continue;
+      }
+
+      if (dest != i) {
+        values[dest] = std::move(values[i]);
+        positions[dest] = positions[i];
+      }
+
+      ++dest;
+    }
+
+    if (dest == values.size())
+      return;
+
+    values.erase(values.begin() + dest, values.end());
+    positions.erase(positions.begin() + dest, positions.end());
+
+    if (erased_indexed)
+      Reindex();
+
+    if (IsEmpty())
+      ClearBounds();
+  }
+
+  /**
+   * Replace the value, and reposition the item in the tree (if its
+   * position has been modified).
+   */
+  template<typename U>
+  void Replace(const_iterator it, U &&value) noexcept {
+    const std::size_t i = it - values.begin();
+    assert(i < values.size());
+
+    const Point new_position = GetPosition(value);
+    values[i] = std::forward<U>(value);
+
+    if (new_position != positions[i]) {
+      positions[i] = new_position;
+      if (i < n_indexed)
+        Reindex();
+    }
+  }
+
+  template<class P>
+  [[gnu::pure]]
+  std::pair<const_iterator, distance_type>
+  FindNearestIf(const Point location, distance_type range,
+                const P &predicate) const noexcept {
+    std::size_t nearest = values.size();
+    uint64_t nearest_square_distance = Square(range);
+
+    const auto check = [&](std::size_t i){
+      const uint64_t d = positions[i].SquareDistanceTo(location);
+      if (d <= nearest_square_distance && predicate(values[i])) {
+        nearest_square_distance = d;
+        nearest = i;
+        return true;
+      }
+
+      return false;
+    };
+
+    SearchNearest(0, n_indexed, 0, location, nearest_square_distance, check);
+
+    for (std::size_t i = n_indexed; i < values.size(); ++i)
+      check(i);
+
+    return {values.begin() + nearest, distance_type(nearest_square_distance)};
+  }
+
+  [[gnu::pure]]
+  std::pair<const_iterator, distance_type>
+  FindNearest(const Point location, distance_type range) const noexcept {
+    return FindNearestIf(location, range, AlwaysTrue());
+  }
+
+  /**
+   * Find up to #k values matching the predicate which are nearest to
+   * the given location (within the given range), and invoke the
+   * visitor on them, nearest first.
+   */
+  template<class P, class V>
+  void VisitNearestIf(const Point location, distance_type range,
+                      std::size_t k, const P &predicate, V &&visitor) const {
+    if (k == 0)
+      return;
+
+    /* a max-heap of the best candidates */
+    using Candidate = std::pair<uint64_t, std::size_t>;
+    std::vector<Candidate> heap;
+    heap.reserve(k);
+
+    uint64_t max_square_distance = Square(range);
+
+    const auto check = [&](std::size_t i){
+      const uint64_t d = positions[i].SquareDistanceTo(location);
+      if (d > max_square_distance || !predicate(values[i]))
+        return false;
+
+      if (heap.size() == k) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.pop_back();
+      }
+
+      heap.emplace_back(d, i);
+      std::push_heap(heap.begin(), heap.end());
+
+      if (heap.size() == k)
+        /* from now on, only better candidates are interesting */
+        max_square_distance = heap.front().first;
+      return true;
+    };
+
+    SearchNearest(0, n_indexed, 0, location, max_square_distance, check);
+
+    for (std::size_t i = n_indexed; i < values.size(); ++i)
+      check(i);
+
+    std::sort_heap(heap.begin(), heap.end());
+    for (const auto &i : heap)
+      visitor(std::as_const(values[i.second]));
+  }
+
+  template<class V>
+  void VisitWithinRange(const Point location, distance_type range,
+                        V &visitor) const {
+    const uint64_t square_range = Square(range);
+
+    VisitWithinRange(0, n_indexed, 0, location, range, square_range, visitor);
+
+    for (std::size_t i = n_indexed; i < values.size(); ++i)
+      if (positions[i].SquareDistanceTo(location) <= square_range)
+        visitor(std::as_const(values[i]));
+  }
+
+private:
+  bool IsTailTooLarge() const noexcept {
+    const std::size_t tail = values.size() - n_indexed;
+    return tail >= MIN_REBUILD_TAIL && tail * tail >= values.size();
+  }
+
+  /**
+   * Rebuild the index after an indexed value was removed or moved.
+   * Without bounds, the positions may be stale, so everything is
+   * moved to the tail instead.
+   */
+  void Reindex() noexcept {
+    if (have_bounds)
+      Rebuild();
+    else
+      Flatten();
+  }
+
+  /**
+   * A value's position and its index in #values, used by Rebuild().
+   */
+  struct BuildItem {
+    Point position;
+    uint32_t index;
+  };
+
+  /**
+   * Rearrange all values in tree order.
+   */
+  void Rebuild() noexcept {
+    std::vector<BuildItem> order;
+    order.reserve(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i)
+      order.push_back({positions[i], uint32_t(i)});
+
+    Build(order.begin(), order.end(), 0);
+
+    std::vector<T> new_values;
+    new_values.reserve(values.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      new_values.emplace_back(std::move(values[order[i].index]));
+      positions[i] = order[i].position;
+    }
+
+    values = std::move(new_values);
+    n_indexed = values.size();
+  }
+
+  static void Build(typename std::vector<BuildItem>::iterator first,
+                    typename std::vector<BuildItem>::iterator last,
+                    unsigned axis) noexcept {
+    if (std::size_t(last - first) <= LEAF_SIZE)
+      return;
+
+    const auto middle = first + (last - first) / 2;
+    std::nth_element(first, middle, last,
+                     [axis](const BuildItem &a, const BuildItem &b){
+                       return a.position[axis] < b.position[axis];
+                     });
+
+    Build(first, middle, axis ^ 1);
+    Build(middle + 1, last, axis ^ 1);
+  }
+
+  /**
+   * Search the (indexed) range for the nearest values, nearer side
+   * first.  The function #check is called for each candidate;
+   * #max_square_distance is updated by it, and prunes the search.
+   */
+  template<typename F>
+  void SearchNearest(std::size_t first, std::size_t last, unsigned axis,
+                     const Point location, const uint64_t &max_square_distance,
+                     F &check) const {
+    if (last - first <= LEAF_SIZE) {
+      for (std::size_t i = first; i < last; ++i)
+        check(i);
+      return;
+    }
+
+    const std::size_t middle = first + (last - first) / 2;
+    const int64_t delta = int64_t(location[axis]) - positions[middle][axis];
+
+    /* the left side contains values up to the median, the right
+       side contains values from the median */
+    if (delta <= 0) {
+      SearchNearest(first, middle, axis ^ 1, location, max_square_distance, check);
+      check(middle);
+      if (Square(delta) <= max_square_distance)
+        SearchNearest(middle + 1, last, axis ^ 1, location, max_square_distance, check);
+    } else {
+      SearchNearest(middle + 1, last, axis ^ 1, location, max_square_distance, check);
+      check(middle);
+      if (Square(delta) <= max_square_distance)
+        SearchNearest(first, middle, axis ^ 1, location, max_square_distance, check);
+    }
+  }
+
+  template<class V>
+  void VisitWithinRange(std::size_t first, std::size_t last, unsigned axis,
+                        const Point location, distance_type range,
+                        uint64_t square_range, V &visitor) const {
+    if (last - first <= LEAF_SIZE) {
+      for (std::size_t i = first; i < last; ++i)
+        if (positions[i].SquareDistanceTo(location) <= square_range)
+          visitor(std::as_const(values[i]));
+      return;
+    }
+
+    const std::size_t middle = first + (last - first) / 2;
+    const int64_t delta = int64_t(location[axis]) - positions[middle][axis];
+
+    if (delta <= int64_t(range))
+      VisitWithinRange(first, middle, axis ^ 1, location, range, square_range,
+                       visitor);
+
+    if (positions[middle].SquareDistanceTo(location) <= square_range)
+      visitor(std::as_const(values[middle]));
+
+    if (-delta <= int64_t(range))
+      VisitWithinRange(middle + 1, last, axis ^ 1, location, range,
+                       square_range, visitor);
+  }
+};
@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "tstring_view.hxx"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <tchar.h>
+
+/**
+ * An associative container which maps TCHAR strings to arbitrary
+ * objects, optimised for prefix search.  Each key may have multiple
+ * values.
+ *
+ * Unlike #RadixTree, this is a flat array of entries sorted by key,
+ * and all keys are stored in one contiguous buffer, in the same
+ * order.  A prefix lookup is a binary search which yields a
+ * contiguous range of entries.
+ *
+ * New entries are inserted into a small sorted "pending" array which
+ * is merged into the main array by Commit() (or automatically when
+ * it grows too large).  Large numbers of entries should be added
+ * with a #Batch, which sorts them all at once.
+ *
+ * Entries are sorted by key; of several values with the same key,
+ * the most recently added one comes first.
+ */
+template<typename T>
+class PrefixIndex {
+  struct Entry {
+    /**
+     * The position of the key in the key buffer.
+     */
+    uint32_t key_offset, key_length;
+
+    T value;
+  };
+
+  /**
+   * Stores the keys of #entries, sorted, followed by the keys of
+   * #pending (and possibly some garbage left by Remove()).
+   */
+  std::vector<TCHAR> keys;
+
+  /**
+   * The main array, sorted by key.
+   */
+  std::vector<Entry> entries;
+
+  /**
+   * Entries not yet merged into #entries, sorted by key.  All of
+   * them are newer than all entries of #entries.
+   */
+  std::vector<Entry> pending;
+
+  /**
+   * #pending is merged when it has this many entries (or the square
+   * root of the size of #entries if that is larger), which keeps the
+   * amortised cost of Add() low.
+   */
+  static constexpr std::size_t MIN_MERGE_PENDING = 64;
+
+public:
+  /**
+   * Collects entries to be added with Add(Batch &&).
+   */
+  class Batch {
+    friend class PrefixIndex;
+
+    std::vector<TCHAR> keys;
+    std::vector<Entry> entries;
+
+  public:
+    void reserve(std::size_t n) noexcept {
+      entries.reserve(n);
+    }
+
+    void Add(tstring_view key, const T &value) noexcept {
+      entries.push_back({uint32_t(keys.size()), uint32_t(key.size()), value});
+      keys.insert(keys.end(), key.begin(), key.end());
+    }
+  };
+
+  bool empty() const noexcept {
+    return entries.empty() && pending.empty();
+  }
+
+  std::size_t size() const noexcept {
+    return entries.size() + pending.size();
+  }
+
+  void Clear() noexcept {
+    keys.clear();
+    entries.clear();
+    pending.clear();
+  }
+
+  /**
+   * Add a value.  It is immediately visible to all lookups.
+   */
+  void Add(tstring_view key, const T &value) noexcept {
+    const Entry entry{uint32_t(keys.size()), uint32_t(key.size()), value};
+    keys.insert(keys.end(), key.begin(), key.end());
+
+    /* insert before all entries with the same key, because the most
+       recent one comes first */
+    pending.insert(LowerBound(pending, key), entry);
+
+    if (pending.size() >= MIN_MERGE_PENDING &&
+        pending.size() * pending.size() >= entries.size())
+      Commit();
+  }
+
+  /**
+   * Add all values collected in the #Batch, as if Add() had been
+   * called for each of them in the same order.
+   */
+  void Add(Batch &&batch) noexcept {
+    Commit();
+
+    /* reverse before the stable sort, so later values come first */
+    std::reverse(batch.entries.begin(), batch.entries.end());
+    std::stable_sort(batch.entries.begin(), batch.entries.end(),
+                     [&batch](const Entry &a, const Entry &b){
+                       return GetKey(batch.keys, a) < GetKey(batch.keys, b);
+                     });
+
+    Merge(batch.keys, batch.entries, keys, entries);
+  }
+
+  /**
+   * Merge the pending entries into the main array.  After this, a
+   * prefix search yields exactly one contiguous range.
+   */
+  void Commit() noexcept {
+    if (!pending.empty())
+      Merge(keys, pending, keys, entries);
+  }
+
+  /**
+   * Remove the specified value with the specified key.  If there
+   * are multiple instances of the same value, only one is removed.
+   *
+   * @return true if a value was found and removed
+   */
+  bool Remove(tstring_view key, const T &value) noexcept {
+    return Remove(pending, key, value) || Remove(entries, key, value);
+  }
+
+  /**
+   * Returns a pointer to the most recently added value with the
+   * specified key, or nullptr if there is none.
+   */
+  [[gnu::pure]]
+  const T *Get(tstring_view key) const noexcept {
+    for (const auto *list : {&pending, &entries}) {
+      const auto i = LowerBound(*list, key);
+      if (i != list->end() && GetKey(*i) == key)
+        return &i->value;
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * Visit all values whose key begins with the specified prefix, in
+   * the order of their keys.
+   */
+  template<typename V>
+  void VisitPrefix(tstring_view prefix, V &&visitor) const {
+    auto a = FindPrefix(pending, prefix), b = FindPrefix(entries, prefix);
+
+    while (!a.empty() && !b.empty()) {
+      /* on equal keys, the (newer) pending entry comes first */
+      if (GetKey(b.front()) < GetKey(a.front())) {
+        visitor(b.front().value);
+        b = b.subspan(1);
+      } else {
+        visitor(a.front().value);
+        a = a.subspan(1);
+      }
+    }
+
+    for (const auto &i : a)
+      visitor(i.value);
+    for (const auto &i : b)
+      visitor(i.value);
+  }
+
+  /**
+   * Visit all values in the order of their keys.
+   */
+  template<typename V>
+  void VisitAll(V &&visitor) const {
+    VisitPrefix({}, visitor);
+  }
+
+  /**
+   * Returns the (sorted) set of characters which follow the
+   * specified prefix in all keys.
+   *
+   * @return nullptr if no key begins with the prefix
+   */
+  [[gnu::pure]]
+  TCHAR *Suggest(tstring_view prefix,
+                 TCHAR *dest, std::size_t max_length) const noexcept {
+    const auto a = FindPrefix(pending, prefix), b = FindPrefix(entries, prefix);
+    if (!prefix.empty() && a.empty() && b.empty())
+      return nullptr;
+
+    TCHAR *p = dest, *const end = dest + max_length - 1;
+
+    TCHAR a_next = NextCharacter(a, prefix.size(), 0);
+    TCHAR b_next = NextCharacter(b, prefix.size(), 0);
+    while ((a_next != 0 || b_next != 0) && p < end) {
+      TCHAR ch;
+      if (b_next == 0 || (a_next != 0 && CharLess(a_next, b_next)))
+        ch = a_next;
+      else
+        ch = b_next;
+
+      *p++ = ch;
+
+      if (a_next == ch)
+        a_next = NextCharacter(a, prefix.size(), ch);
+      if (b_next == ch)
+        b_next = NextCharacter(b, prefix.size(), ch);
+    }
+
+    *p = _T('\0');
+    return dest;
+  }
+
+private:
+  /**
+   * Compare characters like tstring_view does (i.e. unsigned).
+   */
+  static constexpr bool CharLess(TCHAR a, TCHAR b) noexcept {
+    return tstring_view::traits_type::lt(a, b);
+  }
+
+  static tstring_view GetKey(const std::vector<TCHAR> &keys,
+                             const Entry &entry) noexcept {
+    return {keys.data() + entry.key_offset, entry.key_length};
+  }
+
+  tstring_view GetKey(const Entry &entry) const noexcept {
+    return GetKey(keys, entry);
+  }
+
+  template<typename L>
+  auto LowerBound(L &list, tstring_view key) const noexcept {
+    return std::partition_point(list.begin(), list.end(),
+                                [this, key](const Entry &entry){
+                                  return GetKey(entry) < key;
+                                });
+  }
+
+  /**
+   * Returns the range of entries whose key begins with the
+   * specified prefix.
+   */
+  [[gnu::pure]]
+  std::span<const Entry> FindPrefix(const std::vector<Entry> &list,
+                                    tstring_view prefix) const noexcept {
+    const auto first = LowerBound(list, prefix);
+    const auto last = std::partition_point(first, list.end(),
+                                           [this, prefix](const Entry &entry){
+                                             return GetKey(entry).starts_with(prefix);
+                                           });
+    return {first, last};
+  }
+
+  /**
+   * Find the smallest character greater than #after which follows
+   * the prefix (of the given length) in the keys of the range.
+   *
+   * @return the character or 0 if there is none
+   */
+  [[gnu::pure]]
+  TCHAR NextCharacter(std::span<const Entry> range, std::size_t length,
+                      TCHAR after) const noexcept {
+    /* keys equal to the prefix and keys with a smaller next
+       character come first */
+    const auto i = std::partition_point(range.begin(), range.end(),
+                                        [this, length, after](const Entry &entry){
+                                          const auto key = GetKey(entry);
+                                          return key.size() <= length ||
+                                            (after != 0 && !CharLess(after, key[length]));
+                                        });
+    return i != range.end()
+      ? GetKey(*i)[length]
+      : TCHAR(0);
+  }
+
+  /**
+   * Merge a sorted list of newer entries (with keys in #a_keys) into
+   * the main array, rebuilding the key buffer in sorted order.
+   * Clears #pending.
+   */
+  void Merge(const std::vector<TCHAR> &a_keys, const std::vector<Entry> &a,
+             const std::vector<TCHAR> &b_keys, const std::vector<Entry> &b) noexcept {
+    std::vector<TCHAR> new_keys;
+    std::vector<Entry> new_entries;
+    new_entries.reserve(a.size() + b.size());
+
+    std::size_t key_size = 0;
+    for (const auto &i : a)
+      key_size += i.key_length;
+    for (const auto &i : b)
+      key_size += i.key_length;
+    new_keys.reserve(key_size);
+
+    const auto add = [&new_keys, &new_entries](const std::vector<TCHAR> &src,
+                                               const Entry &entry){
+      const auto key = GetKey(src, entry);
+      new_entries.push_back({uint32_t(new_keys.size()), entry.key_length,
+                             entry.value});
+      new_keys.insert(new_keys.end(), key.begin(), key.end());
+    };
+
+    auto i = a.begin(), j = b.begin();
+    while (i != a.end() && j != b.end()) {
+      /* on equal keys, the newer entry comes first */
+      if (GetKey(b_keys, *j) < GetKey(a_keys, *i))
+        add(b_keys, *j++);
+      else
+        add(a_keys, *i++);
+    }
+
+    for (; i != a.end(); ++i)
+      add(a_keys, *i);
+    for (; j != b.end(); ++j)
+      add(b_keys, *j);
+
+    keys = std::move(new_keys);
+    entries = std::move(new_entries);
+    pending.clear();
+  }
+
+  bool Remove(std::vector<Entry> &list, tstring_view key,
+              const T &value) noexcept {
+    for (auto i = LowerBound(list, key);
+         i != list.end() && GetKey(*i) == key; ++i) {
+      if (i->value == value) {
+        /* the key remains in the buffer until the next Merge() */
+        list.erase(i);
+        return true;
+      }
+    }
+
+    return false;
+  }
+};
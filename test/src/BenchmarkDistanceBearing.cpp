@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Compare the cost of calculating distance and bearing from one
+ * origin to many destinations: WGS84 (DistanceBearing()), the FAI
+ * sphere (DistanceBearingS()) and the bulk version of the latter.
+ */
+
+#include "Geo/GeoPoint.hpp"
+#include "Geo/Math.hpp"
+#include "Geo/SimplifiedMath.hpp"
+
+#include <chrono>
+#include <vector>
+
+#include <stdio.h>
+
+using namespace std::chrono;
+
+static constexpr unsigned N_POINTS = 4096;
+static constexpr unsigned N_ROUNDS = 1024;
+
+template<typename F>
+static void
+Measure(const char *name, F &&f)
+{
+  double checksum = 0;
+
+  const auto t0 = steady_clock::now();
+  for (unsigned i = 0; i < N_ROUNDS; ++i)
+    /* accumulate the result to prevent gcc from optimizing the
+       loop away */
+    checksum += f();
+  const auto t1 = steady_clock::now();
+
+  const double ns = duration<double, std::nano>(t1 - t0).count();
+  printf("%-8s %7.2f ns/point [%.0f]\n",
+         name, ns / (double(N_ROUNDS) * N_POINTS), checksum);
+}
+
+int main()
+{
+  const GeoPoint origin(Angle::Degrees(7.7061111111111114),
+                        Angle::Degrees(51.051944444444445));
+
+  std::vector<GeoPoint> destinations;
+  std::vector<double> latitudes, longitudes;
+
+  unsigned seed = 1;
+  auto next = [&seed](){
+    seed = seed * 1103515245 + 12345;
+    return double((seed >> 8) % 20001) / 10000 - 1;
+  };
+
+  for (unsigned i = 0; i < N_POINTS; ++i) {
+    const GeoPoint g(origin.longitude + Angle::Degrees(next() * 3),
+                     origin.latitude + Angle::Degrees(next() * 2));
+    destinations.push_back(g);
+    latitudes.push_back(g.latitude.Radians());
+    longitudes.push_back(g.longitude.Radians());
+  }
+
+  std::vector<double> distances(N_POINTS);
+  std::vector<Angle> bearings(N_POINTS);
+
+  Measure("wgs84", [&]{
+    for (unsigned i = 0; i < N_POINTS; ++i)
+      DistanceBearing(origin, destinations[i], &distances[i], &bearings[i]);
+    return distances[N_POINTS / 2] + bearings.back().Degrees();
+  });
+
+  Measure("sphere", [&]{
+    for (unsigned i = 0; i < N_POINTS; ++i)
+      DistanceBearingS(origin, destinations[i], &distances[i], &bearings[i]);
+    return distances[N_POINTS / 2] + bearings.back().Degrees();
+  });
+
+  Measure("bulk", [&]{
+    DistanceBearingS(origin, latitudes, longitudes,
+                     distances.data(), bearings.data());
+    return distances[N_POINTS / 2] + bearings.back().Degrees();
+  });
+
+  Measure("bulk/d", [&]{
+    DistanceBearingS(origin, latitudes, longitudes,
+                     distances.data(), nullptr);
+    return distances[N_POINTS / 2];
+  });
+
+  return 0;
+}
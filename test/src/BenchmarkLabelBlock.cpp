@@ -0,0 +1,246 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Measure the label collision detection of LabelBlock with the labels
+ * of a dense waypoint file (or of 50000 synthetic waypoints if no
+ * file is given), projected at a medium zoom level on a slowly
+ * panning map.  The previous implementation (fixed horizontal buckets
+ * of 64 rectangles each) is included for comparison.
+ */
+
+#include "Renderer/LabelBlock.hpp"
+#include "Projection/Projection.hpp"
+#include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/Factory.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "Screen/Layout.hpp"
+#include "Operation/ConsoleOperationEnvironment.hpp"
+#include "system/Args.hpp"
+#include "util/StaticArray.hxx"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <vector>
+
+#include <stdio.h>
+
+using namespace std::chrono;
+
+unsigned Layout::scale_1024 = 1024;
+
+static constexpr PixelSize SCREEN_SIZE{800, 480};
+static constexpr unsigned N_FRAMES = 200;
+
+/**
+ * The previous LabelBlock implementation.
+ */
+class LegacyLabelBlock {
+  static constexpr unsigned SCREEN_HEIGHT = 4096;
+  static constexpr unsigned BUCKET_SIZE = 64;
+  static constexpr unsigned BUCKET_SHIFT = 7;
+  static constexpr unsigned BUCKET_HEIGHT = 1 << BUCKET_SHIFT;
+  static constexpr unsigned BUCKET_COUNT = SCREEN_HEIGHT / BUCKET_HEIGHT;
+
+  class Bucket {
+    StaticArray<PixelRect, BUCKET_SIZE> blocks;
+
+  public:
+    void Clear() noexcept {
+      blocks.clear();
+    }
+
+    bool Check(const PixelRect rc) const noexcept {
+      for (const auto &i : blocks)
+        if (i.OverlapsWith(rc))
+          return false;
+
+      return true;
+    }
+
+    void Add(const PixelRect rc) noexcept {
+      if (!blocks.full())
+        blocks.append(rc);
+    }
+  };
+
+  Bucket buckets[BUCKET_COUNT];
+
+public:
+  bool check(const PixelRect rc) noexcept {
+    unsigned top = rc.top >> BUCKET_SHIFT;
+    unsigned bottom = rc.bottom >> BUCKET_SHIFT;
+
+    if (top >= BUCKET_COUNT)
+      top = BUCKET_COUNT - 1;
+
+    if (bottom < BUCKET_COUNT && !buckets[bottom].Check(rc))
+      return false;
+
+    if (top < bottom && !buckets[top].Check(rc))
+      return false;
+
+    buckets[top].Add(rc);
+    if (bottom < BUCKET_COUNT && top != bottom)
+      buckets[bottom].Add(rc);
+
+    return true;
+  }
+
+  void reset() noexcept {
+    for (auto &i : buckets)
+      i.Clear();
+  }
+};
+
+struct Location {
+  GeoPoint location;
+
+  /**
+   * The label width in pixels.
+   */
+  unsigned width;
+};
+
+static std::vector<Location>
+LoadWaypoints(Path path)
+{
+  Waypoints waypoints;
+  ConsoleOperationEnvironment operation;
+  ReadWaypointFile(path, waypoints,
+                   WaypointFactory(WaypointOrigin::NONE),
+                   operation);
+
+  std::vector<Location> v;
+  for (const auto &wp : waypoints)
+    v.push_back({wp->location, 7 * unsigned(wp->name.length())});
+
+  return v;
+}
+
+static std::vector<Location>
+GenerateWaypoints(unsigned n)
+{
+  std::vector<Location> v;
+
+  unsigned seed = 1;
+  auto next = [&seed](){
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) % 10000;
+  };
+
+  for (unsigned i = 0; i < n; ++i)
+    v.push_back({
+        GeoPoint(Angle::Degrees(7.7 + (next() / 10000. - 0.5) * 3),
+                 Angle::Degrees(51. + (next() / 10000. - 0.5) * 2)),
+        7 * (4 + next() % 12),
+      });
+
+  return v;
+}
+
+[[gnu::pure]]
+static GeoPoint
+GetCenter(const std::vector<Location> &locations) noexcept
+{
+  double longitude = 0, latitude = 0;
+  for (const auto &i : locations) {
+    longitude += i.location.longitude.Degrees();
+    latitude += i.location.latitude.Degrees();
+  }
+
+  return GeoPoint(Angle::Degrees(longitude / locations.size()),
+                  Angle::Degrees(latitude / locations.size()));
+}
+
+/**
+ * Project the waypoints of each frame to label rectangles (like
+ * TextInBox() does).
+ */
+static std::vector<std::vector<PixelRect>>
+MakeFrames(const std::vector<Location> &locations)
+{
+  const GeoPoint center = GetCenter(locations);
+
+  Projection projection;
+  projection.SetScreenOrigin(SCREEN_SIZE.width / 2, SCREEN_SIZE.height / 2);
+  /* 40 km across the screen */
+  projection.SetScale(SCREEN_SIZE.width / 40000.);
+
+  const PixelRect screen{SCREEN_SIZE};
+
+  std::vector<std::vector<PixelRect>> frames;
+  for (unsigned i = 0; i < N_FRAMES; ++i) {
+    /* pan slowly to the east */
+    projection.SetGeoLocation(GeoPoint(center.longitude +
+                                       Angle::Degrees(i * 0.0005),
+                                       center.latitude));
+
+    auto &frame = frames.emplace_back();
+    for (const auto &l : locations) {
+      const auto p = projection.GeoToScreen(l.location);
+      if (!screen.Contains(p))
+        continue;
+
+      frame.emplace_back(p.x + 5 - 3, p.y,
+                         p.x + 5 + int(l.width) + 2, p.y + 15);
+    }
+  }
+
+  return frames;
+}
+
+template<typename T>
+static void
+Measure(const char *name, const std::vector<std::vector<PixelRect>> &frames)
+{
+  T label_block;
+
+  std::size_t n_labels = 0, n_drawn = 0;
+
+  const auto t0 = steady_clock::now();
+  for (const auto &frame : frames) {
+    label_block.reset();
+
+    for (const auto &rc : frame)
+      if (label_block.check(rc))
+        ++n_drawn;
+
+    n_labels += frame.size();
+  }
+  const auto t1 = steady_clock::now();
+
+  const double us = duration<double, std::micro>(t1 - t0).count();
+  printf("%-8s %8.1f us/frame; %zu of %zu labels drawn per frame\n",
+         name, us / frames.size(),
+         n_drawn / frames.size(), n_labels / frames.size());
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "[PATH]");
+
+  std::vector<Location> locations;
+  if (!args.IsEmpty()) {
+    const auto path = args.ExpectNextPath();
+    args.ExpectEnd();
+
+    locations = LoadWaypoints(path);
+  } else
+    locations = GenerateWaypoints(50000);
+
+  if (locations.empty()) {
+    fprintf(stderr, "No waypoints\n");
+    return EXIT_FAILURE;
+  }
+
+  const auto frames = MakeFrames(locations);
+
+  Measure<LegacyLabelBlock>("legacy", frames);
+  Measure<LabelBlock>("hash", frames);
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Compare the scalar MacCready::SolveStraight() with its batch
+ * version on all waypoints of a waypoint file (or on 5000 synthetic
+ * destinations if no file is given).
+ */
+
+#include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/Factory.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "Engine/GlideSolvers/GlideSettings.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/GlideSolvers/GlideState.hpp"
+#include "Engine/GlideSolvers/GlideResult.hpp"
+#include "Engine/GlideSolvers/MacCready.hpp"
+#include "Geo/SpeedVector.hpp"
+#include "system/Args.hpp"
+#include "Operation/ConsoleOperationEnvironment.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include <stdio.h>
+
+static constexpr unsigned N_ITERATIONS = 1000;
+
+struct Destinations {
+  std::vector<double> distance, altitude_difference;
+  std::vector<Angle> bearing;
+
+  void Add(const GeoVector &vector, double _altitude_difference) {
+    distance.push_back(vector.distance);
+    bearing.push_back(vector.bearing);
+    altitude_difference.push_back(_altitude_difference);
+  }
+
+  std::size_t size() const noexcept {
+    return distance.size();
+  }
+};
+
+static void
+LoadWaypoints(Path path, Waypoints &waypoints)
+{
+  ConsoleOperationEnvironment operation;
+  ReadWaypointFile(path, waypoints,
+                   WaypointFactory(WaypointOrigin::NONE),
+                   operation);
+  waypoints.Optimise();
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "[PATH]");
+  const bool have_path = !args.IsEmpty();
+
+  const double altitude = 2000;
+  Destinations d;
+
+  if (have_path) {
+    const auto path = args.ExpectNextPath();
+    args.ExpectEnd();
+
+    Waypoints waypoints;
+    LoadWaypoints(path, waypoints);
+    if (waypoints.IsEmpty()) {
+      fprintf(stderr, "No waypoints\n");
+      return EXIT_FAILURE;
+    }
+
+    const GeoPoint origin = (*waypoints.begin())->location;
+    for (const auto &wp : waypoints)
+      d.Add(GeoVector(origin, wp->location),
+            altitude - wp->GetElevationOrZero());
+  } else {
+    for (unsigned i = 0; i < 5000; ++i)
+      d.Add(GeoVector(50. * (i % 1000) + 10, Angle::Degrees(i * 7.)),
+            altitude - (i % 37) * 30.);
+  }
+
+  const std::size_t n = d.size();
+
+  GlideSettings settings;
+  settings.SetDefaults();
+  GlidePolar glide_polar(1);
+  const MacCready mac_cready(settings, glide_polar);
+  const SpeedVector wind(Angle::Degrees(250), 8);
+
+  std::vector<double> arrival(n), time_elapsed(n);
+  std::vector<GlideResult::Validity> validity(n);
+
+  double sum_scalar = 0, max_error = 0;
+
+  const auto t0 = std::chrono::steady_clock::now();
+  for (unsigned j = 0; j < N_ITERATIONS; ++j) {
+    for (std::size_t i = 0; i < n; ++i) {
+      const GlideState state(GeoVector(d.distance[i], d.bearing[i]),
+                             0, d.altitude_difference[i], wind);
+      const GlideResult result = mac_cready.SolveStraight(state);
+      arrival[i] = result.altitude_difference;
+    }
+
+    /* prevent gcc from optimizing this loop away */
+    sum_scalar += arrival[j % n];
+  }
+
+  const auto t1 = std::chrono::steady_clock::now();
+
+  const std::vector<double> scalar_arrival = arrival;
+
+  double sum_batch = 0;
+  for (unsigned j = 0; j < N_ITERATIONS; ++j) {
+    mac_cready.SolveStraight(wind, d.distance, d.bearing,
+                             d.altitude_difference,
+                             arrival, time_elapsed, validity);
+    sum_batch += arrival[j % n];
+  }
+
+  const auto t2 = std::chrono::steady_clock::now();
+
+  for (std::size_t i = 0; i < n; ++i)
+    if (validity[i] == GlideResult::Validity::OK)
+      max_error = std::max(max_error,
+                           std::fabs(arrival[i] - scalar_arrival[i]));
+
+  using std::chrono::duration_cast, std::chrono::nanoseconds;
+  const double per_item = 1. / (double(N_ITERATIONS) * n);
+  printf("destinations: %zu\n", n);
+  printf("scalar: %.1f ns per destination\n",
+         duration_cast<nanoseconds>(t1 - t0).count() * per_item);
+  printf("batch:  %.1f ns per destination\n",
+         duration_cast<nanoseconds>(t2 - t1).count() * per_item);
+  printf("max arrival altitude error: %g m\n", max_error);
+  printf("checksum: %g\n", sum_scalar - sum_batch);
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
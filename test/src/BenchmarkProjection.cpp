@@ -1,11 +1,28 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 // Copyright The XCSoar Project
 
+/*
+ * Compare the scalar Projection::GeoToScreen() and
+ * FlatProjection::ProjectInteger() with their batch versions.
+ */
+
 #include "Projection/Projection.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "Geo/Flat/FlatGeoPoint.hpp"
 #include "Screen/Layout.hpp"
 
+#include <chrono>
+#include <vector>
+
+#include <stdio.h>
+
+using namespace std::chrono;
+
 unsigned Layout::scale_1024 = 1024;
 
+static constexpr unsigned N_POINTS = 4096;
+static constexpr unsigned N_ROUNDS = 16 * 1024;
+
 class TestProjection : public Projection {
 public:
   TestProjection() {
@@ -13,23 +30,78 @@ public:
     SetScale(640. / (100 * 2));
     SetGeoLocation(GeoPoint(Angle::Degrees(7.7061111111111114),
                             Angle::Degrees(51.051944444444445)));
+    SetScreenAngle(Angle::Degrees(30));
   }
 };
 
+static std::vector<GeoPoint>
+MakeLocations(const GeoPoint center)
+{
+  std::vector<GeoPoint> v;
+  v.reserve(N_POINTS);
+
+  unsigned seed = 1;
+  auto next = [&seed](){
+    seed = seed * 1103515245 + 12345;
+    return int((seed >> 8) % 2001) - 1000;
+  };
+
+  for (unsigned i = 0; i < N_POINTS; ++i)
+    v.emplace_back(center.longitude + Angle::Degrees(next() / 1e5),
+                   center.latitude + Angle::Degrees(next() / 1e5));
+
+  return v;
+}
+
+template<typename F>
+static void
+Measure(const char *name, F &&f)
+{
+  long checksum = 0;
+
+  const auto t0 = steady_clock::now();
+  for (unsigned i = 0; i < N_ROUNDS; ++i)
+    /* accumulate the result to prevent gcc from optimizing the
+       loop away */
+    checksum += f();
+  const auto t1 = steady_clock::now();
+
+  const double ns = duration<double, std::nano>(t1 - t0).count();
+  printf("%-8s %6.2f ns/point [%ld]\n",
+         name, ns / (double(N_ROUNDS) * N_POINTS), checksum);
+}
+
 int main()
 {
   TestProjection projection;
+  const auto locations = MakeLocations(projection.GetGeoLocation());
+  std::vector<PixelPoint> points(N_POINTS);
 
-  GeoPoint gp = GeoPoint(Angle::Degrees(7.7061111111111114),
-                         Angle::Degrees(51.051944444444445));
-  long x = 0, y = 0;
-  for (unsigned i = 64 * 1024 * 1024; i-- > 0;) {
-    auto rp = projection.GeoToScreen(gp);
+  Measure("scalar", [&]{
+    for (unsigned i = 0; i < N_POINTS; ++i)
+      points[i] = projection.GeoToScreen(locations[i]);
+    return long(points[N_POINTS / 2].x + points.back().y);
+  });
 
-    /* prevent gcc from optimizing this loop away */
-    x += rp.x;
-    y += rp.y;
-  }
+  Measure("batch", [&]{
+    projection.GeoToScreen(std::span<const GeoPoint>{locations},
+                           points.data());
+    return long(points[N_POINTS / 2].x + points.back().y);
+  });
+
+  const FlatProjection flat(projection.GetGeoLocation());
+  std::vector<FlatGeoPoint> flat_points(N_POINTS);
+
+  Measure("flat", [&]{
+    for (unsigned i = 0; i < N_POINTS; ++i)
+      flat_points[i] = flat.ProjectInteger(locations[i]);
+    return long(flat_points[N_POINTS / 2].x + flat_points.back().y);
+  });
+
+  Measure("flat/b", [&]{
+    flat.ProjectInteger(locations, flat_points.data());
+    return long(flat_points[N_POINTS / 2].x + flat_points.back().y);
+  });
 
-  return x + y;
+  return 0;
 }
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Measure the software polygon rasteriser (RasterCanvas, used by the
+ * memory canvas on framebuffer builds) with a scene resembling a
+ * dense airspace map: many large, overlapping circles and polygons,
+ * partially outside of the screen.
+ */
+
+#include "ui/canvas/memory/RasterCanvas.hpp"
+#include "ui/canvas/memory/PixelOperations.hpp"
+#include "ui/canvas/memory/Optimised.hpp"
+#include "Math/Constants.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <stdio.h>
+
+using namespace std::chrono;
+
+static constexpr PixelSize SCREEN_SIZE{800, 600};
+static constexpr unsigned N_ROUNDS = 50;
+
+using Polygon = std::vector<PixelPoint>;
+
+static std::vector<Polygon>
+MakeScene()
+{
+  std::vector<Polygon> scene;
+
+  srand(1);
+  auto random = [](int min, int max){
+    return min + rand() % (max - min);
+  };
+
+  /* airspace circles */
+  for (unsigned i = 0; i < 150; ++i) {
+    const PixelPoint center(random(-100, SCREEN_SIZE.width + 100),
+                            random(-100, SCREEN_SIZE.height + 100));
+    const int radius = random(20, 300);
+
+    Polygon &p = scene.emplace_back();
+    for (unsigned j = 0; j < 64; ++j) {
+      const double a = j * (2 * M_PI / 64);
+      p.emplace_back(center.x + int(radius * std::cos(a)),
+                     center.y + int(radius * std::sin(a)));
+    }
+  }
+
+  /* irregular airspace areas */
+  for (unsigned i = 0; i < 150; ++i) {
+    const PixelPoint center(random(-100, SCREEN_SIZE.width + 100),
+                            random(-100, SCREEN_SIZE.height + 100));
+
+    Polygon &p = scene.emplace_back();
+    for (unsigned j = 0; j < 24; ++j) {
+      const double a = j * (2 * M_PI / 24);
+      const int radius = random(50, 250);
+      p.emplace_back(center.x + int(radius * std::cos(a)),
+                     center.y + int(radius * std::sin(a)));
+    }
+  }
+
+  return scene;
+}
+
+/**
+ * Generate a different color for each polygon.
+ */
+static constexpr BGRA8Color
+MakeColor(unsigned i) noexcept
+{
+  return BGRA8Color(i * 37, i * 91, i * 13);
+}
+
+template<AnyPixelTraits PixelTraits>
+class BenchmarkCanvas : public RasterCanvas<PixelTraits> {
+public:
+  using RasterCanvas<PixelTraits>::RasterCanvas;
+  using RasterCanvas<PixelTraits>::At;
+};
+
+template<AnyPixelTraits PixelTraits, typename F>
+static void
+Measure(const char *name, F &&f)
+{
+  WritableImageBuffer<PixelTraits> buffer;
+  buffer.Allocate(SCREEN_SIZE);
+
+  BenchmarkCanvas<PixelTraits> canvas(buffer);
+  canvas.FillRectangle(0, 0, SCREEN_SIZE.width, SCREEN_SIZE.height,
+                       typename PixelTraits::color_type{});
+
+  const auto t0 = steady_clock::now();
+  for (unsigned i = 0; i < N_ROUNDS; ++i)
+    f(canvas);
+  const auto t1 = steady_clock::now();
+
+  /* read a pixel to prevent gcc from optimizing the drawing away */
+  const auto *p = canvas.At(SCREEN_SIZE.width / 2, SCREEN_SIZE.height / 2);
+
+  const double ms = duration<double, std::milli>(t1 - t0).count();
+  printf("%-14s %7.2f ms/frame [%u]\n",
+         name, ms / N_ROUNDS, unsigned(*(const uint8_t *)p));
+
+  buffer.Free();
+}
+
+int main()
+{
+  const auto scene = MakeScene();
+
+  Measure<BGRAPixelTraits>("bgra/opaque", [&scene](auto &canvas){
+    unsigned i = 0;
+    for (const auto &p : scene)
+      canvas.FillPolygon(p.data(), p.size(), MakeColor(++i));
+  });
+
+  Measure<BGRAPixelTraits>("bgra/alpha", [&scene](auto &canvas){
+    const AlphaPixelOperations<BGRAPixelTraits> operations(0x60);
+    unsigned i = 0;
+    for (const auto &p : scene)
+      canvas.FillPolygon(p.data(), p.size(), MakeColor(++i), operations);
+  });
+
+  Measure<GreyscalePixelTraits>("grey/opaque", [&scene](auto &canvas){
+    unsigned i = 0;
+    for (const auto &p : scene)
+      canvas.FillPolygon(p.data(), p.size(), Luminosity8(++i * 37));
+  });
+
+  Measure<GreyscalePixelTraits>("grey/alpha", [&scene](auto &canvas){
+    const AlphaPixelOperations<GreyscalePixelTraits> operations(0x60);
+    unsigned i = 0;
+    for (const auto &p : scene)
+      canvas.FillPolygon(p.data(), p.size(), Luminosity8(++i * 37),
+                         operations);
+  });
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Measure the cost of Trace::push_back() (i.e. mostly the thinning
+ * engine) by replaying IGC files.  All files are concatenated to one
+ * long flight, which is replayed into traces configured like the
+ * ones of #TraceComputer.
+ */
+
+#include "IGC/IGCParser.hpp"
+#include "IGC/IGCFix.hpp"
+#include "IGC/IGCExtensions.hpp"
+#include "io/FileLineReader.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "system/Args.hpp"
+#include "system/Path.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace std::chrono;
+
+static constexpr unsigned N_ROUNDS = 5;
+
+struct Config {
+  const char *name;
+  TracePoint::Time no_thin_time, max_time;
+  unsigned max_size;
+};
+
+static constexpr Config configs[] = {
+  { "full", minutes{2}, Trace::null_time, 1024 },
+  { "contest", {}, Trace::null_time, 256 },
+  { "sprint", {}, minutes{120}, 128 },
+  { "large", minutes{2}, Trace::null_time, 16384 },
+};
+
+/**
+ * Append the fixes of an IGC file to the vector, continuing the time
+ * line after the last fix.
+ */
+static void
+LoadFixes(std::vector<TracePoint> &fixes, Path path)
+{
+  FileLineReaderA reader(path);
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  TracePoint::Time offset{};
+  if (!fixes.empty())
+    offset = fixes.back().GetTime() + TracePoint::Time{1};
+
+  TracePoint::Time first_time{};
+  bool first = true;
+
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    IGCFix fix;
+    if (!IGCParseFix(line, extensions, fix) || !fix.gps_valid)
+      continue;
+
+    const auto time = duration_cast<TracePoint::Time>(fix.time.DurationSinceMidnight());
+    if (first) {
+      first_time = time;
+      first = false;
+    }
+
+    if (time < first_time)
+      /* ignore fixes before midnight wraparound */
+      continue;
+
+    fixes.emplace_back(fix.location, offset + (time - first_time),
+                       fix.gps_altitude, 0., 0);
+  }
+}
+
+static double
+Replay(const Config &config, const std::vector<TracePoint> &fixes,
+       unsigned long &checksum)
+{
+  const auto t0 = steady_clock::now();
+
+  for (unsigned round = 0; round < N_ROUNDS; ++round) {
+    Trace trace(config.no_thin_time, config.max_time, config.max_size);
+    for (const auto &fix : fixes)
+      trace.push_back(fix);
+
+    checksum += trace.size();
+    for (const auto &point : trace)
+      checksum += point.GetTime().count();
+  }
+
+  const auto t1 = steady_clock::now();
+  return duration<double, std::milli>(t1 - t0).count() / N_ROUNDS;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "FILE.igc ...");
+
+  std::vector<TracePoint> fixes;
+  do {
+    LoadFixes(fixes, args.ExpectNextPath());
+  } while (!args.IsEmpty());
+
+  if (fixes.empty()) {
+    fprintf(stderr, "No fixes\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("%zu fixes, %u seconds\n", fixes.size(),
+         unsigned(fixes.back().GetTime().count() -
+                  fixes.front().GetTime().count()));
+
+  for (const auto &config : configs) {
+    unsigned long checksum = 0;
+    const double ms = Replay(config, fixes, checksum);
+    printf("%-8s size %5u  %8.2f ms  %6.0f ns/fix [%lu]\n",
+           config.name, config.max_size, ms, ms * 1e6 / fixes.size(),
+           checksum);
+  }
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Compare sequential and parallel parsing of a waypoint file (or of
+ * a synthetic SeeYou file with 50000 waypoints if no file is given).
+ */
+
+#include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/WaypointFileType.hpp"
+#include "Waypoint/Factory.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "system/Args.hpp"
+#include "system/Path.hpp"
+#include "io/FileReader.hxx"
+#include "util/PrintException.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <span>
+#include <string>
+
+#include <stdio.h>
+
+static constexpr unsigned N_ITERATIONS = 5;
+
+static std::string
+LoadFile(Path path)
+{
+  FileReader reader{path};
+  std::string contents;
+  contents.resize(reader.GetSize());
+  reader.ReadFull(std::as_writable_bytes(std::span{contents}));
+  return contents;
+}
+
+static std::string
+GenerateSeeYou(unsigned n)
+{
+  std::string s = "name,code,country,lat,lon,elev,style,rwdir,rwlen,freq,desc\n";
+
+  for (unsigned i = 0; i < n; ++i) {
+    char line[256];
+    snprintf(line, sizeof(line),
+             "\"Waypoint %u\",\"WP%u\",DE,%02u%02u.%03uN,%03u%02u.%03uE,%um,%u,%03u,%um,123.500,\"Description of waypoint %u\"\n",
+             i, i, 40 + i % 15, i % 60, i % 1000,
+             i % 30, (i * 7) % 60, (i * 13) % 1000,
+             i % 3000, 1 + i % 5, i % 360, 500 + i % 1000, i);
+    s += line;
+  }
+
+  return s;
+}
+
+/**
+ * @return the best duration of all iterations in milliseconds
+ */
+static double
+Benchmark(std::string_view contents, WaypointFileType type,
+          unsigned n_threads, std::size_t &n_waypoints)
+{
+  double best = 0;
+
+  for (unsigned i = 0; i < N_ITERATIONS; ++i) {
+    Waypoints waypoints;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    ParseWaypointFile(contents, type, waypoints,
+                      WaypointFactory(WaypointOrigin::NONE), n_threads);
+    waypoints.Optimise();
+    const auto t1 = std::chrono::steady_clock::now();
+
+    const double ms =
+      std::chrono::duration<double, std::milli>(t1 - t0).count();
+    if (i == 0 || ms < best)
+      best = ms;
+
+    n_waypoints = waypoints.size();
+  }
+
+  return best;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "[PATH]");
+
+  std::string contents;
+  WaypointFileType type = WaypointFileType::SEEYOU;
+
+  if (!args.IsEmpty()) {
+    const auto path = args.ExpectNextPath();
+    args.ExpectEnd();
+
+    type = DetermineWaypointFileType(path);
+    contents = LoadFile(path);
+  } else
+    contents = GenerateSeeYou(50000);
+
+  printf("size: %zu bytes\n", contents.size());
+
+  double sequential = 0;
+  for (const unsigned n_threads : {1U, 2U, 4U, 8U}) {
+    std::size_t n_waypoints;
+    const double ms = Benchmark(contents, type, n_threads, n_waypoints);
+    if (n_threads == 1)
+      sequential = ms;
+
+    printf("%u thread(s): %zu waypoints in %.1f ms (speedup %.2f)\n",
+           n_threads, n_waypoints, ms, sequential / ms);
+  }
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
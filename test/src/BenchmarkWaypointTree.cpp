@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Compare the spatial queries of #QuadTree and #PackedKDTree on the
+ * waypoints of a file (or on 50000 random waypoints if no file is
+ * given).
+ */
+
+#include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/WaypointFileType.hpp"
+#include "Waypoint/Factory.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "Geo/Flat/TaskProjection.hpp"
+#include "system/Args.hpp"
+#include "system/Path.hpp"
+#include "io/FileReader.hxx"
+#include "util/PackedKDTree.hxx"
+#include "util/QuadTree.hxx"
+#include "util/PrintException.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+
+static constexpr unsigned N_QUERIES = 20000;
+static constexpr unsigned K_NEAREST = 32;
+
+struct WaypointAccessor {
+  int GetX(const WaypointPtr &wp) const noexcept {
+    return wp->flat_location.x;
+  }
+
+  int GetY(const WaypointPtr &wp) const noexcept {
+    return wp->flat_location.y;
+  }
+};
+
+using OldTree = QuadTree<WaypointPtr, WaypointAccessor>;
+using NewTree = PackedKDTree<WaypointPtr, WaypointAccessor>;
+
+static std::string
+LoadFile(Path path)
+{
+  FileReader reader{path};
+  std::string contents;
+  contents.resize(reader.GetSize());
+  reader.ReadFull(std::as_writable_bytes(std::span{contents}));
+  return contents;
+}
+
+static void
+GenerateWaypoints(Waypoints &waypoints, unsigned n)
+{
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> latitude(44, 54), longitude(2, 16);
+  std::uniform_int_distribution<unsigned> type(0, 9);
+
+  for (unsigned i = 0; i < n; ++i) {
+    Waypoint wp(GeoPoint(Angle::Degrees(longitude(rng)),
+                         Angle::Degrees(latitude(rng))));
+    wp.name = _T("Waypoint");
+    wp.type = type(rng) == 0
+      ? Waypoint::Type::AIRFIELD
+      : Waypoint::Type::NORMAL;
+    waypoints.Append(std::move(wp));
+  }
+}
+
+struct Query {
+  OldTree::Point point;
+  unsigned range;
+};
+
+template<typename F>
+static double
+Measure(F &&f)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+  f();
+  const auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+static void
+Print(const char *name, double old_ms, double new_ms, unsigned long checksum)
+{
+  printf("%-18s QuadTree %8.1f ms  PackedKDTree %8.1f ms  (speedup %5.2f) [%lu]\n",
+         name, old_ms, new_ms, old_ms / new_ms, checksum);
+}
+
+static bool
+IsAirport(const WaypointPtr &wp) noexcept
+{
+  return wp->IsAirport();
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "[PATH]");
+
+  Waypoints waypoints;
+
+  if (!args.IsEmpty()) {
+    const auto path = args.ExpectNextPath();
+    args.ExpectEnd();
+
+    ParseWaypointFile(LoadFile(path), DetermineWaypointFileType(path),
+                      waypoints, WaypointFactory(WaypointOrigin::NONE), 1);
+  } else
+    GenerateWaypoints(waypoints, 50000);
+
+  /* this projects all waypoints */
+  waypoints.Optimise();
+
+  if (waypoints.IsEmpty()) {
+    fprintf(stderr, "No waypoints\n");
+    return EXIT_FAILURE;
+  }
+
+  TaskProjection projection;
+  projection.Reset(waypoints.begin()->get()->location);
+  for (const auto &wp : waypoints)
+    projection.Scan(wp->location);
+  projection.Update();
+
+  printf("%u waypoints\n", waypoints.size());
+
+  OldTree old_tree;
+  NewTree new_tree;
+
+  const double old_build = Measure([&]{
+    for (const auto &wp : waypoints)
+      old_tree.Add(wp);
+    old_tree.Optimise();
+  });
+
+  const double new_build = Measure([&]{
+    new_tree.reserve(waypoints.size());
+    for (const auto &wp : waypoints)
+      new_tree.Add(wp);
+    new_tree.Optimise();
+  });
+
+  Print("build", old_build, new_build, new_tree.size());
+
+  /* queries near random waypoints */
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<std::size_t> pick(0, waypoints.size() - 1);
+  std::vector<const Waypoint *> all;
+  for (const auto &wp : waypoints)
+    all.push_back(wp.get());
+
+  const auto make_queries = [&](double range){
+    std::vector<Query> queries;
+    queries.reserve(N_QUERIES);
+    for (unsigned i = 0; i < N_QUERIES; ++i) {
+      const Waypoint &wp = *all[pick(rng)];
+      const GeoPoint location(wp.location.longitude + Angle::Degrees(0.05),
+                              wp.location.latitude);
+      const auto flat = projection.ProjectInteger(location);
+      queries.push_back({OldTree::Point(flat.x, flat.y),
+                         projection.ProjectRangeInteger(location, range)});
+    }
+    return queries;
+  };
+
+  {
+    const auto queries = make_queries(10000);
+    unsigned long old_sum = 0, new_sum = 0;
+    const double old_ms = Measure([&]{
+      for (const auto &q : queries)
+        old_sum += old_tree.FindNearest(q.point, q.range).first != old_tree.end();
+    });
+    const double new_ms = Measure([&]{
+      for (const auto &q : queries)
+        new_sum += new_tree.FindNearest(NewTree::Point(q.point.x, q.point.y),
+                                        q.range).first != new_tree.end();
+    });
+    Print("nearest", old_ms, new_ms, new_sum);
+    if (old_sum != new_sum)
+      fprintf(stderr, "nearest: mismatch %lu != %lu\n", old_sum, new_sum);
+  }
+
+  {
+    const auto queries = make_queries(50000);
+    unsigned long old_sum = 0, new_sum = 0;
+    const double old_ms = Measure([&]{
+      for (const auto &q : queries)
+        old_sum += old_tree.FindNearestIf(q.point, q.range,
+                                          IsAirport).first != old_tree.end();
+    });
+    const double new_ms = Measure([&]{
+      for (const auto &q : queries)
+        new_sum += new_tree.FindNearestIf(NewTree::Point(q.point.x, q.point.y),
+                                          q.range,
+                                          IsAirport).first != new_tree.end();
+    });
+    Print("nearest airport", old_ms, new_ms, new_sum);
+    if (old_sum != new_sum)
+      fprintf(stderr, "nearest airport: mismatch %lu != %lu\n", old_sum, new_sum);
+  }
+
+  {
+    const auto queries = make_queries(20000);
+    unsigned long old_sum = 0, new_sum = 0;
+    const double old_ms = Measure([&]{
+      for (const auto &q : queries) {
+        auto visitor = [&old_sum](const WaypointPtr &){ ++old_sum; };
+        old_tree.VisitWithinRange(q.point, q.range, visitor);
+      }
+    });
+    const double new_ms = Measure([&]{
+      for (const auto &q : queries) {
+        auto visitor = [&new_sum](const WaypointPtr &){ ++new_sum; };
+        new_tree.VisitWithinRange(NewTree::Point(q.point.x, q.point.y),
+                                  q.range, visitor);
+      }
+    });
+    Print("within range", old_ms, new_ms, new_sum);
+    if (old_sum != new_sum)
+      fprintf(stderr, "within range: mismatch %lu != %lu\n", old_sum, new_sum);
+  }
+
+  {
+    /* the QuadTree has no k-nearest query; collect all within range
+       and sort them */
+    const auto queries = make_queries(50000);
+    unsigned long old_sum = 0, new_sum = 0;
+    const double old_ms = Measure([&]{
+      std::vector<std::pair<unsigned, const Waypoint *>> candidates;
+      for (const auto &q : queries) {
+        candidates.clear();
+        auto visitor = [&candidates, &q](const WaypointPtr &wp){
+          const OldTree::Point p(wp->flat_location.x, wp->flat_location.y);
+          candidates.emplace_back(p.SquareDistanceTo(q.point), wp.get());
+        };
+        old_tree.VisitWithinRange(q.point, q.range, visitor);
+
+        const std::size_t n = std::min<std::size_t>(candidates.size(),
+                                                    K_NEAREST);
+        std::partial_sort(candidates.begin(), candidates.begin() + n,
+                          candidates.end());
+        old_sum += n;
+      }
+    });
+    const double new_ms = Measure([&]{
+      for (const auto &q : queries)
+        new_tree.VisitNearestIf(NewTree::Point(q.point.x, q.point.y), q.range,
+                                K_NEAREST,
+                                [](const WaypointPtr &){ return true; },
+                                [&new_sum](const WaypointPtr &){ ++new_sum; });
+    });
+    Print("k-nearest", old_ms, new_ms, new_sum);
+    if (old_sum != new_sum)
+      fprintf(stderr, "k-nearest: mismatch %lu != %lu\n", old_sum, new_sum);
+  }
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,505 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * A UDP load generator for SkyLines tracking servers such as
+ * xcsoar-cloud-server.  It simulates many gliders (with
+ * #AircraftSim) which cruise and circle in thermals.  Each client
+ * sends fixes, traffic requests and (after each climb) a thermal
+ * submission at configurable intervals.  Every fix is followed by a
+ * ping, and the time until the server's acknowledgement is the
+ * latency of processing one fix.
+ *
+ * With "--fix-interval=0", each client sends the next fix as soon as
+ * the previous ping has been acknowledged (or has timed out), so the
+ * acknowledge rate is the server's throughput.
+ *
+ * If the server's process id is given, its CPU usage (from
+ * /proc/PID/stat) is reported, too.
+ */
+
+#include "Tracking/SkyLines/Assemble.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Tracking/SkyLines/Server.hpp"
+#include "Replay/AircraftSim.hpp"
+#include "net/Resolver.hxx"
+#include "net/AddressInfo.hxx"
+#include "net/SocketError.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
+#include "Geo/GeoPoint.hpp"
+#include "system/Args.hpp"
+#include "util/ByteOrder.hxx"
+#include "util/NumberParser.hpp"
+#include "util/PrintException.hxx"
+#include "util/SpanCast.hxx"
+#include "util/StringCompare.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using std::chrono::steady_clock;
+
+/**
+ * Distance between the start locations of two neighbouring clients
+ * [degrees]; roughly 10 km, which gives each client a few dozen
+ * neighbours within xcsoar-cloud's traffic range.
+ */
+static constexpr double GRID_SPACING = 0.1;
+
+/**
+ * A ping which is not acknowledged within this duration is
+ * considered lost.
+ */
+static constexpr steady_clock::duration PING_TIMEOUT =
+  std::chrono::seconds(1);
+
+/**
+ * How long does a simulated climb last?
+ */
+static constexpr std::chrono::seconds CLIMB_DURATION{30};
+
+struct FloodConfig {
+  /**
+   * Intervals between two fixes, two traffic requests and two
+   * thermals of one client; a zero fix interval means "flood".
+   */
+  steady_clock::duration fix_interval = std::chrono::seconds(1);
+  steady_clock::duration traffic_interval = std::chrono::seconds(10);
+  steady_clock::duration thermal_interval = std::chrono::seconds(60);
+
+  pid_t server_pid = -1;
+};
+
+struct FloodClient {
+  UniqueSocketDescriptor socket;
+  uint64_t key;
+
+  AircraftSim sim;
+  Angle heading;
+
+  /**
+   * Simulation time when the current cruise or climb phase ends.
+   */
+  TimeStamp phase_end;
+
+  bool climbing = false;
+
+  /**
+   * The location where the current climb started.
+   */
+  AGeoPoint climb_start;
+
+  steady_clock::time_point next_fix, next_traffic;
+
+  uint16_t ping_id = 0;
+  bool waiting = false;
+  steady_clock::time_point ping_time;
+};
+
+struct Counters {
+  unsigned long fixes = 0, pings = 0, lost = 0;
+  unsigned long traffic_requests = 0, thermals = 0;
+  unsigned long acks = 0, traffic = 0, other = 0;
+
+  /**
+   * Round-trip times of all acknowledged pings [ms].
+   */
+  std::vector<float> latencies;
+};
+
+static void
+Send(const FloodClient &client, std::span<const std::byte> packet)
+{
+  if (client.socket.Send(packet, MSG_DONTWAIT) < 0 &&
+      errno != EAGAIN && errno != ECONNREFUSED)
+    throw MakeSocketError("Failed to send");
+}
+
+static uint32_t
+GetTimeMs(const FloodClient &client) noexcept
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(client.sim.GetTime().ToDuration()).count();
+}
+
+static void
+SendFix(const FloodClient &client)
+{
+  constexpr uint32_t flags = SkyLinesTracking::FixPacket::FLAG_LOCATION |
+    SkyLinesTracking::FixPacket::FLAG_TRACK |
+    SkyLinesTracking::FixPacket::FLAG_GROUND_SPEED |
+    SkyLinesTracking::FixPacket::FLAG_AIRSPEED |
+    SkyLinesTracking::FixPacket::FLAG_ALTITUDE |
+    SkyLinesTracking::FixPacket::FLAG_VARIO;
+
+  const auto &state = client.sim.GetState();
+  Send(client, ReferenceAsBytes(SkyLinesTracking::MakeFix(client.key, flags,
+                                                          GetTimeMs(client),
+                                                          state.location,
+                                                          state.track,
+                                                          state.ground_speed,
+                                                          state.true_airspeed,
+                                                          (int)state.altitude,
+                                                          state.vario, 0)));
+}
+
+/**
+ * Advance the simulation of one client: it cruises straight ahead
+ * (with slight heading changes) while sinking, then circles in a
+ * thermal, and submits the thermal at the end of the climb.
+ */
+static void
+Fly(FloodClient &client, const FloodConfig &config,
+    FloatDuration timestep, std::minstd_rand &rng, Counters &counters)
+{
+  auto &state = client.sim.GetState();
+
+  if (client.climbing) {
+    client.heading += Angle::Degrees(18 * timestep.count());
+  } else {
+    std::uniform_real_distribution<double> turn(-2, 2);
+    client.heading += Angle::Degrees(turn(rng));
+  }
+
+  client.sim.Update(client.heading.AsBearing(), timestep);
+
+  if (state.time < client.phase_end)
+    return;
+
+  if (client.climbing) {
+    const double lift = (state.altitude - client.climb_start.altitude) /
+      std::chrono::duration<double>(CLIMB_DURATION).count();
+
+    Send(client, ReferenceAsBytes(SkyLinesTracking::MakeThermalSubmit(client.key,
+                                                                      GetTimeMs(client),
+                                                                      client.climb_start,
+                                                                      (int)client.climb_start.altitude,
+                                                                      state.location,
+                                                                      (int)state.altitude,
+                                                                      lift)));
+    ++counters.thermals;
+
+    client.climbing = false;
+    state.vario = -1;
+    client.phase_end = state.time +
+      std::max(config.thermal_interval - CLIMB_DURATION,
+               steady_clock::duration(std::chrono::seconds(1)));
+  } else {
+    std::uniform_real_distribution<double> vario(1, 4);
+    client.climbing = true;
+    client.climb_start = AGeoPoint(state.location, state.altitude);
+    state.vario = vario(rng);
+    client.phase_end = state.time + CLIMB_DURATION;
+  }
+}
+
+static void
+Receive(FloodClient &client, steady_clock::time_point now,
+        Counters &counters)
+{
+  alignas(uint64_t) std::byte buffer[4096];
+
+  while (true) {
+    ssize_t nbytes = client.socket.ReadNoWait(buffer);
+    if (nbytes < 0)
+      return;
+
+    if ((size_t)nbytes < sizeof(SkyLinesTracking::Header))
+      continue;
+
+    const auto &header = *(const SkyLinesTracking::Header *)buffer;
+    switch (FromBE16(header.type)) {
+    case SkyLinesTracking::ACK:
+      if ((size_t)nbytes >= sizeof(SkyLinesTracking::ACKPacket) &&
+          client.waiting &&
+          FromBE16(((const SkyLinesTracking::ACKPacket *)buffer)->id) == client.ping_id) {
+        client.waiting = false;
+        ++counters.acks;
+        counters.latencies.push_back(std::chrono::duration<float, std::milli>(now - client.ping_time).count());
+      }
+      break;
+
+    case SkyLinesTracking::TRAFFIC_RESPONSE:
+      ++counters.traffic;
+      break;
+
+    default:
+      ++counters.other;
+    }
+  }
+}
+
+static void
+ReceiveAll(std::vector<FloodClient> &clients,
+           std::vector<struct pollfd> &pfds, int timeout_ms,
+           Counters &counters)
+{
+  if (poll(pfds.data(), pfds.size(), timeout_ms) <= 0)
+    return;
+
+  const auto now = steady_clock::now();
+  for (std::size_t i = 0; i < pfds.size(); ++i)
+    if (pfds[i].revents & POLLIN)
+      Receive(clients[i], now, counters);
+}
+
+/**
+ * Determine the CPU time consumed by the given process so far.
+ *
+ * @return the CPU time [s] or a negative value on error
+ */
+static double
+GetProcessCPUTime(pid_t pid) noexcept
+{
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+
+  FILE *file = fopen(path, "r");
+  if (file == nullptr)
+    return -1;
+
+  char buffer[1024];
+  const size_t length = fread(buffer, 1, sizeof(buffer) - 1, file);
+  fclose(file);
+  buffer[length] = 0;
+
+  /* the process name may contain spaces; skip it */
+  const char *p = strrchr(buffer, ')');
+  if (p == nullptr)
+    return -1;
+
+  /* "state" is the third field, "utime" and "stime" are the 14th and
+     15th */
+  unsigned long utime, stime;
+  if (sscanf(p + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+             &utime, &stime) != 2)
+    return -1;
+
+  return double(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+static void
+PrintLatencies(std::vector<float> &latencies)
+{
+  if (latencies.empty())
+    return;
+
+  std::sort(latencies.begin(), latencies.end());
+
+  const auto percentile = [&latencies](double p){
+    return latencies[std::min(std::size_t(p * latencies.size()),
+                              latencies.size() - 1)];
+  };
+
+  printf("latency: p50=%.2fms p90=%.2fms p99=%.2fms p99.9=%.2fms max=%.2fms\n",
+         percentile(0.5), percentile(0.9), percentile(0.99),
+         percentile(0.999), latencies.back());
+}
+
+/**
+ * Allow one socket per client.
+ */
+static void
+RaiseFileLimit(unsigned n_clients) noexcept
+{
+  struct rlimit rl;
+  if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < n_clients + 64) {
+    rl.rlim_cur = std::min<rlim_t>(rl.rlim_max, n_clients + 64);
+    setrlimit(RLIMIT_NOFILE, &rl);
+  }
+}
+
+static steady_clock::duration
+ParseInterval(const char *s, Args &args)
+{
+  char *endptr;
+  const double value = ParseDouble(s, &endptr);
+  if (endptr == s || *endptr != 0 || value < 0)
+    args.UsageError();
+
+  return std::chrono::duration_cast<steady_clock::duration>(FloatDuration(value));
+}
+
+int
+main(int argc, char **argv)
+try {
+  Args args(argc, argv,
+            "[OPTIONS] HOST[:PORT] [CLIENTS] [SECONDS]\n\n"
+            "Options:\n"
+            "  --fix-interval=S      seconds between two fixes (default 1; 0 = flood)\n"
+            "  --traffic-interval=S  seconds between two traffic requests (default 10)\n"
+            "  --thermal-interval=S  seconds between two thermals (default 60)\n"
+            "  --pid=PID             report the CPU usage of this server process");
+
+  FloodConfig config;
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--fix-interval=")) != nullptr)
+      config.fix_interval = ParseInterval(value, args);
+    else if ((value = StringAfterPrefix(arg, "--traffic-interval=")) != nullptr)
+      config.traffic_interval = ParseInterval(value, args);
+    else if ((value = StringAfterPrefix(arg, "--thermal-interval=")) != nullptr)
+      config.thermal_interval = ParseInterval(value, args);
+    else if ((value = StringAfterPrefix(arg, "--pid=")) != nullptr)
+      config.server_pid = ParseUnsigned(value);
+    else
+      args.UsageError();
+  }
+
+  const char *host = args.ExpectNext();
+  const unsigned n_clients = args.IsEmpty()
+    ? 1000 : ParseUnsigned(args.ExpectNext());
+  const unsigned seconds = args.IsEmpty()
+    ? 10 : ParseUnsigned(args.ExpectNext());
+  args.ExpectEnd();
+
+  if (n_clients == 0 || config.traffic_interval.count() == 0)
+    args.UsageError();
+
+  const bool flood = config.fix_interval.count() == 0;
+
+  /* in flood mode, the simulation advances one second per fix */
+  const FloatDuration timestep = flood
+    ? FloatDuration(1)
+    : std::chrono::duration_cast<FloatDuration>(config.fix_interval);
+
+  const auto address_list =
+    Resolve(host, SkyLinesTracking::Server::GetDefaultPort(), 0, SOCK_DGRAM);
+  const SocketAddress address = address_list.GetBest();
+
+  RaiseFileLimit(n_clients);
+
+  const unsigned columns = 32;
+
+  std::minstd_rand rng(42);
+  std::uniform_real_distribution<double> random_angle(0, 360);
+  std::uniform_real_distribution<double> random_fraction(0, 1);
+
+  const auto start = steady_clock::now();
+
+  std::vector<FloodClient> clients(n_clients);
+  std::vector<struct pollfd> pfds(n_clients);
+  for (unsigned i = 0; i < n_clients; ++i) {
+    auto &c = clients[i];
+    if (!c.socket.Create(address.GetFamily(), SOCK_DGRAM, 0))
+      throw MakeSocketError("Failed to create socket");
+    if (!c.socket.Connect(address))
+      throw MakeSocketError("Failed to connect");
+
+    c.key = 0x1000 + i;
+
+    const ::GeoPoint location(Angle::Degrees(7 + GRID_SPACING * (i % columns)),
+                              Angle::Degrees(51 + GRID_SPACING * (i / columns)));
+    c.heading = Angle::Degrees(random_angle(rng));
+    c.sim.Start(location, location, 1000);
+    c.sim.GetState().true_airspeed = 25;
+    c.sim.GetState().vario = -1;
+
+    /* start the clients at different phases of their flights, and
+       spread their packets evenly over each interval */
+    c.phase_end = TimeStamp{std::chrono::duration_cast<FloatDuration>(config.thermal_interval * random_fraction(rng))};
+    c.next_fix = start + config.fix_interval * i / n_clients;
+    c.next_traffic = start + config.traffic_interval * i / n_clients;
+
+    pfds[i] = {c.socket.Get(), POLLIN, 0};
+  }
+
+  Counters counters;
+
+  const double cpu_start = config.server_pid > 0
+    ? GetProcessCPUTime(config.server_pid)
+    : -1;
+
+  const auto end = start + std::chrono::seconds(seconds);
+
+  for (auto now = start; now < end; now = steady_clock::now()) {
+    for (auto &c : clients) {
+      if (now >= c.next_traffic) {
+        /* ask for traffic, so the server sends traffic updates */
+        Send(c, ReferenceAsBytes(SkyLinesTracking::MakeTrafficRequest(c.key,
+                                                                      false, false,
+                                                                      true)));
+        ++counters.traffic_requests;
+        c.next_traffic += config.traffic_interval;
+      }
+
+      if (c.waiting && now >= c.ping_time + PING_TIMEOUT) {
+        ++counters.lost;
+        c.waiting = false;
+      }
+
+      if (flood ? c.waiting : now < c.next_fix)
+        continue;
+
+      Fly(c, config, timestep, rng, counters);
+
+      SendFix(c);
+      ++counters.fixes;
+      c.next_fix += config.fix_interval;
+
+      if (c.waiting)
+        /* the previous ping is still pending; don't send another
+           one, because it would distort the latency */
+        continue;
+
+      ++c.ping_id;
+      Send(c, ReferenceAsBytes(SkyLinesTracking::MakePing(c.key, c.ping_id)));
+      ++counters.pings;
+
+      c.waiting = true;
+      c.ping_time = now;
+    }
+
+    ReceiveAll(clients, pfds, 1, counters);
+  }
+
+  const double duration =
+    std::chrono::duration<double>(steady_clock::now() - start).count();
+
+  const double cpu_end = config.server_pid > 0
+    ? GetProcessCPUTime(config.server_pid)
+    : -1;
+
+  /* collect late responses */
+  const auto drain_end = steady_clock::now() + PING_TIMEOUT;
+  while (steady_clock::now() < drain_end)
+    ReceiveAll(clients, pfds, 10, counters);
+
+  for (const auto &c : clients)
+    if (c.waiting)
+      ++counters.lost;
+
+  printf("clients: %u\n", n_clients);
+  printf("sent: %.0f fixes/s, %.0f pings/s, %.1f traffic requests/s, %.1f thermals/s\n",
+         counters.fixes / duration, counters.pings / duration,
+         counters.traffic_requests / duration, counters.thermals / duration);
+  printf("received: %.0f acks/s, %.0f traffic datagrams/s\n",
+         counters.acks / duration, counters.traffic / duration);
+  printf("ping loss: %.1f%%\n",
+         counters.pings > 0 ? 100. * counters.lost / counters.pings : 0.);
+  PrintLatencies(counters.latencies);
+
+  if (cpu_start >= 0 && cpu_end >= 0) {
+    const double cpu = 100. * (cpu_end - cpu_start) / duration;
+    printf("server CPU: %.1f%% (%.1f%% per 1000 clients)\n",
+           cpu, cpu * 1000. / n_clients);
+  } else if (config.server_pid > 0)
+    fprintf(stderr, "Failed to read the CPU usage of process %d\n",
+            (int)config.server_pid);
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
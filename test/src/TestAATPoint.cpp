@@ -120,15 +120,124 @@ TestAATPoint()
   }
 }
 
+static void
+TestIdleTargets()
+{
+  OrderedTask task(task_behaviour);
+  task.Append(StartPoint(std::make_unique<CylinderZone>(wp1->location, 500),
+                         WaypointPtr(wp1),
+                         task_behaviour,
+                         ordered_task_settings.start_constraints));
+  task.Append(AATPoint(std::make_unique<CylinderZone>(wp2->location, 10000),
+                       WaypointPtr(wp2),
+                       task_behaviour));
+  task.Append(FinishPoint(std::make_unique<CylinderZone>(wp3->location, 500),
+                          WaypointPtr(wp3),
+                          task_behaviour,
+                          ordered_task_settings.finish_constraints));
+
+  OrderedTaskSettings settings = ordered_task_settings;
+  settings.aat_min_time = std::chrono::hours{3};
+  task.SetOrderedTaskSettings(settings);
+  task.SetActiveTaskPoint(1);
+  task.UpdateGeometry();
+  ok1(!IsError(task.CheckTask()));
+
+  GlidePolar polar(1);
+
+  AircraftState aircraft;
+  aircraft.Reset();
+  aircraft.location = wp1->location;
+  aircraft.altitude = 1500;
+
+  const auto &counters = task.GetUpdateCounters();
+
+  /* the first call runs the target searches, the second one has
+     nothing to do */
+  task.UpdateIdle(aircraft, polar);
+  ok1(counters.min_target == 1);
+  ok1(counters.opt_target == 1);
+  task.UpdateIdle(aircraft, polar);
+  ok1(counters.min_target == 1);
+  ok1(counters.opt_target == 1);
+
+  /* moving the target manually triggers a new run */
+  AATPoint &ap = (AATPoint &)task.GetPoint(1);
+  ap.SetTarget(MakeGeoPoint(0.05, 45.3), true);
+  task.UpdateIdle(aircraft, polar);
+  ok1(counters.min_target == 2);
+  task.UpdateIdle(aircraft, polar);
+  ok1(counters.min_target == 2);
+
+  /* so does a new aircraft state ... */
+  aircraft.altitude = 1400;
+  task.UpdateIdle(aircraft, polar);
+  ok1(counters.min_target == 3);
+
+  /* ... a new MacCready setting ... */
+  polar.SetMC(2);
+  task.UpdateIdle(aircraft, polar);
+  ok1(counters.min_target == 4);
+
+  /* ... another polar ... */
+  polar.SetCoefficients(PolarCoefficients(0.00180, -0.0800, 1.55));
+  task.UpdateIdle(aircraft, polar);
+  ok1(counters.min_target == 5);
+
+  /* ... another glider mass ... */
+  polar.SetCrewMass(polar.GetCrewMass() + 20);
+  task.UpdateIdle(aircraft, polar);
+  ok1(counters.min_target == 6);
+  task.UpdateIdle(aircraft, polar);
+  ok1(counters.min_target == 6);
+
+  /* ... and a task modification */
+  task.UpdateGeometry();
+  task.UpdateIdle(aircraft, polar);
+  ok1(counters.min_target == 7);
+  ok1(counters.opt_target == 7);
+}
+
+static void
+TestMaxSearch()
+{
+  OrderedTask task(task_behaviour);
+  task.Append(StartPoint(std::make_unique<CylinderZone>(wp1->location, 500),
+                         WaypointPtr(wp1),
+                         task_behaviour,
+                         ordered_task_settings.start_constraints));
+  task.Append(AATPoint(std::make_unique<CylinderZone>(wp2->location, 10000),
+                       WaypointPtr(wp2),
+                       task_behaviour));
+  task.Append(FinishPoint(std::make_unique<CylinderZone>(wp3->location, 500),
+                          WaypointPtr(wp3),
+                          task_behaviour,
+                          ordered_task_settings.finish_constraints));
+  task.UpdateGeometry();
+  ok1(!IsError(task.CheckTask()));
+
+  /* before the start, there are no sampled points, and the
+     "max" search reuses the "max total" solution */
+  const auto &counters = task.GetUpdateCounters();
+  ok1(counters.dijkstra_max_total == 1);
+  ok1(counters.dijkstra_max == 0);
+
+  const TaskStats &stats = task.GetStats();
+  ok1(stats.distance_max > stats.distance_nominal);
+  ok1(equals(stats.distance_max, stats.distance_max_total));
+}
+
 static void
 TestAll()
 {
   TestAATPoint();
+  TestIdleTargets();
+  TestMaxSearch();
 }
 
 int main()
 {
-  plan_tests(717);
+  plan_tests(736);
 
   task_behaviour.SetDefaults();
   ordered_task_settings.SetDefaults();
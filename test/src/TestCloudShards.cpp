@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Cloud/Shards.hpp"
+#include "Cloud/Serialiser.hpp"
+#include "net/IPv4Address.hxx"
+#include "io/StringOutputStream.hxx"
+#include "io/MemoryReader.hxx"
+#include "TestUtil.hpp"
+
+#include <atomic>
+#include <iterator>
+#include <thread>
+
+static std::size_t
+CountSavedClients(const CloudShards &shards)
+{
+  StringOutputStream sos;
+
+  {
+    Serialiser s(sos);
+    shards.Save(s);
+    s.Flush();
+  }
+
+  const auto &value = sos.GetValue();
+  MemoryReader reader{std::as_bytes(std::span{value})};
+  Deserialiser d(reader);
+
+  CloudData data;
+  data.Load(d);
+  return std::distance(data.clients.begin(), data.clients.end());
+}
+
+static void
+TestMovingClient()
+{
+  /* one client moves back and forth between two shards while
+     snapshots are taken; each snapshot must contain it exactly
+     once */
+  CloudShards shards(4);
+
+  const IPv4Address address(127, 0, 0, 1, 5597);
+  const GeoPoint west(Angle::Degrees(-100), Angle::Degrees(50));
+  const GeoPoint east(Angle::Degrees(100), Angle::Degrees(50));
+
+  shards.UpdateClient(address, 42, west, 1000);
+
+  std::atomic_bool stop{false};
+  std::thread mover([&]{
+    for (unsigned i = 0; !stop; ++i)
+      shards.UpdateClient(address, 42, i % 2 == 0 ? east : west, 1000);
+  });
+
+  bool exactly_once = true;
+  for (unsigned i = 0; i < 2000; ++i)
+    if (CountSavedClients(shards) != 1)
+      exactly_once = false;
+
+  stop = true;
+  mover.join();
+
+  ok1(exactly_once);
+  ok1(CountSavedClients(shards) == 1);
+}
+
+int main()
+{
+  plan_tests(2);
+
+  TestMovingClient();
+
+  return exit_status();
+}
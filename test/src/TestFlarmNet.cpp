@@ -6,11 +6,39 @@
 #include "FLARM/FlarmNetRecord.hpp"
 #include "FLARM/Id.hpp"
 #include "system/Path.hpp"
+#include "io/FileOutputStream.hxx"
 #include "TestUtil.hpp"
 
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include <stdio.h>
+
+static std::string
+ReadImage(const char *path)
+{
+  std::string image;
+  FILE *file = fopen(path, "rb");
+  char buffer[4096];
+  std::size_t nbytes;
+  while ((nbytes = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    image.append(buffer, nbytes);
+  fclose(file);
+  return image;
+}
+
+static void
+WriteImage(const char *path, const std::string &image)
+{
+  FILE *file = fopen(path, "wb");
+  fwrite(image.data(), 1, image.size(), file);
+  fclose(file);
+}
+
 int main()
 {
-  plan_tests(15);
+  plan_tests(30);
 
   FlarmNetDatabase db;
   int count = FlarmNetReader::LoadFile(Path(_T("test/data/flarmnet/data.fln")),
@@ -59,5 +87,69 @@ int main()
   ok1(foundDDA85C);
   ok1(foundDDA896);
 
+  /* callsigns are normalised to upper case */
+  ok1(db.FindIdsByCallSign(_T("th"), ids, 3) == 2);
+  ok1(db.FindFirstRecordByCallSign(_T("tH")) != nullptr);
+  ok1(db.FindFirstRecordByCallSign(_T("T")) == nullptr);
+  ok1(db.FindIdsByCallSign(_T("TH"), ids, 1) == 1);
+
+  /* prefix search */
+  ok1(db.FindIdsByCallSignPrefix(_T("t"), ids, 3) == 2);
+  ok1(db.FindIdsByCallSignPrefix(_T("TH"), ids, 3) == 2);
+  ok1(db.FindIdsByCallSignPrefix(_T("THX"), ids, 3) == 0);
+  ok1(db.FindIdsByCallSignPrefix(_T(""), ids, 3) == 3);
+
+  /* round trip through the binary image */
+  const Path image_path(_T("output/test/flarmnet.bin"));
+  const Path source_path(_T("test/data/flarmnet/data.fln"));
+  {
+    FileOutputStream fos(image_path);
+    db.SaveImage(fos, source_path, 1234, 5678);
+    fos.Commit();
+  }
+
+  FlarmNetDatabase db2;
+  ok1(!db2.LoadImage(image_path, source_path, 1234, 5679));
+  ok1(!db2.LoadImage(image_path, Path(_T("other.fln")), 1234, 5678));
+  ok1(db2.LoadImage(image_path, source_path, 1234, 5678));
+  ok1(db2.size() == db.size());
+
+  record = db2.FindRecordById(id2);
+  ok1(record != nullptr && StringIsEqual(record->registration, _T("D-5799")));
+
+  const std::string image = ReadImage("output/test/flarmnet.bin");
+
+  /* an unterminated string (which would make the callsign lookups
+     read beyond the record) is rejected; the records follow the 48
+     byte header */
+  {
+    std::string corrupt = image;
+    memset(corrupt.data() + 48 + offsetof(FlarmNetRecord, callsign), 'X',
+           sizeof(FlarmNetRecord::callsign));
+    WriteImage("output/test/flarmnet.bin", corrupt);
+  }
+
+  FlarmNetDatabase db3;
+  ok1(!db3.LoadImage(image_path, source_path, 1234, 5678));
+
+  /* an id table without an empty slot (which would make lookups loop
+     forever) is rejected; the table lies between the (aligned)
+     records and the callsign index */
+  {
+    std::string corrupt = image;
+    const std::size_t n = db.size();
+    const std::size_t begin = (48 + n * sizeof(FlarmNetRecord) + 3) & ~std::size_t(3);
+    const std::size_t end = corrupt.size() - n * sizeof(uint32_t);
+    for (std::size_t i = begin; i < end; i += sizeof(uint32_t)) {
+      const uint32_t value = 1;
+      memcpy(corrupt.data() + i, &value, sizeof(value));
+    }
+
+    WriteImage("output/test/flarmnet.bin", corrupt);
+  }
+
+  FlarmNetDatabase db4;
+  ok1(!db4.LoadImage(image_path, source_path, 1234, 5678));
+
   return exit_status();
 }
@@ -5,6 +5,8 @@
 #include "GlideSolvers/GlidePolar.hpp"
 #include "Units/System.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 
 class GlidePolarTest
@@ -20,6 +22,7 @@ private:
   void TestBallast();
   void TestBugs();
   void TestMC();
+  void TestSpeedToFly();
 };
 
 void
@@ -145,6 +148,40 @@ GlidePolarTest::TestMC()
   ok1(equals(polar.GetVBestLD(), 25.830434162));
 }
 
+/**
+ * Find the speed to fly by brute force search.
+ */
+static double
+SearchSpeedToFly(const GlidePolar &polar, double netto, double head_wind)
+{
+  double best_v = 0, best_f = 1e9;
+  for (double vg = std::max(1., polar.GetVMin() - head_wind);
+       vg <= polar.GetVMax() - head_wind; vg += 0.001) {
+    const double f = (polar.MSinkRate(vg + head_wind) + netto) / vg;
+    if (f < best_f) {
+      best_f = f;
+      best_v = vg + head_wind;
+    }
+  }
+
+  return best_v;
+}
+
+void
+GlidePolarTest::TestSpeedToFly()
+{
+  for (const double mc : {0., 1., 3.}) {
+    polar.SetMC(mc);
+
+    for (const double netto : {-2., 0., 1.5})
+      for (const double head_wind : {-10., 0., 10.})
+        ok1(fabs(polar.SpeedToFly(netto, head_wind) -
+                 SearchSpeedToFly(polar, netto, head_wind)) < 0.01);
+  }
+
+  polar.SetMC(0);
+}
+
 void
 GlidePolarTest::Run()
 {
@@ -153,11 +190,12 @@ GlidePolarTest::Run()
   TestBallast();
   TestBugs();
   TestMC();
+  TestSpeedToFly();
 }
 
 int main()
 {
-  plan_tests(46);
+  plan_tests(73);
 
   GlidePolarTest test;
   test.Run();
@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ui/canvas/freetype/GlyphAtlas.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <thread>
+
+static void
+TestLookup()
+{
+  GlyphAtlas atlas(false);
+  ok1(!atlas.IsMono());
+  ok1(GlyphAtlas::IsCacheable('A'));
+  ok1(!GlyphAtlas::IsCacheable(0x4e00));
+
+  ok1(atlas.Lookup('A') == nullptr);
+  ok1(atlas.Lookup(0x4e00) == nullptr);
+
+  GlyphAtlas::Glyph glyph;
+  glyph.defined = true;
+  glyph.advance = 7;
+  glyph.kerning = {{'V', -2}, {'W', -1}};
+
+  const auto &a = atlas.Add('A', std::move(glyph));
+  ok1(atlas.Lookup('A') == &a);
+  ok1(atlas.Lookup('B') == nullptr);
+  ok1(a.advance == 7);
+
+  ok1(a.GetKerning('V') == -2);
+  ok1(a.GetKerning('W') == -1);
+  ok1(a.GetKerning('U') == 0);
+  ok1(a.GetKerning('X') == 0);
+
+  /* undefined glyphs are cached, too */
+  const auto &missing = atlas.Add(0x17f, {});
+  ok1(atlas.Lookup(0x17f) == &missing);
+  ok1(!missing.defined);
+}
+
+static void
+TestAllocate()
+{
+  GlyphAtlas atlas(true);
+  ok1(atlas.IsMono());
+
+  ok1(atlas.AllocateBitmap(0) == nullptr);
+
+  /* fill a few pages with small and large bitmaps and check that
+     they do not overlap */
+  std::vector<std::pair<uint8_t *, std::size_t>> bitmaps;
+  for (unsigned i = 0; i < 200; ++i) {
+    const std::size_t size = i % 17 == 0 ? 6000 : 50 + i * 3;
+    uint8_t *p = atlas.AllocateBitmap(size);
+    std::fill_n(p, size, uint8_t(i));
+    bitmaps.emplace_back(p, size);
+  }
+
+  bool intact = true;
+  for (unsigned i = 0; i < bitmaps.size(); ++i) {
+    const auto [p, size] = bitmaps[i];
+    if (std::any_of(p, p + size,
+                    [i](uint8_t value){ return value != uint8_t(i); }))
+      intact = false;
+  }
+
+  ok1(intact);
+}
+
+static void
+TestConcurrentLookup()
+{
+  GlyphAtlas atlas(false);
+
+  /* a reader must see either nothing or the complete glyph */
+  bool consistent = true;
+  std::thread reader([&atlas, &consistent]{
+    for (unsigned done = 0; done < GlyphAtlas::TABLE_SIZE;) {
+      done = 0;
+      for (unsigned ch = 0; ch < GlyphAtlas::TABLE_SIZE; ++ch) {
+        if (const auto *glyph = atlas.Lookup(ch)) {
+          if (glyph->advance != int(ch) || glyph->bitmap == nullptr ||
+              glyph->bitmap[0] != uint8_t(ch))
+            consistent = false;
+          ++done;
+        }
+      }
+    }
+  });
+
+  for (unsigned ch = 0; ch < GlyphAtlas::TABLE_SIZE; ++ch) {
+    GlyphAtlas::Glyph glyph;
+    glyph.defined = true;
+    glyph.advance = ch;
+    glyph.width = glyph.rows = 4;
+
+    uint8_t *bitmap = atlas.AllocateBitmap(16);
+    std::fill_n(bitmap, 16, uint8_t(ch));
+    glyph.bitmap = bitmap;
+
+    atlas.Add(ch, std::move(glyph));
+  }
+
+  reader.join();
+  ok1(consistent);
+}
+
+int main()
+{
+  plan_tests(18);
+
+  TestLookup();
+  TestAllocate();
+  TestConcurrentLookup();
+
+  return exit_status();
+}
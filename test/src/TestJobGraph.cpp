@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Job/Graph.hpp"
+#include "Operation/Operation.hpp"
+#include "thread/Mutex.hxx"
+#include "TestUtil.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * Records the progress passed by JobGraph::Run().
+ */
+class RecordingOperationEnvironment final : public NullOperationEnvironment {
+public:
+  unsigned range = 0, position = 0;
+  bool position_monotonic = true;
+
+  void SetProgressRange(unsigned _range) noexcept override {
+    range = _range;
+  }
+
+  void SetProgressPosition(unsigned _position) noexcept override {
+    if (_position < position)
+      position_monotonic = false;
+    position = _position;
+  }
+};
+
+/**
+ * Records the order in which jobs were started and finished.
+ */
+class Log {
+  Mutex mutex;
+  std::vector<int> events;
+
+public:
+  void Add(int event) noexcept {
+    const std::lock_guard lock{mutex};
+    events.push_back(event);
+  }
+
+  /**
+   * Returns the position of the event in the log, or -1.
+   */
+  int Find(int event) noexcept {
+    const std::lock_guard lock{mutex};
+    for (std::size_t i = 0; i < events.size(); ++i)
+      if (events[i] == event)
+        return i;
+    return -1;
+  }
+};
+
+/**
+ * Job #i logs +i when it starts and -i when it finishes.
+ */
+static JobGraph::Function
+MakeJob(Log &log, int i, std::chrono::milliseconds duration={})
+{
+  return [&log, i, duration](OperationEnvironment &env){
+    log.Add(i);
+
+    env.SetProgressRange(10);
+    for (unsigned step = 1; step <= 10; ++step) {
+      std::this_thread::sleep_for(duration / 10);
+      env.SetProgressPosition(step);
+    }
+
+    log.Add(-i);
+  };
+}
+
+static void
+TestGraph(unsigned n_threads)
+{
+  Log log;
+  JobGraph graph;
+
+  /* 1 and 2 are independent; 3 depends on 1; 4 depends on 2 and 3;
+     5 throws, but that doesn't keep 6 from running */
+  const auto j1 = graph.Add("1", 100, MakeJob(log, 1, std::chrono::milliseconds(50)));
+  const auto j2 = graph.Add("2", 100, MakeJob(log, 2, std::chrono::milliseconds(50)));
+  const auto j3 = graph.Add("3", 50, MakeJob(log, 3), {j1});
+  graph.Add("4", 50, MakeJob(log, 4), {j2, j3});
+  const auto j5 = graph.Add("5", 10, [](OperationEnvironment &){
+    throw std::runtime_error("Error");
+  });
+  graph.Add("6", 0, MakeJob(log, 6), {j5});
+
+  RecordingOperationEnvironment env;
+  graph.Run(env, n_threads);
+
+  /* all jobs have run */
+  bool all = true;
+  for (int i : {1, 2, 3, 4, 6})
+    all = all && log.Find(-i) >= 0;
+  ok1(all);
+
+  /* dependencies are honoured */
+  ok1(log.Find(3) > log.Find(-1));
+  ok1(log.Find(4) > log.Find(-2));
+  ok1(log.Find(4) > log.Find(-3));
+
+  if (n_threads > 1)
+    /* independent jobs run concurrently */
+    ok1(log.Find(2) < log.Find(-1));
+  else
+    /* in the order they were added */
+    ok1(log.Find(2) > log.Find(-1));
+
+  /* the merged progress */
+  ok1(env.range == 310);
+  ok1(env.position == 310);
+  ok1(env.position_monotonic);
+}
+
+int main()
+{
+  plan_tests(3 * 8);
+
+  TestGraph(1);
+  TestGraph(2);
+  TestGraph(4);
+
+  return exit_status();
+}
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Job/Pool.hpp"
+#include "TestUtil.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+static void
+TestPool(unsigned n_threads)
+{
+  JobPool pool("Test", n_threads);
+
+  /* several batches on the same threads */
+  bool all_once = true;
+  for (unsigned round = 0; round < 50; ++round) {
+    std::vector<std::atomic<unsigned>> counters(1 + round % 7);
+    std::vector<JobPool::Function> jobs;
+    for (auto &i : counters)
+      jobs.emplace_back([&i]{ ++i; });
+
+    pool.Run(jobs);
+
+    for (const auto &i : counters)
+      if (i != 1)
+        all_once = false;
+  }
+
+  ok1(all_once);
+
+  /* a throwing job doesn't keep the others from running */
+  std::atomic<unsigned> n = 0;
+  const JobPool::Function throwing[] = {
+    []{ throw std::runtime_error("Error"); },
+    [&n]{ ++n; },
+    [&n]{ ++n; },
+  };
+  pool.Run(throwing);
+  ok1(n == 2);
+
+  /* the jobs of a batch run concurrently: each one waits until all
+     have started (with a timeout, in case they don't) */
+  std::atomic<unsigned> n_started = 0;
+  std::atomic<bool> concurrent = true;
+  const auto wait_for_all = [&]{
+    ++n_started;
+
+    const auto timeout = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(500);
+    while (n_started < 3) {
+      if (std::chrono::steady_clock::now() > timeout) {
+        concurrent = false;
+        return;
+      }
+
+      std::this_thread::yield();
+    }
+  };
+
+  const JobPool::Function barrier[] = {wait_for_all, wait_for_all, wait_for_all};
+  pool.Run(barrier);
+
+  if (n_threads >= 2)
+    ok1(concurrent);
+  else
+    ok1(!concurrent);
+}
+
+static void
+TestOrder()
+{
+  /* without worker threads, the jobs run in order */
+  JobPool pool("Test", 0);
+
+  std::vector<int> order;
+  const JobPool::Function jobs[] = {
+    [&order]{ order.push_back(1); },
+    [&order]{ order.push_back(2); },
+    [&order]{ order.push_back(3); },
+  };
+
+  pool.Run(jobs);
+  ok1(order == std::vector<int>({1, 2, 3}));
+}
+
+int main()
+{
+  plan_tests(3 * 3 + 1);
+
+  TestPool(0);
+  TestPool(2);
+  TestPool(4);
+  TestOrder();
+
+  return exit_status();
+}
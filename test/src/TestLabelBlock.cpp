@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Renderer/LabelBlock.hpp"
+#include "Renderer/WaypointLabelList.hpp"
+#include "Renderer/WaypointPriority.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+/**
+ * The reference implementation: compare with all rectangles added
+ * before.
+ */
+class SimpleLabelBlock {
+  std::vector<PixelRect> blocks;
+
+public:
+  bool check(const PixelRect rc) noexcept {
+    for (const auto &i : blocks)
+      if (i.OverlapsWith(rc))
+        return false;
+
+    blocks.push_back(rc);
+    return true;
+  }
+
+  void reset() noexcept {
+    blocks.clear();
+  }
+};
+
+static PixelRect
+RandomLabel(int max_width, int max_height)
+{
+  /* some labels partially or completely outside of the screen, and
+     a few very large ones */
+  const int x = rand() % 1200 - 200, y = rand() % 900 - 200;
+  const int width = 1 + rand() % max_width, height = 1 + rand() % max_height;
+  return PixelRect{PixelPoint{x, y}, PixelSize(width, height)};
+}
+
+static void
+TestRandom()
+{
+  srand(42);
+
+  LabelBlock label_block;
+  SimpleLabelBlock reference;
+
+  bool equal = true;
+  unsigned n_accepted = 0, n_rejected = 0;
+
+  /* several frames with different label sizes, to exercise the
+     adaption of the grid in LabelBlock::reset() */
+  for (unsigned frame = 0; frame < 40; ++frame) {
+    label_block.reset();
+    reference.reset();
+
+    const int max_width = 8 << (frame % 6);
+    const int max_height = 4 << (frame % 5);
+
+    for (unsigned i = 0; i < 1000; ++i) {
+      const PixelRect rc = i % 100 == 99
+        ? RandomLabel(1000, 600)
+        : RandomLabel(max_width, max_height);
+
+      const bool accepted = label_block.check(rc);
+      if (accepted != reference.check(rc))
+        equal = false;
+
+      if (accepted)
+        ++n_accepted;
+      else
+        ++n_rejected;
+    }
+  }
+
+  ok1(equal);
+  ok1(n_accepted > 0 && n_rejected > 0);
+}
+
+static void
+TestMany()
+{
+  /* many more labels than the old fixed-size buckets were able to
+     hold: none of them may overlap */
+  LabelBlock label_block;
+  bool ok = true;
+
+  for (int y = 0; y < 600; y += 10)
+    for (int x = 0; x < 800; x += 20)
+      if (!label_block.check(PixelRect{PixelPoint{x, y}, PixelSize{18, 8}}))
+        ok = false;
+
+  for (int y = 0; y < 600; y += 10)
+    for (int x = 0; x < 800; x += 20)
+      if (label_block.check(PixelRect{PixelPoint{x + 5, y + 3}, PixelSize{4, 4}}))
+        ok = false;
+
+  ok1(ok);
+}
+
+class TestWaypointLabelList : public WaypointLabelList {
+public:
+  using WaypointLabelList::WaypointLabelList;
+
+  std::size_t size() const noexcept {
+    return labels.size();
+  }
+};
+
+static void
+AddLabels(WaypointLabelList &list)
+{
+  for (int i = 0; i < 100; ++i)
+    list.Add(_T("Waypoint"), PixelPoint{i * 7, i * 5}, TextInBoxMode{},
+             false, i, false, i % 17 == 0, false, false);
+}
+
+static void
+TestLabelList()
+{
+  /* the capacity is configurable */
+  TestWaypointLabelList small(PixelRect{0, 0, 800, 600}, 10);
+  AddLabels(small);
+  ok1(small.size() == 10);
+
+  TestWaypointLabelList list(PixelRect{0, 0, 800, 600}, 1000);
+  AddLabels(list);
+  ok1(list.size() == 100);
+
+  /* the landables (0, 17, 34, 51, 68, 85) first, then the others
+     with the highest arrival altitudes */
+  list.Sort();
+  static constexpr int expected[] = {85, 68, 51, 34, 17, 0, 99, 98, 97, 96};
+  ok1(std::equal(std::begin(expected), std::end(expected), list.begin(),
+                 [](int altitude, const auto &label){
+                   return label.AltArivalAGL == altitude;
+                 }));
+}
+
+struct PriorityItem {
+  WaypointPriority priority;
+  unsigned id;
+};
+
+/**
+ * Add the items in the given order and return the sorted ids of the
+ * items which were kept.
+ */
+static std::vector<unsigned>
+AddPriorityItems(std::size_t max_size, const std::vector<PriorityItem> &items)
+{
+  WaypointPriorityList<PriorityItem> list(max_size);
+  for (const auto &i : items)
+    if (list.Accepts(i.priority))
+      list.Add([&i](PriorityItem &item){ item = i; });
+
+  std::vector<unsigned> ids;
+  for (const auto &i : list)
+    ids.push_back(i.id);
+
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+static void
+TestPriorityList()
+{
+  /* 0-1: task points, 2-4: airports, 5-7: other landables, 8-9:
+     watched, 10-29: others */
+  std::vector<PriorityItem> items;
+  for (unsigned i = 0; i < 30; ++i) {
+    const bool in_task = i < 2;
+    const bool airport = i >= 2 && i < 5;
+    const bool landable = i >= 2 && i < 8;
+    const bool watched = i >= 8 && i < 10;
+    items.push_back({{in_task, airport, landable, watched}, i});
+  }
+
+  /* below the limit, everything is kept */
+  ok1(AddPriorityItems(30, items).size() == 30);
+
+  /* the most important items are kept, regardless of the order in
+     which they are added */
+  static constexpr unsigned expected[] = {0, 1, 2, 3, 4, 5, 6, 7};
+  const std::vector<unsigned> expected_ids(std::begin(expected),
+                                           std::end(expected));
+
+  ok1(AddPriorityItems(8, items) == expected_ids);
+
+  std::reverse(items.begin(), items.end());
+  ok1(AddPriorityItems(8, items) == expected_ids);
+
+  srand(7);
+  bool shuffled_ok = true;
+  for (unsigned i = 0; i < 100; ++i) {
+    for (std::size_t j = items.size() - 1; j > 0; --j)
+      std::swap(items[j], items[rand() % (j + 1)]);
+
+    if (AddPriorityItems(8, items) != expected_ids)
+      shuffled_ok = false;
+  }
+
+  ok1(shuffled_ok);
+
+  /* within the same priority, any of the items may be kept */
+  const auto ids = AddPriorityItems(4, items);
+  ok1(ids.size() == 4 && ids[0] == 0 && ids[1] == 1 &&
+      ids[2] >= 2 && ids[3] <= 4);
+}
+
+int main()
+{
+  plan_tests(2 + 1 + 3 + 5);
+
+  TestRandom();
+  TestMany();
+  TestLabelList();
+  TestPriorityList();
+
+  return exit_status();
+}
@@ -10,6 +10,8 @@
 
 #include "TestUtil.hpp"
 
+#include <array>
+
 static GlideSettings glide_settings;
 static GlidePolar glide_polar(0);
 
@@ -109,6 +111,46 @@ TestWind(const SpeedVector &wind)
   Test(100000, 4000, wind);
 }
 
+/**
+ * Compare the batch version of MacCready::SolveStraight() with the
+ * scalar version.
+ */
+static void
+TestBatch(const SpeedVector wind)
+{
+  constexpr std::size_t N = 64;
+  std::array<double, N> distance, altitude_difference;
+  std::array<Angle, N> bearing;
+  for (std::size_t i = 0; i < N; ++i) {
+    distance[i] = i % 8 == 0 ? 0 : 1000. * i;
+    bearing[i] = Angle::Degrees(i * 37.);
+    altitude_difference[i] = -500. + 40. * i;
+  }
+
+  std::array<double, N> arrival, time_elapsed;
+  std::array<GlideResult::Validity, N> validity;
+
+  const MacCready mac_cready(glide_settings, glide_polar);
+  mac_cready.SolveStraight(wind, distance, bearing, altitude_difference,
+                           arrival, time_elapsed, validity);
+
+  bool success = true;
+  for (std::size_t i = 0; i < N; ++i) {
+    const GlideState state(GeoVector(distance[i], bearing[i]),
+                           0, altitude_difference[i], wind);
+    const GlideResult result = mac_cready.SolveStraight(state);
+
+    if (result.validity != validity[i])
+      success = false;
+    else if (result.IsOk() &&
+             (!equals(result.altitude_difference, arrival[i]) ||
+              !equals(result.time_elapsed.count(), time_elapsed[i])))
+      success = false;
+  }
+
+  ok1(success);
+}
+
 static void
 TestAll()
 {
@@ -118,11 +160,15 @@ TestAll()
   TestWind(SpeedVector(Angle::Zero(), 10));
   TestWind(SpeedVector(Angle::Zero(), 15));
   TestWind(SpeedVector(Angle::Zero(), 30));
+
+  TestBatch(SpeedVector(Angle::Zero(), 0));
+  TestBatch(SpeedVector(Angle::Degrees(60), 10));
+  TestBatch(SpeedVector(Angle::Degrees(200), 40));
 }
 
 int main()
 {
-  plan_tests(2103);
+  plan_tests(2118);
 
   glide_settings.SetDefaults();
 
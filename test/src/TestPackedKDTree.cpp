@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "util/PackedKDTree.hxx"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+struct Item {
+  int x, y;
+  unsigned id;
+
+  bool operator==(const Item &) const noexcept = default;
+};
+
+struct ItemAccessor {
+  int GetX(const Item &item) const noexcept {
+    return item.x;
+  }
+
+  int GetY(const Item &item) const noexcept {
+    return item.y;
+  }
+};
+
+using Tree = PackedKDTree<Item, ItemAccessor>;
+
+static std::mt19937 rng(42);
+
+static Item
+RandomItem(unsigned id, int extent=100000)
+{
+  std::uniform_int_distribution<int> dist(-extent, extent);
+  return {dist(rng), dist(rng), id};
+}
+
+static uint64_t
+SquareDistance(const Item &item, Tree::Point p)
+{
+  return Tree::Point(item.x, item.y).SquareDistanceTo(p);
+}
+
+static bool
+IsEven(const Item &item) noexcept
+{
+  return item.id % 2 == 0;
+}
+
+/**
+ * Returns the sorted square distances of all items within the range
+ * (matching the predicate).
+ */
+template<typename P>
+static std::vector<uint64_t>
+BruteForce(const std::vector<Item> &items, Tree::Point p, unsigned range,
+           P predicate)
+{
+  std::vector<uint64_t> result;
+  for (const auto &i : items) {
+    const uint64_t d = SquareDistance(i, p);
+    if (d <= uint64_t(range) * range && predicate(i))
+      result.push_back(d);
+  }
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+static bool
+CheckContents(const Tree &tree, std::vector<Item> items)
+{
+  std::vector<Item> actual(tree.begin(), tree.end());
+  const auto cmp = [](const Item &a, const Item &b){ return a.id < b.id; };
+  std::sort(actual.begin(), actual.end(), cmp);
+  std::sort(items.begin(), items.end(), cmp);
+  return actual == items;
+}
+
+static bool
+CheckNearest(const Tree &tree, const std::vector<Item> &items, bool if_even)
+{
+  for (unsigned i = 0; i < 200; ++i) {
+    const Item q = RandomItem(0, 120000);
+    const Tree::Point p(q.x, q.y);
+    const unsigned range = std::uniform_int_distribution<unsigned>(0, 30000)(rng);
+
+    const auto expected = if_even
+      ? BruteForce(items, p, range, IsEven)
+      : BruteForce(items, p, range, [](const Item &){ return true; });
+
+    const auto found = if_even
+      ? tree.FindNearestIf(p, range, IsEven)
+      : tree.FindNearest(p, range);
+
+    if (expected.empty()) {
+      if (found.first != tree.end())
+        return false;
+    } else {
+      if (found.first == tree.end() ||
+          (if_even && !IsEven(*found.first)) ||
+          SquareDistance(*found.first, p) != expected.front() ||
+          found.second != expected.front())
+        return false;
+    }
+  }
+
+  return true;
+}
+
+static bool
+CheckWithinRange(const Tree &tree, const std::vector<Item> &items)
+{
+  for (unsigned i = 0; i < 100; ++i) {
+    const Item q = RandomItem(0, 120000);
+    const Tree::Point p(q.x, q.y);
+    const unsigned range = std::uniform_int_distribution<unsigned>(0, 50000)(rng);
+
+    std::vector<uint64_t> actual;
+    const auto visitor = [&actual, p](const Item &item){
+      actual.push_back(SquareDistance(item, p));
+    };
+    tree.VisitWithinRange(p, range, visitor);
+    std::sort(actual.begin(), actual.end());
+
+    if (actual != BruteForce(items, p, range, [](const Item &){ return true; }))
+      return false;
+  }
+
+  return true;
+}
+
+static bool
+CheckKNearest(const Tree &tree, const std::vector<Item> &items)
+{
+  for (unsigned i = 0; i < 100; ++i) {
+    const Item q = RandomItem(0, 120000);
+    const Tree::Point p(q.x, q.y);
+    const unsigned range = std::uniform_int_distribution<unsigned>(0, 50000)(rng);
+    const unsigned k = std::uniform_int_distribution<unsigned>(0, 20)(rng);
+
+    std::vector<uint64_t> actual;
+    bool predicate_ok = true;
+    tree.VisitNearestIf(p, range, k, IsEven,
+                        [&actual, &predicate_ok, p](const Item &item){
+                          predicate_ok &= IsEven(item);
+                          actual.push_back(SquareDistance(item, p));
+                        });
+
+    auto expected = BruteForce(items, p, range, IsEven);
+    if (expected.size() > k)
+      expected.resize(k);
+
+    /* nearest first */
+    if (!predicate_ok || actual != expected)
+      return false;
+  }
+
+  return true;
+}
+
+static void
+CheckAll(const Tree &tree, const std::vector<Item> &items)
+{
+  ok1(tree.size() == items.size());
+  ok1(CheckContents(tree, items));
+  ok1(CheckNearest(tree, items, false));
+  ok1(CheckNearest(tree, items, true));
+  ok1(CheckWithinRange(tree, items));
+  ok1(CheckKNearest(tree, items));
+}
+
+int main()
+{
+  plan_tests(8 * 6 + 7);
+
+  Tree tree;
+  std::vector<Item> items;
+  unsigned next_id = 0;
+
+  ok1(tree.IsEmpty());
+  ok1(!tree.HaveBounds());
+
+  /* not optimised yet: everything is scanned linearly */
+  for (unsigned i = 0; i < 3000; ++i) {
+    items.push_back(RandomItem(next_id++));
+    tree.Add(items.back());
+  }
+
+  /* some duplicate positions */
+  for (unsigned i = 0; i < 50; ++i) {
+    Item item = items[i];
+    item.id = next_id++;
+    items.push_back(item);
+    tree.Add(item);
+  }
+
+  CheckAll(tree, items);
+
+  tree.Optimise();
+  ok1(tree.HaveBounds());
+  CheckAll(tree, items);
+
+  /* add values within the bounds, which eventually get indexed */
+  for (unsigned i = 0; i < 100; ++i) {
+    items.push_back(RandomItem(next_id++, 90000));
+    tree.Add(items.back());
+  }
+
+  ok1(tree.HaveBounds());
+  CheckAll(tree, items);
+
+  /* erase single values */
+  for (unsigned i = 0; i < 20; ++i) {
+    const unsigned n = std::uniform_int_distribution<unsigned>(0, items.size() - 1)(rng);
+    const Item item = items[n];
+    items.erase(items.begin() + n);
+    tree.erase(std::find(tree.begin(), tree.end(), item));
+  }
+
+  CheckAll(tree, items);
+
+  /* erase many values */
+  const auto is_multiple_of_seven = [](const Item &item){
+    return item.id % 7 == 0;
+  };
+  items.erase(std::remove_if(items.begin(), items.end(), is_multiple_of_seven),
+              items.end());
+  tree.EraseIf(is_multiple_of_seven);
+
+  CheckAll(tree, items);
+
+  /* move values */
+  for (unsigned i = 0; i < 20; ++i) {
+    const unsigned n = std::uniform_int_distribution<unsigned>(0, items.size() - 1)(rng);
+    const auto it = std::find(tree.begin(), tree.end(), items[n]);
+    items[n] = RandomItem(items[n].id, 90000);
+    tree.Replace(it, items[n]);
+  }
+
+  CheckAll(tree, items);
+
+  /* a value out of bounds clears the bounds */
+  items.push_back({1000000, 1000000, next_id++});
+  tree.Add(items.back());
+  ok1(!tree.HaveBounds());
+  CheckAll(tree, items);
+
+  tree.Optimise();
+  CheckAll(tree, items);
+
+  tree.clear();
+  ok1(tree.IsEmpty());
+  ok1(!tree.HaveBounds());
+
+  return exit_status();
+}
@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Math/PolynomialTrig.hpp"
+#include "Math/Angle.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Geo/SimplifiedMath.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+static void
+TestSinCos()
+{
+  double max_error = 0;
+  for (double x = -4 * M_PI; x <= 4 * M_PI; x += 0.0001) {
+    const auto sc = PolynomialSinCos(x);
+    max_error = std::max(max_error, std::fabs(sc.first - std::sin(x)));
+    max_error = std::max(max_error, std::fabs(sc.second - std::cos(x)));
+  }
+
+  ok1(max_error < 5e-14);
+
+  /* exact quadrant boundaries */
+  ok1(PolynomialSinCos(0).first == 0);
+  ok1(PolynomialSinCos(0).second == 1);
+  ok1(std::fabs(PolynomialSinCos(M_PI / 2).first - 1) < 1e-15);
+  ok1(std::fabs(PolynomialSinCos(-M_PI).second + 1) < 1e-15);
+}
+
+static void
+TestAtan2()
+{
+  double max_error = 0;
+  for (double a = -M_PI; a <= M_PI; a += 0.0001) {
+    for (double r : {1e-6, 1., 1e6}) {
+      const double y = r * std::sin(a), x = r * std::cos(a);
+      max_error = std::max(max_error,
+                           std::fabs(PolynomialAtan2(y, x) - std::atan2(y, x)));
+    }
+  }
+
+  ok1(max_error < 5e-13);
+
+  ok1(PolynomialAtan2(0, 0) == 0);
+  ok1(PolynomialAtan2(0, 1) == 0);
+  ok1(std::fabs(PolynomialAtan2(1, 0) - M_PI / 2) < 1e-15);
+  ok1(std::fabs(PolynomialAtan2(-1, 0) + M_PI / 2) < 1e-15);
+  ok1(std::fabs(PolynomialAtan2(0, -1) - M_PI) < 1e-15);
+}
+
+static void
+TestBulkDistanceBearing()
+{
+  const GeoPoint origins[] = {
+    GeoPoint(Angle::Degrees(7.7061111111111114),
+             Angle::Degrees(51.051944444444445)),
+    GeoPoint(Angle::Degrees(179.5), Angle::Degrees(-33)),
+    GeoPoint(Angle::Degrees(-10), Angle::Degrees(0)),
+  };
+
+  /* destinations from a few metres to the antipode */
+  std::vector<GeoPoint> destinations;
+  unsigned seed = 7;
+  auto next = [&seed](){
+    seed = seed * 1103515245 + 12345;
+    return double((seed >> 8) % 20001) / 10000 - 1;
+  };
+
+  for (const double range : {1e-4, 0.01, 1., 30., 180.})
+    for (unsigned i = 0; i < 200; ++i)
+      destinations.emplace_back(Angle::Degrees(next() * range),
+                                Angle::Degrees(next() * std::min(range, 89.)));
+
+  for (const auto &origin : origins) {
+    std::vector<double> latitudes, longitudes;
+    for (auto g : destinations) {
+      g.longitude += origin.longitude;
+      g.latitude += origin.latitude;
+      g.Normalize();
+      latitudes.push_back(g.latitude.Radians());
+      longitudes.push_back(g.longitude.Radians());
+    }
+
+    const std::size_t n = latitudes.size();
+    std::vector<double> distances(n), distances_only(n);
+    std::vector<Angle> bearings(n), bearings_only(n);
+    DistanceBearingS(origin, latitudes, longitudes,
+                     distances.data(), bearings.data());
+    DistanceBearingS(origin, latitudes, longitudes,
+                     distances_only.data(), nullptr);
+    DistanceBearingS(origin, latitudes, longitudes,
+                     nullptr, bearings_only.data());
+
+    bool distance_ok = true, bearing_ok = true, consistent = true;
+    for (std::size_t i = 0; i < n; ++i) {
+      const GeoPoint destination(Angle::Radians(longitudes[i]),
+                                 Angle::Radians(latitudes[i]));
+
+      double distance;
+      Angle bearing;
+      DistanceBearingS(origin, destination, &distance, &bearing);
+
+      /* below 1 km, the error is dominated by the acos() in
+         DistanceBearingS() */
+      if (std::fabs(distances[i] - distance) > (distance > 1000 ? 1e-5 : 5e-3))
+        distance_ok = false;
+
+      /* the bearing error, as displacement at the destination */
+      if (distance > 0.1 &&
+          std::fabs((bearings[i] - bearing).AsDelta().Radians()) * distance > 1e-4)
+        bearing_ok = false;
+
+      if (bearings[i] < Angle::Zero() || bearings[i] >= Angle::FullCircle())
+        bearing_ok = false;
+
+      if (distances_only[i] != distances[i] ||
+          bearings_only[i] != bearings[i])
+        consistent = false;
+    }
+
+    ok1(distance_ok);
+    ok1(bearing_ok);
+    ok1(consistent);
+  }
+}
+
+int main()
+{
+  plan_tests(5 + 6 + 3 * 3);
+
+  TestSinCos();
+  TestAtan2();
+  TestBulkDistanceBearing();
+
+  return exit_status();
+}
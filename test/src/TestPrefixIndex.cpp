@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "util/PrefixIndex.hpp"
+#include "util/StringAPI.hxx"
+#include "util/tstring.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * A trivial implementation of #PrefixIndex which the real one is
+ * compared with.
+ */
+struct ReferenceIndex {
+  struct Item {
+    tstring key;
+    int value;
+  };
+
+  /**
+   * In insertion order.
+   */
+  std::vector<Item> items;
+
+  void Add(tstring_view key, int value) {
+    items.push_back({tstring{key}, value});
+  }
+
+  void Remove(tstring_view key, int value) {
+    for (auto i = items.rbegin(); i != items.rend(); ++i) {
+      if (i->key == key && i->value == value) {
+        items.erase(std::next(i).base());
+        return;
+      }
+    }
+  }
+
+  std::vector<int> Visit(tstring_view prefix) const {
+    /* sorted by key, the most recent first */
+    std::vector<Item> sorted(items.rbegin(), items.rend());
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const Item &a, const Item &b){
+                       return a.key < b.key;
+                     });
+
+    std::vector<int> result;
+    for (const auto &i : sorted)
+      if (tstring_view{i.key}.starts_with(prefix))
+        result.push_back(i.value);
+    return result;
+  }
+
+  tstring Suggest(tstring_view prefix) const {
+    tstring result;
+    for (const auto &i : items)
+      if (i.key.size() > prefix.size() &&
+          tstring_view{i.key}.starts_with(prefix) &&
+          result.find(i.key[prefix.size()]) == result.npos)
+        result.push_back(i.key[prefix.size()]);
+
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+};
+
+static std::vector<int>
+Visit(const PrefixIndex<int> &index, tstring_view prefix)
+{
+  std::vector<int> result;
+  index.VisitPrefix(prefix, [&result](int value){
+    result.push_back(value);
+  });
+  return result;
+}
+
+static bool
+Compare(const PrefixIndex<int> &index, const ReferenceIndex &reference,
+        tstring_view prefix)
+{
+  if (Visit(index, prefix) != reference.Visit(prefix))
+    return false;
+
+  TCHAR buffer[64];
+  const TCHAR *suggest = index.Suggest(prefix, buffer, std::size(buffer));
+  const auto expected_values = reference.Visit(prefix);
+  if (!prefix.empty() && expected_values.empty())
+    return suggest == nullptr;
+
+  return suggest != nullptr && reference.Suggest(prefix) == suggest;
+}
+
+static bool
+CompareAll(const PrefixIndex<int> &index, const ReferenceIndex &reference)
+{
+  static constexpr const TCHAR *prefixes[] = {
+    _T(""), _T("A"), _T("AB"), _T("ABC"), _T("ABX"), _T("B"),
+    _T("BA"), _T("C"), _T("CAB"), _T("Z"),
+  };
+
+  if (index.size() != reference.items.size())
+    return false;
+
+  for (const TCHAR *prefix : prefixes)
+    if (!Compare(index, reference, prefix))
+      return false;
+
+  for (const auto &i : reference.items) {
+    const int *value = index.Get(i.key);
+    if (value == nullptr)
+      return false;
+
+    /* Get() returns the most recent value */
+    const auto expected = std::find_if(reference.items.rbegin(),
+                                       reference.items.rend(),
+                                       [&i](const auto &j){
+                                         return j.key == i.key;
+                                       });
+    if (*value != expected->value)
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Generate a deterministic key from the given number.
+ */
+static tstring
+MakeKey(unsigned i)
+{
+  static constexpr TCHAR alphabet[] = _T("ABC");
+
+  tstring key;
+  for (unsigned n = 1 + i % 5; n > 0; --n) {
+    key.push_back(alphabet[i % 3]);
+    i = i * 7 + 3;
+  }
+
+  return key;
+}
+
+static void
+TestBasic()
+{
+  PrefixIndex<int> index;
+  ok1(index.empty());
+  ok1(index.Get(_T("A")) == nullptr);
+  ok1(Visit(index, _T("")).empty());
+
+  TCHAR buffer[64];
+  ok1(StringIsEqual(index.Suggest(_T(""), buffer, std::size(buffer)), _T("")));
+  ok1(index.Suggest(_T("A"), buffer, std::size(buffer)) == nullptr);
+
+  index.Add(_T("FOO"), 1);
+  index.Add(_T("FOOBAR"), 2);
+  index.Add(_T("BAR"), 3);
+  index.Add(_T("FOO"), 4);
+
+  ok1(!index.empty());
+  ok1(index.size() == 4);
+  ok1(*index.Get(_T("FOO")) == 4);
+  ok1(index.Get(_T("FO")) == nullptr);
+  ok1((Visit(index, _T("F")) == std::vector<int>{4, 1, 2}));
+
+  ok1(StringIsEqual(index.Suggest(_T(""), buffer, std::size(buffer)), _T("BF")));
+  ok1(StringIsEqual(index.Suggest(_T("FOO"), buffer, std::size(buffer)), _T("B")));
+  ok1(StringIsEqual(index.Suggest(_T("FOOBAR"), buffer, std::size(buffer)), _T("")));
+  ok1(index.Suggest(_T("FOX"), buffer, std::size(buffer)) == nullptr);
+
+  /* the buffer size is respected */
+  ok1(StringIsEqual(index.Suggest(_T(""), buffer, 2), _T("B")));
+
+  index.Commit();
+  ok1(index.size() == 4);
+  ok1(*index.Get(_T("FOO")) == 4);
+  ok1((Visit(index, _T("F")) == std::vector<int>{4, 1, 2}));
+
+  ok1(index.Remove(_T("FOO"), 4));
+  ok1(!index.Remove(_T("FOO"), 4));
+  ok1(!index.Remove(_T("BAR"), 1));
+  ok1(*index.Get(_T("FOO")) == 1);
+
+  index.Clear();
+  ok1(index.empty());
+}
+
+static void
+TestRandom()
+{
+  PrefixIndex<int> index;
+  ReferenceIndex reference;
+
+  /* single inserts, with automatic merges */
+  for (unsigned i = 0; i < 2000; ++i) {
+    const auto key = MakeKey(i);
+    index.Add(key, i);
+    reference.Add(key, i);
+  }
+
+  ok1(CompareAll(index, reference));
+
+  /* a batch on top of existing entries */
+  PrefixIndex<int>::Batch batch;
+  for (unsigned i = 2000; i < 3000; ++i) {
+    const auto key = MakeKey(i);
+    batch.Add(key, i);
+    reference.Add(key, i);
+  }
+
+  index.Add(std::move(batch));
+  ok1(CompareAll(index, reference));
+
+  /* a few more single inserts, which remain pending */
+  for (unsigned i = 3000; i < 3010; ++i) {
+    const auto key = MakeKey(i);
+    index.Add(key, i);
+    reference.Add(key, i);
+  }
+
+  ok1(CompareAll(index, reference));
+
+  /* remove some from both the pending and the main array */
+  for (unsigned i = 0; i < 3010; i += 7) {
+    const auto key = MakeKey(i);
+    ok(index.Remove(key, i), "remove");
+    reference.Remove(key, i);
+  }
+
+  ok1(CompareAll(index, reference));
+
+  index.Commit();
+  ok1(CompareAll(index, reference));
+}
+
+int main()
+{
+  plan_tests(23 + 5 + 430);
+
+  TestBasic();
+  TestRandom();
+
+  return exit_status();
+}
@@ -2,14 +2,25 @@
 // Copyright The XCSoar Project
 
 #include "Profile/Profile.hpp"
+#include "Profile/Current.hpp"
+#include "Profile/Snapshot.hpp"
+#include "SystemSettings.hpp"
+#include "Computer/Settings.hpp"
+#include "UISettings.hpp"
 #include "io/FileLineReader.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/StringOutputStream.hxx"
 #include "system/Path.hpp"
 #include "TestUtil.hpp"
 #include "util/StringAPI.hxx"
 #include "util/StaticString.hxx"
 #include "util/PrintException.hxx"
+#include "util/SpanCast.hxx"
+
+#include <memory>
 
 #include <stdlib.h>
+#include <string.h>
 
 static void
 TestMap()
@@ -119,13 +130,98 @@ TestReader()
   }
 }
 
+/**
+ * The settings structs written to/read from a snapshot.
+ */
+struct SnapshotSettings {
+  SystemSettings system;
+  ComputerSettings computer;
+  UISettings ui;
+
+  explicit SnapshotSettings(int pattern) noexcept {
+    memset(&system, pattern, sizeof(system));
+    memset(&computer, pattern, sizeof(computer));
+    memset(&ui, pattern, sizeof(ui));
+  }
+
+  bool operator==(const SnapshotSettings &other) const noexcept {
+    return memcmp(&system, &other.system, sizeof(system)) == 0 &&
+      memcmp(&computer, &other.computer, sizeof(computer)) == 0 &&
+      memcmp(&ui, &other.ui, sizeof(ui)) == 0;
+  }
+
+  bool Load(Path path, uint64_t key) {
+    return Profile::LoadSnapshot(path, key, system, computer, ui);
+  }
+};
+
+static void
+TestSnapshot()
+{
+  Profile::Clear();
+  Profile::Set("key1", 4);
+  Profile::Set("key2", "value2");
+
+  const uint64_t key = Profile::GetSnapshotKey(Profile::map, _T("build1"), 3600);
+  ok1(key == Profile::GetSnapshotKey(Profile::map, _T("build1"), 3600));
+  ok1(key != Profile::GetSnapshotKey(Profile::map, _T("build2"), 3600));
+  /* a different system time zone changes the default UTC offset */
+  ok1(key != Profile::GetSnapshotKey(Profile::map, _T("build1"), 7200));
+
+  Profile::Set("key2", "value3");
+  ok1(key != Profile::GetSnapshotKey(Profile::map, _T("build1"), 3600));
+
+  /* the key/value boundaries are part of the key */
+  Profile::Clear();
+  Profile::Set("key1", "4");
+  Profile::Set("key2", "value2");
+  const uint64_t key_a = Profile::GetSnapshotKey(Profile::map, _T("build1"), 3600);
+  Profile::Clear();
+  Profile::Set("key1", "4k");
+  Profile::Set("ey2", "value2");
+  ok1(key_a != Profile::GetSnapshotKey(Profile::map, _T("build1"), 3600));
+
+  const Path path(_T("output/TestProfileSnapshot.bin"));
+  const auto saved = std::make_unique<SnapshotSettings>(0x5a);
+
+  {
+    FileOutputStream fos(path);
+    Profile::SaveSnapshot(fos, key, saved->system, saved->computer, saved->ui);
+    fos.Commit();
+  }
+
+  const auto loaded = std::make_unique<SnapshotSettings>(0);
+  ok1(!loaded->Load(path, key + 1));
+  ok1(*loaded == SnapshotSettings(0));
+  ok1(loaded->Load(path, key));
+  ok1(*loaded == *saved);
+
+  /* a truncated snapshot is rejected */
+  {
+    StringOutputStream sos;
+    Profile::SaveSnapshot(sos, key, saved->system, saved->computer, saved->ui);
+
+    std::string_view contents = sos.GetValue();
+    contents.remove_suffix(1);
+
+    FileOutputStream fos(path);
+    fos.Write(AsBytes(contents));
+    fos.Commit();
+  }
+
+  const auto truncated = std::make_unique<SnapshotSettings>(0);
+  ok1(!truncated->Load(path, key));
+  ok1(*truncated == SnapshotSettings(0));
+}
+
 int main()
 try {
-  plan_tests(31);
+  plan_tests(42);
 
   TestMap();
   TestWriter();
   TestReader();
+  TestSnapshot();
 
   return exit_status();
 } catch (...) {
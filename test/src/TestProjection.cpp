@@ -2,8 +2,13 @@
 // Copyright The XCSoar Project
 
 #include "Projection/Projection.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "Geo/Flat/FlatGeoPoint.hpp"
 #include "TestUtil.hpp"
 
+#include <algorithm>
+#include <vector>
+
 static void
 TestGeoScreenCouple(const Projection prj, const GeoPoint geo,
                     int x, int y)
@@ -27,11 +32,95 @@ test_simple()
                                     Angle::Zero()), 0, 0);
 }
 
+/**
+ * Generate a deterministic pseudo-random set of locations around the
+ * given center, including some which cross the date line.
+ */
+static std::vector<GeoPoint>
+MakeLocations(const GeoPoint center, unsigned n)
+{
+  std::vector<GeoPoint> v;
+  v.reserve(n);
+
+  unsigned seed = 42;
+  auto next = [&seed](){
+    seed = seed * 1103515245 + 12345;
+    return int((seed >> 8) % 20001) - 10000;
+  };
+
+  for (unsigned i = 0; i < n; ++i) {
+    GeoPoint g(center.longitude + Angle::Degrees(next() / 2000.),
+               center.latitude + Angle::Degrees(next() / 4000.));
+    g.Normalize();
+    v.push_back(g);
+  }
+
+  return v;
+}
+
+static bool
+CheckBatch(const Projection &prj, const std::vector<GeoPoint> &locations)
+{
+  /* not a multiple of the batch size, to check the remainder */
+  const unsigned n = locations.size();
+  std::vector<PixelPoint> batch(n);
+  prj.GeoToScreen(std::span<const GeoPoint>{locations}, batch.data());
+
+  for (unsigned i = 0; i < n; ++i)
+    if (batch[i] != prj.GeoToScreen(locations[i]))
+      return false;
+
+  return true;
+}
+
+static void
+TestBatch()
+{
+  const GeoPoint centers[] = {
+    GeoPoint(Angle::Degrees(7.7061111111111114),
+             Angle::Degrees(51.051944444444445)),
+    GeoPoint(Angle::Degrees(179.9), Angle::Degrees(-45)),
+    GeoPoint(Angle::Degrees(-179.5), Angle::Degrees(65)),
+  };
+
+  for (const auto &center : centers) {
+    const auto locations = MakeLocations(center, 1000);
+
+    Projection prj;
+    prj.SetGeoLocation(center);
+    prj.SetScreenOrigin(320, 240);
+    prj.SetScale(640. / 200000);
+    ok1(CheckBatch(prj, locations));
+
+    prj.SetScreenAngle(Angle::Degrees(37));
+    ok1(CheckBatch(prj, locations));
+
+    prj.SetScale(640. / 2000000);
+    prj.SetScreenAngle(Angle::Degrees(-123));
+    ok1(CheckBatch(prj, locations));
+
+    const FlatProjection flat(center);
+    std::vector<FlatGeoPoint> flat_batch(locations.size());
+    flat.ProjectInteger(locations, flat_batch.data());
+    ok1(std::equal(locations.begin(), locations.end(), flat_batch.begin(),
+                   [&flat](const GeoPoint &a, const FlatGeoPoint &b){
+                     return flat.ProjectInteger(a) == b;
+                   }));
+  }
+
+  /* empty input */
+  Projection prj;
+  prj.SetGeoLocation(GeoPoint::Zero());
+  prj.GeoToScreen(std::span<const GeoPoint>{}, (PixelPoint *)nullptr);
+  ok1(true);
+}
+
 int main()
 {
-  plan_tests(4);
+  plan_tests(4 + 3 * 4 + 1);
 
   test_simple();
+  TestBatch();
 
   return exit_status();
 }
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Terrain/RasterBuffer.hpp"
+#include "TestUtil.hpp"
+
+static void
+Fill(RasterBuffer &buffer, std::initializer_list<int16_t> values)
+{
+  TerrainHeight *p = buffer.GetData();
+  for (const int16_t value : values)
+    *p++ = TerrainHeight(value);
+}
+
+static void
+TestInterpolate()
+{
+  constexpr int16_t WATER = -30001;
+
+  RasterBuffer a(3, 2), b(3, 2), c;
+  Fill(a, {0, 100, -100, WATER, -32768, 50});
+  Fill(b, {100, 300, 100, 200, 150, WATER});
+
+  c.Interpolate(a, b, 0);
+  ok1(c.GetSize() == a.GetSize());
+  ok1(c.Get({0, 0}).GetValue() == 0);
+  ok1(c.Get({1, 0}).GetValue() == 100);
+
+  c.Interpolate(a, b, 0x100);
+  ok1(c.Get({0, 0}).GetValue() == 100);
+  ok1(c.Get({1, 0}).GetValue() == 300);
+
+  c.Interpolate(a, b, 0x40);
+  ok1(c.Get({0, 0}).GetValue() == 25);
+  ok1(c.Get({1, 0}).GetValue() == 150);
+  ok1(c.Get({2, 0}).GetValue() == -50);
+
+  /* special values are not interpolated; the nearer one wins */
+  ok1(c.Get({0, 1}).IsWater());
+  ok1(c.Get({1, 1}).IsInvalid());
+  ok1(c.Get({2, 1}).GetValue() == 50);
+
+  c.Interpolate(a, b, 0xc0);
+  ok1(c.Get({0, 1}).GetValue() == 200);
+  ok1(c.Get({1, 1}).GetValue() == 150);
+  ok1(c.Get({2, 1}).IsWater());
+}
+
+int main()
+{
+  plan_tests(14);
+
+  TestInterpolate();
+
+  return exit_status();
+}
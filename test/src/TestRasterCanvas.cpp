@@ -0,0 +1,228 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "ui/canvas/memory/RasterCanvas.hpp"
+#include "ui/canvas/memory/PixelOperations.hpp"
+#include "ui/canvas/memory/Optimised.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+static constexpr unsigned WIDTH = 67, HEIGHT = 53;
+
+struct TestBuffer {
+  WritableImageBuffer<GreyscalePixelTraits> image;
+
+  TestBuffer() noexcept {
+    image.Allocate({WIDTH, HEIGHT});
+  }
+
+  ~TestBuffer() noexcept {
+    image.Free();
+  }
+};
+
+class TestCanvas : TestBuffer, public RasterCanvas<GreyscalePixelTraits> {
+public:
+  TestCanvas() noexcept
+    :RasterCanvas(image) {}
+
+  void Clear() noexcept {
+    FillRectangle(0, 0, WIDTH, HEIGHT, Luminosity8(0));
+  }
+
+  uint8_t Get(unsigned x, unsigned y) noexcept {
+    return At(x, y)->GetLuminosity();
+  }
+
+  bool Equals(TestCanvas &other) noexcept {
+    for (unsigned y = 0; y < HEIGHT; ++y)
+      for (unsigned x = 0; x < WIDTH; ++x)
+        if (Get(x, y) != other.Get(x, y))
+          return false;
+    return true;
+  }
+};
+
+/**
+ * The reference implementation: a pixel is filled if an odd number of
+ * edge crossings on its scanline lie on or left of it; the crossing
+ * is the edge's intersection with the scanline rounded to the nearest
+ * pixel (halves up), calculated without incremental errors.
+ */
+static bool
+IsInside(const std::vector<PixelPoint> &polygon, int x, int y)
+{
+  bool inside = false;
+
+  for (std::size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+    PixelPoint a = polygon[j], b = polygon[i];
+    if (a.y == b.y)
+      continue;
+    if (a.y > b.y)
+      std::swap(a, b);
+    if (y < a.y || y >= b.y)
+      continue;
+
+    const int64_t h = b.y - a.y;
+    const int64_t numerator = 2 * a.x * h + h + 2 * int64_t(y - a.y) * (b.x - a.x);
+    int64_t crossing = numerator / (2 * h);
+    if (numerator % (2 * h) < 0)
+      --crossing;
+
+    if (crossing <= x)
+      inside = !inside;
+  }
+
+  return inside;
+}
+
+static void
+TestRectangle()
+{
+  TestCanvas a, b;
+  a.Clear();
+  b.Clear();
+
+  const PixelPoint rectangle[] = {{5, 7}, {40, 7}, {40, 30}, {5, 30}};
+  a.FillPolygon(rectangle, 4, Luminosity8(0xff));
+  b.FillRectangle(5, 7, 40, 30, Luminosity8(0xff));
+  ok1(a.Equals(b));
+
+  /* completely clipped */
+  const PixelPoint outside[] = {{-20, -20}, {-5, -20}, {-5, 100}};
+  a.Clear();
+  a.FillPolygon(outside, 3, Luminosity8(0xff));
+  b.Clear();
+  ok1(a.Equals(b));
+}
+
+static void
+TestRandomPolygons()
+{
+  srand(42);
+
+  bool reference_ok = true, order_ok = true;
+
+  TestCanvas a, b;
+  for (unsigned n_polygon = 0; n_polygon < 200; ++n_polygon) {
+    /* vertices well outside the buffer, to test clipping */
+    std::vector<PixelPoint> polygon;
+    const unsigned n = 3 + rand() % 10;
+    for (unsigned i = 0; i < n; ++i)
+      polygon.emplace_back(rand() % (3 * WIDTH) - int(WIDTH),
+                           rand() % (3 * HEIGHT) - int(HEIGHT));
+
+    a.Clear();
+    a.FillPolygon(polygon.data(), n, Luminosity8(0xff));
+
+    for (unsigned y = 0; y < HEIGHT; ++y)
+      for (unsigned x = 0; x < WIDTH; ++x)
+        if ((a.Get(x, y) != 0) != IsInside(polygon, x, y))
+          reference_ok = false;
+
+    /* the result must not depend on the vertex order */
+    std::vector<PixelPoint> reversed(polygon.rbegin(), polygon.rend());
+    std::rotate(reversed.begin(), reversed.begin() + n / 2, reversed.end());
+    b.Clear();
+    b.FillPolygon(reversed.data(), n, Luminosity8(0xff));
+    if (!a.Equals(b))
+      order_ok = false;
+  }
+
+  ok1(reference_ok);
+  ok1(order_ok);
+}
+
+static void
+TestSharedEdges()
+{
+  /* a square split into four triangles along its diagonals: each
+     pixel must be filled exactly once */
+  TestCanvas canvas;
+  canvas.Clear();
+
+  const PixelPoint c{30, 25};
+  const PixelPoint corners[] = {{3, 4}, {60, 9}, {55, 50}, {7, 44}};
+
+  for (unsigned i = 0; i < 4; ++i) {
+    const PixelPoint triangle[] = {c, corners[i], corners[(i + 1) % 4]};
+    canvas.FillPolygon(triangle, 3, Luminosity8(1 << i),
+                       BitOrPixelOperations<GreyscalePixelTraits>());
+  }
+
+  const std::vector<PixelPoint> square(std::begin(corners), std::end(corners));
+
+  bool once = true;
+  for (unsigned y = 0; y < HEIGHT; ++y) {
+    for (unsigned x = 0; x < WIDTH; ++x) {
+      const unsigned value = canvas.Get(x, y);
+      if (IsInside(square, x, y)
+          ? (value == 0 || (value & (value - 1)) != 0)
+          : value != 0)
+        once = false;
+    }
+  }
+
+  ok1(once);
+}
+
+static void
+TestAlphaFill()
+{
+  /* all span lengths, to cover both the SIMD and the portable
+     remainder */
+  bool ok = true;
+
+  for (unsigned n = 0; n <= 40; ++n) {
+    for (const uint8_t alpha : {0x00, 0x40, 0x80, 0xff}) {
+      std::vector<Luminosity8> grey(48, Luminosity8(0x30));
+      AlphaPixelOperations<GreyscalePixelTraits>(alpha)
+        .FillPixels(grey.data() + 1, n, Luminosity8(0xe0));
+
+      const int expected = (0x30 * (255 - alpha) + 0xe0 * alpha) / 255;
+      for (unsigned i = 0; i < grey.size(); ++i) {
+        const int value = grey[i].GetLuminosity();
+        if (i >= 1 && i <= n
+            ? std::abs(value - expected) > 2
+            : value != 0x30)
+          ok = false;
+      }
+
+#ifndef GREYSCALE
+      std::vector<BGRA8Color> bgra(48, BGRA8Color(0x10, 0x80, 0xf0));
+      AlphaPixelOperations<BGRAPixelTraits>(alpha)
+        .FillPixels(bgra.data() + 1, n, BGRA8Color(0xf0, 0x20, 0x00));
+
+      const int red = (0x10 * (255 - alpha) + 0xf0 * alpha) / 255;
+      const int green = (0x80 * (255 - alpha) + 0x20 * alpha) / 255;
+      const int blue = (0xf0 * (255 - alpha)) / 255;
+      for (unsigned i = 0; i < bgra.size(); ++i) {
+        const auto c = bgra[i];
+        if (i >= 1 && i <= n
+            ? (std::abs(c.Red() - red) > 2 || std::abs(c.Green() - green) > 2 ||
+               std::abs(c.Blue() - blue) > 2)
+            : c.Red() != 0x10 || c.Green() != 0x80 || c.Blue() != 0xf0)
+          ok = false;
+      }
+#endif
+    }
+  }
+
+  ok1(ok);
+}
+
+int main()
+{
+  plan_tests(2 + 2 + 1 + 1);
+
+  TestRectangle();
+  TestRandomPolygons();
+  TestSharedEdges();
+  TestAlphaFill();
+
+  return exit_status();
+}
@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Engine/Trace/Snapshot.hpp"
+#include "Engine/Trace/Trace.hpp"
+#include "Engine/Trace/Vector.hpp"
+#include "TestUtil.hpp"
+
+#include <cmath>
+#include <memory>
+
+using namespace std::chrono;
+
+/**
+ * Append a point of a (rather wobbly) circle.
+ */
+static void
+Push(Trace &trace, unsigned t)
+{
+  const double angle = t * 0.05;
+  const GeoPoint location(Angle::Degrees(7 + 0.01 * cos(angle) + t * 1e-5),
+                          Angle::Degrees(51 + 0.01 * sin(angle)));
+
+  trace.push_back(TracePoint(location, duration<unsigned>{t},
+                             1000 + (int)(t % 500), (t % 7) - 3.,
+                             (t * 3) % 256));
+}
+
+/**
+ * Does the snapshot contain exactly the points of the trace?
+ */
+static bool
+Equals(const TraceSnapshot &snapshot, const Trace &trace)
+{
+  if (snapshot.size() != trace.size())
+    return false;
+
+  std::size_t i = 0;
+  for (const auto &point : trace) {
+    if (snapshot.GetTimes()[i] != point.GetTime() ||
+        snapshot.GetLocations()[i] != point.GetLocation() ||
+        snapshot.GetFlatX()[i] != point.GetFlatLocation().x ||
+        snapshot.GetFlatY()[i] != point.GetFlatLocation().y ||
+        snapshot.GetAltitudes()[i] != (float)point.GetAltitude() ||
+        snapshot.GetVarios()[i] != (float)point.GetVario() ||
+        snapshot.GetEngineNoiseLevels()[i] != point.GetEngineNoiseLevel())
+      return false;
+
+    ++i;
+  }
+
+  return snapshot.IsUpToDate(trace);
+}
+
+static void
+TestSync()
+{
+  Trace trace({}, Trace::null_time, 64);
+  TraceSnapshot snapshot;
+
+  /* an empty trace */
+  snapshot.Sync(trace);
+  ok1(snapshot.empty());
+  ok1(snapshot.IsUpToDate(trace));
+
+  /* appending */
+  unsigned t = 1000;
+  for (; t < 1000 + 2 * 40; t += 2)
+    Push(trace, t);
+
+  ok1(!snapshot.IsUpToDate(trace));
+  ok1(snapshot.IsAppendable(trace));
+  snapshot.Sync(trace);
+  ok1(Equals(snapshot, trace));
+
+  for (unsigned i = 0; i < 10; ++i, t += 2)
+    Push(trace, t);
+
+  ok1(snapshot.IsAppendable(trace));
+  snapshot.Sync(trace);
+  ok1(Equals(snapshot, trace));
+
+  /* a copy continues where the original left off */
+  TraceSnapshot copy(snapshot);
+  for (unsigned i = 0; i < 5; ++i, t += 2)
+    Push(trace, t);
+  copy.Sync(trace);
+  ok1(Equals(copy, trace));
+  ok1(!snapshot.IsUpToDate(trace));
+
+  /* thinning modifies the trace */
+  for (unsigned i = 0; i < 100; ++i, t += 2)
+    Push(trace, t);
+
+  ok1(!snapshot.IsAppendable(trace));
+  snapshot.Sync(trace);
+  ok1(Equals(snapshot, trace));
+
+  /* clearing */
+  trace.clear();
+  snapshot.Sync(trace);
+  ok1(snapshot.empty());
+  ok1(snapshot.IsUpToDate(trace));
+}
+
+static void
+TestSelect()
+{
+  Trace trace({}, Trace::null_time, 512);
+  for (unsigned t = 1000; t < 1000 + 2 * 400; t += 2)
+    Push(trace, t);
+
+  TraceSnapshot snapshot;
+  snapshot.Sync(trace);
+
+  const GeoPoint location(Angle::Degrees(7), Angle::Degrees(51));
+
+  for (const unsigned min_time : {0u, 1300u, 1555u, 5000u}) {
+    for (const double resolution : {1., 50., 300.}) {
+      TracePointVector expected;
+      trace.GetPoints(expected, duration<unsigned>{min_time},
+                      location, resolution);
+
+      std::vector<unsigned> selection;
+      snapshot.Select(selection, duration<unsigned>{min_time},
+                      location, resolution);
+
+      bool equal = selection.size() == expected.size();
+      for (std::size_t i = 0; equal && i < selection.size(); ++i)
+        equal = snapshot.GetTimes()[selection[i]] == expected[i].GetTime();
+
+      ok1(equal);
+    }
+  }
+
+  ok1(snapshot.FindTime(duration<unsigned>{0}) == 0);
+  ok1(snapshot.FindTime(duration<unsigned>{1001}) == 1);
+  ok1(snapshot.FindTime(duration<unsigned>{5000}) == snapshot.size());
+}
+
+int main()
+{
+  plan_tests(13 + 12 + 3);
+
+  TestSync();
+  TestSelect();
+
+  return exit_status();
+}
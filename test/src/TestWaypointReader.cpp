@@ -3,6 +3,7 @@
 
 #include "Waypoint/WaypointReader.hpp"
 #include "Waypoint/WaypointReaderBase.hpp"
+#include "Waypoint/WaypointFileType.hpp"
 #include "Waypoint/CupWriter.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Terrain/RasterMap.hpp"
@@ -11,9 +12,11 @@
 #include "system/Path.hpp"
 #include "io/BufferedOutputStream.hxx"
 #include "io/StringOutputStream.hxx"
+#include "io/FileReader.hxx"
 #include "util/tstring.hpp"
 #include "util/StringAPI.hxx"
 #include "util/StringStrip.hxx"
+#include "util/SpanCast.hxx"
 #include "Operation/Operation.hpp"
 
 #include <vector>
@@ -318,6 +321,92 @@ TestCupWriter(const wp_vector &org_wp)
 )cup"sv);
 }
 
+static std::string
+LoadFile(Path path)
+{
+  FileReader reader{path};
+  std::string contents;
+  contents.resize(reader.GetSize());
+  reader.ReadFull(std::as_writable_bytes(std::span{contents}));
+  return contents;
+}
+
+/**
+ * Parse the given file contents sequentially and in chunks, and
+ * check that both yield the same waypoint list.
+ */
+static void
+TestParallel(std::string_view contents, WaypointFileType type,
+             unsigned num_wps)
+{
+  const WaypointFactory factory(WaypointOrigin::NONE);
+
+  Waypoints sequential, parallel;
+  ParseWaypointFile(contents, type, sequential, factory, 1);
+  ParseWaypointFile(contents, type, parallel, factory, 4);
+
+  ok1(sequential.size() == num_wps);
+  ok1(parallel.size() == num_wps);
+
+  bool equal = true;
+  for (unsigned id = 1; id <= num_wps; ++id) {
+    const auto a = sequential.LookupId(id), b = parallel.LookupId(id);
+    if (a == nullptr || b == nullptr ||
+        a->name != b->name || a->shortname != b->shortname ||
+        a->comment != b->comment || a->location != b->location ||
+        a->elevation != b->elevation || a->type != b->type)
+      equal = false;
+  }
+
+  ok1(equal);
+}
+
+static void
+TestParallel(Path path, WaypointFileType type, unsigned num_wps)
+{
+  TestParallel(LoadFile(path), type, num_wps);
+}
+
+/**
+ * Generate a SeeYou file with quoted line breaks and commas, which
+ * must not be mistaken for record boundaries, and a task section,
+ * which must not be parsed as waypoints.
+ */
+static std::string
+GenerateSeeYou(unsigned n)
+{
+  std::string s = "name,code,country,lat,lon,elev,style,rwdir,rwlen,freq,desc\n";
+
+  for (unsigned i = 0; i < n; ++i) {
+    char line[256];
+    snprintf(line, sizeof(line),
+             "\"WP %u\",\"W%u\",DE,%02u%02u.%03uN,%03u%02u.%03uE,%um,%u,,,,"
+             "\"line one, %u\nline \"\"two\"\"\"\n",
+             i, i, 40 + i % 10, i % 60, i % 1000,
+             5 + i % 20, (i * 7) % 60, (i * 13) % 1000,
+             i % 3000, 1 + i % 5, i);
+    s += line;
+  }
+
+  s += "-----Related Tasks-----\n"
+    "\"Task\",\"WP 1\",\"WP 2\"\n";
+  return s;
+}
+
+static void
+TestParallel()
+{
+  TestParallel(Path(_T("test/data/waypoints.dat")),
+               WaypointFileType::WINPILOT, 5);
+  TestParallel(Path(_T("test/data/waypoints.cup")),
+               WaypointFileType::SEEYOU, 5);
+  TestParallel(Path(_T("test/data/waypoints2.cup")),
+               WaypointFileType::SEEYOU, 5);
+  TestParallel(Path(_T("test/data/waypoints.wpz")),
+               WaypointFileType::ZANDER, 5);
+  TestParallel(GenerateSeeYou(1000), WaypointFileType::SEEYOU, 1000);
+}
+
 static wp_vector
 CreateOriginalWaypoints()
 {
@@ -420,7 +509,7 @@ int main()
 {
   wp_vector org_wp = CreateOriginalWaypoints();
 
-  plan_tests(451);
+  plan_tests(466);
 
   TestWinPilot(org_wp);
   TestSeeYou(org_wp);
@@ -431,6 +520,7 @@ int main()
   TestCompeGPS(org_wp);
   TestCompeGPS_UTM(org_wp);
   TestCupWriter(org_wp);
+  TestParallel();
 
   return exit_status();
 }
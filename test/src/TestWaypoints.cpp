@@ -4,6 +4,8 @@
 #include "Waypoint/Waypoints.hpp"
 #include "Geo/GeoVector.hpp"
 #include "test_debug.hpp"
+#include "util/StaticString.hxx"
+#include "util/StringCompare.hxx"
 
 #include <functional>
 